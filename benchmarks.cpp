@@ -0,0 +1,809 @@
+/*******************************************************************************
+ Benchmarks for juce_native_macos_dialogs
+
+ Measures the platform independent stages of showing a popup menu, for menu
+ sizes from 10 to 100,000 items and several nesting shapes:
+
+   flatten      PopupMenu -> NativeMacMenuModel
+   build        the same model added item by item, including its ID index
+   lookup       indexOfItemID() for every item
+   hash         NativeMacMenuModel::getHash()
+   text         NativeMacMenuModel::toText()
+   diff         NativeMacMenuModel::compare() after the ticked item moved
+   mockNative   a backend that builds a native-like item tree, as NSMenu does
+   endToEnd     NativeMacPopupMenu::showPopupMenuAt() through that backend
+
+ plus the latency histograms the module keeps for every call:
+
+   histogramRecord    NativeMacLatencyHistogram::record()
+   histogramSummary   getSummary() of a histogram holding 100,000 values
+
+ and the clipboard schema container, with a preset state section of 1 KB to
+ 1 MB next to a few small fields:
+
+   schemaWrite        Writer -> container, into a reused MemoryBlock
+   schemaOpen         Reader construction, which validates header and table
+   schemaReadName     opening the container and reading the name section
+   schemaVerifyAll    Reader::verifyAllSections(), checksumming everything
+
+ and the framed clipboard payload, for 1 KB to 1 MB of preset XML (items is
+ the size of the frame, or of the data for the checksums):
+
+   payloadEncode      encode() with Compression::none
+   payloadEncodeLZ    encode() with Compression::lz
+   payloadDecode      decode() of the stored frame into a reused buffer
+   payloadDecodeLZ    decode() of the compressed frame into a reused buffer
+   crc32c             Checksum::crc32c(), hardware accelerated where available
+   crc32cSoftware     the table-driven Checksum::crc32cSoftware()
+
+ and the text input dialog's validation, against libraries of 1,000 and
+ 50,000 preset names:
+
+   nameIndexBuild     NativeMacNameIndex from the library
+   nameIndexLookup    contains(), half hits and half misses
+   validateKeystroke  NativeMacTextValidator::validate() as a name is typed
+                      and erased one character at a time, with the
+                      file name and uniqueness rules
+
+ and the completion index, for 1,000 to 100,000 names:
+
+   completionBuild        NativeMacCompletionIndex from the names
+   completionTopK         the 10 first completions of each keystroke's prefix
+   completionTopKWeighted the 10 heaviest completions, with usage weights
+
+ and the worker side of a progress dialog, with 1 to 8 threads updating the
+ same NativeMacProgressState at once (size is the number of threads; the
+ time is per call on one of them):
+
+   progressAdvance    advance (1)
+   progressSetStatus  setStatus() with a 47 character status
+   progressSample     what the dialog does per frame, getProgress() and
+                      readStatus(), while the workers update
+
+ Build it as a console application with juce_core, juce_gui_basics and this
+ module. Results are written as JSON, so builders can keep them and compare
+ runs; per operation times are in microseconds.
+
+   benchmarks [--quick] [--output results.json]
+
+ --quick stops at 10,000 items and samples for less time, for CI smoke runs.
+*******************************************************************************/
+
+#include "../juce_native_macos_dialogs/juce_native_macos_dialogs.h"
+
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace Benchmarks
+{
+
+//==============================================================================
+enum class Shape
+{
+    flat,       // every item at the top level
+    sectioned,  // sections of 32 items with headers and separators, every 5th item disabled
+    nested,     // submenus of up to 16 entries each, as deep as needed
+    deep        // a chain of up to 64 submenus with the items spread over them
+};
+
+static const char* getShapeName (Shape shape)
+{
+    switch (shape)
+    {
+        case Shape::flat:       return "flat";
+        case Shape::sectioned:  return "sectioned";
+        case Shape::nested:     return "nested";
+        case Shape::deep:       return "deep";
+    }
+
+    return "";
+}
+
+struct MenuBuilder
+{
+    int nextID = 1;
+    int tickedID = 0;
+
+    void addItem (juce::PopupMenu& menu, bool isEnabled = true)
+    {
+        const auto itemID = nextID++;
+        menu.addItem (itemID, "Preset " + juce::String (itemID), isEnabled, itemID == tickedID);
+    }
+
+    void addNested (juce::PopupMenu& menu, int numItems)
+    {
+        constexpr int branching = 16;
+
+        if (numItems <= branching)
+        {
+            for (int i = 0; i < numItems; ++i)
+                addItem (menu);
+
+            return;
+        }
+
+        // Full submenus of branching^k items, the last one taking the rest
+        auto perSubmenu = branching;
+
+        while (perSubmenu * branching < numItems)
+            perSubmenu *= branching;
+
+        for (int remaining = numItems; remaining > 0; remaining -= perSubmenu)
+        {
+            juce::PopupMenu submenu;
+            addNested (submenu, juce::jmin (perSubmenu, remaining));
+            menu.addSubMenu ("Bank " + juce::String (nextID), submenu);
+        }
+    }
+
+    juce::PopupMenu addDeep (int numItems, int numLevels)
+    {
+        juce::PopupMenu menu;
+        const auto perLevel = numItems / numLevels;
+
+        for (int i = 0; i < (numLevels == 1 ? numItems : perLevel); ++i)
+            addItem (menu);
+
+        if (numLevels > 1)
+            menu.addSubMenu ("Level " + juce::String (numLevels), addDeep (numItems - perLevel, numLevels - 1));
+
+        return menu;
+    }
+
+    juce::PopupMenu create (Shape shape, int numItems)
+    {
+        juce::PopupMenu menu;
+
+        switch (shape)
+        {
+            case Shape::flat:
+                for (int i = 0; i < numItems; ++i)
+                    addItem (menu);
+                break;
+
+            case Shape::sectioned:
+                for (int i = 0; i < numItems; ++i)
+                {
+                    if (i % 32 == 0)
+                    {
+                        if (i > 0)
+                            menu.addSeparator();
+
+                        menu.addSectionHeader ("Section " + juce::String (i / 32 + 1));
+                    }
+
+                    addItem (menu, i % 5 != 4);
+                }
+                break;
+
+            case Shape::nested:
+                addNested (menu, numItems);
+                break;
+
+            case Shape::deep:
+                menu = addDeep (numItems, juce::jlimit (1, 64, numItems / 4));
+                break;
+        }
+
+        return menu;
+    }
+};
+
+/** Creates a menu; the item with the given ID (counted from 1 in display order) is ticked. */
+static juce::PopupMenu createMenu (Shape shape, int numItems, int tickedID)
+{
+    MenuBuilder builder;
+    builder.tickedID = tickedID;
+    return builder.create (shape, numItems);
+}
+
+//==============================================================================
+/** Adds a model's items to another one through the builder functions. */
+static juce::NativeMacMenuModel rebuild (const juce::NativeMacMenuModel& source)
+{
+    using ItemType = juce::NativeMacMenuModel::ItemType;
+
+    juce::NativeMacMenuModel model;
+    int depth = 0;
+
+    for (int i = 0; i < source.getNumItems(); ++i)
+    {
+        const auto& item = source.getItem (i);
+
+        for (; depth > item.depth; --depth)
+            model.endSubmenu();
+
+        switch (item.type)
+        {
+            case ItemType::item:            model.addItem (item.itemID, item.text, item.isEnabled, item.isTicked); break;
+            case ItemType::separator:       model.addSeparator(); break;
+            case ItemType::sectionHeader:   model.addSectionHeader (item.text); break;
+            case ItemType::submenu:         model.beginSubmenu (item.text, item.isEnabled); ++depth; break;
+        }
+    }
+
+    return model;
+}
+
+//==============================================================================
+/**
+    Does what the NSMenu backend does, minus AppKit: one heap object per item
+    holding a copy of its title, nested per submenu, plus the ticked item search.
+    Answers with the ticked item, or else the last item.
+*/
+class MockNativeMenuBackend  : public juce::NativeMacMenuBackend
+{
+public:
+    int showMenu (const juce::NativeMacMenuModel& menu, const ShowOptions&) override
+    {
+        const Node* tickedItem = nullptr;
+        const auto root = buildMenu (menu, 0, menu.getNumItems(), "", &tickedItem);
+
+        if (tickedItem != nullptr)
+            return tickedItem->tag;
+
+        for (auto i = menu.getNumItems(); --i >= 0;)
+            if (menu.getItem (i).type == juce::NativeMacMenuModel::ItemType::item)
+                return menu.getItem (i).itemID;
+
+        return 0;
+    }
+
+private:
+    struct Node
+    {
+        std::string title;
+        int tag = 0;
+        bool isEnabled = true, isOn = false;
+        std::vector<std::unique_ptr<Node>> children;
+    };
+
+    static std::unique_ptr<Node> buildMenu (const juce::NativeMacMenuModel& menu, int begin, int end,
+                                            const char* title, const Node** outTickedItem)
+    {
+        auto node = std::make_unique<Node>();
+        node->title = title;
+
+        for (int i = begin; i < end; i = menu.getNextSibling (i))
+        {
+            const auto& item = menu.getItem (i);
+
+            if (item.type == juce::NativeMacMenuModel::ItemType::submenu)
+            {
+                node->children.push_back (buildMenu (menu, i + 1, menu.getNextSibling (i),
+                                                     item.text.toRawUTF8(), nullptr));
+                continue;
+            }
+
+            auto child = std::make_unique<Node>();
+            child->title = item.text.toRawUTF8();
+            child->tag = item.itemID;
+            child->isEnabled = item.isEnabled;
+            child->isOn = item.isTicked;
+
+            if (item.isTicked && outTickedItem != nullptr && *outTickedItem == nullptr)
+                *outTickedItem = child.get();
+
+            node->children.push_back (std::move (child));
+        }
+
+        return node;
+    }
+};
+
+//==============================================================================
+/** Returns distinct preset-like names, e.g. "Bass/Warm Analog Growl 1234". */
+static juce::StringArray createNames (int numNames)
+{
+    static const char* const categories[] = { "Bass", "Lead", "Pad", "Keys", "Drums", "FX", "Pluck", "Strings", "Brass", "Vocal" };
+    static const char* const adjectives[] = { "Warm", "Bright", "Dark", "Wide", "Soft", "Hard", "Glassy", "Dusty", "Lush", "Thin", "Fat", "Airy" };
+    static const char* const sources[]    = { "Analog", "Digital", "Tape", "Vintage", "Modular", "Granular", "FM", "Wavetable" };
+    static const char* const nouns[]      = { "Growl", "Sweep", "Choir", "Bell", "Drone", "Stab", "Pulse", "Shimmer", "Hit", "Wash", "Motion" };
+
+    std::mt19937 random (42);
+    juce::StringArray names;
+    names.ensureStorageAllocated (numNames);
+
+    for (int i = 0; i < numNames; ++i)
+    {
+        juce::String name;
+        name << categories[random() % juce::numElementsInArray (categories)] << "/"
+             << adjectives[random() % juce::numElementsInArray (adjectives)] << " "
+             << sources[random() % juce::numElementsInArray (sources)] << " "
+             << nouns[random() % juce::numElementsInArray (nouns)] << " " << i;
+        names.add (name);
+    }
+
+    return names;
+}
+
+//==============================================================================
+struct Settings
+{
+    double budgetSeconds = 0.2;    // sampling time per stage
+    int minSamples = 5;
+    int maxSamples = 200;
+};
+
+struct Result
+{
+    juce::String stage;
+    const char* shape = "";        // empty for stages that don't depend on a menu
+    int size = 0;                  // items asked for
+    int numItems = 0;              // items in the model, including submenus, headers and separators
+    int batchSize = 0;             // operations per sample
+    int numSamples = 0;
+    double minUs = 0.0, medianUs = 0.0, meanUs = 0.0;
+};
+
+static volatile juce::uint64 sink = 0;   // keeps results alive so nothing is optimised away
+
+static double getSeconds (juce::int64 ticks)
+{
+    return juce::Time::highResolutionTicksToSeconds (ticks);
+}
+
+/** Times a stage. Operations are batched so that one sample takes at least
+    100 us, then sampled until the time budget is used up.
+*/
+template <typename Operation>
+static Result measure (const Settings& settings, const char* stage, const char* shape, int size,
+                       int numItems, Operation&& operation)
+{
+    const auto timeBatch = [&] (int batchSize)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < batchSize; ++i)
+            sink = sink + (juce::uint64) operation();
+
+        return getSeconds (juce::Time::getHighResolutionTicks() - start);
+    };
+
+    int batchSize = 1;
+
+    while (timeBatch (batchSize) < 1.0e-4 && batchSize < (1 << 20))
+        batchSize *= 2;
+
+    std::vector<double> samples;
+    const auto start = juce::Time::getHighResolutionTicks();
+
+    while ((int) samples.size() < settings.minSamples
+            || ((int) samples.size() < settings.maxSamples
+                 && getSeconds (juce::Time::getHighResolutionTicks() - start) < settings.budgetSeconds))
+    {
+        samples.push_back (timeBatch (batchSize) * 1.0e6 / batchSize);
+    }
+
+    std::sort (samples.begin(), samples.end());
+
+    Result result;
+    result.stage = stage;
+    result.shape = shape;
+    result.size = size;
+    result.numItems = numItems;
+    result.batchSize = batchSize;
+    result.numSamples = (int) samples.size();
+    result.minUs = samples.front();
+    result.medianUs = samples[samples.size() / 2];
+
+    for (auto sample : samples)
+        result.meanUs += sample / (double) samples.size();
+
+    return result;
+}
+
+static void runCase (const Settings& settings, Shape shape, int size, std::vector<Result>& results)
+{
+    const auto menu = createMenu (shape, size, size / 2 + 1);
+    const auto retickedMenu = createMenu (shape, size, size / 3 + 1);
+
+    const juce::NativeMacMenuModel model (menu);
+    const juce::NativeMacMenuModel retickedModel (retickedMenu);
+    const auto numItems = model.getNumItems();
+
+    std::vector<int> itemIDs;
+
+    for (int i = 0; i < numItems; ++i)
+        if (model.getItem (i).type == juce::NativeMacMenuModel::ItemType::item)
+            itemIDs.push_back (model.getItem (i).itemID);
+
+    auto mockBackend = std::make_shared<MockNativeMenuBackend>();
+
+    const auto add = [&] (const char* stage, auto&& operation)
+    {
+        results.push_back (measure (settings, stage, getShapeName (shape), size, numItems, operation));
+        std::cerr << "  " << getShapeName (shape) << " " << size << " " << stage << ": "
+                  << results.back().medianUs << " us" << std::endl;
+    };
+
+    add ("flatten",     [&] { return juce::NativeMacMenuModel (menu).getNumItems(); });
+    add ("build",       [&] { return rebuild (model).getNumItems(); });
+    add ("lookup",      [&]
+                        {
+                            juce::int64 total = 0;
+
+                            for (auto itemID : itemIDs)
+                                total += model.indexOfItemID (itemID);
+
+                            return total;
+                        });
+    add ("hash",        [&] { return model.getHash(); });
+    add ("text",        [&] { return model.toText().length(); });
+    add ("diff",        [&] { return juce::NativeMacMenuModel::compare (model, retickedModel).changedItems.size(); });
+    add ("mockNative",  [&] { return mockBackend->showMenu (model, {}); });
+
+    juce::NativeMacPopupMenu::setBackend (mockBackend);
+    add ("endToEnd",    [&] { return juce::NativeMacPopupMenu::showPopupMenuAt (menu, { 100, 100 }); });
+    juce::NativeMacPopupMenu::setBackend (nullptr);
+}
+
+static void runHistogramCases (const Settings& settings, std::vector<Result>& results)
+{
+    constexpr int numValues = 100000;
+
+    // Durations from 1 us to about 1 s, spread evenly over the exponents
+    std::vector<juce::int64> values;
+    std::mt19937 random (1);
+    std::uniform_real_distribution<double> exponents (0.0, 20.0);
+
+    for (int i = 0; i < 4096; ++i)
+        values.push_back ((juce::int64) std::exp2 (exponents (random)));
+
+    juce::NativeMacLatencyHistogram histogram;
+    size_t next = 0;
+
+    const auto add = [&] (const char* stage, auto&& operation)
+    {
+        results.push_back (measure (settings, stage, "", numValues, juce::NativeMacLatencyHistogram::numBuckets, operation));
+        std::cerr << "  " << stage << ": " << results.back().medianUs << " us" << std::endl;
+    };
+
+    add ("histogramRecord", [&]
+    {
+        const auto value = values[next++ & 4095];
+        histogram.record (value);
+        return value;
+    });
+
+    histogram.reset();
+
+    for (int i = 0; i < numValues; ++i)
+        histogram.record (values[(size_t) i & 4095]);
+
+    add ("histogramSummary", [&] { return histogram.getSummary().count; });
+}
+
+static void runSchemaCases (const Settings& settings, std::vector<Result>& results)
+{
+    using Schema = juce::NativeMacClipboardSchema;
+
+    enum : juce::uint32
+    {
+        nameSection     = Schema::makeSectionID ("name"),
+        authorSection   = Schema::makeSectionID ("auth"),
+        categorySection = Schema::makeSectionID ("catg"),
+        tempoSection    = Schema::makeSectionID ("bpm "),
+        stateSection    = Schema::makeSectionID ("stat")
+    };
+
+    for (auto stateSize : { 1024, 100 * 1024, 1024 * 1024 })
+    {
+        juce::MemoryBlock state ((size_t) stateSize);
+
+        for (size_t i = 0; i < state.getSize(); ++i)
+            state[i] = (char) (i * 31 + i / 7);
+
+        Schema::Writer writer (2);
+        writer.setString (nameSection, "Warm Analog Pad 42");
+        writer.setString (authorSection, "Factory");
+        writer.setString (categorySection, "Pads/Analog");
+        writer.setDouble (tempoSection, 120.0);
+        writer.setSection (stateSection, state.getData(), state.getSize());
+
+        juce::MemoryBlock container;
+        writer.writeTo (container);
+
+        const auto add = [&] (const char* stage, auto&& operation)
+        {
+            results.push_back (measure (settings, stage, "", stateSize, 5, operation));
+            std::cerr << "  " << stage << " " << stateSize << ": " << results.back().medianUs << " us" << std::endl;
+        };
+
+        add ("schemaWrite",     [&] { return writer.writeTo (container) ? container.getSize() : 0; });
+        add ("schemaOpen",      [&] { return Schema::Reader (container.getData(), container.getSize()).getNumSections(); });
+        add ("schemaReadName",  [&]
+                                {
+                                    const Schema::Reader reader (container.getData(), container.getSize());
+                                    return reader.getString (nameSection).length();
+                                });
+        add ("schemaVerifyAll", [&] { return Schema::Reader (container.getData(), container.getSize()).verifyAllSections(); });
+    }
+}
+
+static void runPayloadCases (const Settings& settings, std::vector<Result>& results)
+{
+    using Payload = juce::NativeMacClipboardPayload;
+
+    std::cerr << "  crc32c hardware accelerated: " << (Payload::Checksum::isHardwareAccelerated() ? "yes" : "no") << std::endl;
+
+    for (auto size : { 1024, 64 * 1024, 1024 * 1024 })
+    {
+        // Preset XML compresses about as well as the plug-in state users actually copy
+        juce::MemoryBlock data;
+        std::mt19937 random (3);
+
+        for (int i = 0; data.getSize() < (size_t) size; ++i)
+        {
+            const auto line = "<PARAM id=\"param" + juce::String (i % 500) + "\" value=\""
+                                + juce::String ((double) (random() % 100000) / 100000.0, 5) + "\"/>\n";
+            data.append (line.toRawUTF8(), line.getNumBytesAsUTF8());
+        }
+
+        data.setSize ((size_t) size);
+
+        juce::MemoryBlock stored, compressed, encoded, decoded ((size_t) size);
+        Payload::encode (data.getData(), data.getSize(), stored, Payload::Compression::none);
+        Payload::encode (data.getData(), data.getSize(), compressed, Payload::Compression::lz);
+
+        const auto add = [&] (const char* stage, const juce::MemoryBlock& frame, auto&& operation)
+        {
+            results.push_back (measure (settings, stage, "", size, (int) frame.getSize(), operation));
+            std::cerr << "  " << stage << " " << size << ": " << results.back().medianUs << " us" << std::endl;
+        };
+
+        add ("payloadEncode",   stored,     [&] { return Payload::encode (data.getData(), data.getSize(), encoded, Payload::Compression::none); });
+        add ("payloadEncodeLZ", compressed, [&] { return Payload::encode (data.getData(), data.getSize(), encoded, Payload::Compression::lz); });
+        add ("payloadDecode",   stored,     [&] { return Payload::decode (stored.getData(), stored.getSize(), decoded.getData(), decoded.getSize()); });
+        add ("payloadDecodeLZ", compressed, [&] { return Payload::decode (compressed.getData(), compressed.getSize(), decoded.getData(), decoded.getSize()); });
+        add ("crc32c",          data,       [&] { return Payload::Checksum::crc32c (data.getData(), data.getSize()); });
+        add ("crc32cSoftware",  data,       [&] { return Payload::Checksum::crc32cSoftware (data.getData(), data.getSize()); });
+    }
+}
+
+static void runValidationCases (const Settings& settings, std::vector<Result>& results)
+{
+    for (auto numNames : { 1000, 50000 })
+    {
+        const auto names = createNames (numNames);
+        const auto index = std::make_shared<juce::NativeMacNameIndex> (names);
+
+        juce::StringArray candidates;
+
+        for (int i = 0; i < 512; ++i)
+            candidates.add (i % 2 == 0 ? names[(i * 7919) % numNames] : names[(i * 7919) % numNames] + "x");
+
+        juce::NativeMacTextValidator validator;
+        validator.requireNonEmpty ("Enter a name")
+                 .forbidFileNameCharacters()
+                 .requireUnique (index, "A preset with this name already exists");
+
+        // Typing a name and erasing it again, one keystroke at a time
+        const juce::String typed ("Warm Analog Shimmer Pad for the Second Verse");
+        juce::StringArray keystrokes;
+
+        for (int i = 1; i <= typed.length(); ++i)
+            keystrokes.add (typed.substring (0, i));
+
+        for (int i = typed.length() - 1; i > 0; --i)
+            keystrokes.add (typed.substring (0, i));
+
+        int next = 0;
+
+        const auto add = [&] (const char* stage, auto&& operation)
+        {
+            results.push_back (measure (settings, stage, "", numNames, numNames, operation));
+            std::cerr << "  " << stage << " " << numNames << ": " << results.back().medianUs << " us" << std::endl;
+        };
+
+        add ("nameIndexBuild",    [&] { return juce::NativeMacNameIndex (names).size(); });
+        add ("nameIndexLookup",   [&] { return index->contains (candidates[next++ & 511]); });
+        add ("validateKeystroke", [&]
+                                  {
+                                      const auto& text = keystrokes[next++ % keystrokes.size()];
+                                      return validator.validate (text).wasOk();
+                                  });
+    }
+}
+
+static void runCompletionCases (const Settings& settings, std::vector<Result>& results)
+{
+    for (auto numNames : { 1000, 10000, 100000 })
+    {
+        const auto names = createNames (numNames);
+
+        juce::Array<float> weights;
+        std::mt19937 random (7);
+
+        for (int i = 0; i < numNames; ++i)
+            weights.add ((float) (random() % 1000));
+
+        const juce::NativeMacCompletionIndex index (names);
+        const juce::NativeMacCompletionIndex weightedIndex (names, weights);
+
+        // Every prefix typed on the way to some of the names, from one character on
+        juce::StringArray prefixes;
+
+        for (int i = 0; i < 64; ++i)
+        {
+            const auto& name = names[(i * 7919) % numNames];
+
+            for (int length = 1; length <= juce::jmin (12, name.length()); ++length)
+                prefixes.add (name.substring (0, length));
+        }
+
+        juce::StringArray completions;
+        int next = 0;
+
+        const auto add = [&] (const char* stage, auto&& operation)
+        {
+            results.push_back (measure (settings, stage, "", numNames, numNames, operation));
+            std::cerr << "  " << stage << " " << numNames << ": " << results.back().medianUs << " us" << std::endl;
+        };
+
+        add ("completionBuild",        [&] { return juce::NativeMacCompletionIndex (names).size(); });
+        add ("completionTopK",         [&]
+                                       {
+                                           index.getCompletions (prefixes[next++ % prefixes.size()], 10, completions);
+                                           return completions.size();
+                                       });
+        add ("completionTopKWeighted", [&]
+                                       {
+                                           weightedIndex.getCompletions (prefixes[next++ % prefixes.size()], 10, completions);
+                                           return completions.size();
+                                       });
+    }
+}
+
+static void runProgressCases (const Settings& settings, std::vector<Result>& results)
+{
+    const juce::String status ("Exporting track 12 of 48: Lead Vocal (comp).wav");
+
+    for (auto numThreads : { 1, 2, 4, 8 })
+    {
+        juce::NativeMacProgressState state;
+        state.setTotal ((juce::int64) 1 << 50);
+
+        // Runs an operation on numThreads - 1 other threads while the stage is timed on this one
+        const auto add = [&] (const char* stage, int numContenders, auto&& contenderOperation, auto&& operation)
+        {
+            std::atomic<bool> shouldStop { false };
+            std::vector<std::thread> contenders;
+
+            for (int i = 0; i < numContenders; ++i)
+                contenders.emplace_back ([&]
+                {
+                    while (! shouldStop.load (std::memory_order_relaxed))
+                        contenderOperation();
+                });
+
+            results.push_back (measure (settings, stage, "", numThreads, numThreads, operation));
+
+            shouldStop = true;
+
+            for (auto& contender : contenders)
+                contender.join();
+
+            std::cerr << "  " << stage << " " << numThreads << ": " << results.back().medianUs << " us" << std::endl;
+        };
+
+        const auto advance   = [&] { state.advance (1); return 1; };
+        const auto setStatus = [&] { state.setStatus (status); return 1; };
+
+        add ("progressAdvance",   numThreads - 1, advance, advance);
+        add ("progressSetStatus", numThreads - 1, setStatus, setStatus);
+
+        juce::String sampled;
+        juce::uint64 version = 0;
+
+        add ("progressSample", numThreads, [&] { advance(); setStatus(); }, [&]
+        {
+            const auto progress = state.getProgress();
+            state.readStatus (sampled, version);
+            return progress > 0.0 ? version : 0;
+        });
+    }
+}
+
+//==============================================================================
+static juce::String toJSON (const std::vector<Result>& results, bool quick)
+{
+    juce::String json;
+    json << "{\n"
+         << "  \"benchmark\": \"juce_native_macos_dialogs\",\n"
+         << "  \"quick\": " << (quick ? "true" : "false") << ",\n"
+         << "  \"unit\": \"us\",\n"
+         << "  \"results\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& r = results[i];
+
+        json << "    { \"stage\": \"" << r.stage << "\", \"shape\": \"" << r.shape << "\""
+             << ", \"size\": " << r.size << ", \"items\": " << r.numItems
+             << ", \"batch\": " << r.batchSize << ", \"samples\": " << r.numSamples
+             << ", \"min\": " << juce::String (r.minUs, 4)
+             << ", \"median\": " << juce::String (r.medianUs, 4)
+             << ", \"mean\": " << juce::String (r.meanUs, 4) << " }"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    json << "  ]\n"
+         << "}\n";
+
+    return json;
+}
+
+} // namespace Benchmarks
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    using namespace Benchmarks;
+
+    bool quick = false;
+    juce::File outputFile;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg (argv[i]);
+
+        if (arg == "--quick")
+        {
+            quick = true;
+        }
+        else if (arg == "--output" && i + 1 < argc)
+        {
+            outputFile = juce::File::getCurrentWorkingDirectory().getChildFile (argv[++i]);
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--quick] [--output results.json]" << std::endl;
+            return 1;
+        }
+    }
+
+    Settings settings;
+
+    if (quick)
+    {
+        settings.budgetSeconds = 0.02;
+        settings.minSamples = 3;
+    }
+
+    const int sizes[] = { 10, 50, 128, 256, 1000, 10000, 100000 };
+    const Shape shapes[] = { Shape::flat, Shape::sectioned, Shape::nested, Shape::deep };
+
+    std::vector<Result> results;
+
+    for (auto size : sizes)
+    {
+        if (quick && size > 10000)
+            break;
+
+        for (auto shape : shapes)
+            runCase (settings, shape, size, results);
+    }
+
+    runHistogramCases (settings, results);
+    runSchemaCases (settings, results);
+    runPayloadCases (settings, results);
+    runValidationCases (settings, results);
+    runCompletionCases (settings, results);
+    runProgressCases (settings, results);
+
+    const auto json = toJSON (results, quick);
+
+    if (outputFile == juce::File())
+    {
+        std::cout << json;
+    }
+    else if (! outputFile.replaceWithText (json))
+    {
+        std::cerr << "Couldn't write " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
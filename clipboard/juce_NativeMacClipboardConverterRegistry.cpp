@@ -0,0 +1,550 @@
+/*******************************************************************************
+ Clipboard format conversion registry - implementation
+*******************************************************************************/
+
+#if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+namespace juce
+{
+
+//==============================================================================
+struct NativeMacClipboardConverterRegistry::Graph
+{
+    struct Edge
+    {
+        juce::String source, target;
+        std::shared_ptr<const Converter> converter;
+    };
+
+    using Chain = std::vector<Edge>;
+    using Results = std::vector<std::shared_ptr<juce::MemoryBlock>>;
+
+    /** Breadth-first search for the shortest chain. The caller must hold the lock. */
+    bool findChain (const juce::String& source, const juce::String& target, Chain& chain) const
+    {
+        chain.clear();
+
+        if (source == target)
+            return true;
+
+        std::map<juce::String, int> reachedVia { { source, -1 } };   // type -> index of the edge leading to it
+        juce::StringArray queue;
+        queue.add (source);
+
+        for (int i = 0; i < queue.size(); ++i)
+        {
+            for (int e = 0; e < (int) edges.size(); ++e)
+            {
+                auto& edge = edges[(size_t) e];
+
+                if (edge.source != queue[i] || reachedVia.count (edge.target) != 0)
+                    continue;
+
+                reachedVia[edge.target] = e;
+
+                if (edge.target == target)
+                {
+                    for (auto index = e; index >= 0; index = reachedVia[edges[(size_t) index].source])
+                        chain.insert (chain.begin(), edges[(size_t) index]);
+
+                    return true;
+                }
+
+                queue.add (edge.target);
+            }
+        }
+
+        return false;
+    }
+
+    /** Types reachable from source in breadth-first order. The caller must hold the lock. */
+    juce::StringArray getReachableTypes (const juce::String& source) const
+    {
+        juce::StringArray queue;
+        queue.add (source);
+
+        for (int i = 0; i < queue.size(); ++i)
+            for (auto& edge : edges)
+                if (edge.source == queue[i])
+                    queue.addIfNotAlreadyThere (edge.target);
+
+        queue.remove (0);
+        return queue;
+    }
+
+    /** Runs each converter of the chain in turn, keeping every intermediate result. */
+    bool runChain (const Chain& chain, const void* data, size_t size, Results& results)
+    {
+        for (auto& edge : chain)
+        {
+            auto output = std::make_shared<juce::MemoryBlock>();
+            ++numConversions;
+
+            if (! (*edge.converter) (data, size, *output))
+                return false;
+
+            data = output->getData();
+            size = output->getSize();
+            results.push_back (std::move (output));
+        }
+
+        return true;
+    }
+
+    bool convert (const void* data, size_t size,
+                  const juce::String& source, const juce::String& target,
+                  juce::MemoryBlock& dest)
+    {
+        Chain chain;
+
+        {
+            const juce::ScopedLock sl (lock);
+
+            if (! findChain (source, target, chain))
+                return false;
+        }
+
+        if (chain.empty())
+        {
+            dest.replaceAll (data, size);
+            return true;
+        }
+
+        // Converters run without the lock, using the chain captured above
+        Results results;
+
+        if (! runChain (chain, data, size, results))
+            return false;
+
+        dest.swapWith (*results.back());
+        return true;
+    }
+
+    juce::CriticalSection lock;
+    std::vector<Edge> edges;
+
+    std::atomic<juce::int64> numConversions { 0 }, numCacheHits { 0 }, numCacheMisses { 0 };
+};
+
+//==============================================================================
+NativeMacClipboardConverterRegistry::NativeMacClipboardConverterRegistry()
+    : graph (std::make_shared<Graph>())
+{
+}
+
+NativeMacClipboardConverterRegistry::~NativeMacClipboardConverterRegistry() = default;
+
+//==============================================================================
+void NativeMacClipboardConverterRegistry::addConverter (const juce::String& sourceUTI,
+                                                        const juce::String& targetUTI,
+                                                        Converter converter)
+{
+    jassert (converter != nullptr && sourceUTI != targetUTI);
+
+    {
+        const juce::ScopedLock sl (graph->lock);
+
+        auto sharedConverter = std::make_shared<const Converter> (std::move (converter));
+
+        for (auto& edge : graph->edges)
+        {
+            if (edge.source == sourceUTI && edge.target == targetUTI)
+            {
+                edge.converter = std::move (sharedConverter);
+                sharedConverter = nullptr;
+                break;
+            }
+        }
+
+        if (sharedConverter != nullptr)
+            graph->edges.push_back ({ sourceUTI, targetUTI, std::move (sharedConverter) });
+    }
+
+    clearCache();
+}
+
+void NativeMacClipboardConverterRegistry::removeConverter (const juce::String& sourceUTI,
+                                                           const juce::String& targetUTI)
+{
+    {
+        const juce::ScopedLock sl (graph->lock);
+
+        auto& edges = graph->edges;
+        edges.erase (std::remove_if (edges.begin(), edges.end(),
+                                     [&] (const Graph::Edge& e) { return e.source == sourceUTI && e.target == targetUTI; }),
+                     edges.end());
+    }
+
+    clearCache();
+}
+
+juce::StringArray NativeMacClipboardConverterRegistry::getConversionPath (const juce::String& sourceUTI,
+                                                                          const juce::String& targetUTI) const
+{
+    Graph::Chain chain;
+
+    const juce::ScopedLock sl (graph->lock);
+
+    if (! graph->findChain (sourceUTI, targetUTI, chain))
+        return {};
+
+    juce::StringArray path;
+    path.add (sourceUTI);
+
+    for (auto& edge : chain)
+        path.add (edge.target);
+
+    return path;
+}
+
+juce::StringArray NativeMacClipboardConverterRegistry::getDerivedTypes (const juce::String& sourceUTI) const
+{
+    const juce::ScopedLock sl (graph->lock);
+    return graph->getReachableTypes (sourceUTI);
+}
+
+bool NativeMacClipboardConverterRegistry::convert (const void* data, size_t size,
+                                                   const juce::String& sourceUTI,
+                                                   const juce::String& targetUTI,
+                                                   juce::MemoryBlock& dest) const
+{
+    return graph->convert (data, size, sourceUTI, targetUTI, dest);
+}
+
+//==============================================================================
+void NativeMacClipboardConverterRegistry::copyToClipboard (const void* data, size_t size,
+                                                           const juce::String& sourceUTI)
+{
+    const auto derivedTypes = getDerivedTypes (sourceUTI);
+
+    if (derivedTypes.isEmpty())
+    {
+        NativeMacPasteboard::copyDataToClipboard (data, size, sourceUTI);
+        return;
+    }
+
+    // The provider must not keep the registry alive, but needs its own copy of the data
+    std::weak_ptr<Graph> weakGraph (graph);
+    auto canonical = std::make_shared<const juce::MemoryBlock> (data, size);
+
+    NativeMacPasteboard::copyDataToClipboard (data, size, sourceUTI, derivedTypes,
+                                              [weakGraph, canonical, sourceUTI] (const juce::String& type, juce::MemoryBlock& dest)
+                                              {
+                                                  if (auto g = weakGraph.lock())
+                                                      return g->convert (canonical->getData(), canonical->getSize(), sourceUTI, type, dest);
+
+                                                  return false;
+                                              });
+}
+
+bool NativeMacClipboardConverterRegistry::canFetchFromClipboard (const juce::String& targetUTI) const
+{
+    if (findInCache (targetUTI, NativeMacPasteboard::getChangeCount()) != nullptr
+         || NativeMacPasteboard::clipboardContainsDataType (targetUTI))
+        return true;
+
+    juce::StringArray sources;
+
+    {
+        const juce::ScopedLock sl (graph->lock);
+        Graph::Chain chain;
+
+        for (auto& edge : graph->edges)
+            if (edge.source != targetUTI && ! sources.contains (edge.source)
+                 && graph->findChain (edge.source, targetUTI, chain))
+                sources.add (edge.source);
+    }
+
+    for (auto& source : sources)
+        if (NativeMacPasteboard::clipboardContainsDataType (source))
+            return true;
+
+    return false;
+}
+
+bool NativeMacClipboardConverterRegistry::fetchFromClipboard (juce::MemoryBlock& dest, const juce::String& targetUTI)
+{
+    const auto changeCount = NativeMacPasteboard::getChangeCount();
+
+    if (auto cached = findInCache (targetUTI, changeCount))
+    {
+        ++graph->numCacheHits;
+        dest = *cached;
+        return true;
+    }
+
+    // Present as is, or promised by whoever wrote the clipboard
+    if (NativeMacPasteboard::clipboardContainsDataType (targetUTI)
+         && NativeMacPasteboard::fetchDataFromClipboard (dest, targetUTI))
+        return true;
+
+    // Otherwise convert locally from the type with the shortest chain
+    std::vector<Graph::Chain> candidates;
+
+    {
+        const juce::ScopedLock sl (graph->lock);
+        juce::StringArray sources;
+
+        for (auto& edge : graph->edges)
+        {
+            Graph::Chain chain;
+
+            if (edge.source != targetUTI && ! sources.contains (edge.source)
+                 && graph->findChain (edge.source, targetUTI, chain))
+            {
+                sources.add (edge.source);
+                candidates.push_back (std::move (chain));
+            }
+        }
+    }
+
+    std::stable_sort (candidates.begin(), candidates.end(),
+                      [] (const Graph::Chain& a, const Graph::Chain& b) { return a.size() < b.size(); });
+
+    for (auto& chain : candidates)
+    {
+        const auto& source = chain.front().source;
+        juce::MemoryBlock sourceData;
+
+        if (! NativeMacPasteboard::clipboardContainsDataType (source)
+             || ! NativeMacPasteboard::fetchDataFromClipboard (sourceData, source))
+            continue;
+
+        ++graph->numCacheMisses;
+
+        Graph::Results results;
+
+        if (! graph->runChain (chain, sourceData.getData(), sourceData.getSize(), results))
+            continue;
+
+        // Intermediate formats are cached too, as they are often asked for next.
+        // If the clipboard changed meanwhile, the results are still returned but not kept
+        if (NativeMacPasteboard::getChangeCount() == changeCount)
+            for (size_t i = 0; i < chain.size(); ++i)
+                addToCache (chain[i].target, changeCount, results[i]);
+
+        dest = *results.back();
+        return true;
+    }
+
+    return false;
+}
+
+//==============================================================================
+NativeMacClipboardConverterRegistry::DataPointer NativeMacClipboardConverterRegistry::findInCache (const juce::String& type,
+                                                                                                  juce::int64 changeCount) const
+{
+    const juce::SpinLock::ScopedLockType sl (cacheLock);
+
+    if (changeCount != cacheChangeCount)
+        return nullptr;
+
+    auto it = cache.find (type);
+    return it != cache.end() ? it->second : nullptr;
+}
+
+void NativeMacClipboardConverterRegistry::addToCache (const juce::String& type, juce::int64 changeCount, DataPointer data)
+{
+    const juce::SpinLock::ScopedLockType sl (cacheLock);
+
+    if (changeCount != cacheChangeCount)
+    {
+        cache.clear();
+        cacheChangeCount = changeCount;
+    }
+
+    cache[type] = std::move (data);
+}
+
+void NativeMacClipboardConverterRegistry::clearCache()
+{
+    std::map<juce::String, DataPointer> oldCache;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (cacheLock);
+        oldCache.swap (cache);
+        cacheChangeCount = -1;
+    }
+}
+
+//==============================================================================
+NativeMacClipboardConverterRegistry::Stats NativeMacClipboardConverterRegistry::getStats() const noexcept
+{
+    Stats stats;
+    stats.numConversions = graph->numConversions.load();
+    stats.numCacheHits   = graph->numCacheHits.load();
+    stats.numCacheMisses = graph->numCacheMisses.load();
+    return stats;
+}
+
+void NativeMacClipboardConverterRegistry::resetStats() noexcept
+{
+    graph->numConversions = 0;
+    graph->numCacheHits = 0;
+    graph->numCacheMisses = 0;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacClipboardConverterRegistryTests  : public juce::UnitTest
+{
+public:
+    NativeMacClipboardConverterRegistryTests()
+        : juce::UnitTest ("NativeMacClipboardConverterRegistry", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        const auto previousBackend = NativeMacPasteboard::getBackend();
+
+        beginTest ("Conversion paths");
+        {
+            NativeMacClipboardConverterRegistry registry;
+            addAppendingConverter (registry, "a", "b");
+            addAppendingConverter (registry, "b", "c");
+            addAppendingConverter (registry, "c", "d");
+
+            expectEquals (registry.getConversionPath ("a", "d").joinIntoString (","), juce::String ("a,b,c,d"));
+            expectEquals (registry.getDerivedTypes ("a").joinIntoString (","), juce::String ("b,c,d"));
+            expect (registry.getConversionPath ("d", "a").isEmpty());
+
+            // A shortcut replaces the longer chain
+            addAppendingConverter (registry, "a", "c");
+            expectEquals (registry.getConversionPath ("a", "d").joinIntoString (","), juce::String ("a,c,d"));
+
+            registry.removeConverter ("a", "c");
+            expectEquals (registry.getConversionPath ("a", "d").joinIntoString (","), juce::String ("a,b,c,d"));
+
+            // Cycles don't stop the search
+            addAppendingConverter (registry, "d", "a");
+            expectEquals (registry.getConversionPath ("b", "a").joinIntoString (","), juce::String ("b,c,d,a"));
+            expectEquals (registry.getDerivedTypes ("a").joinIntoString (","), juce::String ("b,c,d"));
+        }
+
+        beginTest ("Chained conversion");
+        {
+            NativeMacClipboardConverterRegistry registry;
+            addAppendingConverter (registry, "a", "b");
+            addAppendingConverter (registry, "b", "c");
+
+            juce::MemoryBlock dest;
+            expect (registry.convert ("x", 1, "a", "c", dest));
+            expectEquals (dest.toString(), juce::String ("x>b>c"));
+            expectEquals (registry.getStats().numConversions, (juce::int64) 2);
+
+            expect (! registry.convert ("x", 1, "c", "a", dest));
+
+            registry.addConverter ("b", "c", [] (const void*, size_t, juce::MemoryBlock&) { return false; });
+            expect (! registry.convert ("x", 1, "a", "c", dest));
+        }
+
+        beginTest ("Promised types");
+        {
+            auto pasteboard = std::make_shared<NativeMacInMemoryPasteboard>();
+            auto otherProcess = pasteboard->createClient();
+            NativeMacPasteboard::setBackend (pasteboard);
+
+            {
+                NativeMacClipboardConverterRegistry registry;
+                addAppendingConverter (registry, "a", "b");
+                addAppendingConverter (registry, "b", "c");
+
+                registry.copyToClipboard ("x", 1, "a");
+                expectEquals (registry.getStats().numConversions, (juce::int64) 0);
+
+                expect (otherProcess->containsDataType ("c"));
+                expectEquals (readAsString (*otherProcess, "c"), juce::String ("x>b>c"));
+                expectEquals (readAsString (*otherProcess, "a"), juce::String ("x"));
+
+                registry.copyToClipboard ("y", 1, "b");
+                expect (! otherProcess->containsDataType ("a"));
+            }
+
+            // The promise can't be kept once the registry has gone
+            expect (readAsString (*otherProcess, "c").isEmpty());
+        }
+
+        beginTest ("Fetching converts locally and caches every step");
+        {
+            auto pasteboard = std::make_shared<NativeMacInMemoryPasteboard>();
+            auto otherProcess = pasteboard->createClient();
+            NativeMacPasteboard::setBackend (pasteboard);
+
+            NativeMacClipboardConverterRegistry registry;
+            addAppendingConverter (registry, "a", "b");
+            addAppendingConverter (registry, "b", "c");
+
+            expect (! registry.canFetchFromClipboard ("c"));
+
+            otherProcess->writeData ("x", 1, "a");
+            expect (registry.canFetchFromClipboard ("c"));
+
+            juce::MemoryBlock dest;
+            expect (registry.fetchFromClipboard (dest, "c"));
+            expectEquals (dest.toString(), juce::String ("x>b>c"));
+
+            expect (registry.fetchFromClipboard (dest, "b"));
+            expectEquals (dest.toString(), juce::String ("x>b"));
+
+            auto stats = registry.getStats();
+            expectEquals (stats.numConversions, (juce::int64) 2);
+            expectEquals (stats.numCacheMisses, (juce::int64) 1);
+            expectEquals (stats.numCacheHits, (juce::int64) 1);
+
+            // A new clipboard change invalidates the cache
+            otherProcess->writeData ("y", 1, "a");
+            expect (registry.fetchFromClipboard (dest, "b"));
+            expectEquals (dest.toString(), juce::String ("y>b"));
+
+            // Data present on the clipboard is used without converting
+            otherProcess->writeData ("z", 1, "c");
+            registry.resetStats();
+            expect (registry.fetchFromClipboard (dest, "c"));
+            expectEquals (dest.toString(), juce::String ("z"));
+            expectEquals (registry.getStats().numConversions, (juce::int64) 0);
+
+            expect (! registry.fetchFromClipboard (dest, "a"));
+        }
+
+        NativeMacPasteboard::setBackend (previousBackend);
+    }
+
+private:
+    // Each step appends ">target", so the result shows the chain that produced it
+    static void addAppendingConverter (NativeMacClipboardConverterRegistry& registry,
+                                       const juce::String& source, const juce::String& target)
+    {
+        registry.addConverter (source, target, [target] (const void* data, size_t size, juce::MemoryBlock& dest)
+        {
+            dest.replaceAll (data, size);
+            dest.append (">", 1);
+            dest.append (target.toRawUTF8(), target.getNumBytesAsUTF8());
+            return true;
+        });
+    }
+
+    static juce::String readAsString (NativeMacPasteboardBackend& backend, const juce::String& typeUTI)
+    {
+        juce::String result;
+
+        backend.readData (typeUTI,
+                          [] (void* context, const void* data, size_t size)
+                          {
+                              *static_cast<juce::String*> (context) = juce::String::fromUTF8 (static_cast<const char*> (data), (int) size);
+                          },
+                          &result);
+
+        return result;
+    }
+};
+
+static NativeMacClipboardConverterRegistryTests nativeMacClipboardConverterRegistryTests;
+
+#endif
+
+} // namespace juce
+
+#endif // JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
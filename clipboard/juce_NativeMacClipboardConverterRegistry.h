@@ -0,0 +1,150 @@
+/*******************************************************************************
+ Clipboard format conversion registry
+
+ Converters between clipboard types, applied lazily: one canonical payload is
+ published and derived formats are only produced when someone asks for them.
+*******************************************************************************/
+
+#pragma once
+
+#if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A set of converters between clipboard types, keyed by (sourceUTI, targetUTI).
+
+    The converters form a graph, so registering binary -> JSON and JSON -> text
+    is enough to turn binary into text; conversions always take the shortest
+    chain of converters.
+
+    copyToClipboard() publishes only the canonical payload and promises every
+    type that can be derived from it. The pasteboard asks for a promised type
+    only when a reader wants it, so nothing is serialised into formats nobody
+    pastes.
+
+    fetchFromClipboard() works the other way round: if the clipboard doesn't
+    hold the requested type, it fetches a type that converts to it and runs the
+    converters locally. Converted results (including intermediate steps) are
+    cached until the pasteboard's change count moves, so repeated fetches of
+    the same format cost a single conversion.
+
+    Everything here goes through NativeMacPasteboard, so it works the same with
+    NSPasteboard on macOS and with a NativeMacInMemoryPasteboard elsewhere.
+
+    @code
+    NativeMacClipboardConverterRegistry converters;
+
+    converters.addConverter ("com.mycompany.preset", "public.json", [] (const void* data, size_t size, MemoryBlock& dest)
+    {
+        return Preset::fromBinary (data, size).writeJSON (dest);
+    });
+
+    converters.addConverter ("public.json", "public.utf8-plain-text", jsonToText);
+
+    converters.copyToClipboard (binary.getData(), binary.getSize(), "com.mycompany.preset");
+
+    MemoryBlock text;
+    converters.fetchFromClipboard (text, "public.utf8-plain-text");
+    @endcode
+
+    The registry can be used from any thread. Converters are called without any
+    lock held, and promised types may be produced on whichever thread reads them.
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacClipboardConverterRegistry
+{
+public:
+    //==============================================================================
+    /** Converts sourceSize bytes at sourceData into dest, returning false on failure. */
+    using Converter = std::function<bool (const void* sourceData, size_t sourceSize, juce::MemoryBlock& dest)>;
+
+    /** Creates an empty registry. */
+    NativeMacClipboardConverterRegistry();
+
+    /** Destructor. Promises made by copyToClipboard() can no longer be fulfilled afterwards. */
+    ~NativeMacClipboardConverterRegistry();
+
+    //==============================================================================
+    /** Registers a converter, replacing any existing one for the same pair of types. */
+    void addConverter (const juce::String& sourceUTI, const juce::String& targetUTI, Converter converter);
+
+    /** Removes the converter for a pair of types, if there is one. */
+    void removeConverter (const juce::String& sourceUTI, const juce::String& targetUTI);
+
+    /** Returns the shortest chain of types leading from sourceUTI to targetUTI,
+        including both ends, or an empty array if there is no way to convert.
+    */
+    juce::StringArray getConversionPath (const juce::String& sourceUTI, const juce::String& targetUTI) const;
+
+    /** Returns every type that sourceUTI can be converted to, nearest first. */
+    juce::StringArray getDerivedTypes (const juce::String& sourceUTI) const;
+
+    /** Converts data along the shortest chain of converters.
+
+        @returns false if there is no conversion path or a converter failed
+    */
+    bool convert (const void* data, size_t size,
+                  const juce::String& sourceUTI, const juce::String& targetUTI,
+                  juce::MemoryBlock& dest) const;
+
+    //==============================================================================
+    /** Copies the canonical payload to the clipboard, promising all types derived from it.
+
+        A copy of the data is held until the clipboard next changes, so promised
+        types can still be produced after the caller's buffer has gone.
+    */
+    void copyToClipboard (const void* data, size_t size, const juce::String& sourceUTI);
+
+    /** Returns true if the clipboard holds targetUTI or a type that converts to it. */
+    bool canFetchFromClipboard (const juce::String& targetUTI) const;
+
+    /** Retrieves targetUTI from the clipboard, converting from another type if necessary.
+
+        @param dest        MemoryBlock that will receive the data
+        @param targetUTI   The type to retrieve
+        @returns true if the data was found or produced
+    */
+    bool fetchFromClipboard (juce::MemoryBlock& dest, const juce::String& targetUTI);
+
+    /** Discards all cached conversion results. */
+    void clearCache();
+
+    //==============================================================================
+    /** Counters for conversions and cache lookups. */
+    struct Stats
+    {
+        juce::int64 numConversions = 0;   /**< Converter calls, including each step of a chain. */
+        juce::int64 numCacheHits = 0;     /**< Fetches answered from the cache. */
+        juce::int64 numCacheMisses = 0;   /**< Fetches that needed a local conversion. */
+    };
+
+    /** Returns the counters accumulated since creation or the last resetStats(). */
+    Stats getStats() const noexcept;
+
+    /** Resets the counters. */
+    void resetStats() noexcept;
+
+private:
+    //==============================================================================
+    struct Graph;
+    using DataPointer = std::shared_ptr<const juce::MemoryBlock>;
+
+    DataPointer findInCache (const juce::String& type, juce::int64 changeCount) const;
+    void addToCache (const juce::String& type, juce::int64 changeCount, DataPointer data);
+
+    std::shared_ptr<Graph> graph;   // shared with the providers of outstanding promises
+
+    mutable juce::SpinLock cacheLock;
+    juce::int64 cacheChangeCount = -1;
+    std::map<juce::String, DataPointer> cache;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacClipboardConverterRegistry)
+};
+
+} // namespace juce
+
+#endif // JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
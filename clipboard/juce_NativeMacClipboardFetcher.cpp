@@ -0,0 +1,409 @@
+/*******************************************************************************
+ Background clipboard fetching - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+struct NativeMacClipboardFetcher::State
+{
+    struct Request
+    {
+        uint32 id = 0;
+        juce::String typeUTI;
+        Completion completion;
+        Validator validator;
+    };
+
+    bool isCurrent (uint32 id) const noexcept    { return currentID.load() == id; }
+
+    ReadFunction readFunction;
+    Dispatcher dispatcher;
+
+    std::atomic<uint32> currentID { 0 };      // the only request whose result may be delivered
+    std::atomic<uint32> deliveredID { 0 };
+
+    juce::CriticalSection lock;
+    uint32 lastIssuedID = 0;
+    Request pending;
+    bool hasPending = false;
+};
+
+//==============================================================================
+class NativeMacClipboardFetcher::Worker  : public juce::Thread
+{
+public:
+    explicit Worker (std::shared_ptr<State> s)
+        : juce::Thread ("Clipboard Fetcher"), state (std::move (s))
+    {
+    }
+
+    ~Worker() override
+    {
+        signalThreadShouldExit();
+        wakeUp.signal();
+
+        // A pasteboard read can't be interrupted, so wait for it rather than killing the thread
+        stopThread (-1);
+    }
+
+    void requestAdded()
+    {
+        wakeUp.signal();
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wakeUp.wait();
+
+            State::Request request;
+
+            {
+                const juce::ScopedLock sl (state->lock);
+
+                if (! state->hasPending)
+                    continue;
+
+                request = std::move (state->pending);
+                state->hasPending = false;
+            }
+
+            process (request);
+        }
+    }
+
+private:
+    void process (State::Request& request)
+    {
+        if (! state->isCurrent (request.id))
+            return;
+
+        auto data = std::make_shared<juce::MemoryBlock>();
+        auto result = Result::noData;
+
+        if (state->readFunction (*data, request.typeUTI))
+            result = Result::ok;
+
+        // Skip validation for results nobody is waiting for any more
+        if (! state->isCurrent (request.id))
+            return;
+
+        if (result == Result::ok && request.validator != nullptr && ! request.validator (*data))
+            result = Result::invalid;
+
+        if (result != Result::ok)
+            data->reset();
+
+        const auto id = request.id;
+        auto completion = std::move (request.completion);
+        std::weak_ptr<State> weakState (state);
+
+        state->dispatcher ([weakState, id, result, data, completion]
+        {
+            // Re-checked on the receiving thread, as a cancel may have raced with delivery
+            auto s = weakState.lock();
+
+            if (s == nullptr || ! s->isCurrent (id))
+                return;
+
+            s->deliveredID = id;
+
+            if (completion != nullptr)
+                completion (result, std::move (*data));
+        });
+    }
+
+    std::shared_ptr<State> state;
+    juce::WaitableEvent wakeUp;
+
+    JUCE_DECLARE_NON_COPYABLE (Worker)
+};
+
+//==============================================================================
+NativeMacClipboardFetcher::NativeMacClipboardFetcher (ReadFunction readFunction, Dispatcher dispatcher)
+    : state (std::make_shared<State>())
+{
+    if (readFunction == nullptr)
+    {
+       #if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+        readFunction = [] (juce::MemoryBlock& dest, const juce::String& typeUTI)
+        {
+            return NativeMacPasteboard::fetchDataFromClipboard (dest, typeUTI);
+        };
+       #else
+        jassertfalse; // pasteboard support is disabled, so supply a ReadFunction
+        readFunction = [] (juce::MemoryBlock&, const juce::String&) { return false; };
+       #endif
+    }
+
+    if (dispatcher == nullptr)
+        dispatcher = [] (std::function<void()> callback) { juce::MessageManager::callAsync (std::move (callback)); };
+
+    state->readFunction = std::move (readFunction);
+    state->dispatcher = std::move (dispatcher);
+}
+
+NativeMacClipboardFetcher::~NativeMacClipboardFetcher()
+{
+    cancel();
+    worker.reset();
+}
+
+//==============================================================================
+uint32 NativeMacClipboardFetcher::fetchAsync (const juce::String& typeUTI,
+                                              Completion completion,
+                                              Validator validator)
+{
+    uint32 id;
+
+    {
+        const juce::ScopedLock sl (state->lock);
+
+        // Replacing the current ID is what cancels the previous request
+        id = ++state->lastIssuedID;
+
+        if (id == 0)
+            id = ++state->lastIssuedID;
+
+        state->currentID = id;
+        state->pending = { id, typeUTI, std::move (completion), std::move (validator) };
+        state->hasPending = true;
+    }
+
+    if (worker == nullptr)
+    {
+        worker = std::make_unique<Worker> (state);
+        worker->startThread();
+    }
+
+    worker->requestAdded();
+    return id;
+}
+
+void NativeMacClipboardFetcher::cancel()
+{
+    const juce::ScopedLock sl (state->lock);
+
+    state->hasPending = false;
+    state->pending = {};
+
+    // ID 0 is never issued, so no in-flight result can match it
+    state->deliveredID = state->currentID.load();
+    state->currentID = 0;
+}
+
+bool NativeMacClipboardFetcher::isPending() const noexcept
+{
+    const auto current = state->currentID.load();
+    return current != 0 && state->deliveredID.load() != current;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacClipboardFetcherTests  : public juce::UnitTest
+{
+public:
+    NativeMacClipboardFetcherTests()
+        : juce::UnitTest ("NativeMacClipboardFetcher", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        using FetchResult = NativeMacClipboardFetcher::Result;
+
+        beginTest ("Results");
+        {
+            CallbackQueue queue;
+            NativeMacClipboardFetcher fetcher (readFakeClipboard, queue.getDispatcher());
+
+            for (auto type : { "com.example.preset", "com.example.missing", "com.example.rejected" })
+            {
+                auto result = FetchResult::noData;
+                juce::MemoryBlock received;
+
+                fetcher.fetchAsync (type,
+                                    [&] (FetchResult r, juce::MemoryBlock data) { result = r; received = std::move (data); },
+                                    [] (const juce::MemoryBlock& data) { return data.toString() != "com.example.rejected"; });
+
+                expect (fetcher.isPending());
+                expect (queue.waitAndRun());
+                expect (! fetcher.isPending());
+
+                const juce::String typeUTI (type);
+
+                if (typeUTI.endsWith ("preset"))
+                {
+                    expect (result == FetchResult::ok);
+                    expectEquals (received.toString(), typeUTI);
+                }
+                else
+                {
+                    expect (result == (typeUTI.endsWith ("missing") ? FetchResult::noData : FetchResult::invalid));
+                    expectEquals (received.getSize(), (size_t) 0);
+                }
+            }
+        }
+
+        beginTest ("A new request supersedes the pending one");
+        {
+            CallbackQueue queue;
+            SlowRead slowRead;
+            NativeMacClipboardFetcher fetcher (slowRead.getReadFunction(), queue.getDispatcher());
+
+            juce::StringArray completed;
+            const auto first  = fetcher.fetchAsync ("com.example.slow", [&] (FetchResult, juce::MemoryBlock) { completed.add ("slow"); });
+            expect (slowRead.started.wait (5000));
+
+            const auto second = fetcher.fetchAsync ("com.example.preset", [&] (FetchResult, juce::MemoryBlock) { completed.add ("preset"); });
+            expectNotEquals (first, second);
+
+            slowRead.gate.signal();
+            expect (queue.waitAndRun());
+            expect (! queue.waitAndRun (50));
+
+            expectEquals (completed.joinIntoString (","), juce::String ("preset"));
+            expect (! fetcher.isPending());
+        }
+
+        beginTest ("Cancel before the read finishes");
+        {
+            CallbackQueue queue;
+            SlowRead slowRead;
+            NativeMacClipboardFetcher fetcher (slowRead.getReadFunction(), queue.getDispatcher());
+
+            auto numCompleted = 0;
+            fetcher.fetchAsync ("com.example.slow", [&] (FetchResult, juce::MemoryBlock) { ++numCompleted; });
+            expect (slowRead.started.wait (5000));
+
+            fetcher.cancel();
+            expect (! fetcher.isPending());
+
+            slowRead.gate.signal();
+            expect (! queue.waitAndRun (50));
+            expectEquals (numCompleted, 0);
+        }
+
+        beginTest ("Cancel after the result has been dispatched");
+        {
+            CallbackQueue queue;
+            NativeMacClipboardFetcher fetcher (readFakeClipboard, queue.getDispatcher());
+
+            auto numCompleted = 0;
+            fetcher.fetchAsync ("com.example.preset", [&] (FetchResult, juce::MemoryBlock) { ++numCompleted; });
+            expect (queue.waitUntilPosted());
+
+            fetcher.cancel();
+            queue.runAll();
+
+            expectEquals (numCompleted, 0);
+            expect (! fetcher.isPending());
+        }
+
+        beginTest ("Results dispatched after destruction are dropped");
+        {
+            CallbackQueue queue;
+            auto numCompleted = 0;
+
+            {
+                NativeMacClipboardFetcher fetcher (readFakeClipboard, queue.getDispatcher());
+                fetcher.fetchAsync ("com.example.preset", [&] (FetchResult, juce::MemoryBlock) { ++numCompleted; });
+                expect (queue.waitUntilPosted());
+            }
+
+            queue.runAll();
+            expectEquals (numCompleted, 0);
+        }
+    }
+
+private:
+    //==============================================================================
+    // Holds dispatched completions until the test runs them, standing in for the message thread
+    struct CallbackQueue
+    {
+        NativeMacClipboardFetcher::Dispatcher getDispatcher()
+        {
+            return [this] (std::function<void()> callback)
+            {
+                {
+                    const juce::ScopedLock sl (lock);
+                    callbacks.push_back (std::move (callback));
+                }
+
+                posted.signal();
+            };
+        }
+
+        bool waitUntilPosted (int timeoutMs = 5000)
+        {
+            return posted.wait (timeoutMs);
+        }
+
+        void runAll()
+        {
+            std::vector<std::function<void()>> toRun;
+
+            {
+                const juce::ScopedLock sl (lock);
+                toRun.swap (callbacks);
+            }
+
+            for (auto& callback : toRun)
+                callback();
+        }
+
+        bool waitAndRun (int timeoutMs = 5000)
+        {
+            if (! waitUntilPosted (timeoutMs))
+                return false;
+
+            runAll();
+            return true;
+        }
+
+        juce::CriticalSection lock;
+        std::vector<std::function<void()>> callbacks;
+        juce::WaitableEvent posted;
+    };
+
+    // Blocks reads of "com.example.slow" until the gate opens
+    struct SlowRead
+    {
+        NativeMacClipboardFetcher::ReadFunction getReadFunction()
+        {
+            return [this] (juce::MemoryBlock& dest, const juce::String& typeUTI)
+            {
+                if (typeUTI == "com.example.slow")
+                {
+                    started.signal();
+                    gate.wait (5000);
+                }
+
+                return readFakeClipboard (dest, typeUTI);
+            };
+        }
+
+        juce::WaitableEvent started, gate;
+    };
+
+    // Every type except "com.example.missing" holds its own name
+    static bool readFakeClipboard (juce::MemoryBlock& dest, const juce::String& typeUTI)
+    {
+        if (typeUTI == "com.example.missing")
+            return false;
+
+        dest.replaceAll (typeUTI.toRawUTF8(), typeUTI.getNumBytesAsUTF8());
+        return true;
+    }
+};
+
+static NativeMacClipboardFetcherTests nativeMacClipboardFetcherTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,108 @@
+/*******************************************************************************
+ Background clipboard fetching
+
+ Reads (and optionally validates) clipboard data on a worker thread and
+ delivers the result back to the message thread.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Fetches clipboard data on a background thread.
+
+    Large payloads can take long enough to read and decode that doing it on the
+    message thread causes visible hitches. A fetcher owns one worker thread that
+    performs the read, decoding and validation, then hands the resulting
+    MemoryBlock to a completion callback on the message thread by move.
+
+    Only one request is ever in flight: starting a new fetch (e.g. because the
+    user pasted again) cancels the previous one, and the completion callback of
+    a cancelled request is never called.
+
+    By default the data is read with NativeMacPasteboard::fetchDataFromClipboard()
+    and results are delivered with MessageManager::callAsync(). Both can be
+    replaced, which allows the fetcher to be driven without a GUI session.
+
+    @code
+    fetcher.fetchAsync ("com.yourcompany.yourapp.preset",
+                        [this] (auto result, juce::MemoryBlock data)
+                        {
+                            if (result == juce::NativeMacClipboardFetcher::Result::ok)
+                                loadPreset (std::move (data));
+                        });
+    @endcode
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacClipboardFetcher
+{
+public:
+    //==============================================================================
+    /** The outcome of a fetch. */
+    enum class Result
+    {
+        ok,         /**< Data was read and passed validation. */
+        noData,     /**< The clipboard held no data of the requested type. */
+        invalid     /**< Data was read but rejected by the validator. */
+    };
+
+    /** Reads the clipboard data of a type into dest, returning false if there is none.
+        Called on the worker thread.
+    */
+    using ReadFunction = std::function<bool (juce::MemoryBlock& dest, const juce::String& typeUTI)>;
+
+    /** Returns true if the data is acceptable. Called on the worker thread. */
+    using Validator = std::function<bool (const juce::MemoryBlock& data)>;
+
+    /** Receives the result. Called on the message thread (or via the custom dispatcher). */
+    using Completion = std::function<void (Result result, juce::MemoryBlock data)>;
+
+    /** Runs a callback on the thread that should receive completions. */
+    using Dispatcher = std::function<void (std::function<void()> callback)>;
+
+    //==============================================================================
+    /** Creates a fetcher.
+
+        @param readFunction  Reads the clipboard; if empty, the native pasteboard is used
+        @param dispatcher    Delivers completions; if empty, MessageManager::callAsync() is used
+    */
+    explicit NativeMacClipboardFetcher (ReadFunction readFunction = nullptr,
+                                        Dispatcher dispatcher = nullptr);
+
+    /** Destructor. Cancels any pending request and waits for the worker to finish. */
+    ~NativeMacClipboardFetcher();
+
+    //==============================================================================
+    /** Starts fetching clipboard data, cancelling any request that is still pending.
+
+        @param typeUTI      The custom UTI to retrieve
+        @param completion   Called with the result once the fetch has finished
+        @param validator    Optional check run on the worker before the data is delivered
+        @returns an ID identifying this request
+    */
+    uint32 fetchAsync (const juce::String& typeUTI,
+                       Completion completion,
+                       Validator validator = nullptr);
+
+    /** Cancels the pending request, if any. Its completion callback will not be called. */
+    void cancel();
+
+    /** Returns true if a request has been started and its completion hasn't been delivered yet. */
+    bool isPending() const noexcept;
+
+private:
+    //==============================================================================
+    struct State;
+    class Worker;
+
+    std::shared_ptr<State> state;
+    std::unique_ptr<Worker> worker;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacClipboardFetcher)
+};
+
+} // namespace juce
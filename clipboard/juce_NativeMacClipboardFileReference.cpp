@@ -0,0 +1,368 @@
+/*******************************************************************************
+ File-backed clipboard payloads - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+namespace ClipboardFileReferenceHelpers
+{
+    static constexpr size_t recordHeaderSize = 28;
+    static constexpr size_t nonceSize = 8;
+    static constexpr const char* filePrefix = "juce_clipboard_";
+    static constexpr const char* fileSuffix = ".spill";
+
+    struct Record
+    {
+        uint64 size = 0;
+        uint64 nonce = 0;
+        const char* path = nullptr;
+        size_t pathLength = 0;
+    };
+
+    static bool parseRecord (const void* data, size_t size, Record& record) noexcept
+    {
+        using namespace ClipboardPayloadHelpers;
+
+        if (data == nullptr || size < recordHeaderSize)
+            return false;
+
+        auto* p = static_cast<const uint8*> (data);
+
+        if (readLE32 (p) != NativeMacClipboardFileReference::magic
+             || p[4] == 0 || p[4] > NativeMacClipboardFileReference::currentVersion)
+            return false;
+
+        record.size       = readLE64 (p + 8);
+        record.nonce      = readLE64 (p + 16);
+        record.pathLength = readLE32 (p + 24);
+        record.path       = reinterpret_cast<const char*> (p + recordHeaderSize);
+
+        return record.pathLength > 0
+            && record.pathLength == size - recordHeaderSize
+            && record.size <= (uint64) std::numeric_limits<size_t>::max() - nonceSize;
+    }
+
+    // The path comes from the pasteboard, so it must name a file this module could
+    // have created; the trailing nonce can't prove that, as the same writer controls it
+    static bool isSpillFileIn (const juce::File& file, const juce::File& directory)
+    {
+        return directory.getFullPathName().isNotEmpty()
+            && file.getParentDirectory() == directory
+            && file.getFileName().matchesWildcard (juce::String (filePrefix) + "*" + fileSuffix, false)
+            && ! file.isSymbolicLink()
+            && file.existsAsFile();
+    }
+}
+
+//==============================================================================
+bool NativeMacClipboardFileReference::createSpillFile (const void* data, size_t size,
+                                                       const juce::File& directory,
+                                                       juce::MemoryBlock& referenceRecord,
+                                                       juce::File& spillFile)
+{
+    using namespace ClipboardFileReferenceHelpers;
+    using namespace ClipboardPayloadHelpers;
+
+    if (! directory.createDirectory().wasOk())
+        return false;
+
+    spillFile = directory.getNonexistentChildFile (filePrefix + juce::String::toHexString (juce::Time::currentTimeMillis()),
+                                                   fileSuffix, false);
+
+    const auto nonce = (uint64) juce::Random::getSystemRandom().nextInt64();
+    uint8 nonceBytes[nonceSize];
+    writeLE64 (nonceBytes, nonce);
+
+    {
+        juce::FileOutputStream out (spillFile);
+
+        if (! (out.openedOk()
+                && (size == 0 || out.write (data, size))
+                && out.write (nonceBytes, nonceSize)))
+        {
+            spillFile.deleteFile();
+            return false;
+        }
+
+        out.flush();
+    }
+
+    const auto path = spillFile.getFullPathName();
+    const auto pathLength = path.getNumBytesAsUTF8();
+
+    referenceRecord.setSize (recordHeaderSize + pathLength, true);
+    auto* p = static_cast<uint8*> (referenceRecord.getData());
+
+    writeLE32 (p, magic);
+    p[4] = currentVersion;
+    writeLE64 (p + 8, (uint64) size);
+    writeLE64 (p + 16, nonce);
+    writeLE32 (p + 24, (uint32) pathLength);
+    std::memcpy (p + recordHeaderSize, path.toRawUTF8(), pathLength);
+
+    return true;
+}
+
+bool NativeMacClipboardFileReference::isReference (const void* data, size_t size) noexcept
+{
+    ClipboardFileReferenceHelpers::Record record;
+    return ClipboardFileReferenceHelpers::parseRecord (data, size, record);
+}
+
+juce::File NativeMacClipboardFileReference::getReferencedFile (const void* data, size_t size)
+{
+    ClipboardFileReferenceHelpers::Record record;
+
+    if (! ClipboardFileReferenceHelpers::parseRecord (data, size, record))
+        return {};
+
+    // File normalises "." and ".." components, so the result can be compared with a directory
+    const auto path = juce::String::fromUTF8 (record.path, (int) record.pathLength);
+
+    if (! juce::File::isAbsolutePath (path))
+        return {};
+
+    return juce::File (path);
+}
+
+//==============================================================================
+NativeMacClipboardFileReference::Mapping::Mapping (const void* referenceRecord, size_t recordSize,
+                                                   const juce::File& spillDirectory)
+{
+    using namespace ClipboardFileReferenceHelpers;
+
+    Record record;
+
+    if (! parseRecord (referenceRecord, recordSize, record))
+        return;
+
+    const auto file = getReferencedFile (referenceRecord, recordSize);
+
+    if (! isSpillFileIn (file, spillDirectory))
+        return;
+
+    const auto expectedFileSize = (juce::int64) (record.size + nonceSize);
+
+    if (file.getSize() != expectedFileSize)
+        return;
+
+    auto mapping = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+
+    if (mapping->getData() == nullptr || (juce::int64) mapping->getSize() != expectedFileSize)
+        return;
+
+    // The trailing nonce ties the file to this particular reference
+    auto* trailer = static_cast<const uint8*> (mapping->getData()) + record.size;
+
+    if (ClipboardPayloadHelpers::readLE64 (trailer) != record.nonce)
+        return;
+
+    size = (size_t) record.size;
+    mappedFile = std::move (mapping);
+}
+
+//==============================================================================
+juce::File NativeMacClipboardFileReference::getDefaultDirectory()
+{
+    return juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("juce_native_macos_clipboard");
+}
+
+int NativeMacClipboardFileReference::deleteStaleFiles (const juce::File& directory, juce::RelativeTime maximumAge)
+{
+    using namespace ClipboardFileReferenceHelpers;
+
+    const auto cutoff = juce::Time::getCurrentTime() - maximumAge;
+    int numDeleted = 0;
+
+    for (auto& file : directory.findChildFiles (juce::File::findFiles, false, juce::String (filePrefix) + "*" + fileSuffix))
+        if (file.getLastModificationTime() < cutoff && file.deleteFile())
+            ++numDeleted;
+
+    return numDeleted;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacClipboardFileReferenceTests  : public juce::UnitTest
+{
+public:
+    NativeMacClipboardFileReferenceTests()
+        : juce::UnitTest ("NativeMacClipboardFileReference", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        const auto directory = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                                  .getNonexistentChildFile ("juce_clipboard_reference_tests", {}, false);
+
+        const auto otherDirectory = directory.getSiblingFile (directory.getFileName() + "_other");
+
+        juce::MemoryBlock payload (3000);
+
+        for (size_t i = 0; i < payload.getSize(); ++i)
+            payload[i] = (char) i;
+
+        beginTest ("Create and map");
+        {
+            juce::MemoryBlock record;
+            juce::File spillFile;
+            expect (Reference::createSpillFile (payload.getData(), payload.getSize(), directory, record, spillFile));
+
+            expect (spillFile.existsAsFile());
+            expect (spillFile.getParentDirectory() == directory);
+            expect (Reference::isReference (record.getData(), record.getSize()));
+            expect (Reference::getReferencedFile (record.getData(), record.getSize()) == spillFile);
+
+            Reference::Mapping mapping (record.getData(), record.getSize(), directory);
+            expect (mapping.isValid());
+            expectEquals (mapping.getSize(), payload.getSize());
+            expect (juce::MemoryBlock (mapping.getData(), mapping.getSize()) == payload);
+
+            juce::MemoryBlock emptyRecord;
+            juce::File emptyFile;
+            expect (Reference::createSpillFile (nullptr, 0, directory, emptyRecord, emptyFile));
+            expect (Reference::Mapping (emptyRecord.getData(), emptyRecord.getSize(), directory).isValid());
+        }
+
+        beginTest ("Stale references");
+        {
+            juce::MemoryBlock record;
+            juce::File spillFile;
+            Reference::createSpillFile (payload.getData(), payload.getSize(), directory, record, spillFile);
+
+            // Each record field that ties it to the file: the size and the nonce
+            for (size_t offset : { (size_t) 8, (size_t) 16 })
+            {
+                auto changed = record;
+                changed[offset] = (char) (changed[offset] ^ 1);
+                expect (! Reference::Mapping (changed.getData(), changed.getSize(), directory).isValid());
+            }
+
+            // The file has been replaced by a later spill
+            juce::MemoryBlock otherRecord;
+            juce::File otherFile;
+            Reference::createSpillFile (payload.getData(), payload.getSize(), directory, otherRecord, otherFile);
+            expect (otherFile.copyFileTo (spillFile));
+            expect (! Reference::Mapping (record.getData(), record.getSize(), directory).isValid());
+
+            spillFile.deleteFile();
+            expect (! Reference::Mapping (record.getData(), record.getSize(), directory).isValid());
+        }
+
+        beginTest ("Only spill files in the spill directory are mapped");
+        {
+            juce::MemoryBlock record;
+            juce::File spillFile;
+            Reference::createSpillFile (payload.getData(), payload.getSize(), otherDirectory, record, spillFile);
+
+            expect (Reference::Mapping (record.getData(), record.getSize(), otherDirectory).isValid());
+            expect (! Reference::Mapping (record.getData(), record.getSize(), directory).isValid());
+            expect (! Reference::Mapping (record.getData(), record.getSize(), juce::File()).isValid());
+
+            const auto escaping = directory.getFullPathName() + "/../" + otherDirectory.getFileName() + "/" + spillFile.getFileName();
+            expect (! isMappedWithPath (record, escaping, directory));
+
+            const auto link = directory.getChildFile ("juce_clipboard_link.spill");
+            expect (spillFile.createSymbolicLink (link, true));
+            expect (! isMappedWithPath (record, link.getFullPathName(), directory));
+
+            const auto wrongName = directory.getChildFile ("notes.txt");
+            expect (spillFile.copyFileTo (wrongName));
+            expect (! isMappedWithPath (record, wrongName.getFullPathName(), directory));
+
+            const auto subdirectory = directory.getChildFile ("nested");
+            subdirectory.createDirectory();
+            const auto nested = subdirectory.getChildFile ("juce_clipboard_nested.spill");
+            expect (spillFile.copyFileTo (nested));
+            expect (! isMappedWithPath (record, nested.getFullPathName(), directory));
+
+            const auto relative = withPath (record, "juce_clipboard_x.spill");
+            expect (Reference::getReferencedFile (relative.getData(), relative.getSize()) == juce::File());
+
+            // A copy with a spill file name in the directory is indistinguishable from the original
+            const auto copy = directory.getChildFile ("juce_clipboard_copy.spill");
+            expect (spillFile.copyFileTo (copy));
+            expect (isMappedWithPath (record, copy.getFullPathName(), directory));
+        }
+
+        beginTest ("Malformed records");
+        {
+            juce::MemoryBlock record;
+            juce::File spillFile;
+            Reference::createSpillFile (payload.getData(), payload.getSize(), directory, record, spillFile);
+
+            for (size_t size = 0; size < record.getSize(); ++size)
+                expect (! Reference::isReference (record.getData(), size));
+
+            auto random = getRandom();
+
+            for (int i = 0; i < 500; ++i)
+            {
+                juce::MemoryBlock junk ((size_t) random.nextInt (100));
+
+                for (size_t j = 0; j < junk.getSize(); ++j)
+                    junk[j] = (char) random.nextInt (256);
+
+                if (! Reference::isReference (junk.getData(), junk.getSize()))
+                    expect (! Reference::Mapping (junk.getData(), junk.getSize(), directory).isValid());
+            }
+        }
+
+        beginTest ("Stale file cleanup");
+        {
+            directory.deleteRecursively();
+
+            juce::MemoryBlock record;
+            juce::File oldFile, newFile;
+            Reference::createSpillFile (payload.getData(), payload.getSize(), directory, record, oldFile);
+            Reference::createSpillFile (payload.getData(), payload.getSize(), directory, record, newFile);
+
+            const auto unrelated = directory.getChildFile ("notes.txt");
+            unrelated.replaceWithText ("keep");
+
+            const auto twoHoursAgo = juce::Time::getCurrentTime() - juce::RelativeTime::hours (2);
+            oldFile.setLastModificationTime (twoHoursAgo);
+            unrelated.setLastModificationTime (twoHoursAgo);
+
+            expectEquals (Reference::deleteStaleFiles (directory, juce::RelativeTime::hours (1)), 1);
+            expect (! oldFile.exists());
+            expect (newFile.existsAsFile());
+            expect (unrelated.existsAsFile());
+        }
+
+        directory.deleteRecursively();
+        otherDirectory.deleteRecursively();
+    }
+
+private:
+    using Reference = NativeMacClipboardFileReference;
+
+    // Rewrites the path in a record, as another process writing the pasteboard could
+    static juce::MemoryBlock withPath (const juce::MemoryBlock& record, const juce::String& path)
+    {
+        using namespace ClipboardFileReferenceHelpers;
+
+        const auto pathLength = path.getNumBytesAsUTF8();
+
+        juce::MemoryBlock result (record.getData(), recordHeaderSize);
+        result.append (path.toRawUTF8(), pathLength);
+        ClipboardPayloadHelpers::writeLE32 (static_cast<uint8*> (result.getData()) + 24, (uint32) pathLength);
+        return result;
+    }
+
+    static bool isMappedWithPath (const juce::MemoryBlock& record, const juce::String& path, const juce::File& directory)
+    {
+        const auto changed = withPath (record, path);
+        return Reference::Mapping (changed.getData(), changed.getSize(), directory).isValid();
+    }
+};
+
+static NativeMacClipboardFileReferenceTests nativeMacClipboardFileReferenceTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,117 @@
+/*******************************************************************************
+ File-backed clipboard payloads
+
+ Very large payloads are written to a temporary file, and only a small
+ reference to that file is put on the pasteboard.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Spill files and the reference records that point at them.
+
+    A reference record is a small little-endian structure placed on the
+    pasteboard in place of the payload itself:
+
+    | Offset | Size | Field                                   |
+    |--------|------|-----------------------------------------|
+    | 0      | 4    | Magic "JNCF"                            |
+    | 4      | 1    | Format version                          |
+    | 5      | 3    | Reserved (0)                            |
+    | 8      | 8    | Payload size                            |
+    | 16     | 8    | Nonce, repeated at the end of the file  |
+    | 24     | 4    | Path length in bytes                    |
+    | 28     | n    | UTF-8 path of the spill file            |
+
+    The spill file holds the payload followed by the 8-byte nonce, so a reader
+    can tell whether the file still belongs to the reference without hashing
+    the whole payload. Readers memory-map the file instead of loading it, and
+    only ever map juce_clipboard_*.spill files in their spill directory.
+
+    NativeMacPasteboard uses this automatically once a threshold has been set
+    with NativeMacPasteboard::setFileBackedThreshold().
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacClipboardFileReference
+{
+public:
+    //==============================================================================
+    static constexpr uint32 magic          = 0x46434e4a;   // "JNCF" in little-endian order
+    static constexpr uint8  currentVersion = 1;
+
+    //==============================================================================
+    /** Writes a payload to a new spill file.
+
+        @param data             The payload
+        @param size             Size of the payload in bytes
+        @param directory        Where to create the file (see getDefaultDirectory())
+        @param referenceRecord  Receives the record to put on the pasteboard
+        @param spillFile        Receives the file that was created
+        @returns false if the file couldn't be written
+    */
+    static bool createSpillFile (const void* data, size_t size,
+                                 const juce::File& directory,
+                                 juce::MemoryBlock& referenceRecord,
+                                 juce::File& spillFile);
+
+    /** Returns true if the data is a well-formed reference record. Runs in constant time. */
+    static bool isReference (const void* data, size_t size) noexcept;
+
+    /** Returns the spill file a reference record points at, or an empty File if it isn't
+        a reference or doesn't hold an absolute path.
+    */
+    static juce::File getReferencedFile (const void* data, size_t size);
+
+    //==============================================================================
+    /** A read-only mapping of a referenced payload. */
+    class JUCE_API  Mapping
+    {
+    public:
+        /** Maps the file a reference record points at. Check isValid() afterwards.
+
+            Any process can write the pasteboard, so the record is only trusted to
+            name one of the spill files in spillDirectory: anything else, including
+            symbolic links, is never mapped.
+        */
+        Mapping (const void* referenceRecord, size_t recordSize,
+                 const juce::File& spillDirectory = getDefaultDirectory());
+
+        /** Returns true if the file is a spill file in the directory, matches the
+            reference and could be mapped.
+        */
+        bool isValid() const noexcept           { return mappedFile != nullptr; }
+
+        /** Returns the payload. */
+        const void* getData() const noexcept    { return mappedFile != nullptr ? mappedFile->getData() : nullptr; }
+
+        /** Returns the payload size. */
+        size_t getSize() const noexcept         { return size; }
+
+    private:
+        std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+        size_t size = 0;
+
+        JUCE_DECLARE_NON_COPYABLE (Mapping)
+    };
+
+    //==============================================================================
+    /** Returns the directory spill files are created in by default. */
+    static juce::File getDefaultDirectory();
+
+    /** Deletes spill files in a directory that are older than the given age.
+
+        @returns the number of files deleted
+    */
+    static int deleteStaleFiles (const juce::File& directory, juce::RelativeTime maximumAge);
+
+private:
+    NativeMacClipboardFileReference() = delete;
+    JUCE_DECLARE_NON_COPYABLE (NativeMacClipboardFileReference)
+};
+
+} // namespace juce
@@ -0,0 +1,545 @@
+/*******************************************************************************
+ In-process clipboard history - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+struct NativeMacClipboardHistory::Entry
+{
+    ~Entry()
+    {
+        // Unmap before deleting, as some platforms refuse to delete mapped files
+        mappedFile.reset();
+
+        if (spillFile.getFullPathName().isNotEmpty())
+            spillFile.deleteFile();
+    }
+
+    bool isSpilled() const noexcept         { return mappedFile != nullptr; }
+
+    const void* getData() const noexcept
+    {
+        return mappedFile != nullptr ? mappedFile->getData() : heapData.getData();
+    }
+
+    juce::String typeUTI;
+    uint64 hash = 0;
+    size_t size = 0;
+
+    juce::MemoryBlock heapData;
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    juce::File spillFile;
+};
+
+//==============================================================================
+NativeMacClipboardHistory::NativeMacClipboardHistory()
+    : NativeMacClipboardHistory (Options())
+{
+}
+
+NativeMacClipboardHistory::NativeMacClipboardHistory (Options o)
+    : options (std::move (o))
+{
+    jassert (options.maxEntries > 0);
+    ring.resize ((size_t) jmax (1, options.maxEntries));
+}
+
+NativeMacClipboardHistory::~NativeMacClipboardHistory()
+{
+    clear();
+}
+
+//==============================================================================
+bool NativeMacClipboardHistory::isRecordedType (const juce::String& typeUTI) const
+{
+    if (options.typeUTIs.isEmpty())
+        return true;
+
+    for (auto& type : options.typeUTIs)
+        if (type == typeUTI)
+            return true;
+
+    return false;
+}
+
+bool NativeMacClipboardHistory::add (const void* data, size_t size, const juce::String& typeUTI)
+{
+    if (options.maxEntries <= 0 || ! isRecordedType (typeUTI))
+        return false;
+
+    const auto hash = NativeMacClipboardPayload::Checksum::hash64 (data, size, (uint64) typeUTI.hashCode64());
+
+    auto moveExistingToFront = [&]
+    {
+        for (int i = 0; i < numEntries; ++i)
+        {
+            auto entry = getEntryAt (i);
+
+            if (entry->hash == hash && entry->size == size && entry->typeUTI == typeUTI)
+            {
+                const auto capacity = (int) ring.size();
+
+                for (int j = i; j > 0; --j)
+                    ring[(size_t) ((head - j + capacity) % capacity)] = getEntryAt (j - 1);
+
+                ring[(size_t) head] = std::move (entry);
+                ++stats.numDeduplicated;
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    const bool shouldSpill = options.spillThreshold > 0 && size > 0 && size >= options.spillThreshold;
+
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (moveExistingToFront())
+            return true;
+
+        if (shouldSpill ? (juce::int64) size > options.maxSpilledBytes
+                        : size > options.maxHeapBytes)
+        {
+            ++stats.numRejected;
+            return false;
+        }
+    }
+
+    // Copying or writing the spill file happens outside the lock
+    auto entry = std::make_shared<Entry>();
+    entry->typeUTI = typeUTI;
+    entry->hash = hash;
+    entry->size = size;
+
+    if (shouldSpill)
+    {
+        auto directory = options.spillDirectory.getFullPathName().isNotEmpty()
+                            ? options.spillDirectory
+                            : juce::File::getSpecialLocation (juce::File::tempDirectory);
+
+        entry->spillFile = directory.getNonexistentChildFile ("juce_clipboard_history", ".tmp", false);
+
+        {
+            juce::FileOutputStream out (entry->spillFile);
+
+            if (! out.openedOk() || ! out.write (data, size))
+                return false;   // the Entry destructor removes the partial file
+
+            out.flush();
+        }
+
+        entry->mappedFile = std::make_unique<juce::MemoryMappedFile> (entry->spillFile, juce::MemoryMappedFile::readOnly);
+
+        if (entry->mappedFile->getData() == nullptr || entry->mappedFile->getSize() != size)
+            return false;
+    }
+    else
+    {
+        entry->heapData.replaceAll (data, size);
+    }
+
+    const juce::ScopedLock sl (lock);
+
+    // Another thread may have added the same payload while we weren't holding the lock
+    if (moveExistingToFront())
+        return true;
+
+    evictToFit (entry->isSpilled() ? 0 : size, entry->isSpilled() ? (juce::int64) size : 0);
+
+    if (entry->isSpilled())
+        stats.spilledBytes += (juce::int64) size;
+    else
+        stats.heapBytes += size;
+
+    head = (head + 1) % (int) ring.size();
+    ring[(size_t) head] = std::move (entry);
+    ++numEntries;
+    stats.numEntries = numEntries;
+
+    return true;
+}
+
+//==============================================================================
+int NativeMacClipboardHistory::getNumEntries() const
+{
+    const juce::ScopedLock sl (lock);
+    return numEntries;
+}
+
+NativeMacClipboardHistory::EntryInfo NativeMacClipboardHistory::getEntryInfo (int index) const
+{
+    EntryInfo info;
+
+    const juce::ScopedLock sl (lock);
+
+    if (auto entry = getEntryAt (index))
+    {
+        info.typeUTI = entry->typeUTI;
+        info.size = entry->size;
+        info.isSpilled = entry->isSpilled();
+    }
+
+    return info;
+}
+
+bool NativeMacClipboardHistory::getEntry (int index, juce::MemoryBlock& dest) const
+{
+    return visitEntry (index, [&dest] (const void* data, size_t size) { dest.replaceAll (data, size); });
+}
+
+bool NativeMacClipboardHistory::visitEntry (int index, DataVisitorFunction visitorFunction, void* context) const
+{
+    std::shared_ptr<Entry> entry;
+
+    {
+        const juce::ScopedLock sl (lock);
+        entry = getEntryAt (index);
+    }
+
+    // Holding the shared_ptr keeps the data (and any mapping) alive even if it gets evicted meanwhile
+    if (entry == nullptr)
+        return false;
+
+    visitorFunction (context, entry->getData(), entry->size);
+    return true;
+}
+
+void NativeMacClipboardHistory::clear()
+{
+    const juce::ScopedLock sl (lock);
+
+    for (auto& slot : ring)
+        slot.reset();
+
+    head = 0;
+    numEntries = 0;
+    stats.numEntries = 0;
+    stats.heapBytes = 0;
+    stats.spilledBytes = 0;
+}
+
+NativeMacClipboardHistory::Stats NativeMacClipboardHistory::getStats() const
+{
+    const juce::ScopedLock sl (lock);
+    return stats;
+}
+
+//==============================================================================
+std::shared_ptr<NativeMacClipboardHistory::Entry> NativeMacClipboardHistory::getEntryAt (int index) const
+{
+    if (! isPositiveAndBelow (index, numEntries))
+        return nullptr;
+
+    const auto capacity = (int) ring.size();
+    return ring[(size_t) ((head - index + capacity) % capacity)];
+}
+
+void NativeMacClipboardHistory::removeAt (int index)
+{
+    const auto capacity = (int) ring.size();
+    auto slot = [&] (int i) -> std::shared_ptr<Entry>& { return ring[(size_t) ((head - i + capacity) % capacity)]; };
+
+    auto& entry = *slot (index);
+
+    if (entry.isSpilled())
+        stats.spilledBytes -= (juce::int64) entry.size;
+    else
+        stats.heapBytes -= entry.size;
+
+    // Close the gap by moving the older entries one step towards the front
+    for (int i = index; i < numEntries - 1; ++i)
+        slot (i) = std::move (slot (i + 1));
+
+    slot (numEntries - 1).reset();
+    --numEntries;
+
+    stats.numEntries = numEntries;
+    ++stats.numEvictions;
+}
+
+void NativeMacClipboardHistory::evictToFit (size_t heapBytesNeeded, juce::int64 spilledBytesNeeded)
+{
+    while (numEntries > 0)
+    {
+        if (numEntries >= (int) ring.size())
+        {
+            removeAt (numEntries - 1);
+            continue;
+        }
+
+        const bool heapOver  = heapBytesNeeded > 0 && stats.heapBytes + heapBytesNeeded > options.maxHeapBytes;
+        const bool spillOver = spilledBytesNeeded > 0 && stats.spilledBytes + spilledBytesNeeded > options.maxSpilledBytes;
+
+        if (! heapOver && ! spillOver)
+            return;
+
+        // Evict the oldest entry of the kind whose budget is exceeded
+        int victim = -1;
+
+        for (int i = numEntries; --i >= 0;)
+        {
+            const bool spilled = getEntryAt (i)->isSpilled();
+
+            if ((heapOver && ! spilled) || (spillOver && spilled))
+            {
+                victim = i;
+                break;
+            }
+        }
+
+        if (victim < 0)
+            return;
+
+        removeAt (victim);
+    }
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacClipboardHistoryTests  : public juce::UnitTest
+{
+public:
+    NativeMacClipboardHistoryTests()
+        : juce::UnitTest ("NativeMacClipboardHistory", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest ("Most recent first");
+        {
+            NativeMacClipboardHistory history;
+
+            for (int i = 0; i < 3; ++i)
+                expect (add (history, makePayload (i, 100)));
+
+            expectEquals (history.getNumEntries(), 3);
+
+            for (int i = 0; i < 3; ++i)
+                expect (entryEquals (history, i, makePayload (2 - i, 100)));
+
+            juce::MemoryBlock dest;
+            expect (! history.getEntry (3, dest));
+            expect (! history.visitEntry (-1, [] (const void*, size_t) {}));
+            expectEquals (history.getEntryInfo (3).size, (size_t) 0);
+        }
+
+        beginTest ("Entry count budget");
+        {
+            auto options = createOptions();
+            options.maxEntries = 4;
+            NativeMacClipboardHistory history (options);
+
+            for (int i = 0; i < 10; ++i)
+                add (history, makePayload (i, 100));
+
+            const auto stats = history.getStats();
+            expectEquals (history.getNumEntries(), 4);
+            expectEquals (stats.numEvictions, (juce::int64) 6);
+            expectEquals (stats.heapBytes, (size_t) 400);
+            expect (entryEquals (history, 0, makePayload (9, 100)));
+            expect (entryEquals (history, 3, makePayload (6, 100)));
+        }
+
+        beginTest ("Heap budget evicts the oldest entries");
+        {
+            auto options = createOptions();
+            options.maxHeapBytes = 1000;
+            NativeMacClipboardHistory history (options);
+
+            for (int i = 0; i < 5; ++i)
+                add (history, makePayload (i, 300));
+
+            expectEquals (history.getNumEntries(), 3);
+            expectEquals (history.getStats().heapBytes, (size_t) 900);
+            expect (entryEquals (history, 2, makePayload (2, 300)));
+
+            // Too large for the budget on its own, so nothing is evicted for it
+            expect (! add (history, makePayload (9, 1001)));
+            expectEquals (history.getNumEntries(), 3);
+            expectEquals (history.getStats().numRejected, (juce::int64) 1);
+        }
+
+        beginTest ("Duplicates move to the front");
+        {
+            NativeMacClipboardHistory history (createOptions());
+
+            for (int i = 0; i < 3; ++i)
+                add (history, makePayload (i, 100));
+
+            expect (add (history, makePayload (0, 100)));
+
+            const auto stats = history.getStats();
+            expectEquals (history.getNumEntries(), 3);
+            expectEquals (stats.numDeduplicated, (juce::int64) 1);
+            expectEquals (stats.heapBytes, (size_t) 300);
+            expect (entryEquals (history, 0, makePayload (0, 100)));
+            expect (entryEquals (history, 1, makePayload (2, 100)));
+            expect (entryEquals (history, 2, makePayload (1, 100)));
+
+            // The same bytes under another type are a different entry
+            expect (add (history, makePayload (0, 100), "com.example.other"));
+            expectEquals (history.getNumEntries(), 4);
+        }
+
+        beginTest ("Type filter");
+        {
+            auto options = createOptions();
+            options.typeUTIs = { "com.example.preset" };
+            NativeMacClipboardHistory history (options);
+
+            expect (history.isRecordedType ("com.example.preset"));
+            expect (! history.isRecordedType ("com.example.other"));
+            expect (! add (history, makePayload (0, 100), "com.example.other"));
+            expectEquals (history.getNumEntries(), 0);
+        }
+
+        beginTest ("Large payloads are spilled");
+        {
+            const auto directory = createSpillDirectory();
+
+            {
+                auto options = createOptions();
+                options.spillThreshold = 1000;
+                options.maxSpilledBytes = 5000;
+                options.spillDirectory = directory;
+                NativeMacClipboardHistory history (options);
+
+                add (history, makePayload (0, 100));
+
+                for (int i = 1; i <= 3; ++i)
+                    add (history, makePayload (i, 2000));
+
+                // The third spilled payload pushes the first out of the spill budget
+                auto stats = history.getStats();
+                expectEquals (history.getNumEntries(), 3);
+                expectEquals (stats.spilledBytes, (juce::int64) 4000);
+                expectEquals (stats.heapBytes, (size_t) 100);
+                expectEquals (directory.getNumberOfChildFiles (juce::File::findFiles), 2);
+
+                expect (history.getEntryInfo (0).isSpilled);
+                expect (! history.getEntryInfo (2).isSpilled);
+                expect (entryEquals (history, 0, makePayload (3, 2000)));
+                expect (entryEquals (history, 1, makePayload (2, 2000)));
+                expect (entryEquals (history, 2, makePayload (0, 100)));
+
+                expect (! add (history, makePayload (4, 5001)));
+
+                history.clear();
+                stats = history.getStats();
+                expectEquals (history.getNumEntries(), 0);
+                expectEquals (stats.heapBytes, (size_t) 0);
+                expectEquals (stats.spilledBytes, (juce::int64) 0);
+                expectEquals (directory.getNumberOfChildFiles (juce::File::findFiles), 0);
+
+                add (history, makePayload (5, 2000));
+                expectEquals (directory.getNumberOfChildFiles (juce::File::findFiles), 1);
+            }
+
+            expectEquals (directory.getNumberOfChildFiles (juce::File::findFiles), 0);
+            directory.deleteRecursively();
+        }
+
+        beginTest ("Stats match the entries after random use");
+        {
+            auto random = getRandom();
+            const auto directory = createSpillDirectory();
+
+            {
+                auto options = createOptions();
+                options.maxEntries = 8;
+                options.maxHeapBytes = 3000;
+                options.spillThreshold = 1500;
+                options.maxSpilledBytes = 6000;
+                options.spillDirectory = directory;
+                NativeMacClipboardHistory history (options);
+
+                for (int i = 0; i < 500; ++i)
+                {
+                    if (random.nextInt (50) == 0)
+                        history.clear();
+                    else
+                        add (history, makePayload (random.nextInt (20), (size_t) random.nextInt (2500)));
+
+                    const auto stats = history.getStats();
+                    size_t heapBytes = 0;
+                    juce::int64 spilledBytes = 0;
+
+                    for (int j = 0; j < history.getNumEntries(); ++j)
+                    {
+                        const auto info = history.getEntryInfo (j);
+
+                        if (info.isSpilled)
+                            spilledBytes += (juce::int64) info.size;
+                        else
+                            heapBytes += info.size;
+                    }
+
+                    expectLessOrEqual (history.getNumEntries(), options.maxEntries);
+                    expectEquals (stats.numEntries, history.getNumEntries());
+                    expectEquals (stats.heapBytes, heapBytes);
+                    expectEquals (stats.spilledBytes, spilledBytes);
+                    expectLessOrEqual (heapBytes, options.maxHeapBytes);
+                    expectLessOrEqual (spilledBytes, options.maxSpilledBytes);
+                }
+            }
+
+            directory.deleteRecursively();
+        }
+    }
+
+private:
+    static NativeMacClipboardHistory::Options createOptions()
+    {
+        NativeMacClipboardHistory::Options options;
+        options.spillThreshold = 0;
+        return options;
+    }
+
+    static juce::File createSpillDirectory()
+    {
+        auto directory = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                            .getNonexistentChildFile ("juce_clipboard_history_tests", {}, false);
+        directory.createDirectory();
+        return directory;
+    }
+
+    static juce::MemoryBlock makePayload (int seed, size_t size)
+    {
+        juce::MemoryBlock data (size);
+
+        for (size_t i = 0; i < size; ++i)
+            data[i] = (char) (seed * 31 + (int) i);
+
+        return data;
+    }
+
+    static bool add (NativeMacClipboardHistory& history, const juce::MemoryBlock& data,
+                     const juce::String& typeUTI = "com.example.preset")
+    {
+        return history.add (data.getData(), data.getSize(), typeUTI);
+    }
+
+    static bool entryEquals (const NativeMacClipboardHistory& history, int index, const juce::MemoryBlock& expected)
+    {
+        juce::MemoryBlock copied, visited;
+
+        return history.getEntry (index, copied)
+            && history.visitEntry (index, [&] (const void* data, size_t size) { visited.replaceAll (data, size); })
+            && copied == expected
+            && visited == expected
+            && history.getEntryInfo (index).size == expected.getSize();
+    }
+};
+
+static NativeMacClipboardHistoryTests nativeMacClipboardHistoryTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,158 @@
+/*******************************************************************************
+ In-process clipboard history
+
+ A bounded record of recent clipboard payloads, so that earlier copies can be
+ pasted again without going back to the system pasteboard.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A ring of the most recently copied clipboard payloads.
+
+    Entries are kept in memory up to a byte budget. Payloads at or above the spill
+    threshold are written to a temporary file and memory-mapped instead, so large
+    entries don't grow the heap. Adding a payload identical to one already held
+    moves that entry to the front instead of storing it twice.
+
+    Once installed with NativeMacPasteboard::setHistory(), everything written
+    through NativeMacPasteboard::copyDataToClipboard() is recorded automatically.
+
+    Index 0 is always the most recent entry, so "paste previous" is index 1.
+
+    This class is thread-safe.
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacClipboardHistory
+{
+public:
+    //==============================================================================
+    struct Options
+    {
+        /** The maximum number of entries kept. */
+        int maxEntries = 16;
+
+        /** The total size of entries kept on the heap. */
+        size_t maxHeapBytes = 4 * 1024 * 1024;
+
+        /** Payloads of this size or larger are spilled to a memory-mapped temporary file
+            (0 disables spilling, so every entry counts against the heap budget).
+        */
+        size_t spillThreshold = 256 * 1024;
+
+        /** The total size of spilled entries kept on disk. */
+        juce::int64 maxSpilledBytes = 256 * 1024 * 1024;
+
+        /** Where spill files are created. Defaults to the system temp directory. */
+        juce::File spillDirectory;
+
+        /** Only these types are recorded. Leave empty to record every type. */
+        juce::StringArray typeUTIs;
+    };
+
+    /** Describes one entry. */
+    struct EntryInfo
+    {
+        juce::String typeUTI;
+        size_t size = 0;
+        bool isSpilled = false;
+    };
+
+    /** Memory usage and activity counters. */
+    struct Stats
+    {
+        int numEntries = 0;
+        size_t heapBytes = 0;
+        juce::int64 spilledBytes = 0;
+        juce::int64 numEvictions = 0;
+        juce::int64 numDeduplicated = 0;
+        juce::int64 numRejected = 0;     /**< Payloads too large for either budget. */
+    };
+
+    //==============================================================================
+    /** Creates an empty history with the default options. */
+    NativeMacClipboardHistory();
+
+    /** Creates an empty history. */
+    explicit NativeMacClipboardHistory (Options options);
+
+    /** Destructor. Deletes any spill files. */
+    ~NativeMacClipboardHistory();
+
+    //==============================================================================
+    /** Records a payload as the most recent entry.
+
+        Older entries are evicted as needed to respect the entry and byte budgets.
+
+        @returns false if the type isn't recorded or the payload can't fit the budgets
+    */
+    bool add (const void* data, size_t size, const juce::String& typeUTI);
+
+    /** Returns true if payloads of this type are recorded. */
+    bool isRecordedType (const juce::String& typeUTI) const;
+
+    /** Returns the number of entries. */
+    int getNumEntries() const;
+
+    /** Returns information about an entry (0 = most recent), or an empty EntryInfo if the index is out of range. */
+    EntryInfo getEntryInfo (int index) const;
+
+    /** Copies an entry's data into a MemoryBlock.
+
+        @returns false if the index is out of range
+    */
+    bool getEntry (int index, juce::MemoryBlock& dest) const;
+
+    /** Calls visitor (const void* data, size_t size) with an entry's data in place.
+
+        The data stays valid for the duration of the call even if the entry is
+        evicted concurrently.
+
+        @returns false if the index is out of range
+    */
+    template <typename Visitor>
+    bool visitEntry (int index, Visitor&& visitor) const
+    {
+        using VisitorType = std::remove_reference_t<Visitor>;
+
+        return visitEntry (index,
+                           [] (void* context, const void* data, size_t size)
+                           {
+                               (*static_cast<VisitorType*> (context)) (data, size);
+                           },
+                           const_cast<void*> (static_cast<const void*> (std::addressof (visitor))));
+    }
+
+    /** Removes all entries and deletes any spill files. */
+    void clear();
+
+    /** Returns the current memory usage and counters. */
+    Stats getStats() const;
+
+private:
+    //==============================================================================
+    struct Entry;
+
+    using DataVisitorFunction = void (*) (void* context, const void* data, size_t size);
+
+    bool visitEntry (int index, DataVisitorFunction, void* context) const;
+    std::shared_ptr<Entry> getEntryAt (int index) const;
+    void removeAt (int index);
+    void evictToFit (size_t heapBytesNeeded, juce::int64 spilledBytesNeeded);
+
+    const Options options;
+
+    juce::CriticalSection lock;
+    std::vector<std::shared_ptr<Entry>> ring;   // fixed capacity of options.maxEntries
+    int head = 0, numEntries = 0;               // head is the slot of the most recent entry
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacClipboardHistory)
+};
+
+} // namespace juce
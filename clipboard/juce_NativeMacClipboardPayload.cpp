@@ -0,0 +1,859 @@
+/*******************************************************************************
+ Framed clipboard payload format - implementation
+*******************************************************************************/
+
+#if JUCE_INTEL && JUCE_64BIT && (JUCE_GCC || JUCE_CLANG || JUCE_MSVC)
+ #define JUCE_NATIVE_MACOS_CRC32C_SSE42 1
+ #include <nmmintrin.h>
+#elif JUCE_ARM && JUCE_64BIT && defined (__ARM_FEATURE_CRC32)
+ #define JUCE_NATIVE_MACOS_CRC32C_ARM 1
+ #include <arm_acle.h>
+#endif
+
+namespace juce
+{
+
+namespace ClipboardPayloadHelpers
+{
+    static inline uint16 readLE16 (const uint8* p) noexcept    { return (uint16) (p[0] | (p[1] << 8)); }
+    static inline uint32 readLE32 (const uint8* p) noexcept    { return (uint32) p[0] | ((uint32) p[1] << 8) | ((uint32) p[2] << 16) | ((uint32) p[3] << 24); }
+    static inline uint64 readLE64 (const uint8* p) noexcept    { return (uint64) readLE32 (p) | ((uint64) readLE32 (p + 4) << 32); }
+
+    static inline void writeLE16 (uint8* p, uint16 v) noexcept { p[0] = (uint8) v; p[1] = (uint8) (v >> 8); }
+    static inline void writeLE32 (uint8* p, uint32 v) noexcept { writeLE16 (p, (uint16) v); writeLE16 (p + 2, (uint16) (v >> 16)); }
+    static inline void writeLE64 (uint8* p, uint64 v) noexcept { writeLE32 (p, (uint32) v); writeLE32 (p + 4, (uint32) (v >> 32)); }
+
+    enum CodecID : uint8
+    {
+        codecStored = 0,
+        codecLZ     = 1
+    };
+
+    struct Header
+    {
+        uint8  version;
+        uint8  codec;
+        uint16 headerSize;
+        uint64 decodedSize;
+        uint32 encodedSize;
+        uint32 crc;
+    };
+
+    static bool parseHeader (const void* data, size_t size, Header& header) noexcept
+    {
+        if (data == nullptr || size < NativeMacClipboardPayload::headerSize)
+            return false;
+
+        auto* p = static_cast<const uint8*> (data);
+
+        if (readLE32 (p) != NativeMacClipboardPayload::magic)
+            return false;
+
+        header.version     = p[4];
+        header.codec       = p[5];
+        header.headerSize  = readLE16 (p + 6);
+        header.decodedSize = readLE64 (p + 8);
+        header.encodedSize = readLE32 (p + 16);
+        header.crc         = readLE32 (p + 20);
+
+        // Newer versions may grow the header, but must keep these fields where they are
+        if (header.version == 0 || header.version > NativeMacClipboardPayload::currentVersion)
+            return false;
+
+        if (header.headerSize < NativeMacClipboardPayload::headerSize
+             || (uint64) header.headerSize + header.encodedSize != (uint64) size)
+            return false;
+
+        if (header.decodedSize > (uint64) std::numeric_limits<size_t>::max())
+            return false;
+
+        switch (header.codec)
+        {
+            case codecStored:   return header.decodedSize == header.encodedSize;
+            // Every encoded byte expands to at most 255 decoded bytes, which bounds
+            // the allocation a corrupt or hostile header can trigger
+            case codecLZ:       return header.decodedSize != 0
+                                    && header.decodedSize <= (uint64) header.encodedSize * 255u;
+            default:            return false;
+        }
+    }
+
+    //==============================================================================
+    struct CRCTables
+    {
+        CRCTables() noexcept
+        {
+            for (uint32 i = 0; i < 256; ++i)
+            {
+                auto crc = i;
+
+                for (int bit = 0; bit < 8; ++bit)
+                    crc = (crc >> 1) ^ (0x82f63b78u & (0u - (crc & 1u)));
+
+                table[0][i] = crc;
+            }
+
+            for (uint32 i = 0; i < 256; ++i)
+                for (int slice = 1; slice < 8; ++slice)
+                    table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xff];
+        }
+
+        uint32 table[8][256];
+    };
+
+    static const CRCTables& getCRCTables() noexcept
+    {
+        static const CRCTables tables;
+        return tables;
+    }
+
+   #if JUCE_NATIVE_MACOS_CRC32C_SSE42
+    #if JUCE_GCC || JUCE_CLANG
+     __attribute__ ((target ("sse4.2")))
+    #endif
+    static uint32 crc32cHardware (const uint8* p, size_t size, uint32 crc) noexcept
+    {
+        uint64 crc64 = crc;
+
+        for (; size >= 8; size -= 8, p += 8)
+        {
+            uint64 word;
+            std::memcpy (&word, p, sizeof (word));
+            crc64 = _mm_crc32_u64 (crc64, word);
+        }
+
+        crc = (uint32) crc64;
+
+        for (; size > 0; --size)
+            crc = _mm_crc32_u8 (crc, *p++);
+
+        return crc;
+    }
+   #elif JUCE_NATIVE_MACOS_CRC32C_ARM
+    static uint32 crc32cHardware (const uint8* p, size_t size, uint32 crc) noexcept
+    {
+        for (; size >= 8; size -= 8, p += 8)
+        {
+            uint64 word;
+            std::memcpy (&word, p, sizeof (word));
+            crc = __crc32cd (crc, word);
+        }
+
+        for (; size > 0; --size)
+            crc = __crc32cb (crc, *p++);
+
+        return crc;
+    }
+   #endif
+
+    //==============================================================================
+    // LZ block format constants, matching the LZ4 block conventions
+    static constexpr size_t minMatch     = 4;
+    static constexpr size_t lastLiterals = 5;    // the final bytes are always literals
+    static constexpr size_t matchLimit   = 12;   // no match may start within this many bytes of the end
+    static constexpr size_t maxOffset    = 65535;
+    static constexpr int    hashLog      = 12;
+
+    static inline uint32 read32 (const uint8* p) noexcept
+    {
+        uint32 v;
+        std::memcpy (&v, p, sizeof (v));
+        return v;
+    }
+
+    static inline uint32 hashSequence (uint32 sequence) noexcept
+    {
+        return (sequence * 2654435761u) >> (32 - hashLog);
+    }
+
+    static inline uint8* writeExtendedLength (uint8* op, size_t length) noexcept
+    {
+        for (; length >= 255; length -= 255)
+            *op++ = 255;
+
+        *op++ = (uint8) length;
+        return op;
+    }
+
+    static inline bool readExtendedLength (const uint8*& ip, const uint8* ipEnd, size_t& length) noexcept
+    {
+        for (;;)
+        {
+            if (ip >= ipEnd)
+                return false;
+
+            const auto b = *ip++;
+
+            if (length > std::numeric_limits<size_t>::max() - b)
+                return false;
+
+            length += b;
+
+            if (b != 255)
+                return true;
+        }
+    }
+
+    static inline size_t getSequenceSizeBound (size_t numLiterals, size_t matchLength) noexcept
+    {
+        return 1 + numLiterals / 255 + 1 + numLiterals + 2 + matchLength / 255 + 1;
+    }
+}
+
+//==============================================================================
+uint32 NativeMacClipboardPayload::Checksum::crc32cSoftware (const void* data, size_t size, uint32 previousCrc) noexcept
+{
+    auto& t = ClipboardPayloadHelpers::getCRCTables().table;
+    auto* p = static_cast<const uint8*> (data);
+    auto crc = ~previousCrc;
+
+    for (; size >= 8; size -= 8, p += 8)
+    {
+        crc ^= ClipboardPayloadHelpers::readLE32 (p);
+        const auto high = ClipboardPayloadHelpers::readLE32 (p + 4);
+
+        crc = t[7][crc & 0xff]         ^ t[6][(crc >> 8) & 0xff]
+            ^ t[5][(crc >> 16) & 0xff] ^ t[4][crc >> 24]
+            ^ t[3][high & 0xff]        ^ t[2][(high >> 8) & 0xff]
+            ^ t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+    }
+
+    for (; size > 0; --size)
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+
+    return ~crc;
+}
+
+bool NativeMacClipboardPayload::Checksum::isHardwareAccelerated() noexcept
+{
+   #if JUCE_NATIVE_MACOS_CRC32C_SSE42
+    static const bool hasSSE42 = SystemStats::hasSSE42();
+    return hasSSE42;
+   #elif JUCE_NATIVE_MACOS_CRC32C_ARM
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+uint32 NativeMacClipboardPayload::Checksum::crc32c (const void* data, size_t size, uint32 previousCrc) noexcept
+{
+   #if JUCE_NATIVE_MACOS_CRC32C_SSE42 || JUCE_NATIVE_MACOS_CRC32C_ARM
+    if (isHardwareAccelerated())
+        return ~ClipboardPayloadHelpers::crc32cHardware (static_cast<const uint8*> (data), size, ~previousCrc);
+   #endif
+
+    return crc32cSoftware (data, size, previousCrc);
+}
+
+uint64 NativeMacClipboardPayload::Checksum::hash64 (const void* data, size_t size, uint64 seed) noexcept
+{
+    constexpr uint64 m = 0xc6a4a7935bd1e995ull;
+    constexpr int r = 47;
+
+    auto* p = static_cast<const uint8*> (data);
+    auto h = seed ^ ((uint64) size * m);
+
+    for (auto* end = p + (size & ~(size_t) 7); p != end; p += 8)
+    {
+        uint64 k;
+        std::memcpy (&k, p, sizeof (k));
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    if (const auto remaining = size & 7)
+    {
+        for (size_t i = remaining; i > 0; --i)
+            h ^= (uint64) p[i - 1] << (8 * (i - 1));
+
+        h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+//==============================================================================
+size_t NativeMacClipboardPayload::LZ::getMaxCompressedSize (size_t sourceSize) noexcept
+{
+    return sourceSize + sourceSize / 255 + 16;
+}
+
+size_t NativeMacClipboardPayload::LZ::compress (const void* source, size_t sourceSize,
+                                                void* dest, size_t destCapacity) noexcept
+{
+    using namespace ClipboardPayloadHelpers;
+
+    auto* const base   = static_cast<const uint8*> (source);
+    auto* const end    = base + sourceSize;
+    auto* const outBase = static_cast<uint8*> (dest);
+    auto* const outEnd = outBase + destCapacity;
+
+    auto* ip     = base;
+    auto* anchor = base;
+    auto* op     = outBase;
+
+    auto emitSequence = [&] (size_t numLiterals, size_t offset, size_t matchLength) -> bool
+    {
+        if ((size_t) (outEnd - op) < getSequenceSizeBound (numLiterals, matchLength))
+            return false;
+
+        auto* token = op++;
+        *token = (uint8) ((jmin (numLiterals, (size_t) 15) << 4) | jmin (matchLength, (size_t) 15));
+
+        if (numLiterals >= 15)
+            op = writeExtendedLength (op, numLiterals - 15);
+
+        std::memcpy (op, anchor, numLiterals);
+        op += numLiterals;
+
+        writeLE16 (op, (uint16) offset);
+        op += 2;
+
+        if (matchLength >= 15)
+            op = writeExtendedLength (op, matchLength - 15);
+
+        return true;
+    };
+
+    if (sourceSize > matchLimit)
+    {
+        uint32 hashTable[1 << hashLog] = {};
+
+        auto* const searchLimit = end - matchLimit;
+        auto* const matchEnd    = end - lastLiterals;
+
+        hashTable[hashSequence (read32 (ip))] = 0;
+        ++ip;
+
+        size_t searchCount = 0;
+
+        while (ip <= searchLimit)
+        {
+            const auto sequence = read32 (ip);
+            auto& slot = hashTable[hashSequence (sequence)];
+            auto* ref = base + slot;
+            slot = (uint32) (ip - base);
+
+            if (ref >= ip || (size_t) (ip - ref) > maxOffset || read32 (ref) != sequence)
+            {
+                // Skip ahead faster through incompressible data
+                ip += 1 + (searchCount++ >> 6);
+                continue;
+            }
+
+            searchCount = 0;
+
+            while (ip > anchor && ref > base && ip[-1] == ref[-1])
+            {
+                --ip;
+                --ref;
+            }
+
+            auto* matchPos = ip + minMatch;
+            auto* refPos   = ref + minMatch;
+
+            while (matchPos < matchEnd && *matchPos == *refPos)
+            {
+                ++matchPos;
+                ++refPos;
+            }
+
+            if (! emitSequence ((size_t) (ip - anchor), (size_t) (ip - ref), (size_t) (matchPos - ip) - minMatch))
+                return 0;
+
+            ip = anchor = matchPos;
+
+            if (ip <= searchLimit)
+                hashTable[hashSequence (read32 (ip - 2))] = (uint32) (ip - 2 - base);
+        }
+    }
+
+    // Final literal run, which has no match part
+    const auto numLiterals = (size_t) (end - anchor);
+
+    if ((size_t) (outEnd - op) < 1 + numLiterals / 255 + 1 + numLiterals)
+        return 0;
+
+    *op++ = (uint8) (jmin (numLiterals, (size_t) 15) << 4);
+
+    if (numLiterals >= 15)
+        op = writeExtendedLength (op, numLiterals - 15);
+
+    if (numLiterals > 0)
+        std::memcpy (op, anchor, numLiterals);
+
+    op += numLiterals;
+    return (size_t) (op - outBase);
+}
+
+juce::int64 NativeMacClipboardPayload::LZ::decompress (const void* source, size_t sourceSize,
+                                                       void* dest, size_t destCapacity) noexcept
+{
+    using namespace ClipboardPayloadHelpers;
+
+    auto* ip          = static_cast<const uint8*> (source);
+    auto* const ipEnd = ip + sourceSize;
+    auto* const outBase = static_cast<uint8*> (dest);
+    auto* op          = outBase;
+    auto* const opEnd = outBase + destCapacity;
+
+    if (sourceSize == 0)
+        return -1;
+
+    for (;;)
+    {
+        if (ip >= ipEnd)
+            return -1;
+
+        const auto token = *ip++;
+        size_t numLiterals = token >> 4;
+
+        if (numLiterals == 15 && ! readExtendedLength (ip, ipEnd, numLiterals))
+            return -1;
+
+        if (numLiterals > (size_t) (ipEnd - ip) || numLiterals > (size_t) (opEnd - op))
+            return -1;
+
+        if (numLiterals > 0)
+            std::memcpy (op, ip, numLiterals);
+
+        op += numLiterals;
+        ip += numLiterals;
+
+        // The last sequence ends after its literals
+        if (ip == ipEnd)
+            break;
+
+        if (ipEnd - ip < 2)
+            return -1;
+
+        const size_t offset = readLE16 (ip);
+        ip += 2;
+
+        if (offset == 0 || offset > (size_t) (op - outBase))
+            return -1;
+
+        size_t matchLength = token & 15;
+
+        if (matchLength == 15 && ! readExtendedLength (ip, ipEnd, matchLength))
+            return -1;
+
+        matchLength += minMatch;
+
+        if (matchLength > (size_t) (opEnd - op))
+            return -1;
+
+        auto* match = op - offset;
+
+        if (offset >= matchLength)
+        {
+            std::memcpy (op, match, matchLength);
+            op += matchLength;
+        }
+        else
+        {
+            // Overlapping copy - repeats the last 'offset' bytes
+            for (size_t i = 0; i < matchLength; ++i)
+                *op++ = *match++;
+        }
+    }
+
+    return (juce::int64) (op - outBase);
+}
+
+juce::int64 NativeMacClipboardPayload::LZ::getDecompressedSize (const void* source, size_t sourceSize) noexcept
+{
+    using namespace ClipboardPayloadHelpers;
+
+    // The same checks as decompress(), with the output only counted
+    auto* ip          = static_cast<const uint8*> (source);
+    auto* const ipEnd = ip + sourceSize;
+    size_t outputSize = 0;
+
+    if (sourceSize == 0)
+        return -1;
+
+    for (;;)
+    {
+        if (ip >= ipEnd)
+            return -1;
+
+        const auto token = *ip++;
+        size_t numLiterals = token >> 4;
+
+        if (numLiterals == 15 && ! readExtendedLength (ip, ipEnd, numLiterals))
+            return -1;
+
+        if (numLiterals > (size_t) (ipEnd - ip))
+            return -1;
+
+        outputSize += numLiterals;
+        ip += numLiterals;
+
+        if (ip == ipEnd)
+            break;
+
+        if (ipEnd - ip < 2)
+            return -1;
+
+        const size_t offset = readLE16 (ip);
+        ip += 2;
+
+        if (offset == 0 || offset > outputSize)
+            return -1;
+
+        size_t matchLength = token & 15;
+
+        if (matchLength == 15 && ! readExtendedLength (ip, ipEnd, matchLength))
+            return -1;
+
+        matchLength += minMatch;
+
+        if (matchLength > (size_t) std::numeric_limits<juce::int64>::max() - outputSize)
+            return -1;
+
+        outputSize += matchLength;
+    }
+
+    return (juce::int64) outputSize;
+}
+
+//==============================================================================
+bool NativeMacClipboardPayload::encode (const void* data, size_t size,
+                                        juce::MemoryBlock& dest,
+                                        Compression compression)
+{
+    JUCE_NATIVE_MACOS_TRACE ("clipboard", "encodePayload");
+
+    using namespace ClipboardPayloadHelpers;
+
+    if (size > (size_t) std::numeric_limits<uint32>::max() - LZ::getMaxCompressedSize (0))
+        return false;
+
+    jassert (data != nullptr || size == 0);
+
+    uint8 codec = codecStored;
+    size_t encodedSize = size;
+
+    if (compression == Compression::lz && size > 0)
+    {
+        dest.setSize (headerSize + LZ::getMaxCompressedSize (size), false);
+        auto* payload = static_cast<uint8*> (dest.getData()) + headerSize;
+
+        const auto compressedSize = LZ::compress (data, size, payload, dest.getSize() - headerSize);
+
+        if (compressedSize > 0 && compressedSize < size)
+        {
+            codec = codecLZ;
+            encodedSize = compressedSize;
+        }
+    }
+
+    dest.setSize (headerSize + encodedSize, false);
+    auto* p = static_cast<uint8*> (dest.getData());
+
+    if (codec == codecStored && size > 0)
+        std::memcpy (p + headerSize, data, size);
+
+    writeLE32 (p, magic);
+    p[4] = currentVersion;
+    p[5] = codec;
+    writeLE16 (p + 6, (uint16) headerSize);
+    writeLE64 (p + 8, (uint64) size);
+    writeLE32 (p + 16, (uint32) encodedSize);
+    writeLE32 (p + 20, Checksum::crc32c (data, size));
+
+    return true;
+}
+
+bool NativeMacClipboardPayload::isEncodedPayload (const void* data, size_t size) noexcept
+{
+    ClipboardPayloadHelpers::Header header;
+    return ClipboardPayloadHelpers::parseHeader (data, size, header);
+}
+
+juce::int64 NativeMacClipboardPayload::getDecodedSize (const void* data, size_t size) noexcept
+{
+    ClipboardPayloadHelpers::Header header;
+
+    if (! ClipboardPayloadHelpers::parseHeader (data, size, header))
+        return -1;
+
+    return (juce::int64) header.decodedSize;
+}
+
+juce::int64 NativeMacClipboardPayload::getValidatedDecodedSize (const void* data, size_t size) noexcept
+{
+    using namespace ClipboardPayloadHelpers;
+
+    Header header;
+
+    if (! parseHeader (data, size, header))
+        return -1;
+
+    // Stored data is as large as the frame itself, but a compressed block's size has to be counted
+    if (header.codec == codecLZ
+         && LZ::getDecompressedSize (static_cast<const uint8*> (data) + header.headerSize, header.encodedSize)
+              != (juce::int64) header.decodedSize)
+        return -1;
+
+    return (juce::int64) header.decodedSize;
+}
+
+juce::int64 NativeMacClipboardPayload::decode (const void* data, size_t size,
+                                               void* destBuffer, size_t bufferSize) noexcept
+{
+    JUCE_NATIVE_MACOS_TRACE ("clipboard", "decodePayload");
+
+    using namespace ClipboardPayloadHelpers;
+
+    Header header;
+
+    if (! parseHeader (data, size, header) || header.decodedSize > bufferSize)
+        return -1;
+
+    auto* payload = static_cast<const uint8*> (data) + header.headerSize;
+    const auto decodedSize = (size_t) header.decodedSize;
+
+    if (header.codec == codecLZ)
+    {
+        if (LZ::decompress (payload, header.encodedSize, destBuffer, decodedSize) != (juce::int64) decodedSize)
+            return -1;
+    }
+    else if (decodedSize > 0)
+    {
+        std::memcpy (destBuffer, payload, decodedSize);
+    }
+
+    if (Checksum::crc32c (destBuffer, decodedSize) != header.crc)
+        return -1;
+
+    return (juce::int64) decodedSize;
+}
+
+bool NativeMacClipboardPayload::decode (const void* data, size_t size, juce::MemoryBlock& dest)
+{
+    const auto decodedSize = getValidatedDecodedSize (data, size);
+
+    if (decodedSize < 0)
+        return false;
+
+    juce::MemoryBlock decoded ((size_t) decodedSize, false);
+
+    if (decode (data, size, decoded.getData(), decoded.getSize()) != decodedSize)
+        return false;
+
+    dest.swapWith (decoded);
+    return true;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacClipboardPayloadTests  : public juce::UnitTest
+{
+public:
+    NativeMacClipboardPayloadTests()
+        : juce::UnitTest ("NativeMacClipboardPayload", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        beginTest ("Checksum");
+        {
+            expectEquals (Checksum::crc32c ("123456789", 9), (uint32) 0xe3069283);
+            expectEquals (Checksum::crc32cSoftware ("123456789", 9), (uint32) 0xe3069283);
+
+            for (int i = 0; i < 50; ++i)
+            {
+                const auto data = createData (random, random.nextInt (5000));
+                expectEquals (Checksum::crc32c (data.getData(), data.getSize()),
+                              Checksum::crc32cSoftware (data.getData(), data.getSize()));
+            }
+        }
+
+        beginTest ("Round trip");
+        {
+            for (auto compression : { Compression::none, Compression::lz })
+            {
+                for (int i = 0; i < 300; ++i)
+                {
+                    const auto data = createData (random, i < 40 ? i : random.nextInt (20000));
+
+                    juce::MemoryBlock encoded, decoded;
+                    expect (Payload::encode (data.getData(), data.getSize(), encoded, compression));
+                    expect (Payload::isEncodedPayload (encoded.getData(), encoded.getSize()));
+                    expectEquals (Payload::getDecodedSize (encoded.getData(), encoded.getSize()), (juce::int64) data.getSize());
+                    expect (Payload::decode (encoded.getData(), encoded.getSize(), decoded));
+                    expect (decoded == data);
+
+                    if (compression == Compression::none)
+                        expectEquals (encoded.getSize(), data.getSize() + Payload::headerSize);
+                    else
+                        expectLessOrEqual (encoded.getSize(), data.getSize() + Payload::headerSize);
+                }
+            }
+        }
+
+        beginTest ("Compressible data shrinks");
+        {
+            juce::MemoryBlock data (64 * 1024, true), encoded;
+            expect (Payload::encode (data.getData(), data.getSize(), encoded));
+            expectLessThan (encoded.getSize(), data.getSize() / 10);
+        }
+
+        beginTest ("Corrupted payloads never decode to different data");
+        {
+            for (int i = 0; i < 300; ++i)
+            {
+                const auto data = createData (random, 1 + random.nextInt (5000));
+
+                juce::MemoryBlock encoded, decoded;
+                Payload::encode (data.getData(), data.getSize(), encoded, random.nextBool() ? Compression::lz : Compression::none);
+
+                auto corrupted = encoded;
+                const auto index = (size_t) random.nextInt ((int) corrupted.getSize());
+                corrupted[index] = (char) (corrupted[index] ^ (1 + random.nextInt (255)));
+
+                // A changed match offset in repetitive data can still produce the
+                // same bytes, so the guarantee is never returning different data
+                if (Payload::decode (corrupted.getData(), corrupted.getSize(), decoded))
+                    expect (decoded == data);
+            }
+        }
+
+        beginTest ("Truncated payloads are rejected");
+        {
+            const auto data = createData (random, 3000);
+
+            juce::MemoryBlock encoded, decoded;
+            Payload::encode (data.getData(), data.getSize(), encoded);
+
+            for (size_t size = 0; size < encoded.getSize(); size += 1 + (size_t) random.nextInt (40))
+            {
+                expect (! Payload::decode (encoded.getData(), size, decoded));
+                expectEquals (Payload::decode (encoded.getData(), size, decoded.getData(), decoded.getSize()), (juce::int64) -1);
+            }
+        }
+
+        beginTest ("Random input is rejected");
+        {
+            juce::MemoryBlock output (4096);
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                const auto junk = createData (random, random.nextInt (300));
+                juce::MemoryBlock decoded;
+
+                expect (! Payload::decode (junk.getData(), junk.getSize(), decoded));
+
+                // Only checks that the raw codec stays in bounds, as random
+                // input can also be a valid LZ block
+                const auto numDecoded = Payload::LZ::decompress (junk.getData(), junk.getSize(), output.getData(), output.getSize());
+                expectLessOrEqual (numDecoded, (juce::int64) output.getSize());
+            }
+        }
+
+        beginTest ("Decompressed size");
+        {
+            for (int i = 0; i < 200; ++i)
+            {
+                const auto data = createData (random, 1 + random.nextInt (20000));
+                juce::MemoryBlock compressed (Payload::LZ::getMaxCompressedSize (data.getSize()));
+
+                const auto compressedSize = Payload::LZ::compress (data.getData(), data.getSize(),
+                                                                   compressed.getData(), compressed.getSize());
+                expectGreaterThan (compressedSize, (size_t) 0);
+                expectEquals (Payload::LZ::getDecompressedSize (compressed.getData(), compressedSize), (juce::int64) data.getSize());
+
+                // Agrees with decompress() on truncated blocks too
+                const auto truncatedSize = (size_t) random.nextInt ((int) compressedSize);
+                juce::MemoryBlock output (data.getSize());
+
+                expectEquals (Payload::LZ::getDecompressedSize (compressed.getData(), truncatedSize),
+                              Payload::LZ::decompress (compressed.getData(), truncatedSize, output.getData(), output.getSize()));
+            }
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                const auto junk = createData (random, random.nextInt (300));
+                juce::MemoryBlock output (1 << 20);
+
+                expectEquals (Payload::LZ::getDecompressedSize (junk.getData(), junk.getSize()),
+                              Payload::LZ::decompress (junk.getData(), junk.getSize(), output.getData(), output.getSize()));
+            }
+        }
+
+        beginTest ("Overstated sizes are caught before allocating");
+        {
+            juce::MemoryBlock data (10000, true), encoded;
+            Payload::encode (data.getData(), data.getSize(), encoded, Compression::lz);
+
+            const auto encodedSize = encoded.getSize() - Payload::headerSize;
+            expectEquals (Payload::getValidatedDecodedSize (encoded.getData(), encoded.getSize()), (juce::int64) data.getSize());
+
+            // Claims the most the header allows, 255 bytes per encoded byte
+            auto inflated = encoded;
+            ClipboardPayloadHelpers::writeLE64 (static_cast<uint8*> (inflated.getData()) + 8, (uint64) encodedSize * 255);
+
+            expectEquals (Payload::getDecodedSize (inflated.getData(), inflated.getSize()), (juce::int64) encodedSize * 255);
+            expectEquals (Payload::getValidatedDecodedSize (inflated.getData(), inflated.getSize()), (juce::int64) -1);
+
+            juce::MemoryBlock decoded;
+            expect (! Payload::decode (inflated.getData(), inflated.getSize(), decoded));
+
+            // Stored payloads can't overstate their size
+            Payload::encode (data.getData(), data.getSize(), encoded, Compression::none);
+            expectEquals (Payload::getValidatedDecodedSize (encoded.getData(), encoded.getSize()), (juce::int64) data.getSize());
+        }
+
+        beginTest ("Undersized destination buffer");
+        {
+            const auto data = createData (random, 1000);
+
+            juce::MemoryBlock encoded, tooSmall (999);
+            Payload::encode (data.getData(), data.getSize(), encoded);
+
+            expectEquals (Payload::decode (encoded.getData(), encoded.getSize(), tooSmall.getData(), tooSmall.getSize()), (juce::int64) -1);
+        }
+    }
+
+private:
+    // Mixes incompressible, repetitive and run-length data, so both the
+    // stored and compressed paths are exercised
+    static juce::MemoryBlock createData (juce::Random& random, int size)
+    {
+        juce::MemoryBlock data ((size_t) size);
+        const auto kind = random.nextInt (3);
+
+        for (int i = 0; i < size; ++i)
+            data[(size_t) i] = (char) (kind == 0 ? random.nextInt (256)
+                                     : kind == 1 ? "abcabcxyz"[random.nextInt (9)]
+                                                 : i / 100);
+
+        return data;
+    }
+
+    using Payload     = NativeMacClipboardPayload;
+    using Checksum    = Payload::Checksum;
+    using Compression = Payload::Compression;
+};
+
+static NativeMacClipboardPayloadTests nativeMacClipboardPayloadTests;
+
+#endif
+
+} // namespace juce
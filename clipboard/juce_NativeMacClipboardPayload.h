@@ -0,0 +1,164 @@
+/*******************************************************************************
+ Framed clipboard payload format
+
+ Optional framing used by NativeMacPasteboard for custom UTIs: a small
+ versioned header, an LZ-family block codec and a CRC32C checksum.
+ This code is platform independent.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Encodes and decodes the framed payload format used by NativeMacPasteboard.
+
+    A framed payload is a 24-byte little-endian header followed by the
+    (optionally compressed) data:
+
+    | Offset | Size | Field                                      |
+    |--------|------|--------------------------------------------|
+    | 0      | 4    | Magic "JNCP"                               |
+    | 4      | 1    | Format version                             |
+    | 5      | 1    | Codec (0 = stored, 1 = LZ)                 |
+    | 6      | 2    | Header size in bytes                       |
+    | 8      | 8    | Decoded size                               |
+    | 16     | 4    | Encoded size (bytes following the header)  |
+    | 20     | 4    | CRC32C of the decoded data                 |
+
+    Use isEncodedPayload() as a cheap O(1) check before attempting to decode
+    data that may have come from another application.
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacClipboardPayload
+{
+public:
+    //==============================================================================
+    /** How the payload data is stored inside the frame. */
+    enum class Compression
+    {
+        none,   /**< Data is stored as-is, only the header and checksum are added. */
+        lz      /**< Data is LZ compressed, falling back to stored if it doesn't shrink. */
+    };
+
+    static constexpr uint32 magic          = 0x50434e4a;   // "JNCP" in little-endian order
+    static constexpr uint8  currentVersion = 1;
+    static constexpr size_t headerSize     = 24;
+
+    //==============================================================================
+    /** Encodes data into a framed payload.
+
+        @param data         The data to encode
+        @param size         Size of the data in bytes
+        @param dest         Receives the framed payload (its previous contents are replaced)
+        @param compression  Whether to try compressing the data
+        @returns true on success, false if the data is too large to frame
+    */
+    static bool encode (const void* data, size_t size,
+                        juce::MemoryBlock& dest,
+                        Compression compression = Compression::lz);
+
+    /** Returns true if the data starts with a well-formed frame header.
+
+        This only looks at the header, so it runs in constant time and is
+        suitable as a fast-reject test for foreign clipboard data. The
+        checksum is verified by decode().
+    */
+    static bool isEncodedPayload (const void* data, size_t size) noexcept;
+
+    /** Returns the decoded size of a framed payload, or -1 if the header is invalid. */
+    static juce::int64 getDecodedSize (const void* data, size_t size) noexcept;
+
+    /** Returns the decoded size of a framed payload, once the encoded data has been
+        checked to really produce that many bytes, or -1 if the payload is malformed.
+
+        getDecodedSize() only reads the header. This also walks compressed data,
+        without allocating, so a header that overstates the size is caught before a
+        buffer is grown for it. The checksum can still only be verified by decode().
+    */
+    static juce::int64 getValidatedDecodedSize (const void* data, size_t size) noexcept;
+
+    /** Decodes a framed payload into a caller-supplied buffer.
+
+        @param data         The framed payload
+        @param size         Size of the framed payload in bytes
+        @param destBuffer   Buffer that will receive the decoded data
+        @param bufferSize   Capacity of destBuffer, which must be at least getDecodedSize()
+        @returns the number of decoded bytes, or -1 if the payload is malformed,
+                 fails its checksum or doesn't fit
+    */
+    static juce::int64 decode (const void* data, size_t size,
+                               void* destBuffer, size_t bufferSize) noexcept;
+
+    /** Decodes a framed payload into a MemoryBlock.
+
+        @returns true if the payload was valid and dest now holds the decoded data
+    */
+    static bool decode (const void* data, size_t size, juce::MemoryBlock& dest);
+
+    //==============================================================================
+    /** The LZ block codec used for compressed payloads.
+
+        A byte-oriented LZ77 format in the style of LZ4: a token byte holding the
+        literal and match lengths, the literals, then a 16-bit match offset. The
+        decompressor is fully bounds-checked and safe to run on untrusted input.
+    */
+    struct LZ
+    {
+        /** Returns the worst-case compressed size for a given input size. */
+        static size_t getMaxCompressedSize (size_t sourceSize) noexcept;
+
+        /** Compresses a block.
+
+            @returns the compressed size, or 0 if it doesn't fit in destCapacity
+        */
+        static size_t compress (const void* source, size_t sourceSize,
+                                void* dest, size_t destCapacity) noexcept;
+
+        /** Decompresses a block.
+
+            @returns the decompressed size, or -1 if the input is malformed or
+                     the output doesn't fit in destCapacity
+        */
+        static juce::int64 decompress (const void* source, size_t sourceSize,
+                                       void* dest, size_t destCapacity) noexcept;
+
+        /** Returns the size a block decompresses to, by walking its sequences
+            without writing any output, or -1 if the input is malformed.
+        */
+        static juce::int64 getDecompressedSize (const void* source, size_t sourceSize) noexcept;
+    };
+
+    //==============================================================================
+    /** CRC32C (Castagnoli) checksum.
+
+        Uses the SSE4.2 or ARMv8 CRC instructions when available, and a
+        slice-by-8 table implementation otherwise.
+    */
+    struct Checksum
+    {
+        /** Computes the CRC32C of a block, optionally continuing from a previous result. */
+        static uint32 crc32c (const void* data, size_t size, uint32 previousCrc = 0) noexcept;
+
+        /** The portable table-driven implementation, exposed for comparison. */
+        static uint32 crc32cSoftware (const void* data, size_t size, uint32 previousCrc = 0) noexcept;
+
+        /** Returns true if crc32c() uses a hardware instruction on this machine. */
+        static bool isHardwareAccelerated() noexcept;
+
+        /** Computes a fast 64-bit non-cryptographic hash (MurmurHash64A) of a block.
+
+            Used to recognise identical payloads without keeping a copy of them.
+        */
+        static uint64 hash64 (const void* data, size_t size, uint64 seed = 0) noexcept;
+    };
+
+private:
+    NativeMacClipboardPayload() = delete;
+    JUCE_DECLARE_NON_COPYABLE (NativeMacClipboardPayload)
+};
+
+} // namespace juce
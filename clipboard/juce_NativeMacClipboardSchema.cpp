@@ -0,0 +1,478 @@
+/*******************************************************************************
+ Versioned clipboard schema container - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+bool NativeMacClipboardSchema::isSchemaPayload (const void* data, size_t size) noexcept
+{
+    using namespace ClipboardPayloadHelpers;
+
+    if (data == nullptr || size < headerSize)
+        return false;
+
+    auto* p = static_cast<const uint8*> (data);
+    return readLE32 (p) == magic && p[4] == currentVersion;
+}
+
+//==============================================================================
+NativeMacClipboardSchema::Writer::Writer (uint32 version)
+    : schemaVersion (version)
+{
+}
+
+void NativeMacClipboardSchema::Writer::setSection (uint32 sectionID, const void* data, size_t size)
+{
+    sections[sectionID].replaceAll (data, size);
+}
+
+void NativeMacClipboardSchema::Writer::setString (uint32 sectionID, const juce::String& value)
+{
+    setSection (sectionID, value.toRawUTF8(), value.getNumBytesAsUTF8());
+}
+
+void NativeMacClipboardSchema::Writer::setInt64 (uint32 sectionID, juce::int64 value)
+{
+    uint8 bytes[8];
+    ClipboardPayloadHelpers::writeLE64 (bytes, (uint64) value);
+    setSection (sectionID, bytes, sizeof (bytes));
+}
+
+void NativeMacClipboardSchema::Writer::setDouble (uint32 sectionID, double value)
+{
+    uint64 bits;
+    static_assert (sizeof (bits) == sizeof (value), "unexpected double size");
+    std::memcpy (&bits, &value, sizeof (bits));
+    setInt64 (sectionID, (juce::int64) bits);
+}
+
+void NativeMacClipboardSchema::Writer::removeSection (uint32 sectionID)
+{
+    sections.erase (sectionID);
+}
+
+size_t NativeMacClipboardSchema::Writer::getTotalSize() const noexcept
+{
+    auto total = headerSize + sections.size() * entrySize;
+
+    for (auto& section : sections)
+        total += section.second.getSize();
+
+    return total;
+}
+
+bool NativeMacClipboardSchema::Writer::writeTo (juce::MemoryBlock& dest) const
+{
+    using namespace ClipboardPayloadHelpers;
+
+    const auto totalSize = getTotalSize();
+
+    if (sections.size() > (size_t) maxSections || (uint64) totalSize > 0xffffffffu)
+        return false;
+
+    dest.setSize (totalSize, false);
+    auto* const base = static_cast<uint8*> (dest.getData());
+
+    writeLE32 (base, magic);
+    base[4] = currentVersion;
+    base[5] = 0;
+    writeLE16 (base + 6, (uint16) headerSize);
+    writeLE32 (base + 8, schemaVersion);
+    writeLE32 (base + 12, (uint32) sections.size());
+    writeLE32 (base + 16, (uint32) totalSize);
+
+    auto* entry = base + headerSize;
+    auto offset = headerSize + sections.size() * entrySize;
+
+    for (auto& section : sections)
+    {
+        const auto size = section.second.getSize();
+
+        writeLE32 (entry, section.first);
+        writeLE32 (entry + 4, (uint32) offset);
+        writeLE32 (entry + 8, (uint32) size);
+        writeLE32 (entry + 12, NativeMacClipboardPayload::Checksum::crc32c (section.second.getData(), size));
+
+        if (size > 0)
+            std::memcpy (base + offset, section.second.getData(), size);
+
+        entry += entrySize;
+        offset += size;
+    }
+
+    const auto tableCrc = NativeMacClipboardPayload::Checksum::crc32c (base + headerSize, sections.size() * entrySize,
+                                                                      NativeMacClipboardPayload::Checksum::crc32c (base, 20));
+    writeLE32 (base + 20, tableCrc);
+    return true;
+}
+
+//==============================================================================
+NativeMacClipboardSchema::Reader::Reader (const void* data, size_t size) noexcept
+{
+    using namespace ClipboardPayloadHelpers;
+
+    if (! isSchemaPayload (data, size))
+        return;
+
+    auto* p = static_cast<const uint8*> (data);
+
+    const size_t headerBytes = readLE16 (p + 6);
+    const auto sectionCount  = readLE32 (p + 12);
+    const size_t declaredSize = readLE32 (p + 16);
+
+    // Everything is checked against the declared size, which may be less than the buffer
+    if (headerBytes < headerSize || sectionCount > (uint32) maxSections || declaredSize > size)
+        return;
+
+    const auto tableSize = (size_t) sectionCount * entrySize;
+    const auto dataStart = headerBytes + tableSize;
+
+    if (dataStart > declaredSize)
+        return;
+
+    const auto tableCrc = NativeMacClipboardPayload::Checksum::crc32c (p + headerBytes, tableSize,
+                                                                      NativeMacClipboardPayload::Checksum::crc32c (p, 20));
+
+    if (tableCrc != readLE32 (p + 20))
+        return;
+
+    // The table is intact, but may still have been written by a broken encoder
+    for (uint32 i = 0; i < sectionCount; ++i)
+    {
+        auto* entry = p + headerBytes + i * entrySize;
+        const uint64 offset = readLE32 (entry + 4);
+        const uint64 sectionSize = readLE32 (entry + 8);
+
+        if (offset < dataStart || offset + sectionSize > declaredSize)
+            return;
+
+        if (i > 0 && readLE32 (entry) <= readLE32 (entry - entrySize))
+            return;
+    }
+
+    base = p;
+    table = p + headerBytes;
+    schemaVersion = readLE32 (p + 8);
+    numSections = sectionCount;
+    totalSize = declaredSize;
+}
+
+uint32 NativeMacClipboardSchema::Reader::getSectionID (int index) const noexcept
+{
+    if (! isPositiveAndBelow (index, (int) numSections))
+        return 0;
+
+    return ClipboardPayloadHelpers::readLE32 (table + (size_t) index * entrySize);
+}
+
+const uint8* NativeMacClipboardSchema::Reader::findEntry (uint32 sectionID) const noexcept
+{
+    // The table is sorted, so this is a binary search over at most maxSections entries
+    uint32 low = 0, high = numSections;
+
+    while (low < high)
+    {
+        const auto mid = (low + high) / 2;
+        auto* entry = table + (size_t) mid * entrySize;
+        const auto id = ClipboardPayloadHelpers::readLE32 (entry);
+
+        if (id == sectionID)
+            return entry;
+
+        if (id < sectionID)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return nullptr;
+}
+
+bool NativeMacClipboardSchema::Reader::readEntry (const uint8* entry, const void*& data, size_t& size) const noexcept
+{
+    using namespace ClipboardPayloadHelpers;
+
+    auto* sectionData = base + readLE32 (entry + 4);
+    const size_t sectionSize = readLE32 (entry + 8);
+
+    if (NativeMacClipboardPayload::Checksum::crc32c (sectionData, sectionSize) != readLE32 (entry + 12))
+        return false;
+
+    data = sectionData;
+    size = sectionSize;
+    return true;
+}
+
+bool NativeMacClipboardSchema::Reader::hasSection (uint32 sectionID) const noexcept
+{
+    return isValid() && findEntry (sectionID) != nullptr;
+}
+
+bool NativeMacClipboardSchema::Reader::getSection (uint32 sectionID, const void*& data, size_t& size) const noexcept
+{
+    if (! isValid())
+        return false;
+
+    auto* entry = findEntry (sectionID);
+    return entry != nullptr && readEntry (entry, data, size);
+}
+
+juce::String NativeMacClipboardSchema::Reader::getString (uint32 sectionID, const juce::String& defaultValue) const
+{
+    const void* data;
+    size_t size;
+
+    if (! getSection (sectionID, data, size))
+        return defaultValue;
+
+    return juce::String::fromUTF8 (static_cast<const char*> (data), (int) size);
+}
+
+juce::int64 NativeMacClipboardSchema::Reader::getInt64 (uint32 sectionID, juce::int64 defaultValue) const noexcept
+{
+    const void* data;
+    size_t size;
+
+    if (! getSection (sectionID, data, size) || size != 8)
+        return defaultValue;
+
+    return (juce::int64) ClipboardPayloadHelpers::readLE64 (static_cast<const uint8*> (data));
+}
+
+double NativeMacClipboardSchema::Reader::getDouble (uint32 sectionID, double defaultValue) const noexcept
+{
+    const void* data;
+    size_t size;
+
+    if (! getSection (sectionID, data, size) || size != 8)
+        return defaultValue;
+
+    const auto bits = ClipboardPayloadHelpers::readLE64 (static_cast<const uint8*> (data));
+
+    double value;
+    std::memcpy (&value, &bits, sizeof (value));
+    return value;
+}
+
+bool NativeMacClipboardSchema::Reader::verifyAllSections() const noexcept
+{
+    if (! isValid())
+        return false;
+
+    for (uint32 i = 0; i < numSections; ++i)
+    {
+        const void* data;
+        size_t size;
+
+        if (! readEntry (table + (size_t) i * entrySize, data, size))
+            return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacClipboardSchemaTests  : public juce::UnitTest
+{
+public:
+    NativeMacClipboardSchemaTests()
+        : juce::UnitTest ("NativeMacClipboardSchema", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        using Schema = NativeMacClipboardSchema;
+
+        auto random = getRandom();
+
+        beginTest ("Typed sections");
+        {
+            Schema::Writer writer (7);
+            writer.setString (Schema::makeSectionID ("name"), juce::CharPointer_UTF8 ("Warm Pad \xc3\xa9\xe2\x82\xac"));
+            writer.setInt64 (Schema::makeSectionID ("prog"), -1234567890123LL);
+            writer.setDouble (Schema::makeSectionID ("gain"), 0.75);
+            writer.setString (Schema::makeSectionID ("tmp "), "removed");
+            writer.removeSection (Schema::makeSectionID ("tmp "));
+
+            juce::MemoryBlock container;
+            expect (writer.writeTo (container));
+            expectEquals (container.getSize(), writer.getTotalSize());
+            expect (Schema::isSchemaPayload (container.getData(), container.getSize()));
+
+            // Unused bytes after the container are allowed
+            container.append ("junk", 4);
+
+            Schema::Reader reader (container.getData(), container.getSize());
+            expect (reader.isValid());
+            expectEquals (reader.getSchemaVersion(), (uint32) 7);
+            expectEquals (reader.getNumSections(), 3);
+            expectEquals (reader.getTotalSize(), writer.getTotalSize());
+
+            expectEquals (reader.getString (Schema::makeSectionID ("name")), juce::String (juce::CharPointer_UTF8 ("Warm Pad \xc3\xa9\xe2\x82\xac")));
+            expectEquals (reader.getInt64 (Schema::makeSectionID ("prog")), (juce::int64) -1234567890123LL);
+            expectEquals (reader.getDouble (Schema::makeSectionID ("gain")), 0.75);
+
+            expect (! reader.hasSection (Schema::makeSectionID ("tmp ")));
+            expectEquals (reader.getString (Schema::makeSectionID ("tmp "), "default"), juce::String ("default"));
+            expectEquals (reader.getInt64 (Schema::makeSectionID ("name"), 42), (juce::int64) 42);
+            expect (reader.verifyAllSections());
+        }
+
+        beginTest ("Round trip");
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                const auto sections = createSections (random);
+                const auto container = write (sections);
+
+                Schema::Reader reader (container.getData(), container.getSize());
+                expect (reader.isValid());
+                expectEquals (reader.getNumSections(), (int) sections.size());
+                expect (reader.verifyAllSections());
+
+                int index = 0;
+
+                for (auto& section : sections)
+                {
+                    expectEquals (reader.getSectionID (index++), section.first);
+                    expect (sectionEquals (reader, section.first, section.second));
+                }
+            }
+        }
+
+        beginTest ("Section limit");
+        {
+            Schema::Writer writer (1);
+
+            for (uint32 id = 0; id < (uint32) Schema::maxSections; ++id)
+                writer.setInt64 (id, id);
+
+            juce::MemoryBlock container;
+            expect (writer.writeTo (container));
+
+            writer.setInt64 ((uint32) Schema::maxSections, 0);
+            expect (! writer.writeTo (container));
+        }
+
+        beginTest ("Truncated containers are rejected");
+        {
+            const auto container = write (createSections (random));
+
+            for (size_t size = 0; size < container.getSize(); ++size)
+                expect (! Schema::Reader (container.getData(), size).isValid());
+        }
+
+        beginTest ("Corrupted containers never return different data");
+        {
+            for (int i = 0; i < 500; ++i)
+            {
+                const auto sections = createSections (random);
+                auto container = write (sections);
+
+                const auto numFlips = 1 + random.nextInt (3);
+
+                for (int flip = 0; flip < numFlips; ++flip)
+                {
+                    const auto index = (size_t) random.nextInt ((int) container.getSize());
+                    container[index] = (char) (container[index] ^ (1 + random.nextInt (255)));
+                }
+
+                Schema::Reader reader (container.getData(), container.getSize());
+
+                if (! reader.isValid())
+                    continue;
+
+                bool allIntact = true;
+
+                for (auto& section : sections)
+                {
+                    const void* data = nullptr;
+                    size_t size = 0;
+
+                    if (reader.getSection (section.first, data, size))
+                        expect (juce::MemoryBlock (data, size) == section.second);
+                    else
+                        allIntact = false;
+                }
+
+                if (reader.verifyAllSections())
+                    expect (allIntact);
+            }
+        }
+
+        beginTest ("Random input is rejected");
+        {
+            for (int i = 0; i < 2000; ++i)
+            {
+                juce::MemoryBlock junk ((size_t) random.nextInt (200));
+
+                for (size_t j = 0; j < junk.getSize(); ++j)
+                    junk[j] = (char) random.nextInt (256);
+
+                // Starting with a real header makes the reader look further
+                if (junk.getSize() >= 5 && random.nextBool())
+                {
+                    ClipboardPayloadHelpers::writeLE32 (static_cast<uint8*> (junk.getData()), Schema::magic);
+                    junk[4] = (char) Schema::currentVersion;
+                }
+
+                expect (! Schema::Reader (junk.getData(), junk.getSize()).isValid());
+            }
+        }
+    }
+
+private:
+    using Sections = std::map<uint32, juce::MemoryBlock>;
+
+    static Sections createSections (juce::Random& random)
+    {
+        Sections sections;
+        const auto numSections = random.nextInt (10);
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            juce::MemoryBlock data ((size_t) random.nextInt (random.nextBool() ? 16 : 2000));
+
+            for (size_t j = 0; j < data.getSize(); ++j)
+                data[j] = (char) random.nextInt (256);
+
+            sections[(uint32) random.nextInt()] = std::move (data);
+        }
+
+        return sections;
+    }
+
+    static juce::MemoryBlock write (const Sections& sections)
+    {
+        NativeMacClipboardSchema::Writer writer ((uint32) sections.size());
+
+        for (auto& section : sections)
+            writer.setSection (section.first, section.second.getData(), section.second.getSize());
+
+        juce::MemoryBlock container;
+        writer.writeTo (container);
+        return container;
+    }
+
+    static bool sectionEquals (const NativeMacClipboardSchema::Reader& reader, uint32 sectionID, const juce::MemoryBlock& expected)
+    {
+        const void* data = nullptr;
+        size_t size = 0;
+
+        return reader.hasSection (sectionID)
+            && reader.getSection (sectionID, data, size)
+            && juce::MemoryBlock (data, size) == expected;
+    }
+};
+
+static NativeMacClipboardSchemaTests nativeMacClipboardSchemaTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,212 @@
+/*******************************************************************************
+ Versioned clipboard schema container
+
+ A small self-describing container for structured clipboard payloads: a
+ versioned header, a table of checksummed sections and the section data.
+ This code is platform independent.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Reads and writes the schema container format for structured clipboard data.
+
+    Instead of each paste handler parsing and validating its own byte layout,
+    data is stored as a set of sections, each identified by a 32-bit ID. A
+    reader validates the header and section table without touching the section
+    data, and then pulls out just the sections it needs - e.g. only the preset
+    name for a menu label - verifying the checksum of those sections alone.
+
+    All integers are little-endian. The container starts with a 24-byte header:
+
+    | Offset | Size | Field                                                 |
+    |--------|------|-------------------------------------------------------|
+    | 0      | 4    | Magic "JNCS"                                          |
+    | 4      | 1    | Container format version                              |
+    | 5      | 1    | Reserved (0)                                          |
+    | 6      | 2    | Header size in bytes (the section table follows)      |
+    | 8      | 4    | Schema version, chosen by the application             |
+    | 12     | 4    | Number of sections                                    |
+    | 16     | 4    | Total container size in bytes                         |
+    | 20     | 4    | CRC32C of header bytes 0-19 and the section table     |
+
+    followed by one 16-byte table entry per section, sorted by ID:
+
+    | Offset | Size | Field                                                 |
+    |--------|------|-------------------------------------------------------|
+    | 0      | 4    | Section ID                                            |
+    | 4      | 4    | Offset of the section data from the container start   |
+    | 8      | 4    | Section size in bytes                                 |
+    | 12     | 4    | CRC32C of the section data                            |
+
+    Readers ignore sections they don't know, so new sections can be added
+    without bumping the schema version; bump it when the meaning of an
+    existing section changes.
+
+    @code
+    enum : uint32
+    {
+        presetName  = NativeMacClipboardSchema::makeSectionID ("name"),
+        presetState = NativeMacClipboardSchema::makeSectionID ("stat")
+    };
+
+    NativeMacClipboardSchema::Writer writer (2);
+    writer.setString (presetName, preset.getName());
+    writer.setSection (presetState, state.getData(), state.getSize());
+
+    MemoryBlock container;
+    writer.writeTo (container);
+
+    // ... later, straight from the clipboard without copying
+    NativeMacPasteboard::visitClipboardData (uti, [&] (const void* data, size_t size)
+    {
+        NativeMacClipboardSchema::Reader reader (data, size);
+
+        if (reader.isValid() && reader.getSchemaVersion() <= 2)
+            label = reader.getString (presetName);
+    });
+    @endcode
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacClipboardSchema
+{
+public:
+    //==============================================================================
+    static constexpr uint32 magic          = 0x53434e4a;   // "JNCS" in little-endian order
+    static constexpr uint8  currentVersion = 1;
+    static constexpr size_t headerSize     = 24;
+    static constexpr size_t entrySize      = 16;
+    static constexpr int    maxSections    = 256;
+
+    /** Builds a section ID from four characters, e.g. makeSectionID ("name"). */
+    static constexpr uint32 makeSectionID (const char (&fourCC)[5]) noexcept
+    {
+        return (uint32) (uint8) fourCC[0]
+             | ((uint32) (uint8) fourCC[1] << 8)
+             | ((uint32) (uint8) fourCC[2] << 16)
+             | ((uint32) (uint8) fourCC[3] << 24);
+    }
+
+    /** Returns true if the data starts with the container magic and a supported version.
+
+        This is a constant-time fast-reject test; use Reader::isValid() for a full
+        check of the header and section table.
+    */
+    static bool isSchemaPayload (const void* data, size_t size) noexcept;
+
+    //==============================================================================
+    /** Collects sections and serialises them into a container. */
+    class JUCE_API  Writer
+    {
+    public:
+        /** Creates a writer for the given application-defined schema version. */
+        explicit Writer (uint32 schemaVersion);
+
+        /** Adds a section, replacing any existing section with the same ID. */
+        void setSection (uint32 sectionID, const void* data, size_t size);
+
+        /** Adds a section holding a UTF-8 string. */
+        void setString (uint32 sectionID, const juce::String& value);
+
+        /** Adds a section holding a 64-bit integer. */
+        void setInt64 (uint32 sectionID, juce::int64 value);
+
+        /** Adds a section holding a double. */
+        void setDouble (uint32 sectionID, double value);
+
+        /** Removes a section. */
+        void removeSection (uint32 sectionID);
+
+        /** Returns the size writeTo() would produce. */
+        size_t getTotalSize() const noexcept;
+
+        /** Serialises the container, replacing the previous contents of dest.
+
+            @returns false if there are more than maxSections sections or the
+                     container would exceed 4 GB
+        */
+        bool writeTo (juce::MemoryBlock& dest) const;
+
+    private:
+        uint32 schemaVersion;
+        std::map<uint32, juce::MemoryBlock> sections;   // ordered by ID, as the table requires
+
+        JUCE_DECLARE_NON_COPYABLE (Writer)
+    };
+
+    //==============================================================================
+    /**
+        A read-only view of a container.
+
+        The reader doesn't copy anything: it refers to the data passed to the
+        constructor, which must stay valid while the reader is used.
+
+        The constructor validates the header and the section table only, so its
+        cost doesn't depend on the size of the section data. Each section's
+        checksum is verified when that section is read.
+    */
+    class JUCE_API  Reader
+    {
+    public:
+        /** Creates a reader over a container. Check isValid() before using it. */
+        Reader (const void* data, size_t size) noexcept;
+
+        /** Returns true if the header and section table are well-formed and intact. */
+        bool isValid() const noexcept                { return table != nullptr; }
+
+        /** Returns the application-defined schema version. */
+        uint32 getSchemaVersion() const noexcept     { return schemaVersion; }
+
+        /** Returns the container size in bytes (the data may be followed by unused bytes). */
+        size_t getTotalSize() const noexcept         { return totalSize; }
+
+        /** Returns the number of sections. */
+        int getNumSections() const noexcept          { return (int) numSections; }
+
+        /** Returns the ID of a section by index, in ascending ID order. */
+        uint32 getSectionID (int index) const noexcept;
+
+        /** Returns true if the container has a section with this ID. */
+        bool hasSection (uint32 sectionID) const noexcept;
+
+        /** Gives access to a section's data after verifying its checksum.
+
+            @returns false if the section is missing or corrupt
+        */
+        bool getSection (uint32 sectionID, const void*& data, size_t& size) const noexcept;
+
+        /** Reads a string section, or returns defaultValue if it is missing or corrupt. */
+        juce::String getString (uint32 sectionID, const juce::String& defaultValue = {}) const;
+
+        /** Reads a 64-bit integer section, or returns defaultValue if it is missing or corrupt. */
+        juce::int64 getInt64 (uint32 sectionID, juce::int64 defaultValue = 0) const noexcept;
+
+        /** Reads a double section, or returns defaultValue if it is missing or corrupt. */
+        double getDouble (uint32 sectionID, double defaultValue = 0.0) const noexcept;
+
+        /** Verifies the checksum of every section. This reads all the data. */
+        bool verifyAllSections() const noexcept;
+
+    private:
+        const uint8* findEntry (uint32 sectionID) const noexcept;
+        bool readEntry (const uint8* entry, const void*& data, size_t& size) const noexcept;
+
+        const uint8* base = nullptr;
+        const uint8* table = nullptr;
+        uint32 schemaVersion = 0, numSections = 0;
+        size_t totalSize = 0;
+
+        JUCE_DECLARE_NON_COPYABLE (Reader)
+    };
+
+private:
+    NativeMacClipboardSchema() = delete;
+    JUCE_DECLARE_NON_COPYABLE (NativeMacClipboardSchema)
+};
+
+} // namespace juce
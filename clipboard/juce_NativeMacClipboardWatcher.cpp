@@ -0,0 +1,434 @@
+/*******************************************************************************
+ Clipboard change watcher - implementation
+*******************************************************************************/
+
+#if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+namespace juce
+{
+
+//==============================================================================
+NativeMacClipboardWatcher::Subscription::Subscription (std::function<void (const Event&)> callback)
+    : onChange (std::move (callback))
+{
+}
+
+NativeMacClipboardWatcher::Subscription::~Subscription() = default;
+
+void NativeMacClipboardWatcher::Subscription::push (const Event& event) noexcept
+{
+    latestChangeCount = event.changeCount;
+    latestTimeMs = event.timeMs;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+    if (size1 + size2 == 0)
+    {
+        // The consumer has fallen behind - it will get one event for the latest state instead
+        overflowed = true;
+        return;
+    }
+
+    events[size1 > 0 ? start1 : start2] = event;
+    fifo.finishedWrite (1);
+}
+
+bool NativeMacClipboardWatcher::Subscription::popEvent (Event& event) noexcept
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (1, start1, size1, start2, size2);
+
+    if (size1 + size2 > 0)
+    {
+        event = events[size1 > 0 ? start1 : start2];
+        fifo.finishedRead (1);
+        return true;
+    }
+
+    if (overflowed.exchange (false))
+    {
+        event.changeCount = latestChangeCount.load();
+        event.timeMs = latestTimeMs.load();
+        return true;
+    }
+
+    return false;
+}
+
+bool NativeMacClipboardWatcher::Subscription::popLatestEvent (Event& event) noexcept
+{
+    bool found = false;
+
+    for (Event e; popEvent (e);)
+    {
+        event = e;
+        found = true;
+    }
+
+    return found;
+}
+
+//==============================================================================
+NativeMacClipboardWatcher::NativeMacClipboardWatcher()
+    : NativeMacClipboardWatcher (Options(), nullptr)
+{
+}
+
+NativeMacClipboardWatcher::NativeMacClipboardWatcher (Options o,
+                                                      std::shared_ptr<NativeMacPasteboardBackend> b,
+                                                      std::function<double()> c)
+    : options (o),
+      backend (std::move (b)),
+      clock (c != nullptr ? std::move (c) : [] { return juce::Time::getMillisecondCounterHiRes(); }),
+      currentIntervalMs (o.minIntervalMs)
+{
+    jassert (options.minIntervalMs > 0 && options.maxIntervalMs >= options.minIntervalMs);
+    jassert (options.backoffFactor >= 1.0);
+}
+
+NativeMacClipboardWatcher::~NativeMacClipboardWatcher()
+{
+    stopTimer();
+}
+
+std::shared_ptr<NativeMacClipboardWatcher> NativeMacClipboardWatcher::getShared()
+{
+    static juce::SpinLock lock;
+    static std::weak_ptr<NativeMacClipboardWatcher> instance;
+
+    const juce::SpinLock::ScopedLockType sl (lock);
+
+    auto watcher = instance.lock();
+
+    if (watcher == nullptr)
+    {
+        watcher = std::make_shared<NativeMacClipboardWatcher>();
+        watcher->start();
+        instance = watcher;
+    }
+
+    return watcher;
+}
+
+//==============================================================================
+std::shared_ptr<NativeMacClipboardWatcher::Subscription> NativeMacClipboardWatcher::subscribe (std::function<void (const Event&)> onChange)
+{
+    std::shared_ptr<Subscription> subscription (new Subscription (std::move (onChange)));
+
+    const juce::ScopedLock sl (subscriberLock);
+    subscribers.push_back (subscription);
+    return subscription;
+}
+
+int NativeMacClipboardWatcher::getNumSubscribers() const
+{
+    const juce::ScopedLock sl (subscriberLock);
+
+    return (int) std::count_if (subscribers.begin(), subscribers.end(),
+                                [] (const auto& s) { return ! s.expired(); });
+}
+
+void NativeMacClipboardWatcher::publish (const Event& event)
+{
+    std::vector<std::shared_ptr<Subscription>> live;
+
+    {
+        const juce::ScopedLock sl (subscriberLock);
+
+        subscribers.erase (std::remove_if (subscribers.begin(), subscribers.end(),
+                                           [] (const auto& s) { return s.expired(); }),
+                           subscribers.end());
+
+        live.reserve (subscribers.size());
+
+        for (auto& s : subscribers)
+            if (auto subscription = s.lock())
+                live.push_back (std::move (subscription));
+    }
+
+    for (auto& subscription : live)
+    {
+        subscription->push (event);
+
+        if (subscription->onChange != nullptr)
+            subscription->onChange (event);
+    }
+}
+
+//==============================================================================
+void NativeMacClipboardWatcher::start()
+{
+    startTimer (1);
+}
+
+void NativeMacClipboardWatcher::stop()
+{
+    stopTimer();
+}
+
+void NativeMacClipboardWatcher::timerCallback()
+{
+    const auto delayMs = poll (clock());
+    startTimer (jmax (1, (int) std::ceil (delayMs)));
+}
+
+void NativeMacClipboardWatcher::notifyUserActivity()
+{
+    notifyUserActivity (clock());
+
+    if (isTimerRunning())
+        startTimer (1);
+}
+
+void NativeMacClipboardWatcher::notifyUserActivity (double nowMs)
+{
+    const juce::ScopedLock sl (scheduleLock);
+
+    currentIntervalMs = options.minIntervalMs;
+    nextPollTimeMs = jmin (nextPollTimeMs, nowMs);
+}
+
+double NativeMacClipboardWatcher::poll (double nowMs)
+{
+    {
+        const juce::ScopedLock sl (scheduleLock);
+
+        if (nowMs < nextPollTimeMs)
+            return nextPollTimeMs - nowMs;
+    }
+
+    const auto changeCount = getBackendToWatch()->getChangeCount();
+    ++numProbes;
+
+    const auto previous = lastChangeCount.exchange (changeCount);
+    const bool changed = previous >= 0 && changeCount != previous;
+
+    double intervalMs;
+
+    {
+        const juce::ScopedLock sl (scheduleLock);
+
+        if (changed)
+            intervalMs = options.minIntervalMs;
+        else if (previous < 0)
+            intervalMs = currentIntervalMs.load();
+        else
+            intervalMs = jmin (options.maxIntervalMs, currentIntervalMs.load() * options.backoffFactor);
+
+        currentIntervalMs = intervalMs;
+        nextPollTimeMs = nowMs + intervalMs;
+    }
+
+    if (changed)
+        publish ({ changeCount, nowMs });
+
+    return intervalMs;
+}
+
+//==============================================================================
+bool NativeMacClipboardWatcher::containsDataType (const juce::String& typeUTI)
+{
+    const auto changeCount = lastChangeCount.load();
+
+    // Nothing to key the cache on until the first poll
+    if (changeCount < 0)
+        return getBackendToWatch()->containsDataType (typeUTI);
+
+    {
+        const juce::SpinLock::ScopedLockType sl (cacheLock);
+
+        if (cacheChangeCount == changeCount)
+        {
+            auto it = typeCache.find (typeUTI);
+
+            if (it != typeCache.end())
+                return it->second;
+        }
+    }
+
+    const auto result = getBackendToWatch()->containsDataType (typeUTI);
+
+    const juce::SpinLock::ScopedLockType sl (cacheLock);
+
+    if (cacheChangeCount != changeCount)
+    {
+        typeCache.clear();
+        cacheChangeCount = changeCount;
+    }
+
+    typeCache[typeUTI] = result;
+    return result;
+}
+
+std::shared_ptr<NativeMacPasteboardBackend> NativeMacClipboardWatcher::getBackendToWatch() const
+{
+    return backend != nullptr ? backend : NativeMacPasteboard::getBackend();
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacClipboardWatcherTests  : public juce::UnitTest
+{
+public:
+    NativeMacClipboardWatcherTests()
+        : juce::UnitTest ("NativeMacClipboardWatcher", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        NativeMacClipboardWatcher::Options options;
+        options.minIntervalMs = 50.0;
+        options.maxIntervalMs = 400.0;
+        options.backoffFactor = 2.0;
+
+        beginTest ("Adaptive polling");
+        {
+            auto pasteboard = std::make_shared<NativeMacInMemoryPasteboard>();
+            NativeMacClipboardWatcher watcher (options, pasteboard, [] { return 0.0; });
+
+            expectEquals (watcher.poll (0.0), 50.0);
+            expectEquals (watcher.poll (10.0), 40.0);
+            expectEquals (watcher.getNumProbes(), (juce::int64) 1);
+
+            // Each quiet poll doubles the interval, up to the maximum
+            auto nowMs = 50.0;
+
+            for (auto expectedMs : { 100.0, 200.0, 400.0, 400.0 })
+            {
+                expectEquals (watcher.poll (nowMs), expectedMs);
+                nowMs += expectedMs;
+            }
+
+            expectEquals (watcher.getNumProbes(), (juce::int64) 5);
+
+            pasteboard->writeData ("x", 1, "com.example.preset");
+            expectEquals (watcher.poll (nowMs), 50.0);
+            expectEquals (watcher.getLastChangeCount(), pasteboard->getChangeCount());
+
+            expectEquals (watcher.poll (nowMs + 50.0), 100.0);
+
+            // Activity makes a poll due straight away and resets the backoff
+            watcher.notifyUserActivity (nowMs + 60.0);
+            expectEquals (watcher.getCurrentIntervalMs(), 50.0);
+            expectEquals (watcher.poll (nowMs + 60.0), 100.0);
+            expectEquals (watcher.getNumProbes(), (juce::int64) 8);
+        }
+
+        beginTest ("Events");
+        {
+            auto pasteboard = std::make_shared<NativeMacInMemoryPasteboard>();
+            NativeMacClipboardWatcher watcher (options, pasteboard, [] { return 0.0; });
+
+            std::vector<juce::int64> notified;
+            auto subscription = watcher.subscribe ([&] (const auto& event) { notified.push_back (event.changeCount); });
+            expectEquals (watcher.getNumSubscribers(), 1);
+
+            auto nowMs = 0.0;
+            nowMs += watcher.poll (nowMs);
+
+            NativeMacClipboardWatcher::Event event;
+            expect (! subscription->popEvent (event));
+
+            for (int i = 0; i < 3; ++i)
+            {
+                pasteboard->writeData ("x", 1, "com.example.preset");
+                nowMs += watcher.poll (nowMs);
+            }
+
+            expectEquals ((int) notified.size(), 3);
+
+            for (int i = 0; i < 3; ++i)
+            {
+                expect (subscription->popEvent (event));
+                expectEquals (event.changeCount, notified[(size_t) i]);
+            }
+
+            expect (! subscription->popEvent (event));
+
+            subscription.reset();
+            expectEquals (watcher.getNumSubscribers(), 0);
+
+            pasteboard->writeData ("x", 1, "com.example.preset");
+            watcher.poll (nowMs);
+            expectEquals ((int) notified.size(), 3);
+        }
+
+        beginTest ("A full queue coalesces into the latest event");
+        {
+            auto pasteboard = std::make_shared<NativeMacInMemoryPasteboard>();
+            NativeMacClipboardWatcher watcher (options, pasteboard, [] { return 0.0; });
+            auto subscription = watcher.subscribe();
+
+            auto nowMs = 0.0;
+            nowMs += watcher.poll (nowMs);
+
+            for (int i = 0; i < 40; ++i)
+            {
+                pasteboard->writeData ("x", 1, "com.example.preset");
+                nowMs += watcher.poll (nowMs);
+            }
+
+            std::vector<juce::int64> received;
+
+            for (NativeMacClipboardWatcher::Event event; subscription->popEvent (event);)
+                received.push_back (event.changeCount);
+
+            expectLessThan ((int) received.size(), 40);
+            expectEquals (received.back(), pasteboard->getChangeCount());
+
+            for (size_t i = 1; i < received.size(); ++i)
+                expectGreaterThan (received[i], received[i - 1]);
+
+            pasteboard->writeData ("x", 1, "com.example.preset");
+            watcher.poll (nowMs);
+
+            NativeMacClipboardWatcher::Event latest;
+            expect (subscription->popLatestEvent (latest));
+            expectEquals (latest.changeCount, pasteboard->getChangeCount());
+            expect (! subscription->popLatestEvent (latest));
+        }
+
+        beginTest ("Type cache");
+        {
+            auto pasteboard = std::make_shared<NativeMacInMemoryPasteboard>();
+            NativeMacClipboardWatcher watcher (options, pasteboard, [] { return 0.0; });
+
+            pasteboard->writeData ("x", 1, "com.example.preset");
+
+            // Nothing is cached before the first poll
+            expect (watcher.containsDataType ("com.example.preset"));
+            expect (watcher.containsDataType ("com.example.preset"));
+            expectEquals (pasteboard->getStats().numTypeQueries, (juce::int64) 2);
+
+            auto nowMs = 0.0;
+            nowMs += watcher.poll (nowMs);
+
+            for (int i = 0; i < 5; ++i)
+            {
+                expect (watcher.containsDataType ("com.example.preset"));
+                expect (! watcher.containsDataType ("com.example.other"));
+            }
+
+            expectEquals (pasteboard->getStats().numTypeQueries, (juce::int64) 4);
+
+            pasteboard->writeData ("x", 1, "com.example.other");
+            watcher.poll (nowMs);
+
+            expect (! watcher.containsDataType ("com.example.preset"));
+            expect (watcher.containsDataType ("com.example.other"));
+            expectEquals (pasteboard->getStats().numTypeQueries, (juce::int64) 6);
+        }
+    }
+};
+
+static NativeMacClipboardWatcherTests nativeMacClipboardWatcherTests;
+
+#endif
+
+} // namespace juce
+
+#endif // JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
@@ -0,0 +1,195 @@
+/*******************************************************************************
+ Clipboard change watcher
+
+ One process-wide probe of the pasteboard change count, shared by any number
+ of subscribers.
+*******************************************************************************/
+
+#pragma once
+
+#if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Watches the pasteboard for changes on behalf of many subscribers.
+
+    Instead of every component polling clipboardContainsDataType() on its own
+    timer, a single watcher samples the pasteboard change count and fans change
+    events out to its subscribers. Each subscription has its own lock-free
+    single-producer/single-consumer queue, so consumers on any thread can drain
+    events without ever blocking the watcher.
+
+    Polling is adaptive: after user activity (see notifyUserActivity()) or a
+    detected change the interval drops to the minimum, and every poll that
+    finds nothing new multiplies it by the backoff factor, up to the maximum.
+
+    The watcher also caches containsDataType() answers per change count, so N
+    components asking the same question cost one pasteboard query.
+
+    All scheduling decisions are made by poll(), which takes the current time
+    as an argument; call it directly with a virtual clock to drive a watcher
+    deterministically, or start() it to poll from a Timer on the message thread.
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacClipboardWatcher  : private juce::Timer
+{
+public:
+    //==============================================================================
+    struct Options
+    {
+        double minIntervalMs = 50.0;       /**< Poll interval right after activity or a change. */
+        double maxIntervalMs = 2000.0;     /**< Poll interval once idle. */
+        double backoffFactor = 2.0;        /**< Interval growth for each poll that finds no change. */
+    };
+
+    /** A detected clipboard change. */
+    struct Event
+    {
+        juce::int64 changeCount = 0;
+        double timeMs = 0.0;
+    };
+
+    //==============================================================================
+    /**
+        A subscriber's view of the watcher.
+
+        Events are delivered into a bounded lock-free queue. If the consumer falls
+        behind and the queue fills up, further events are coalesced: the next
+        popEvent() after the backlog returns a single event describing the latest
+        change instead.
+    */
+    class JUCE_API  Subscription
+    {
+    public:
+        ~Subscription();
+
+        /** Takes the oldest pending event. Must only be called from one thread at a time.
+
+            @returns false if there are no pending events
+        */
+        bool popEvent (Event& event) noexcept;
+
+        /** Discards pending events and returns the latest one, if there were any. */
+        bool popLatestEvent (Event& event) noexcept;
+
+    private:
+        friend class NativeMacClipboardWatcher;
+        explicit Subscription (std::function<void (const Event&)>);
+
+        void push (const Event&) noexcept;
+
+        static constexpr int queueSize = 16;
+
+        juce::AbstractFifo fifo { queueSize };
+        Event events[queueSize];
+
+        std::atomic<bool> overflowed { false };
+        std::atomic<juce::int64> latestChangeCount { 0 };
+        std::atomic<double> latestTimeMs { 0.0 };
+
+        // Fixed at construction, as the polling thread calls it without a lock
+        const std::function<void (const Event&)> onChange;
+
+        JUCE_DECLARE_NON_COPYABLE (Subscription)
+    };
+
+    //==============================================================================
+    /** Creates a watcher with the default options on the current pasteboard backend. */
+    NativeMacClipboardWatcher();
+
+    /** Creates a watcher.
+
+        @param options   Polling intervals
+        @param backend   Pasteboard to watch; if null, NativeMacPasteboard::getBackend() is used on each poll
+        @param clock     Returns the current time in milliseconds; if empty,
+                         Time::getMillisecondCounterHiRes() is used
+    */
+    NativeMacClipboardWatcher (Options options,
+                               std::shared_ptr<NativeMacPasteboardBackend> backend,
+                               std::function<double()> clock = nullptr);
+
+    /** Destructor. */
+    ~NativeMacClipboardWatcher() override;
+
+    /** Returns the process-wide watcher, creating it if necessary. */
+    static std::shared_ptr<NativeMacClipboardWatcher> getShared();
+
+    //==============================================================================
+    /** Registers a subscriber. Events are delivered until the returned object is destroyed.
+
+        @param onChange   Optional callback invoked on the polling thread after each
+                          event is queued; it can't be changed afterwards
+    */
+    std::shared_ptr<Subscription> subscribe (std::function<void (const Event&)> onChange = nullptr);
+
+    /** Returns the number of live subscriptions. */
+    int getNumSubscribers() const;
+
+    //==============================================================================
+    /** Starts polling from a Timer on the message thread. */
+    void start();
+
+    /** Stops the Timer. */
+    void stop();
+
+    /** Call this on user interaction (e.g. mouse enter or a menu opening) to poll quickly again. */
+    void notifyUserActivity();
+
+    /** Samples the change count if a poll is due at the given time.
+
+        @param nowMs   The current time in milliseconds
+        @returns the delay in milliseconds until the next poll is due
+    */
+    double poll (double nowMs);
+
+    /** Like notifyUserActivity(), but with an explicit time for use with a virtual clock. */
+    void notifyUserActivity (double nowMs);
+
+    //==============================================================================
+    /** Returns the change count seen by the most recent poll. */
+    juce::int64 getLastChangeCount() const noexcept      { return lastChangeCount.load(); }
+
+    /** Returns the interval the watcher is currently using. */
+    double getCurrentIntervalMs() const noexcept         { return currentIntervalMs.load(); }
+
+    /** Returns the number of times the pasteboard has been probed. */
+    juce::int64 getNumProbes() const noexcept            { return numProbes.load(); }
+
+    /** Answers NativeMacPasteboard::clipboardContainsDataType() from a cache that is
+        invalidated whenever a poll sees the change count move.
+    */
+    bool containsDataType (const juce::String& typeUTI);
+
+private:
+    //==============================================================================
+    void timerCallback() override;
+    std::shared_ptr<NativeMacPasteboardBackend> getBackendToWatch() const;
+    void publish (const Event&);
+
+    const Options options;
+    const std::shared_ptr<NativeMacPasteboardBackend> backend;
+    const std::function<double()> clock;
+
+    std::atomic<juce::int64> lastChangeCount { -1 }, numProbes { 0 };
+    std::atomic<double> currentIntervalMs;
+
+    juce::CriticalSection scheduleLock;
+    double nextPollTimeMs = 0.0;
+
+    juce::CriticalSection subscriberLock;
+    std::vector<std::weak_ptr<Subscription>> subscribers;
+
+    juce::SpinLock cacheLock;
+    juce::int64 cacheChangeCount = -1;
+    std::map<juce::String, bool> typeCache;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacClipboardWatcher)
+};
+
+} // namespace juce
+
+#endif // JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
@@ -0,0 +1,745 @@
+/*******************************************************************************
+ NativeMacPasteboard - platform independent implementation
+
+ All clipboard operations go through the current NativeMacPasteboardBackend.
+ The NSPasteboard backend lives in juce_native_macos_dialogs.mm.
+*******************************************************************************/
+
+#if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+namespace juce
+{
+
+#if JUCE_MAC
+ // Defined in juce_native_macos_dialogs.mm
+ std::shared_ptr<NativeMacPasteboardBackend> createNativeMacGeneralPasteboardBackend();
+#endif
+
+namespace PasteboardHelpers
+{
+    static std::shared_ptr<NativeMacPasteboardBackend> createDefaultBackend()
+    {
+       #if JUCE_MAC
+        return createNativeMacGeneralPasteboardBackend();
+       #else
+        // No system pasteboard is wrapped on this platform, so keep the data in-process
+        return std::make_shared<NativeMacInMemoryPasteboard>();
+       #endif
+    }
+
+    struct BackendHolder
+    {
+        juce::SpinLock lock;
+        std::shared_ptr<NativeMacPasteboardBackend> backend;
+        std::shared_ptr<NativeMacClipboardHistory> history;
+    };
+
+    static BackendHolder& getBackendHolder()
+    {
+        static BackendHolder holder;
+        return holder;
+    }
+
+    //==============================================================================
+    // Large payloads are moved to spill files; only the most recent one is kept alive
+    struct SpillState
+    {
+        juce::CriticalSection lock;
+        size_t threshold = 0;
+        juce::File directory;
+        juce::File currentFile;
+        bool hasSweptStaleFiles = false;
+    };
+
+    static SpillState& getSpillState()
+    {
+        static SpillState state;
+        return state;
+    }
+
+    static juce::File getSpillDirectory()
+    {
+        auto& spill = getSpillState();
+
+        const juce::ScopedLock sl (spill.lock);
+
+        return spill.directory.getFullPathName().isNotEmpty() ? spill.directory
+                                                              : NativeMacClipboardFileReference::getDefaultDirectory();
+    }
+
+    static juce::int64 writePayload (NativeMacPasteboardBackend& backend, const void* data, size_t size,
+                                     const juce::String& typeUTI,
+                                     const juce::StringArray& promisedTypes = {},
+                                     NativeMacPasteboardBackend::DataProvider provider = nullptr)
+    {
+        JUCE_NATIVE_MACOS_TRACE ("clipboard", "writePasteboard");
+
+        auto& spill = getSpillState();
+        const juce::ScopedLock sl (spill.lock);
+
+        juce::File previousFile = spill.currentFile;
+        spill.currentFile = juce::File();
+
+        juce::int64 changeCount = -1;
+
+        if (spill.threshold > 0 && size >= spill.threshold)
+        {
+            const auto directory = getSpillDirectory();
+
+            if (! spill.hasSweptStaleFiles)
+            {
+                // Files from earlier sessions may have been left on the clipboard when they quit
+                NativeMacClipboardFileReference::deleteStaleFiles (directory, juce::RelativeTime::days (1));
+                spill.hasSweptStaleFiles = true;
+            }
+
+            juce::MemoryBlock record;
+            juce::File spillFile;
+
+            if (NativeMacClipboardFileReference::createSpillFile (data, size, directory, record, spillFile))
+            {
+                changeCount = backend.writeDataWithPromises (record.getData(), record.getSize(), typeUTI,
+                                                             promisedTypes, provider);
+                spill.currentFile = spillFile;
+            }
+        }
+
+        // Below the threshold, or the spill file couldn't be written
+        if (changeCount < 0)
+            changeCount = backend.writeDataWithPromises (data, size, typeUTI, promisedTypes, std::move (provider));
+
+        // The previous spill file is no longer referenced by the clipboard
+        if (previousFile.getFullPathName().isNotEmpty())
+            previousFile.deleteFile();
+
+        return changeCount;
+    }
+
+    //==============================================================================
+    // Remembers the last payload this process wrote, so that copying the same
+    // data again while we still own the pasteboard can be skipped
+    struct WriteDeduplicator
+    {
+        juce::SpinLock lock;
+        std::weak_ptr<NativeMacPasteboardBackend> backend;
+        juce::String typeUTI;
+        juce::int64 changeCount = -1;
+        uint64 hash = 0;
+        size_t size = 0;
+        int encoding = 0;
+
+        std::atomic<bool> enabled { true };
+        std::atomic<juce::int64> numWrites { 0 }, numSkippedWrites { 0 }, numBytesSkipped { 0 };
+    };
+
+    static WriteDeduplicator& getWriteDeduplicator()
+    {
+        static WriteDeduplicator deduplicator;
+        return deduplicator;
+    }
+
+    /** Calls write (backend) unless it would store exactly what this process last wrote
+        and nobody has changed the pasteboard since.
+
+        write returns the change count after the write, or -1 if nothing was written.
+        'encoding' distinguishes raw writes from framed ones, so the same input
+        written in both forms is never mistaken for a repeat.
+    */
+    template <typename WriteFunction>
+    static void writeUnlessUnchanged (const void* data, size_t size, const juce::String& typeUTI,
+                                      int encoding, WriteFunction&& write)
+    {
+        JUCE_NATIVE_MACOS_TRACE ("clipboard", "copyDataToClipboard");
+        JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (copyDataToClipboard);
+
+        // Recorded even when the write itself is skipped, which moves the entry back to the front
+        if (auto history = NativeMacPasteboard::getHistory())
+            history->add (data, size, typeUTI);
+
+        auto backend = NativeMacPasteboard::getBackend();
+        auto& dedup = getWriteDeduplicator();
+
+        if (! dedup.enabled.load())
+        {
+            if (write (*backend) >= 0)
+                ++dedup.numWrites;
+
+            return;
+        }
+
+        const auto hash = NativeMacClipboardPayload::Checksum::hash64 (data, size, (uint64) typeUTI.hashCode64());
+        juce::int64 expectedChangeCount = -1;
+
+        {
+            const juce::SpinLock::ScopedLockType sl (dedup.lock);
+
+            if (dedup.hash == hash && dedup.size == size && dedup.encoding == encoding
+                 && dedup.typeUTI == typeUTI && dedup.backend.lock() == backend)
+                expectedChangeCount = dedup.changeCount;
+        }
+
+        // Only query the backend outside the lock, as it may be a round trip to the pasteboard server
+        if (expectedChangeCount >= 0 && backend->getChangeCount() == expectedChangeCount)
+        {
+            ++dedup.numSkippedWrites;
+            dedup.numBytesSkipped += (juce::int64) size;
+            return;
+        }
+
+        const auto newChangeCount = write (*backend);
+
+        // The pasteboard still holds whatever was written before, so the remembered write stays valid
+        if (newChangeCount < 0)
+            return;
+
+        ++dedup.numWrites;
+
+        const juce::SpinLock::ScopedLockType sl (dedup.lock);
+
+        dedup.backend = backend;
+        dedup.typeUTI = typeUTI;
+        dedup.changeCount = newChangeCount;
+        dedup.hash = hash;
+        dedup.size = size;
+        dedup.encoding = encoding;
+    }
+
+    /** Reads pasteboard data with a lambda, without allocating a std::function.
+        The visitor isn't called if the data is a reference to a spill file that can't be mapped.
+    */
+    template <typename Visitor>
+    static bool readData (const juce::String& typeUTI, Visitor&& visitor)
+    {
+        JUCE_NATIVE_MACOS_TRACE ("clipboard", "readClipboard");
+
+        using VisitorType = std::remove_reference_t<Visitor>;
+
+        return NativeMacPasteboard::getBackend()->readData (typeUTI,
+                                                            [] (void* context, const void* data, size_t size)
+                                                            {
+                                                                auto& v = *static_cast<VisitorType*> (context);
+
+                                                                // File-backed payloads are mapped rather than read into memory
+                                                                if (NativeMacClipboardFileReference::isReference (data, size))
+                                                                {
+                                                                    NativeMacClipboardFileReference::Mapping mapping (data, size, getSpillDirectory());
+
+                                                                    if (mapping.isValid())
+                                                                        v (mapping.getData(), mapping.getSize());
+
+                                                                    return;
+                                                                }
+
+                                                                v (data, size);
+                                                            },
+                                                            std::addressof (visitor));
+    }
+}
+
+//==============================================================================
+void NativeMacPasteboard::setBackend (std::shared_ptr<NativeMacPasteboardBackend> newBackend)
+{
+    auto& holder = PasteboardHelpers::getBackendHolder();
+
+    const juce::SpinLock::ScopedLockType sl (holder.lock);
+    holder.backend = std::move (newBackend);
+}
+
+std::shared_ptr<NativeMacPasteboardBackend> NativeMacPasteboard::getBackend()
+{
+    auto& holder = PasteboardHelpers::getBackendHolder();
+
+    const juce::SpinLock::ScopedLockType sl (holder.lock);
+
+    if (holder.backend == nullptr)
+        holder.backend = PasteboardHelpers::createDefaultBackend();
+
+    return holder.backend;
+}
+
+void NativeMacPasteboard::setHistory (std::shared_ptr<NativeMacClipboardHistory> history)
+{
+    auto& holder = PasteboardHelpers::getBackendHolder();
+
+    const juce::SpinLock::ScopedLockType sl (holder.lock);
+    holder.history = std::move (history);
+}
+
+std::shared_ptr<NativeMacClipboardHistory> NativeMacPasteboard::getHistory()
+{
+    auto& holder = PasteboardHelpers::getBackendHolder();
+
+    const juce::SpinLock::ScopedLockType sl (holder.lock);
+    return holder.history;
+}
+
+juce::int64 NativeMacPasteboard::getChangeCount()
+{
+    return getBackend()->getChangeCount();
+}
+
+//==============================================================================
+void NativeMacPasteboard::copyDataToClipboard (const void* data, size_t size,
+                                               const juce::String& typeUTI)
+{
+    PasteboardHelpers::writeUnlessUnchanged (data, size, typeUTI, -1, [&] (NativeMacPasteboardBackend& backend)
+    {
+        return PasteboardHelpers::writePayload (backend, data, size, typeUTI);
+    });
+}
+
+void NativeMacPasteboard::copyDataToClipboard (const void* data, size_t size,
+                                               const juce::String& typeUTI,
+                                               NativeMacClipboardPayload::Compression compression)
+{
+    // Deduplicated on the raw input, so a repeated copy doesn't even pay for encoding
+    PasteboardHelpers::writeUnlessUnchanged (data, size, typeUTI, (int) compression, [&] (NativeMacPasteboardBackend& backend)
+    {
+        juce::MemoryBlock framed;
+
+        if (! NativeMacClipboardPayload::encode (data, size, framed, compression))
+        {
+            jassertfalse; // payload too large to frame
+            return (juce::int64) -1;
+        }
+
+        return PasteboardHelpers::writePayload (backend, framed.getData(), framed.getSize(), typeUTI);
+    });
+}
+
+void NativeMacPasteboard::copyDataToClipboard (const void* data, size_t size,
+                                               const juce::String& typeUTI,
+                                               const juce::StringArray& promisedTypes,
+                                               NativeMacPasteboardBackend::DataProvider provider)
+{
+    // A different set of promises must not look like a repeat of the last write, so the
+    // type list becomes part of the encoding, kept clear of the raw (-1) and framed (>= 0) values
+    const auto encoding = -2 - (promisedTypes.joinIntoString ("\n").hashCode() & 0x3fffffff);
+
+    PasteboardHelpers::writeUnlessUnchanged (data, size, typeUTI, encoding, [&] (NativeMacPasteboardBackend& backend)
+    {
+        return PasteboardHelpers::writePayload (backend, data, size, typeUTI, promisedTypes, std::move (provider));
+    });
+}
+
+//==============================================================================
+void NativeMacPasteboard::setFileBackedThreshold (size_t numBytes, const juce::File& directory)
+{
+    auto& spill = PasteboardHelpers::getSpillState();
+
+    const juce::ScopedLock sl (spill.lock);
+    spill.threshold = numBytes;
+    spill.directory = directory;
+}
+
+size_t NativeMacPasteboard::getFileBackedThreshold()
+{
+    auto& spill = PasteboardHelpers::getSpillState();
+
+    const juce::ScopedLock sl (spill.lock);
+    return spill.threshold;
+}
+
+//==============================================================================
+void NativeMacPasteboard::setWriteDeduplicationEnabled (bool shouldBeEnabled) noexcept
+{
+    PasteboardHelpers::getWriteDeduplicator().enabled = shouldBeEnabled;
+}
+
+bool NativeMacPasteboard::isWriteDeduplicationEnabled() noexcept
+{
+    return PasteboardHelpers::getWriteDeduplicator().enabled.load();
+}
+
+NativeMacPasteboard::WriteStats NativeMacPasteboard::getWriteStats() noexcept
+{
+    auto& dedup = PasteboardHelpers::getWriteDeduplicator();
+
+    WriteStats stats;
+    stats.numWrites        = dedup.numWrites.load();
+    stats.numSkippedWrites = dedup.numSkippedWrites.load();
+    stats.numBytesSkipped  = dedup.numBytesSkipped.load();
+    return stats;
+}
+
+void NativeMacPasteboard::resetWriteStats() noexcept
+{
+    auto& dedup = PasteboardHelpers::getWriteDeduplicator();
+
+    dedup.numWrites = 0;
+    dedup.numSkippedWrites = 0;
+    dedup.numBytesSkipped = 0;
+}
+
+//==============================================================================
+bool NativeMacPasteboard::clipboardContainsDataType (const juce::String& typeUTI)
+{
+    JUCE_NATIVE_MACOS_TRACE ("clipboard", "clipboardContainsDataType");
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (clipboardContainsDataType);
+
+    return getBackend()->containsDataType (typeUTI);
+}
+
+//==============================================================================
+bool NativeMacPasteboard::fetchDataFromClipboard (juce::MemoryBlock& memoryBlock,
+                                                  const juce::String& typeUTI)
+{
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (fetchDataFromClipboard);
+
+    bool success = false;
+
+    PasteboardHelpers::readData (typeUTI, [&] (const void* data, size_t size)
+    {
+        // Framed payloads are unwrapped transparently; the header check is O(1)
+        if (NativeMacClipboardPayload::isEncodedPayload (data, size))
+        {
+            success = NativeMacClipboardPayload::decode (data, size, memoryBlock);
+        }
+        else
+        {
+            memoryBlock.replaceAll (data, size);
+            success = true;
+        }
+    });
+
+    return success;
+}
+
+//==============================================================================
+juce::int64 NativeMacPasteboard::getClipboardDataSize (const juce::String& typeUTI)
+{
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (getClipboardDataSize);
+
+    juce::int64 result = -1;
+
+    PasteboardHelpers::readData (typeUTI, [&] (const void* data, size_t size)
+    {
+        result = NativeMacClipboardPayload::isEncodedPayload (data, size)
+                    ? NativeMacClipboardPayload::getDecodedSize (data, size)
+                    : (juce::int64) size;
+    });
+
+    return result;
+}
+
+//==============================================================================
+bool NativeMacPasteboard::fetchDataFromClipboard (void* destBuffer, size_t bufferSize,
+                                                  size_t& bytesNeeded,
+                                                  const juce::String& typeUTI)
+{
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (fetchDataFromClipboard);
+
+    bool success = false;
+    bytesNeeded = 0;
+
+    PasteboardHelpers::readData (typeUTI, [&] (const void* data, size_t size)
+    {
+        if (NativeMacClipboardPayload::isEncodedPayload (data, size))
+        {
+            bytesNeeded = (size_t) NativeMacClipboardPayload::getDecodedSize (data, size);
+
+            // Decompresses straight into the caller's buffer
+            success = bytesNeeded <= bufferSize
+                       && NativeMacClipboardPayload::decode (data, size, destBuffer, bufferSize) >= 0;
+            return;
+        }
+
+        bytesNeeded = size;
+
+        if (size <= bufferSize)
+        {
+            if (size > 0)
+                std::memcpy (destBuffer, data, size);
+
+            success = true;
+        }
+    });
+
+    return success;
+}
+
+//==============================================================================
+bool NativeMacPasteboard::fetchDataFromClipboard (juce::MemoryBlock& buffer,
+                                                  size_t& numBytesFetched,
+                                                  const juce::String& typeUTI)
+{
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (fetchDataFromClipboard);
+
+    bool success = false;
+    numBytesFetched = 0;
+
+    PasteboardHelpers::readData (typeUTI, [&] (const void* data, size_t size)
+    {
+        if (NativeMacClipboardPayload::isEncodedPayload (data, size))
+        {
+            auto decodedSize = NativeMacClipboardPayload::getDecodedSize (data, size);
+
+            // The header comes from whoever wrote the clipboard, so before growing the buffer
+            // for it, check that the encoded data really decodes to that size
+            if (decodedSize > (juce::int64) buffer.getSize())
+                decodedSize = NativeMacClipboardPayload::getValidatedDecodedSize (data, size);
+
+            if (decodedSize < 0)
+                return;
+
+            buffer.ensureSize ((size_t) decodedSize, false);
+
+            if (NativeMacClipboardPayload::decode (data, size, buffer.getData(), buffer.getSize()) == decodedSize)
+            {
+                numBytesFetched = (size_t) decodedSize;
+                success = true;
+            }
+
+            return;
+        }
+
+        // Grow only - the block's size acts as its capacity
+        buffer.ensureSize (size, false);
+
+        if (size > 0)
+            std::memcpy (buffer.getData(), data, size);
+
+        numBytesFetched = size;
+        success = true;
+    });
+
+    return success;
+}
+
+//==============================================================================
+bool NativeMacPasteboard::visitClipboardData (const juce::String& typeUTI,
+                                              DataVisitorFunction visitorFunction,
+                                              void* context)
+{
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (visitClipboardData);
+
+    bool success = false;
+
+    PasteboardHelpers::readData (typeUTI, [&] (const void* data, size_t size)
+    {
+        if (NativeMacClipboardPayload::isEncodedPayload (data, size))
+        {
+            juce::MemoryBlock decoded;
+
+            if (NativeMacClipboardPayload::decode (data, size, decoded))
+            {
+                visitorFunction (context, decoded.getData(), decoded.getSize());
+                success = true;
+            }
+
+            return;
+        }
+
+        visitorFunction (context, data, size);
+        success = true;
+    });
+
+    return success;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacPasteboardTests  : public juce::UnitTest
+{
+public:
+    NativeMacPasteboardTests()
+        : juce::UnitTest ("NativeMacPasteboard", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        using Pasteboard = NativeMacPasteboard;
+        using Compression = NativeMacClipboardPayload::Compression;
+
+        const auto previousBackend = Pasteboard::getBackend();
+        const auto previousHistory = Pasteboard::getHistory();
+        const auto wasEnabled = Pasteboard::isWriteDeduplicationEnabled();
+
+        Pasteboard::setHistory (nullptr);
+        Pasteboard::setWriteDeduplicationEnabled (true);
+
+        const juce::String type ("com.example.preset"), otherType ("com.example.other");
+        const char data[] = "preset data";
+        const char otherData[] = "other data!";
+
+        beginTest ("Repeated copies are skipped");
+        {
+            auto pasteboard = useNewPasteboard();
+
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type);
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type);
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type);
+
+            expectWriteStats (1, 2, 2 * (juce::int64) sizeof (data));
+            expectEquals (pasteboard->getStats().numWrites, (juce::int64) 1);
+            expectEquals (pasteboard->getChangeCount(), (juce::int64) 1);
+            expect (holds (type, data, sizeof (data)));
+
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type, Compression::lz);
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type, Compression::lz);
+            expectWriteStats (2, 3, 3 * (juce::int64) sizeof (data));
+        }
+
+        beginTest ("Changes by others are never skipped over");
+        {
+            auto pasteboard = useNewPasteboard();
+            auto otherProcess = pasteboard->createClient();
+
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type);
+
+            otherProcess->writeData (otherData, sizeof (otherData), type);
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type);
+            expect (holds (type, data, sizeof (data)));
+
+            pasteboard->clear();
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type);
+            expect (holds (type, data, sizeof (data)));
+
+            expectWriteStats (3, 0, 0);
+        }
+
+        beginTest ("Anything different is written");
+        {
+            auto pasteboard = useNewPasteboard();
+
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type);
+            Pasteboard::copyDataToClipboard (otherData, sizeof (otherData), type);
+            Pasteboard::copyDataToClipboard (otherData, sizeof (otherData) - 1, type);
+            Pasteboard::copyDataToClipboard (otherData, sizeof (otherData) - 1, otherType);
+
+            // The same input in another encoding
+            Pasteboard::copyDataToClipboard (otherData, sizeof (otherData) - 1, otherType, Compression::none);
+            Pasteboard::copyDataToClipboard (otherData, sizeof (otherData) - 1, otherType, Compression::lz);
+            Pasteboard::copyDataToClipboard (otherData, sizeof (otherData) - 1, otherType);
+
+            // Other promises
+            const auto provider = [] (const juce::String&, juce::MemoryBlock& dest) { dest.append ("x", 1); return true; };
+            Pasteboard::copyDataToClipboard (otherData, sizeof (otherData) - 1, otherType, juce::StringArray { "a" }, provider);
+            Pasteboard::copyDataToClipboard (otherData, sizeof (otherData) - 1, otherType, juce::StringArray { "b" }, provider);
+            Pasteboard::copyDataToClipboard (otherData, sizeof (otherData) - 1, otherType, juce::StringArray { "b" }, provider);
+
+            expectWriteStats (9, 1, (juce::int64) sizeof (otherData) - 1);
+            expectEquals (pasteboard->getStats().numWrites, (juce::int64) 9);
+
+            // Another backend, even one sharing the same contents and change count
+            Pasteboard::setBackend (pasteboard->createClient());
+            Pasteboard::copyDataToClipboard (otherData, sizeof (otherData) - 1, otherType, juce::StringArray { "b" }, provider);
+            expectWriteStats (10, 1, (juce::int64) sizeof (otherData) - 1);
+        }
+
+        beginTest ("Overstated payload sizes don't grow the buffer");
+        {
+            auto pasteboard = useNewPasteboard();
+
+            juce::MemoryBlock zeros (10000, true), encoded;
+            NativeMacClipboardPayload::encode (zeros.getData(), zeros.getSize(), encoded, Compression::lz);
+            ClipboardPayloadHelpers::writeLE64 (static_cast<uint8*> (encoded.getData()) + 8,
+                                                (uint64) (encoded.getSize() - NativeMacClipboardPayload::headerSize) * 255);
+
+            pasteboard->writeData (encoded.getData(), encoded.getSize(), type);
+
+            juce::MemoryBlock buffer (16);
+            size_t numBytesFetched = 0;
+
+            expect (! Pasteboard::fetchDataFromClipboard (buffer, numBytesFetched, type));
+            expectEquals (buffer.getSize(), (size_t) 16);
+            expectEquals (numBytesFetched, (size_t) 0);
+
+            // An honest payload still grows it
+            Pasteboard::copyDataToClipboard (zeros.getData(), zeros.getSize(), type, Compression::lz);
+            expect (Pasteboard::fetchDataFromClipboard (buffer, numBytesFetched, type));
+            expectEquals (numBytesFetched, zeros.getSize());
+            expect (buffer.matches (zeros.getData(), zeros.getSize()));
+        }
+
+        beginTest ("Deduplication off");
+        {
+            auto pasteboard = useNewPasteboard();
+            Pasteboard::setWriteDeduplicationEnabled (false);
+
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type);
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type);
+
+            expectWriteStats (2, 0, 0);
+            expectEquals (pasteboard->getStats().numWrites, (juce::int64) 2);
+
+            Pasteboard::setWriteDeduplicationEnabled (true);
+        }
+
+        beginTest ("Failed writes");
+        {
+            auto pasteboard = useNewPasteboard();
+
+            // A write that fails, e.g. a payload too large to frame, isn't remembered...
+            writeFailing (data, sizeof (data), type);
+            expectWriteStats (0, 0, 0);
+
+            // ...so the same data copied again is written
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type);
+            expectWriteStats (1, 0, 0);
+            expect (holds (type, data, sizeof (data)));
+
+            // A failure doesn't forget the last write that succeeded either
+            writeFailing (otherData, sizeof (otherData), type);
+            Pasteboard::copyDataToClipboard (data, sizeof (data), type);
+            expectWriteStats (1, 1, (juce::int64) sizeof (data));
+
+            Pasteboard::copyDataToClipboard (otherData, sizeof (otherData), type);
+            expectWriteStats (2, 1, (juce::int64) sizeof (data));
+            expect (holds (type, otherData, sizeof (otherData)));
+
+            Pasteboard::setWriteDeduplicationEnabled (false);
+            writeFailing (data, sizeof (data), type);
+            expectWriteStats (2, 1, (juce::int64) sizeof (data));
+            Pasteboard::setWriteDeduplicationEnabled (true);
+        }
+
+        Pasteboard::setBackend (previousBackend);
+        Pasteboard::setHistory (previousHistory);
+        Pasteboard::setWriteDeduplicationEnabled (wasEnabled);
+        Pasteboard::resetWriteStats();
+    }
+
+private:
+    static std::shared_ptr<NativeMacInMemoryPasteboard> useNewPasteboard()
+    {
+        auto pasteboard = std::make_shared<NativeMacInMemoryPasteboard>();
+        NativeMacPasteboard::setBackend (pasteboard);
+        NativeMacPasteboard::resetWriteStats();
+        return pasteboard;
+    }
+
+    static void writeFailing (const void* data, size_t size, const juce::String& type)
+    {
+        PasteboardHelpers::writeUnlessUnchanged (data, size, type, -1, [] (NativeMacPasteboardBackend&)
+        {
+            return (juce::int64) -1;
+        });
+    }
+
+    static bool holds (const juce::String& type, const void* data, size_t size)
+    {
+        juce::MemoryBlock block;
+        return NativeMacPasteboard::fetchDataFromClipboard (block, type) && block.matches (data, size);
+    }
+
+    void expectWriteStats (juce::int64 numWrites, juce::int64 numSkippedWrites, juce::int64 numBytesSkipped)
+    {
+        const auto stats = NativeMacPasteboard::getWriteStats();
+
+        expectEquals (stats.numWrites, numWrites);
+        expectEquals (stats.numSkippedWrites, numSkippedWrites);
+        expectEquals (stats.numBytesSkipped, numBytesSkipped);
+    }
+};
+
+static NativeMacPasteboardTests nativeMacPasteboardTests;
+
+#endif
+
+} // namespace juce
+
+#endif // JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
@@ -0,0 +1,491 @@
+/*******************************************************************************
+ Pasteboard backends - in-memory implementation
+*******************************************************************************/
+
+#if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+namespace juce
+{
+
+//==============================================================================
+struct NativeMacInMemoryPasteboard::SharedContents
+{
+    using DataPointer = std::shared_ptr<const juce::MemoryBlock>;   // immutable once published, so readers need no lock
+
+    DataPointer find (const juce::String& type) const
+    {
+        for (auto& item : items)
+            if (item.first == type)
+                return item.second;
+
+        return nullptr;
+    }
+
+    bool isPromised (const juce::String& type) const
+    {
+        for (auto& t : promisedTypes)
+            if (t == type)
+                return true;
+
+        return false;
+    }
+
+    void reset()
+    {
+        items.clear();
+        promisedTypes.clear();
+        provider = nullptr;
+    }
+
+    juce::SpinLock lock;
+    std::vector<std::pair<juce::String, DataPointer>> items;
+    juce::StringArray promisedTypes;                 // not yet produced
+    DataProvider provider;
+    std::atomic<juce::int64> changeCount { 0 };
+};
+
+//==============================================================================
+NativeMacInMemoryPasteboard::NativeMacInMemoryPasteboard()
+    : NativeMacInMemoryPasteboard (std::make_shared<SharedContents>())
+{
+}
+
+NativeMacInMemoryPasteboard::NativeMacInMemoryPasteboard (std::shared_ptr<SharedContents> c)
+    : contents (std::move (c))
+{
+}
+
+NativeMacInMemoryPasteboard::~NativeMacInMemoryPasteboard() = default;
+
+std::shared_ptr<NativeMacInMemoryPasteboard> NativeMacInMemoryPasteboard::createClient() const
+{
+    return std::shared_ptr<NativeMacInMemoryPasteboard> (new NativeMacInMemoryPasteboard (contents));
+}
+
+void NativeMacInMemoryPasteboard::clear()
+{
+    const juce::SpinLock::ScopedLockType sl (contents->lock);
+
+    contents->reset();
+    ++contents->changeCount;
+}
+
+//==============================================================================
+NativeMacInMemoryPasteboard::Stats NativeMacInMemoryPasteboard::getStats() const noexcept
+{
+    Stats stats;
+    stats.numWrites             = numWrites.load();
+    stats.numReads              = numReads.load();
+    stats.numTypeQueries        = numTypeQueries.load();
+    stats.numChangeCountQueries = numChangeCountQueries.load();
+    return stats;
+}
+
+void NativeMacInMemoryPasteboard::resetStats() noexcept
+{
+    numWrites = 0;
+    numReads = 0;
+    numTypeQueries = 0;
+    numChangeCountQueries = 0;
+}
+
+//==============================================================================
+juce::int64 NativeMacInMemoryPasteboard::writeData (const void* data, size_t size, const juce::String& typeUTI)
+{
+    return writeDataWithPromises (data, size, typeUTI, {}, nullptr);
+}
+
+juce::int64 NativeMacInMemoryPasteboard::writeDataWithPromises (const void* data, size_t size, const juce::String& typeUTI,
+                                                                const juce::StringArray& promisedTypes,
+                                                                DataProvider provider)
+{
+    ++numWrites;
+
+    // Copy outside the lock so that large writes don't stall readers
+    auto newData = std::make_shared<const juce::MemoryBlock> (data, size);
+
+    const juce::SpinLock::ScopedLockType sl (contents->lock);
+
+    contents->reset();
+    contents->items.emplace_back (typeUTI, std::move (newData));
+
+    if (provider != nullptr)
+    {
+        contents->promisedTypes = promisedTypes;
+        contents->provider = std::move (provider);
+    }
+
+    return ++contents->changeCount;
+}
+
+bool NativeMacInMemoryPasteboard::containsDataType (const juce::String& typeUTI)
+{
+    ++numTypeQueries;
+
+    const juce::SpinLock::ScopedLockType sl (contents->lock);
+    return contents->find (typeUTI) != nullptr || contents->isPromised (typeUTI);
+}
+
+bool NativeMacInMemoryPasteboard::readData (const juce::String& typeUTI,
+                                            DataVisitorFunction visitorFunction,
+                                            void* context)
+{
+    ++numReads;
+
+    SharedContents::DataPointer data;
+    DataProvider provider;
+    juce::int64 changeCount = 0;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (contents->lock);
+
+        data = contents->find (typeUTI);
+
+        if (data == nullptr && contents->isPromised (typeUTI))
+        {
+            provider = contents->provider;
+            changeCount = contents->changeCount.load();
+        }
+    }
+
+    if (data == nullptr && provider != nullptr)
+    {
+        // Like NSPasteboard, fulfil the promise once and keep the result for later readers
+        auto produced = std::make_shared<juce::MemoryBlock>();
+
+        if (provider (typeUTI, *produced))
+        {
+            const juce::SpinLock::ScopedLockType sl (contents->lock);
+
+            if (contents->changeCount.load() == changeCount)
+            {
+                if ((data = contents->find (typeUTI)) == nullptr)
+                {
+                    data = std::move (produced);
+                    contents->items.emplace_back (typeUTI, data);
+                }
+            }
+            else
+            {
+                data = std::move (produced);
+            }
+        }
+    }
+
+    if (data == nullptr)
+        return false;
+
+    visitorFunction (context, data->getData(), data->getSize());
+    return true;
+}
+
+juce::int64 NativeMacInMemoryPasteboard::getChangeCount()
+{
+    ++numChangeCountQueries;
+    return contents->changeCount.load();
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacInMemoryPasteboardTests  : public juce::UnitTest
+{
+public:
+    NativeMacInMemoryPasteboardTests()
+        : juce::UnitTest ("NativeMacInMemoryPasteboard", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        const juce::String text ("public.utf8-plain-text"), preset ("com.example.preset"), rtf ("public.rtf");
+
+        beginTest ("Change count");
+        {
+            NativeMacInMemoryPasteboard pasteboard;
+            expectEquals (pasteboard.getChangeCount(), (juce::int64) 0);
+
+            expectEquals (pasteboard.writeData ("a", 1, text), (juce::int64) 1);
+            expectEquals (pasteboard.writeData ("a", 1, text), (juce::int64) 2);
+            expectEquals (pasteboard.writeDataWithPromises ("b", 1, text, { preset }, provideTypeName), (juce::int64) 3);
+            expectEquals (pasteboard.getChangeCount(), (juce::int64) 3);
+
+            pasteboard.clear();
+            expectEquals (pasteboard.getChangeCount(), (juce::int64) 4);
+
+            // Reads, queries and producing a promise leave it alone
+            pasteboard.writeDataWithPromises ("b", 1, text, { preset }, provideTypeName);
+            expect (pasteboard.containsDataType (preset));
+            expect (read (pasteboard, preset).isNotEmpty());
+            expectEquals (pasteboard.getChangeCount(), (juce::int64) 5);
+
+            // Clients share the contents and the count
+            auto client = pasteboard.createClient();
+            expectEquals (client->getChangeCount(), (juce::int64) 5);
+            expectEquals (client->writeData ("c", 1, text), (juce::int64) 6);
+            expectEquals (pasteboard.getChangeCount(), (juce::int64) 6);
+            expectEquals (read (pasteboard, text), juce::String ("c"));
+        }
+
+        beginTest ("Writes replace the contents");
+        {
+            NativeMacInMemoryPasteboard pasteboard;
+            expect (! pasteboard.containsDataType (text));
+            expect (! canRead (pasteboard, text));
+
+            pasteboard.writeData ("hello", 5, text);
+            expect (pasteboard.containsDataType (text));
+            expectEquals (read (pasteboard, text), juce::String ("hello"));
+
+            pasteboard.writeData ("{}", 2, preset);
+            expect (! pasteboard.containsDataType (text));
+            expect (! canRead (pasteboard, text));
+            expectEquals (read (pasteboard, preset), juce::String ("{}"));
+
+            // A plain write drops earlier promises too
+            pasteboard.writeDataWithPromises ("hello", 5, text, { preset, rtf }, provideTypeName);
+            expect (pasteboard.containsDataType (rtf));
+
+            pasteboard.writeData ("bye", 3, text);
+            expect (! pasteboard.containsDataType (preset));
+            expect (! pasteboard.containsDataType (rtf));
+            expect (! canRead (pasteboard, rtf));
+
+            pasteboard.clear();
+            expect (! pasteboard.containsDataType (text));
+            expect (! canRead (pasteboard, text));
+        }
+
+        beginTest ("Promised types");
+        {
+            NativeMacInMemoryPasteboard pasteboard;
+            auto client = pasteboard.createClient();
+            std::atomic<int> numProduced { 0 };
+
+            pasteboard.writeDataWithPromises ("hello", 5, text, { preset, rtf },
+                                              [&numProduced] (const juce::String& type, juce::MemoryBlock& dest)
+                                              {
+                                                  ++numProduced;
+                                                  return provideTypeName (type, dest);
+                                              });
+
+            // Advertised, but not produced until read
+            expect (pasteboard.containsDataType (text));
+            expect (pasteboard.containsDataType (preset));
+            expect (pasteboard.containsDataType (rtf));
+            expect (! pasteboard.containsDataType ("public.png"));
+            expectEquals (numProduced.load(), 0);
+
+            // Produced once and kept, for every client
+            expectEquals (read (pasteboard, preset), preset);
+            expectEquals (read (pasteboard, preset), preset);
+            expectEquals (read (*client, preset), preset);
+            expectEquals (numProduced.load(), 1);
+
+            // Each promised type is produced separately; the written type never is
+            expectEquals (read (*client, rtf), rtf);
+            expectEquals (read (pasteboard, text), juce::String ("hello"));
+            expectEquals (numProduced.load(), 2);
+
+            expect (! canRead (pasteboard, "public.png"));
+            expectEquals (numProduced.load(), 2);
+        }
+
+        beginTest ("Promises that fail or go stale");
+        {
+            NativeMacInMemoryPasteboard pasteboard;
+            int numAttempts = 0;
+
+            // A provider that fails isn't remembered, so the next read asks again
+            pasteboard.writeDataWithPromises ("hello", 5, text, { preset },
+                                              [&numAttempts] (const juce::String&, juce::MemoryBlock&)
+                                              {
+                                                  ++numAttempts;
+                                                  return false;
+                                              });
+
+            expect (! canRead (pasteboard, preset));
+            expect (! canRead (pasteboard, preset));
+            expectEquals (numAttempts, 2);
+            expect (pasteboard.containsDataType (preset));
+
+            // Produced after someone else has written, the data goes to the reader that asked
+            // for it but doesn't become part of the new contents
+            auto otherProcess = pasteboard.createClient();
+
+            pasteboard.writeDataWithPromises ("hello", 5, text, { preset },
+                                              [otherProcess, rtf] (const juce::String& type, juce::MemoryBlock& dest)
+                                              {
+                                                  otherProcess->writeData ("{}", 2, rtf);
+                                                  return provideTypeName (type, dest);
+                                              });
+
+            expectEquals (read (pasteboard, preset), preset);
+            expect (! pasteboard.containsDataType (preset));
+            expect (! pasteboard.containsDataType (text));
+            expectEquals (read (pasteboard, rtf), juce::String ("{}"));
+        }
+
+        beginTest ("Sizes");
+        {
+            NativeMacInMemoryPasteboard pasteboard;
+            juce::MemoryBlock block;
+
+            pasteboard.writeData ("", 0, text);
+            expect (pasteboard.containsDataType (text));
+            expect (pasteboard.readData (text, copyData, &block));
+            expectEquals ((int) block.getSize(), 0);
+
+            auto random = getRandom();
+
+            for (auto size : { (size_t) 1, (size_t) 4095, (size_t) 4096, (size_t) 1 << 20 })
+            {
+                juce::MemoryBlock written (size);
+
+                for (size_t i = 0; i < size; ++i)
+                    static_cast<char*> (written.getData())[i] = (char) random.nextInt (256);
+
+                pasteboard.writeData (written.getData(), written.getSize(), preset);
+
+                expect (pasteboard.readData (preset, copyData, &block));
+                expect (block.matches (written.getData(), written.getSize()), juce::String ((juce::int64) size));
+            }
+        }
+
+        beginTest ("Statistics");
+        {
+            NativeMacInMemoryPasteboard pasteboard;
+            auto client = pasteboard.createClient();
+
+            pasteboard.writeData ("a", 1, text);
+            pasteboard.writeDataWithPromises ("a", 1, text, { preset }, provideTypeName);
+            pasteboard.containsDataType (text);
+            read (pasteboard, preset);
+            canRead (pasteboard, rtf);
+            pasteboard.getChangeCount();
+            client->getChangeCount();
+
+            auto stats = pasteboard.getStats();
+            expectEquals (stats.numWrites, (juce::int64) 2);
+            expectEquals (stats.numReads, (juce::int64) 2);
+            expectEquals (stats.numTypeQueries, (juce::int64) 1);
+            expectEquals (stats.numChangeCountQueries, (juce::int64) 1);
+
+            // Each client counts its own operations
+            expectEquals (client->getStats().numWrites, (juce::int64) 0);
+            expectEquals (client->getStats().numChangeCountQueries, (juce::int64) 1);
+
+            pasteboard.resetStats();
+            stats = pasteboard.getStats();
+            expectEquals (stats.numWrites + stats.numReads + stats.numTypeQueries + stats.numChangeCountQueries, (juce::int64) 0);
+            expectEquals (client->getStats().numChangeCountQueries, (juce::int64) 1);
+        }
+
+        beginTest ("Concurrent clients");
+        {
+            // Every write fills its data with one byte value, so a reader can tell if it sees
+            // a mix of two writes
+            constexpr int numWriters = 4, numPerWriter = 2000;
+
+            NativeMacInMemoryPasteboard pasteboard;
+            std::atomic<int> numWritersDone { 0 };
+            std::vector<std::thread> threads;
+
+            for (int i = 0; i < numWriters; ++i)
+            {
+                threads.emplace_back ([client = pasteboard.createClient(), &numWritersDone, i]
+                {
+                    char data[256];
+
+                    for (int j = 0; j < numPerWriter; ++j)
+                    {
+                        std::memset (data, (i * numPerWriter + j) & 0xff, sizeof (data));
+                        client->writeDataWithPromises (data, 1 + (size_t) (j % (int) sizeof (data)), "public.data", { "com.example.copy" },
+                                                       [] (const juce::String&, juce::MemoryBlock& dest)
+                                                       {
+                                                           dest.replaceAll ("copy", 4);
+                                                           return true;
+                                                       });
+                    }
+
+                    ++numWritersDone;
+                });
+            }
+
+            std::atomic<int> numMixed { 0 }, numBadPromises { 0 }, numBackwards { 0 };
+
+            threads.emplace_back ([client = pasteboard.createClient(), &numWritersDone, &numMixed, &numBadPromises, &numBackwards]
+            {
+                juce::MemoryBlock block;
+                auto lastChangeCount = (juce::int64) 0;
+
+                while (numWritersDone.load() < numWriters)
+                {
+                    const auto changeCount = client->getChangeCount();
+
+                    if (changeCount < lastChangeCount)
+                        ++numBackwards;
+
+                    lastChangeCount = changeCount;
+
+                    if (client->readData ("public.data", copyData, &block))
+                    {
+                        const auto* bytes = static_cast<const char*> (block.getData());
+
+                        for (size_t i = 1; i < block.getSize(); ++i)
+                            if (bytes[i] != bytes[0])
+                                ++numMixed;
+                    }
+
+                    if (client->readData ("com.example.copy", copyData, &block) && ! block.matches ("copy", 4))
+                        ++numBadPromises;
+                }
+            });
+
+            for (auto& thread : threads)
+                thread.join();
+
+            expectEquals (numMixed.load(), 0);
+            expectEquals (numBadPromises.load(), 0);
+            expectEquals (numBackwards.load(), 0);
+            expectEquals (pasteboard.getChangeCount(), (juce::int64) (numWriters * numPerWriter));
+        }
+    }
+
+private:
+    static bool provideTypeName (const juce::String& type, juce::MemoryBlock& dest)
+    {
+        dest.replaceAll (type.toRawUTF8(), type.getNumBytesAsUTF8());
+        return true;
+    }
+
+    static void copyData (void* context, const void* data, size_t size)
+    {
+        static_cast<juce::MemoryBlock*> (context)->replaceAll (data, size);
+    }
+
+    static bool canRead (NativeMacPasteboardBackend& pasteboard, const juce::String& type)
+    {
+        juce::MemoryBlock block;
+        return pasteboard.readData (type, copyData, &block);
+    }
+
+    static juce::String read (NativeMacPasteboardBackend& pasteboard, const juce::String& type)
+    {
+        juce::MemoryBlock block;
+
+        if (! pasteboard.readData (type, copyData, &block))
+            return {};
+
+        return juce::String::fromUTF8 (static_cast<const char*> (block.getData()), (int) block.getSize());
+    }
+};
+
+static NativeMacInMemoryPasteboardTests nativeMacInMemoryPasteboardTests;
+
+#endif
+
+} // namespace juce
+
+#endif // JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
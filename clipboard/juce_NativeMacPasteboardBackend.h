@@ -0,0 +1,159 @@
+/*******************************************************************************
+ Pasteboard backends
+
+ The interface NativeMacPasteboard talks to, plus a thread-safe in-memory
+ implementation that works on every platform.
+*******************************************************************************/
+
+#pragma once
+
+#if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    The storage that NativeMacPasteboard reads from and writes to.
+
+    On macOS the default backend wraps [NSPasteboard generalPasteboard]. Other
+    implementations can be installed with NativeMacPasteboard::setBackend(),
+    e.g. a NativeMacInMemoryPasteboard to exercise clipboard code without a
+    window server.
+
+    Implementations must be safe to call from any thread.
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacPasteboardBackend
+{
+public:
+    //==============================================================================
+    virtual ~NativeMacPasteboardBackend() = default;
+
+    /** Receives a read-only view of pasteboard data for the duration of the call. */
+    using DataVisitorFunction = void (*) (void* context, const void* data, size_t size);
+
+    //==============================================================================
+    /** Replaces the pasteboard contents with data of a single type.
+
+        Like declareTypes:owner:, this clears any other types and bumps the
+        change count.
+
+        @returns the change count after the write
+    */
+    virtual juce::int64 writeData (const void* data, size_t size, const juce::String& typeUTI) = 0;
+
+    /** Produces the data for a promised type on demand. */
+    using DataProvider = std::function<bool (const juce::String& typeUTI, juce::MemoryBlock& dest)>;
+
+    /** Writes data of one type and promises further types, whose data is only
+        produced by the provider if a reader actually asks for it.
+
+        The default implementation ignores the promises and just writes the data.
+
+        @returns the change count after the write
+    */
+    virtual juce::int64 writeDataWithPromises (const void* data, size_t size, const juce::String& typeUTI,
+                                               const juce::StringArray& promisedTypes,
+                                               DataProvider provider)
+    {
+        juce::ignoreUnused (promisedTypes, provider);
+        return writeData (data, size, typeUTI);
+    }
+
+    /** Returns true if the pasteboard holds data of the given type. */
+    virtual bool containsDataType (const juce::String& typeUTI) = 0;
+
+    /** Calls the visitor with the data of the given type.
+
+        @returns false (without calling the visitor) if there is no data of this type
+    */
+    virtual bool readData (const juce::String& typeUTI,
+                           DataVisitorFunction visitorFunction,
+                           void* context) = 0;
+
+    /** Returns the pasteboard's change count, which increases whenever its contents change. */
+    virtual juce::int64 getChangeCount() = 0;
+};
+
+//==============================================================================
+/**
+    A thread-safe pasteboard held in memory.
+
+    It behaves like the system pasteboard - one set of contents, a change count
+    that increases on every write, promised types that are produced on first
+    read - without touching any platform API.
+
+    createClient() returns further backends attached to the same contents, which
+    lets a test simulate several processes sharing one clipboard. Every client
+    counts the operations made through it.
+
+    @code
+    auto pasteboard = std::make_shared<juce::NativeMacInMemoryPasteboard>();
+    juce::NativeMacPasteboard::setBackend (pasteboard);
+
+    auto otherProcess = pasteboard->createClient();
+    otherProcess->writeData ("x", 1, "public.utf8-plain-text");
+    @endcode
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacInMemoryPasteboard  : public NativeMacPasteboardBackend
+{
+public:
+    //==============================================================================
+    /** Creates an empty pasteboard with a change count of 0. */
+    NativeMacInMemoryPasteboard();
+
+    /** Destructor. */
+    ~NativeMacInMemoryPasteboard() override;
+
+    //==============================================================================
+    /** Creates another client sharing this pasteboard's contents and change count. */
+    std::shared_ptr<NativeMacInMemoryPasteboard> createClient() const;
+
+    /** Clears the contents, bumping the change count. */
+    void clear();
+
+    //==============================================================================
+    /** Operation counts for one client. */
+    struct Stats
+    {
+        juce::int64 numWrites = 0;
+        juce::int64 numReads = 0;
+        juce::int64 numTypeQueries = 0;
+        juce::int64 numChangeCountQueries = 0;
+    };
+
+    /** Returns the number of operations made through this client. */
+    Stats getStats() const noexcept;
+
+    /** Resets this client's operation counts. */
+    void resetStats() noexcept;
+
+    //==============================================================================
+    juce::int64 writeData (const void* data, size_t size, const juce::String& typeUTI) override;
+    juce::int64 writeDataWithPromises (const void* data, size_t size, const juce::String& typeUTI,
+                                       const juce::StringArray& promisedTypes, DataProvider provider) override;
+    bool containsDataType (const juce::String& typeUTI) override;
+    bool readData (const juce::String& typeUTI, DataVisitorFunction, void* context) override;
+    juce::int64 getChangeCount() override;
+
+private:
+    //==============================================================================
+    struct SharedContents;
+
+    explicit NativeMacInMemoryPasteboard (std::shared_ptr<SharedContents>);
+
+    std::shared_ptr<SharedContents> contents;
+
+    std::atomic<juce::int64> numWrites { 0 }, numReads { 0 },
+                             numTypeQueries { 0 }, numChangeCountQueries { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacInMemoryPasteboard)
+};
+
+} // namespace juce
+
+#endif // JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
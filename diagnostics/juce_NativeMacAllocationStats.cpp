@@ -0,0 +1,427 @@
+/*******************************************************************************
+ Allocation counting - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+namespace AllocationStatsHelpers
+{
+    // Plain data, so the first access on a thread never runs a constructor (or
+    // allocates) from inside operator new
+    struct ThreadCounts
+    {
+        juce::int64 numAllocations;
+        juce::int64 numBytes;
+        juce::int64 numNativeObjects;
+        juce::int64 numNativeBytes;
+    };
+
+    static thread_local ThreadCounts threadCounts;
+
+    struct Entry
+    {
+        juce::SpinLock lock;
+        NativeMacAllocationStats::CallStats stats;
+    };
+
+    static Entry& getEntry (NativeMacAllocationStats::Function function) noexcept
+    {
+        static Entry entries[NativeMacAllocationStats::numFunctions];
+
+        const auto index = (int) function;
+        jassert (isPositiveAndBelow (index, NativeMacAllocationStats::numFunctions));
+
+        return entries[jlimit (0, NativeMacAllocationStats::numFunctions - 1, index)];
+    }
+
+    static void add (NativeMacAllocationStats::Counts& target, const NativeMacAllocationStats::Counts& source) noexcept
+    {
+        target.numAllocations   += source.numAllocations;
+        target.numBytes         += source.numBytes;
+        target.numNativeObjects += source.numNativeObjects;
+        target.numNativeBytes   += source.numNativeBytes;
+    }
+
+   #if JUCE_NATIVE_MACOS_ENABLE_ALLOCATION_COUNTING
+    static void countAllocation (size_t numBytes) noexcept
+    {
+        auto& counts = threadCounts;
+        ++counts.numAllocations;
+        counts.numBytes += (juce::int64) numBytes;
+    }
+   #endif
+}
+
+//==============================================================================
+NativeMacAllocationStats::CallStats NativeMacAllocationStats::getCallStats (Function function) noexcept
+{
+    auto& entry = AllocationStatsHelpers::getEntry (function);
+
+    const juce::SpinLock::ScopedLockType sl (entry.lock);
+    return entry.stats;
+}
+
+const char* NativeMacAllocationStats::getFunctionName (Function function) noexcept
+{
+    switch (function)
+    {
+        case Function::showTextInputDialog:         return "showTextInputDialog";
+        case Function::showInfoDialog:              return "showInfoDialog";
+        case Function::showConfirmDialog:           return "showConfirmDialog";
+        case Function::showFormDialog:              return "showFormDialog";
+        case Function::showAlertTemplate:           return "showAlertTemplate";
+        case Function::showPopupMenu:               return "showPopupMenu";
+        case Function::showPopupMenuAt:             return "showPopupMenuAt";
+        case Function::showPopupMenuAtFixed:        return "showPopupMenuAtFixed";
+        case Function::copyDataToClipboard:         return "copyDataToClipboard";
+        case Function::fetchDataFromClipboard:      return "fetchDataFromClipboard";
+        case Function::getClipboardDataSize:        return "getClipboardDataSize";
+        case Function::visitClipboardData:          return "visitClipboardData";
+        case Function::clipboardContainsDataType:   return "clipboardContainsDataType";
+        default:                                    break;
+    }
+
+    return "";
+}
+
+void NativeMacAllocationStats::resetAll() noexcept
+{
+    for (int function = 0; function < numFunctions; ++function)
+    {
+        auto& entry = AllocationStatsHelpers::getEntry ((Function) function);
+
+        const juce::SpinLock::ScopedLockType sl (entry.lock);
+        entry.stats = {};
+    }
+}
+
+//==============================================================================
+NativeMacAllocationStats::Counts NativeMacAllocationStats::getThreadCounts() noexcept
+{
+    const auto& counts = AllocationStatsHelpers::threadCounts;
+
+    Counts result;
+    result.numAllocations   = counts.numAllocations;
+    result.numBytes         = counts.numBytes;
+    result.numNativeObjects = counts.numNativeObjects;
+    result.numNativeBytes   = counts.numNativeBytes;
+    return result;
+}
+
+void NativeMacAllocationStats::noteNativeObject (size_t numBytes) noexcept
+{
+   #if JUCE_NATIVE_MACOS_ENABLE_ALLOCATION_COUNTING
+    auto& counts = AllocationStatsHelpers::threadCounts;
+    ++counts.numNativeObjects;
+    counts.numNativeBytes += (juce::int64) numBytes;
+   #else
+    ignoreUnused (numBytes);
+   #endif
+}
+
+//==============================================================================
+NativeMacAllocationStats::Scope::Scope() noexcept
+    : start (getThreadCounts())
+{
+}
+
+NativeMacAllocationStats::Counts NativeMacAllocationStats::Scope::getCounts() const noexcept
+{
+    const auto now = getThreadCounts();
+
+    Counts result;
+    result.numAllocations   = now.numAllocations   - start.numAllocations;
+    result.numBytes         = now.numBytes         - start.numBytes;
+    result.numNativeObjects = now.numNativeObjects - start.numNativeObjects;
+    result.numNativeBytes   = now.numNativeBytes   - start.numNativeBytes;
+    return result;
+}
+
+//==============================================================================
+NativeMacAllocationStats::ScopedCall::ScopedCall (Function functionToCount) noexcept
+    : function (functionToCount)
+{
+}
+
+NativeMacAllocationStats::ScopedCall::~ScopedCall()
+{
+    // Nested calls are included in the outer call's counts, as they are part of its cost
+    const auto counts = scope.getCounts();
+    auto& entry = AllocationStatsHelpers::getEntry (function);
+
+    const juce::SpinLock::ScopedLockType sl (entry.lock);
+
+    ++entry.stats.numCalls;
+
+    if (! counts.isZero())
+        ++entry.stats.numAllocatingCalls;
+
+    entry.stats.lastCall = counts;
+    AllocationStatsHelpers::add (entry.stats.total, counts);
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacAllocationStatsTests  : public juce::UnitTest
+{
+public:
+    NativeMacAllocationStatsTests()
+        : juce::UnitTest ("NativeMacAllocationStats", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        using Stats = NativeMacAllocationStats;
+        const auto enabled = Stats::isEnabled();
+
+        beginTest ("Scope");
+        {
+            Stats::Scope scope;
+            expect (scope.getCounts().isZero());
+
+            allocate (100);
+            allocate (28);
+
+            const auto counts = scope.getCounts();
+            expectEquals (counts.numAllocations, enabled ? (juce::int64) 2 : (juce::int64) 0);
+            expectEquals (counts.numBytes, enabled ? (juce::int64) 128 : (juce::int64) 0);
+            expectEquals (counts.numNativeObjects, (juce::int64) 0);
+
+            // Counts only grow while the scope exists
+            Stats::Scope inner;
+            Stats::noteNativeObject (64);
+
+            expectEquals (inner.getCounts().numAllocations, (juce::int64) 0);
+            expectEquals (inner.getCounts().numNativeObjects, enabled ? (juce::int64) 1 : (juce::int64) 0);
+            expectEquals (inner.getCounts().numNativeBytes, enabled ? (juce::int64) 64 : (juce::int64) 0);
+            expectEquals (scope.getCounts().numNativeObjects, inner.getCounts().numNativeObjects);
+            expect (inner.getCounts().isZero() != enabled);
+        }
+
+        beginTest ("Other threads aren't counted");
+        {
+            Stats::Counts otherThreadCounts;
+            juce::WaitableEvent started, finished;
+
+            // Started before the scope, as creating a thread allocates on the creating thread
+            std::thread thread ([&]
+            {
+                started.wait();
+
+                const Stats::Scope otherScope;
+                allocate (1000);
+                otherThreadCounts = otherScope.getCounts();
+
+                finished.signal();
+            });
+
+            {
+                Stats::Scope scope;
+                started.signal();
+                finished.wait();
+
+                expect (scope.getCounts().isZero());
+            }
+
+            thread.join();
+            expectEquals (otherThreadCounts.numBytes, enabled ? (juce::int64) 1000 : (juce::int64) 0);
+        }
+
+        beginTest ("Call stats");
+        {
+            Stats::resetAll();
+
+            constexpr auto function = Stats::Function::showInfoDialog;
+
+            {
+                const Stats::ScopedCall call (function);
+                allocate (10);
+
+                // Nested calls count towards the outer call too
+                const Stats::ScopedCall nested (Stats::Function::showConfirmDialog);
+                allocate (20);
+            }
+
+            {
+                const Stats::ScopedCall call (function);
+            }
+
+            const auto stats = Stats::getCallStats (function);
+            expectEquals (stats.numCalls, (juce::int64) 2);
+            expectEquals (stats.numAllocatingCalls, enabled ? (juce::int64) 1 : (juce::int64) 0);
+            expect (stats.lastCall.isZero());
+            expectEquals (stats.total.numAllocations, enabled ? (juce::int64) 2 : (juce::int64) 0);
+            expectEquals (stats.total.numBytes, enabled ? (juce::int64) 30 : (juce::int64) 0);
+
+            const auto nestedStats = Stats::getCallStats (Stats::Function::showConfirmDialog);
+            expectEquals (nestedStats.numCalls, (juce::int64) 1);
+            expectEquals (nestedStats.total.numBytes, enabled ? (juce::int64) 20 : (juce::int64) 0);
+
+            Stats::resetAll();
+            expectEquals (Stats::getCallStats (function).numCalls, (juce::int64) 0);
+        }
+
+        beginTest ("Function names");
+        {
+            juce::StringArray names;
+
+            for (int i = 0; i < Stats::numFunctions; ++i)
+                names.add (Stats::getFunctionName ((Stats::Function) i));
+
+            expectEquals (names[0], juce::String ("showTextInputDialog"));
+            expectEquals (names[Stats::numFunctions - 1], juce::String ("clipboardContainsDataType"));
+
+            names.removeDuplicates (false);
+            names.removeEmptyStrings();
+            expectEquals (names.size(), Stats::numFunctions);
+        }
+
+       #if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+        beginTest ("Clipboard calls");
+        {
+            const auto previousBackend = NativeMacPasteboard::getBackend();
+            NativeMacPasteboard::setBackend (std::make_shared<NativeMacInMemoryPasteboard>());
+
+            const juce::String type ("com.example.preset");
+            const char data[] = "preset data";
+            char buffer[64];
+            size_t bytesNeeded = 0;
+
+            NativeMacPasteboard::copyDataToClipboard (data, sizeof (data), type);
+            Stats::resetAll();
+
+            {
+                // The caller-supplied buffer version doesn't allocate
+                Stats::Scope scope;
+                expect (NativeMacPasteboard::fetchDataFromClipboard (buffer, sizeof (buffer), bytesNeeded, type));
+                expect (scope.getCounts().isZero());
+            }
+
+            expectEquals ((int) bytesNeeded, (int) sizeof (data));
+
+            // The entry points record themselves only when counting is enabled
+            const auto stats = Stats::getCallStats (Stats::Function::fetchDataFromClipboard);
+            expectEquals (stats.numCalls, enabled ? (juce::int64) 1 : (juce::int64) 0);
+            expectEquals (stats.numAllocatingCalls, (juce::int64) 0);
+
+            Stats::resetAll();
+            NativeMacPasteboard::setBackend (previousBackend);
+        }
+       #endif
+    }
+
+private:
+    // Allocates through a pointer the optimiser can't see through, so the new and
+    // delete aren't elided
+    static void allocate (size_t numBytes)
+    {
+        static char* volatile sink = nullptr;
+
+        sink = new char[numBytes];
+        delete[] sink;
+    }
+};
+
+static NativeMacAllocationStatsTests nativeMacAllocationStatsTests;
+
+#endif
+
+} // namespace juce
+
+//==============================================================================
+#if JUCE_NATIVE_MACOS_ENABLE_ALLOCATION_COUNTING
+
+namespace juce
+{
+namespace AllocationStatsHelpers
+{
+    constexpr auto defaultAlignment = alignof (std::max_align_t);
+
+    static void* allocate (std::size_t size, std::size_t alignment = defaultAlignment)
+    {
+        countAllocation (size);
+
+        if (size == 0)
+            size = 1;
+
+        for (;;)
+        {
+           #if JUCE_WINDOWS
+            if (auto* ptr = _aligned_malloc (size, alignment))
+                return ptr;
+           #else
+            void* ptr = nullptr;
+
+            if (alignment <= defaultAlignment ? (ptr = std::malloc (size)) != nullptr
+                                              : posix_memalign (&ptr, alignment, size) == 0)
+                return ptr;
+           #endif
+
+            if (auto handler = std::get_new_handler())
+                handler();
+            else
+                throw std::bad_alloc();
+        }
+    }
+
+    static void* allocateNoThrow (std::size_t size, std::size_t alignment = defaultAlignment) noexcept
+    {
+        try
+        {
+            return allocate (size, alignment);
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    static void deallocate (void* ptr) noexcept
+    {
+       #if JUCE_WINDOWS
+        _aligned_free (ptr);
+       #else
+        std::free (ptr);
+       #endif
+    }
+}
+}
+
+// Every form is replaced, not just the ones the others forward to by default,
+// as sanitizers and some runtimes supply their own sized and array versions
+void* operator new   (std::size_t size)                                 { return juce::AllocationStatsHelpers::allocate (size); }
+void* operator new[] (std::size_t size)                                 { return juce::AllocationStatsHelpers::allocate (size); }
+void* operator new   (std::size_t size, const std::nothrow_t&) noexcept { return juce::AllocationStatsHelpers::allocateNoThrow (size); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept { return juce::AllocationStatsHelpers::allocateNoThrow (size); }
+
+void* operator new   (std::size_t size, std::align_val_t alignment)     { return juce::AllocationStatsHelpers::allocate (size, (std::size_t) alignment); }
+void* operator new[] (std::size_t size, std::align_val_t alignment)     { return juce::AllocationStatsHelpers::allocate (size, (std::size_t) alignment); }
+
+void* operator new (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return juce::AllocationStatsHelpers::allocateNoThrow (size, (std::size_t) alignment);
+}
+
+void* operator new[] (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return juce::AllocationStatsHelpers::allocateNoThrow (size, (std::size_t) alignment);
+}
+
+void operator delete   (void* ptr) noexcept                                           { juce::AllocationStatsHelpers::deallocate (ptr); }
+void operator delete[] (void* ptr) noexcept                                           { juce::AllocationStatsHelpers::deallocate (ptr); }
+void operator delete   (void* ptr, std::size_t) noexcept                              { juce::AllocationStatsHelpers::deallocate (ptr); }
+void operator delete[] (void* ptr, std::size_t) noexcept                              { juce::AllocationStatsHelpers::deallocate (ptr); }
+void operator delete   (void* ptr, const std::nothrow_t&) noexcept                    { juce::AllocationStatsHelpers::deallocate (ptr); }
+void operator delete[] (void* ptr, const std::nothrow_t&) noexcept                    { juce::AllocationStatsHelpers::deallocate (ptr); }
+void operator delete   (void* ptr, std::align_val_t) noexcept                         { juce::AllocationStatsHelpers::deallocate (ptr); }
+void operator delete[] (void* ptr, std::align_val_t) noexcept                         { juce::AllocationStatsHelpers::deallocate (ptr); }
+void operator delete   (void* ptr, std::size_t, std::align_val_t) noexcept            { juce::AllocationStatsHelpers::deallocate (ptr); }
+void operator delete[] (void* ptr, std::size_t, std::align_val_t) noexcept            { juce::AllocationStatsHelpers::deallocate (ptr); }
+void operator delete   (void* ptr, std::align_val_t, const std::nothrow_t&) noexcept  { juce::AllocationStatsHelpers::deallocate (ptr); }
+void operator delete[] (void* ptr, std::align_val_t, const std::nothrow_t&) noexcept  { juce::AllocationStatsHelpers::deallocate (ptr); }
+
+#endif
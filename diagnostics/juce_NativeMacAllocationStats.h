@@ -0,0 +1,161 @@
+/*******************************************************************************
+ Allocation counting
+
+ Heap allocations and native objects created by each public dialog, menu and
+ clipboard call, for test and profiling builds.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Counts how many heap allocations, and how many bytes, each public call of
+    the module costs.
+
+    When the module is compiled with JUCE_NATIVE_MACOS_ENABLE_ALLOCATION_COUNTING=1,
+    the module replaces the global operator new and delete with versions that
+    count every allocation on the calling thread, and the macOS backends
+    report each Objective-C object they create (the NSMenu and its items,
+    alerts, accessory views, ...). Every public dialog, menu and clipboard call
+    then records what it cost:
+
+    @code
+    using Stats = juce::NativeMacAllocationStats;
+
+    juce::NativeMacPopupMenu::showPopupMenuAt (presetMenu, position);
+
+    auto stats = Stats::getCallStats (Stats::Function::showPopupMenuAt);
+    DBG (stats.lastCall.numAllocations << " allocations, " << stats.lastCall.numNativeObjects << " native objects");
+    @endcode
+
+    A Scope counts everything on the current thread between two points, which
+    lets a test assert that a hot path doesn't allocate, e.g. with a mock
+    backend on Linux:
+
+    @code
+    juce::NativeMacAllocationStats::Scope scope;
+    juce::NativeMacPasteboard::fetchDataFromClipboard (buffer, numBytes, "com.example.preset");
+    jassert (scope.getCounts().isZero());
+    @endcode
+
+    Only allocations on the calling thread are counted, so work a call hands
+    to other threads isn't included, and native objects are those the module
+    creates itself, not AppKit's internal allocations.
+
+    The replacement operators apply to the whole program, so only enable the
+    flag in test and profiling builds, and not if the app already replaces
+    operator new. With the flag off nothing is counted, every count reads 0
+    and the per-call macro expands to nothing.
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacAllocationStats
+{
+public:
+    //==============================================================================
+    enum class Function
+    {
+        showTextInputDialog,
+        showInfoDialog,
+        showConfirmDialog,
+        showFormDialog,
+        showAlertTemplate,            /**< NativeMacAlertTemplate::show() and showTextInput(). */
+        showPopupMenu,
+        showPopupMenuAt,
+        showPopupMenuAtFixed,
+        copyDataToClipboard,          /**< All overloads. */
+        fetchDataFromClipboard,       /**< All overloads. */
+        getClipboardDataSize,
+        visitClipboardData,
+        clipboardContainsDataType
+    };
+
+    static constexpr int numFunctions = 13;
+
+    struct Counts
+    {
+        juce::int64 numAllocations = 0;      /**< Calls of operator new. */
+        juce::int64 numBytes = 0;            /**< Bytes requested from operator new. */
+        juce::int64 numNativeObjects = 0;    /**< Objective-C objects created by the module. */
+        juce::int64 numNativeBytes = 0;      /**< The instance sizes of those objects. */
+
+        bool isZero() const noexcept         { return numAllocations == 0 && numNativeObjects == 0; }
+    };
+
+    struct CallStats
+    {
+        juce::int64 numCalls = 0;
+        juce::int64 numAllocatingCalls = 0;  /**< Calls whose counts weren't zero. */
+        Counts lastCall;
+        Counts total;
+    };
+
+    //==============================================================================
+    /** Returns true if the module was built with JUCE_NATIVE_MACOS_ENABLE_ALLOCATION_COUNTING. */
+    static constexpr bool isEnabled() noexcept     { return JUCE_NATIVE_MACOS_ENABLE_ALLOCATION_COUNTING != 0; }
+
+    /** Returns what the calls of a function have cost so far. */
+    static CallStats getCallStats (Function function) noexcept;
+
+    /** Returns the function's name, e.g. "fetchDataFromClipboard". */
+    static const char* getFunctionName (Function function) noexcept;
+
+    /** Resets the stats of every function. */
+    static void resetAll() noexcept;
+
+    //==============================================================================
+    /** Returns everything counted on the calling thread since it started. */
+    static Counts getThreadCounts() noexcept;
+
+    /** Counts a native object created on the calling thread. Custom backends can
+        call this for the objects they create.
+    */
+    static void noteNativeObject (size_t numBytes) noexcept;
+
+    //==============================================================================
+    /** Counts what the calling thread allocates while this object exists. */
+    class JUCE_API  Scope
+    {
+    public:
+        Scope() noexcept;
+
+        /** Returns the counts since construction. Call it on the thread that created the scope. */
+        Counts getCounts() const noexcept;
+
+    private:
+        const Counts start;
+
+        JUCE_DECLARE_NON_COPYABLE (Scope)
+    };
+
+    /** Adds what the calling thread allocates while this object exists to a function's stats. */
+    class JUCE_API  ScopedCall
+    {
+    public:
+        explicit ScopedCall (Function functionToCount) noexcept;
+        ~ScopedCall();
+
+    private:
+        const Function function;
+        const Scope scope;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedCall)
+    };
+
+private:
+    NativeMacAllocationStats() = delete;
+};
+
+} // namespace juce
+
+//==============================================================================
+/** Adds the rest of the enclosing scope to a function's allocation stats, when counting is enabled. */
+#if JUCE_NATIVE_MACOS_ENABLE_ALLOCATION_COUNTING
+ #define JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS(function) \
+    const juce::NativeMacAllocationStats::ScopedCall JUCE_JOIN_MACRO (nativeMacAllocationCall_, __LINE__) (juce::NativeMacAllocationStats::Function::function)
+#else
+ #define JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS(function)
+#endif
@@ -0,0 +1,475 @@
+/*******************************************************************************
+ Latency histograms - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+namespace LatencyHistogramHelpers
+{
+    constexpr int subBucketCount = 1 << NativeMacLatencyHistogram::subBucketBits;
+    constexpr int subBucketHalfCount = subBucketCount / 2;
+
+    static int getHighestBit (juce::uint64 value) noexcept
+    {
+        const auto high = (juce::uint32) (value >> 32);
+
+        return high != 0 ? 32 + juce::findHighestSetBit (high)
+                         : juce::findHighestSetBit ((juce::uint32) value);
+    }
+
+    static double toMilliseconds (juce::int64 microseconds) noexcept
+    {
+        return (double) microseconds * 0.001;
+    }
+}
+
+//==============================================================================
+NativeMacLatencyHistogram::NativeMacLatencyHistogram() noexcept
+{
+    for (auto& bucket : buckets)
+        bucket.store (0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+int NativeMacLatencyHistogram::getBucketIndex (juce::int64 microseconds) noexcept
+{
+    using namespace LatencyHistogramHelpers;
+
+    const auto value = (juce::uint64) jlimit ((juce::int64) 0, maxTrackableMicroseconds, microseconds);
+
+    if (value < (juce::uint64) subBucketCount)
+        return (int) value;
+
+    // Each power of two from subBucketCount up holds subBucketHalfCount buckets
+    const auto shift = getHighestBit (value) - subBucketBits + 1;
+    return shift * subBucketHalfCount + (int) (value >> shift);
+}
+
+juce::int64 NativeMacLatencyHistogram::getBucketLowestValue (int bucketIndex) noexcept
+{
+    using namespace LatencyHistogramHelpers;
+
+    if (bucketIndex < subBucketCount)
+        return bucketIndex;
+
+    const auto shift = bucketIndex / subBucketHalfCount - 1;
+    const auto subBucket = bucketIndex % subBucketHalfCount + subBucketHalfCount;
+    return (juce::int64) subBucket << shift;
+}
+
+juce::int64 NativeMacLatencyHistogram::getBucketHighestValue (int bucketIndex) noexcept
+{
+    using namespace LatencyHistogramHelpers;
+
+    if (bucketIndex < subBucketCount)
+        return bucketIndex;
+
+    const auto shift = bucketIndex / subBucketHalfCount - 1;
+    return getBucketLowestValue (bucketIndex) + ((juce::int64) 1 << shift) - 1;
+}
+
+//==============================================================================
+void NativeMacLatencyHistogram::record (juce::int64 microseconds) noexcept
+{
+    microseconds = jlimit ((juce::int64) 0, maxTrackableMicroseconds, microseconds);
+
+    buckets[getBucketIndex (microseconds)].fetch_add (1, std::memory_order_relaxed);
+    sumMicroseconds.fetch_add (microseconds, std::memory_order_relaxed);
+}
+
+void NativeMacLatencyHistogram::recordMilliseconds (double milliseconds) noexcept
+{
+    record ((juce::int64) std::llround (jlimit (0.0, (double) maxTrackableMicroseconds, milliseconds * 1000.0)));
+}
+
+//==============================================================================
+void NativeMacLatencyHistogram::copyCounts (juce::int64* counts, juce::int64& total) const noexcept
+{
+    total = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        counts[i] = buckets[i].load (std::memory_order_relaxed);
+        total += counts[i];
+    }
+}
+
+juce::int64 NativeMacLatencyHistogram::getCount() const noexcept
+{
+    juce::int64 total = 0;
+
+    for (auto& bucket : buckets)
+        total += bucket.load (std::memory_order_relaxed);
+
+    return total;
+}
+
+double NativeMacLatencyHistogram::getPercentileMs (double percentile) const noexcept
+{
+    juce::int64 counts[numBuckets], total;
+    copyCounts (counts, total);
+
+    if (total == 0)
+        return 0.0;
+
+    // The smallest value with at least the given share of values at or below it
+    const auto target = jmax ((juce::int64) 1, (juce::int64) std::ceil (jlimit (0.0, 100.0, percentile) * 0.01 * (double) total));
+    juce::int64 cumulative = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        cumulative += counts[i];
+
+        if (cumulative >= target)
+            return LatencyHistogramHelpers::toMilliseconds (getBucketHighestValue (i));
+    }
+
+    return LatencyHistogramHelpers::toMilliseconds (maxTrackableMicroseconds);
+}
+
+NativeMacLatencyHistogram::Summary NativeMacLatencyHistogram::getSummary() const noexcept
+{
+    using namespace LatencyHistogramHelpers;
+
+    juce::int64 counts[numBuckets], total;
+    copyCounts (counts, total);
+
+    Summary summary;
+    summary.count = total;
+
+    if (total == 0)
+        return summary;
+
+    summary.meanMs = toMilliseconds (sumMicroseconds.load (std::memory_order_relaxed)) / (double) total;
+
+    // All percentiles in one pass over the same copy, so they agree with each other
+    const double percentiles[] = { 50.0, 90.0, 99.0 };
+    double* results[] = { &summary.p50Ms, &summary.p90Ms, &summary.p99Ms };
+
+    juce::int64 cumulative = 0;
+    size_t next = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        if (counts[i] == 0)
+            continue;
+
+        cumulative += counts[i];
+
+        for (; next < std::size (percentiles)
+                 && cumulative >= jmax ((juce::int64) 1, (juce::int64) std::ceil (percentiles[next] * 0.01 * (double) total)); ++next)
+            *results[next] = toMilliseconds (getBucketHighestValue (i));
+
+        summary.maxMs = toMilliseconds (getBucketHighestValue (i));
+    }
+
+    return summary;
+}
+
+void NativeMacLatencyHistogram::reset() noexcept
+{
+    for (auto& bucket : buckets)
+        bucket.store (0, std::memory_order_relaxed);
+
+    sumMicroseconds.store (0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+namespace LatencyStatsHelpers
+{
+    static NativeMacLatencyHistogram& getHistogram (int function, int measure) noexcept
+    {
+        static NativeMacLatencyHistogram histograms[NativeMacLatencyStats::numFunctions][2];
+        return histograms[function][measure];
+    }
+}
+
+NativeMacLatencyHistogram& NativeMacLatencyStats::getHistogram (Function function, Measure measure) noexcept
+{
+    jassert (isPositiveAndBelow ((int) function, numFunctions));
+    return LatencyStatsHelpers::getHistogram ((int) function, (int) measure);
+}
+
+NativeMacLatencyHistogram::Summary NativeMacLatencyStats::getSummary (Function function, Measure measure) noexcept
+{
+    return getHistogram (function, measure).getSummary();
+}
+
+const char* NativeMacLatencyStats::getFunctionName (Function function) noexcept
+{
+    switch (function)
+    {
+        case Function::showTextInputDialog:     return "showTextInputDialog";
+        case Function::showInfoDialog:          return "showInfoDialog";
+        case Function::showConfirmDialog:       return "showConfirmDialog";
+        case Function::showFormDialog:          return "showFormDialog";
+        case Function::showAlertTemplate:       return "showAlertTemplate";
+        case Function::showPopupMenu:           return "showPopupMenu";
+        case Function::showPopupMenuAt:         return "showPopupMenuAt";
+        case Function::showPopupMenuAtFixed:    return "showPopupMenuAtFixed";
+        default:                                break;
+    }
+
+    return "";
+}
+
+void NativeMacLatencyStats::resetAll() noexcept
+{
+    for (int function = 0; function < numFunctions; ++function)
+        for (auto measure : { Measure::timeToVisible, Measure::timeToResult })
+            getHistogram ((Function) function, measure).reset();
+}
+
+//==============================================================================
+NativeMacLatencyStats::ScopedCall::ScopedCall (Function f) noexcept
+    : function (f),
+      startTicks (juce::Time::getHighResolutionTicks())
+{
+}
+
+NativeMacLatencyStats::ScopedCall::~ScopedCall()
+{
+    const auto elapsed = juce::Time::getHighResolutionTicks() - startTicks;
+    getHistogram (function, Measure::timeToResult)
+        .record ((juce::int64) (juce::Time::highResolutionTicksToSeconds (elapsed) * 1.0e6));
+}
+
+std::function<void()> NativeMacLatencyStats::ScopedCall::getOpenedCallback()
+{
+    return [this]
+    {
+        // Only the first call counts, in case a backend reports the same window twice
+        if (hasOpened.exchange (true))
+            return;
+
+        const auto elapsed = juce::Time::getHighResolutionTicks() - startTicks;
+        getHistogram (function, Measure::timeToVisible)
+            .record ((juce::int64) (juce::Time::highResolutionTicksToSeconds (elapsed) * 1.0e6));
+    };
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacLatencyHistogramTests  : public juce::UnitTest
+{
+public:
+    NativeMacLatencyHistogramTests()
+        : juce::UnitTest ("NativeMacLatencyHistogram", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        using Histogram = NativeMacLatencyHistogram;
+
+        beginTest ("Buckets");
+        {
+            for (int i = 0; i < 32; ++i)
+            {
+                expectEquals (Histogram::getBucketIndex (i), i);
+                expectEquals (Histogram::getBucketHighestValue (i), (juce::int64) i);
+            }
+
+            // Contiguous, each within 1/16 of its values, and covering the whole range
+            bool consistent = true;
+
+            for (int i = 0; i < Histogram::numBuckets; ++i)
+            {
+                const auto lowest = Histogram::getBucketLowestValue (i);
+                const auto highest = Histogram::getBucketHighestValue (i);
+
+                consistent = consistent
+                              && Histogram::getBucketIndex (lowest) == i
+                              && Histogram::getBucketIndex (highest) == i
+                              && (i == 0 || lowest == Histogram::getBucketHighestValue (i - 1) + 1)
+                              && (i < 32 || (highest - lowest + 1) * 16 <= lowest);
+            }
+
+            expect (consistent);
+            expectEquals (Histogram::getBucketLowestValue (0), (juce::int64) 0);
+            expectEquals (Histogram::getBucketHighestValue (Histogram::numBuckets - 1), Histogram::maxTrackableMicroseconds);
+
+            expectEquals (Histogram::getBucketIndex (32), 32);
+            expectEquals (Histogram::getBucketIndex (33), 32);
+            expectEquals (Histogram::getBucketIndex (64), 48);
+            expectEquals (Histogram::getBucketIndex (-5), 0);
+            expectEquals (Histogram::getBucketIndex (std::numeric_limits<juce::int64>::max()), Histogram::numBuckets - 1);
+
+            auto random = getRandom();
+
+            for (int i = 0; i < 10000; ++i)
+            {
+                const auto value = random.nextInt64() & Histogram::maxTrackableMicroseconds;
+                const auto index = Histogram::getBucketIndex (value);
+
+                if (Histogram::getBucketLowestValue (index) > value || Histogram::getBucketHighestValue (index) < value)
+                {
+                    expect (false, "value " + juce::String (value) + " is outside its bucket");
+                    break;
+                }
+            }
+        }
+
+        beginTest ("Empty");
+        {
+            Histogram histogram;
+            const auto summary = histogram.getSummary();
+
+            expectEquals (summary.count, (juce::int64) 0);
+            expectEquals (summary.maxMs, 0.0);
+            expectEquals (histogram.getPercentileMs (50.0), 0.0);
+        }
+
+        beginTest ("Percentiles");
+        {
+            Histogram histogram;
+
+            for (int i = 100; i >= 1; --i)
+                histogram.record (i);
+
+            // Reported as the highest value of the bucket: 50 is in [50, 51], 90 in [88, 91], ...
+            const auto summary = histogram.getSummary();
+            expectEquals (summary.count, (juce::int64) 100);
+            expectWithinAbsoluteError (summary.meanMs, 0.0505, 1.0e-9);
+            expectWithinAbsoluteError (summary.p50Ms, 0.051, 1.0e-9);
+            expectWithinAbsoluteError (summary.p90Ms, 0.091, 1.0e-9);
+            expectWithinAbsoluteError (summary.p99Ms, 0.099, 1.0e-9);
+            expectWithinAbsoluteError (summary.maxMs, 0.103, 1.0e-9);
+
+            expectEquals (histogram.getPercentileMs (50.0), summary.p50Ms);
+            expectEquals (histogram.getPercentileMs (90.0), summary.p90Ms);
+            expectEquals (histogram.getPercentileMs (99.0), summary.p99Ms);
+            expectWithinAbsoluteError (histogram.getPercentileMs (0.0), 0.001, 1.0e-9);
+            expectEquals (histogram.getPercentileMs (100.0), summary.maxMs);
+            expectEquals (histogram.getPercentileMs (250.0), summary.maxMs);
+
+            histogram.reset();
+            expectEquals (histogram.getCount(), (juce::int64) 0);
+            expectEquals (histogram.getSummary().meanMs, 0.0);
+        }
+
+        beginTest ("Milliseconds and clamping");
+        {
+            Histogram histogram;
+            histogram.recordMilliseconds (4.2);
+            histogram.recordMilliseconds (-1.0);
+            histogram.record (-100);
+
+            expectEquals (histogram.getCount(), (juce::int64) 3);
+            expectWithinAbsoluteError (histogram.getSummary().meanMs, 1.4, 1.0e-9);
+            expectEquals (histogram.getPercentileMs (60.0), 0.0);
+            expectWithinAbsoluteError (histogram.getPercentileMs (100.0), 4.351, 1.0e-9);   // [4096, 4351]
+
+            histogram.recordMilliseconds (1.0e300);
+            expectEquals (histogram.getSummary().maxMs, (double) Histogram::maxTrackableMicroseconds * 0.001);
+        }
+
+        beginTest ("Precision against exact percentiles");
+        {
+            auto random = getRandom();
+
+            for (int iteration = 0; iteration < 20; ++iteration)
+            {
+                Histogram histogram;
+                std::vector<juce::int64> values;
+
+                for (int i = 1 + random.nextInt (2000); --i >= 0;)
+                {
+                    // Spread over several orders of magnitude
+                    const auto value = (juce::int64) std::pow (10.0, random.nextDouble() * 8.0);
+                    values.push_back (value);
+                    histogram.record (value);
+                }
+
+                std::sort (values.begin(), values.end());
+
+                for (auto percentile : { 1.0, 25.0, 50.0, 90.0, 99.0, 99.9, 100.0 })
+                {
+                    const auto rank = jmax ((size_t) 1, (size_t) std::ceil (percentile * 0.01 * (double) values.size()));
+                    const auto exactMs = (double) values[rank - 1] * 0.001;
+                    const auto reportedMs = histogram.getPercentileMs (percentile);
+
+                    expect (reportedMs >= exactMs - 1.0e-9 && reportedMs <= exactMs * (1.0 + 1.0 / 16.0) + 1.0e-9,
+                            "p" + juce::String (percentile) + ": " + juce::String (reportedMs) + " for " + juce::String (exactMs));
+                }
+            }
+        }
+
+        beginTest ("Concurrent recording");
+        {
+            Histogram histogram;
+            constexpr int numThreads = 8, numPerThread = 100000;
+            std::vector<std::thread> threads;
+
+            for (int i = 0; i < numThreads; ++i)
+            {
+                threads.emplace_back ([&histogram, i]
+                {
+                    for (int n = 0; n < numPerThread; ++n)
+                        histogram.record (i * 1000 + n % 1000);
+                });
+            }
+
+            // Each summary taken meanwhile must be internally consistent
+            for (int i = 0; i < 100; ++i)
+            {
+                const auto summary = histogram.getSummary();
+
+                if (summary.count > 0)
+                    expect (summary.p50Ms <= summary.p90Ms && summary.p90Ms <= summary.p99Ms && summary.p99Ms <= summary.maxMs);
+            }
+
+            for (auto& thread : threads)
+                thread.join();
+
+            expectEquals (histogram.getCount(), (juce::int64) numThreads * numPerThread);
+
+            // Thread i records i * 1000 + 0..999, averaging i * 1000 + 499.5
+            expectWithinAbsoluteError (histogram.getSummary().meanMs, 3.9995, 1.0e-9);
+        }
+
+        beginTest ("Call stats");
+        {
+            using Stats = NativeMacLatencyStats;
+
+            Stats::resetAll();
+
+            {
+                Stats::ScopedCall call (Stats::Function::showPopupMenuAt);
+                auto onOpened = call.getOpenedCallback();
+
+                onOpened();
+                onOpened();
+                juce::Thread::sleep (2);
+            }
+
+            {
+                // Never opened, e.g. an alert that failed to show
+                Stats::ScopedCall call (Stats::Function::showPopupMenuAt);
+            }
+
+            const auto visible = Stats::getSummary (Stats::Function::showPopupMenuAt, Stats::Measure::timeToVisible);
+            const auto result = Stats::getSummary (Stats::Function::showPopupMenuAt, Stats::Measure::timeToResult);
+
+            expectEquals (visible.count, (juce::int64) 1);
+            expectEquals (result.count, (juce::int64) 2);
+            expectGreaterOrEqual (result.maxMs, 2.0);
+            expectEquals (Stats::getSummary (Stats::Function::showPopupMenu, Stats::Measure::timeToResult).count, (juce::int64) 0);
+
+            expectEquals (juce::String (Stats::getFunctionName (Stats::Function::showPopupMenuAt)), juce::String ("showPopupMenuAt"));
+            expectEquals (juce::String (Stats::getFunctionName (Stats::Function::showTextInputDialog)), juce::String ("showTextInputDialog"));
+
+            Stats::resetAll();
+            expectEquals (Stats::getSummary (Stats::Function::showPopupMenuAt, Stats::Measure::timeToResult).count, (juce::int64) 0);
+        }
+    }
+};
+
+static NativeMacLatencyHistogramTests nativeMacLatencyHistogramTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,187 @@
+/*******************************************************************************
+ Latency histograms
+
+ Log-bucketed histograms of how long dialogs and menus take to appear and to
+ return, kept for every public entry point.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A histogram of durations with logarithmically sized buckets, in the style of
+    HdrHistogram.
+
+    Values are in microseconds. Below 32 us every value has its own bucket;
+    above, every power of two is split into 16 buckets, so any value is reported
+    within 1/16 (about 6%) while the whole range up to several days fits in a
+    fixed table of counters.
+
+    record() is wait-free: it is a couple of atomic increments, with no locks,
+    allocation or loops, so it can be called from any thread, including the
+    audio thread. Queries can run at the same time; they see each recorded
+    value either completely or not at all in the bucket counts.
+
+    @code
+    juce::NativeMacLatencyHistogram histogram;
+    histogram.recordMilliseconds (4.2);
+
+    auto summary = histogram.getSummary();
+    DBG ("p99: " << summary.p99Ms << " ms of " << summary.count);
+    @endcode
+
+    @see NativeMacLatencyStats
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacLatencyHistogram
+{
+public:
+    //==============================================================================
+    static constexpr int subBucketBits = 5;
+    static constexpr int numBuckets = 576;
+    static constexpr juce::int64 maxTrackableMicroseconds = ((juce::int64) 1 << 39) - 1;   /**< About 6 days; longer values are counted as this. */
+
+    /** Percentiles are reported as the highest value that falls into the same bucket. */
+    struct Summary
+    {
+        juce::int64 count = 0;
+        double meanMs = 0.0;
+        double p50Ms = 0.0;
+        double p90Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    //==============================================================================
+    /** Creates an empty histogram. */
+    NativeMacLatencyHistogram() noexcept;
+
+    /** Records a duration. Negative values count as 0. Wait-free. */
+    void record (juce::int64 microseconds) noexcept;
+
+    /** Records a duration given in milliseconds. Wait-free. */
+    void recordMilliseconds (double milliseconds) noexcept;
+
+    //==============================================================================
+    /** Returns the number of values recorded. */
+    juce::int64 getCount() const noexcept;
+
+    /** Returns the value below which the given percentage (0 to 100) of values lie, or 0 if empty. */
+    double getPercentileMs (double percentile) const noexcept;
+
+    /** Returns the count, mean, p50, p90, p99 and max. */
+    Summary getSummary() const noexcept;
+
+    /** Removes all values. Values recorded concurrently may or may not be kept. */
+    void reset() noexcept;
+
+    //==============================================================================
+    /** Returns the bucket a value is counted in. */
+    static int getBucketIndex (juce::int64 microseconds) noexcept;
+
+    /** Returns the smallest value counted in a bucket. */
+    static juce::int64 getBucketLowestValue (int bucketIndex) noexcept;
+
+    /** Returns the largest value counted in a bucket. */
+    static juce::int64 getBucketHighestValue (int bucketIndex) noexcept;
+
+private:
+    //==============================================================================
+    void copyCounts (juce::int64* counts, juce::int64& total) const noexcept;
+
+    std::atomic<juce::int64> buckets[numBuckets];
+    std::atomic<juce::int64> sumMicroseconds { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacLatencyHistogram)
+};
+
+//==============================================================================
+/**
+    The module's latency histograms: for every public dialog and menu function,
+    the time until its window or menu was on screen, and the time until it
+    returned a result.
+
+    They are always kept, at the cost of a few atomic increments per call.
+    Dialogs answered without showing anything (e.g. a suppressed confirmation)
+    aren't counted. Custom backends contribute a time to visible only if they
+    call the onOpened callback they are given.
+
+    @code
+    using Stats = juce::NativeMacLatencyStats;
+
+    auto open = Stats::getSummary (Stats::Function::showPopupMenuAt, Stats::Measure::timeToVisible);
+    telemetry.send ("menuOpenP90", open.p90Ms);
+    @endcode
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacLatencyStats
+{
+public:
+    //==============================================================================
+    enum class Function
+    {
+        showTextInputDialog,
+        showInfoDialog,
+        showConfirmDialog,
+        showFormDialog,
+        showAlertTemplate,            /**< NativeMacAlertTemplate::show() and showTextInput(). */
+        showPopupMenu,
+        showPopupMenuAt,
+        showPopupMenuAtFixed
+    };
+
+    static constexpr int numFunctions = 8;
+
+    enum class Measure
+    {
+        timeToVisible,                /**< From the call until the alert or menu is on screen. */
+        timeToResult                  /**< From the call until it returns. */
+    };
+
+    //==============================================================================
+    /** Returns the histogram for a function and measure. */
+    static NativeMacLatencyHistogram& getHistogram (Function function, Measure measure) noexcept;
+
+    /** Returns the summary of a function's histogram. */
+    static NativeMacLatencyHistogram::Summary getSummary (Function function, Measure measure) noexcept;
+
+    /** Returns the function's name, e.g. "showPopupMenuAt". */
+    static const char* getFunctionName (Function function) noexcept;
+
+    /** Resets every histogram. */
+    static void resetAll() noexcept;
+
+    //==============================================================================
+    /** Times one call of a function: the time to result is recorded when this is
+        destroyed, and the time to visible when the callback from
+        getOpenedCallback() is first called.
+    */
+    class ScopedCall
+    {
+    public:
+        explicit ScopedCall (Function function) noexcept;
+        ~ScopedCall();
+
+        /** Returns a callback to pass on as the alert's or menu's onOpened; it must
+            not be called after this object is destroyed.
+        */
+        std::function<void()> getOpenedCallback();
+
+    private:
+        const Function function;
+        const juce::int64 startTicks;
+        std::atomic<bool> hasOpened { false };
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedCall)
+    };
+
+private:
+    NativeMacLatencyStats() = delete;
+};
+
+} // namespace juce
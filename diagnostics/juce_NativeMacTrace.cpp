@@ -0,0 +1,419 @@
+/*******************************************************************************
+ Tracing - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+namespace TraceHelpers
+{
+    //==============================================================================
+    // One thread's spans. Only the owning thread writes; readers check each slot's
+    // sequence number before and after copying it, and skip slots that were being
+    // rewritten meanwhile
+    struct Ring
+    {
+        struct Slot
+        {
+            std::atomic<juce::uint64> sequence { 0 };   // 2n + 1 while span n is written, 2n + 2 once it's complete
+            std::atomic<const char*> category { nullptr };
+            std::atomic<const char*> name { nullptr };
+            std::atomic<juce::int64> startTicks { 0 };
+            std::atomic<juce::int64> durationTicks { 0 };
+            std::atomic<juce::uint32> threadID { 0 };
+        };
+
+        Slot slots[NativeMacTrace::spansPerThread];
+        std::atomic<juce::uint64> numWritten { 0 };
+        std::atomic<juce::uint64> clearedAt { 0 };
+        std::atomic<bool> inUse { true };
+        Ring* next = nullptr;                             // fixed once the ring is published
+    };
+
+    struct Registry
+    {
+        std::atomic<Ring*> head { nullptr };
+        std::atomic<juce::uint32> lastThreadID { 0 };
+    };
+
+    static Registry& getRegistry() noexcept
+    {
+        // Rings are never freed, so a reader can walk the list at any time
+        static Registry registry;
+        return registry;
+    }
+
+    static Ring* acquireRing()
+    {
+        auto& registry = getRegistry();
+
+        // Rings of threads that have finished are reused; their spans stay readable until overwritten
+        for (auto* ring = registry.head.load (std::memory_order_acquire); ring != nullptr; ring = ring->next)
+        {
+            auto expected = false;
+
+            if (ring->inUse.compare_exchange_strong (expected, true, std::memory_order_acquire))
+                return ring;
+        }
+
+        auto* ring = new Ring();
+        ring->next = registry.head.load (std::memory_order_relaxed);
+
+        while (! registry.head.compare_exchange_weak (ring->next, ring, std::memory_order_release,
+                                                                         std::memory_order_relaxed))
+        {
+        }
+
+        return ring;
+    }
+
+    struct ThreadState
+    {
+        ThreadState()
+            : ring (acquireRing()),
+              threadID (getRegistry().lastThreadID.fetch_add (1, std::memory_order_relaxed) + 1)
+        {
+        }
+
+        ~ThreadState()
+        {
+            ring->inUse.store (false, std::memory_order_release);
+        }
+
+        Ring* const ring;
+        const juce::uint32 threadID;
+    };
+
+    static ThreadState& getThreadState()
+    {
+        thread_local ThreadState state;
+        return state;
+    }
+
+    static void appendEscaped (juce::String& json, const char* text)
+    {
+        json << "\"";
+
+        for (auto* c = text; *c != 0; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+                json << "\\" << juce::String::charToString ((juce::juce_wchar) (juce::uint8) *c);
+            else if ((juce::uint8) *c < 0x20)
+                json << " ";
+            else
+                json << juce::String::charToString ((juce::juce_wchar) (juce::uint8) *c);
+        }
+
+        json << "\"";
+    }
+}
+
+//==============================================================================
+void NativeMacTrace::record (const char* category, const char* name,
+                             juce::int64 startTicks, juce::int64 endTicks) noexcept
+{
+    auto& state = TraceHelpers::getThreadState();
+    auto& ring = *state.ring;
+
+    const auto n = ring.numWritten.load (std::memory_order_relaxed);
+    auto& slot = ring.slots[n % (juce::uint64) spansPerThread];
+
+    slot.sequence.store (2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    slot.category.store (category, std::memory_order_relaxed);
+    slot.name.store (name, std::memory_order_relaxed);
+    slot.startTicks.store (startTicks, std::memory_order_relaxed);
+    slot.durationTicks.store (endTicks - startTicks, std::memory_order_relaxed);
+    slot.threadID.store (state.threadID, std::memory_order_relaxed);
+
+    slot.sequence.store (2 * n + 2, std::memory_order_release);
+    ring.numWritten.store (n + 1, std::memory_order_release);
+}
+
+std::vector<NativeMacTrace::Span> NativeMacTrace::getSpans()
+{
+    std::vector<Span> spans;
+
+    for (auto* ring = TraceHelpers::getRegistry().head.load (std::memory_order_acquire); ring != nullptr; ring = ring->next)
+    {
+        const auto numWritten = ring->numWritten.load (std::memory_order_acquire);
+        const auto oldest = numWritten > (juce::uint64) spansPerThread ? numWritten - (juce::uint64) spansPerThread : 0;
+
+        for (auto n = jmax (oldest, ring->clearedAt.load (std::memory_order_relaxed)); n < numWritten; ++n)
+        {
+            auto& slot = ring->slots[n % (juce::uint64) spansPerThread];
+
+            if (slot.sequence.load (std::memory_order_acquire) != 2 * n + 2)
+                continue;
+
+            Span span;
+            span.category      = slot.category.load (std::memory_order_relaxed);
+            span.name          = slot.name.load (std::memory_order_relaxed);
+            span.startTicks    = slot.startTicks.load (std::memory_order_relaxed);
+            span.durationTicks = slot.durationTicks.load (std::memory_order_relaxed);
+            span.threadID      = slot.threadID.load (std::memory_order_relaxed);
+
+            std::atomic_thread_fence (std::memory_order_acquire);
+
+            // Overwritten while it was copied
+            if (slot.sequence.load (std::memory_order_relaxed) != 2 * n + 2)
+                continue;
+
+            spans.push_back (span);
+        }
+    }
+
+    std::sort (spans.begin(), spans.end(), [] (const Span& a, const Span& b)
+    {
+        return a.startTicks < b.startTicks;
+    });
+
+    return spans;
+}
+
+void NativeMacTrace::clear() noexcept
+{
+    for (auto* ring = TraceHelpers::getRegistry().head.load (std::memory_order_acquire); ring != nullptr; ring = ring->next)
+        ring->clearedAt.store (ring->numWritten.load (std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+//==============================================================================
+juce::String NativeMacTrace::toChromeTraceJSON()
+{
+    const auto spans = getSpans();
+    const auto ticksToMicroseconds = 1.0e6 / (double) juce::Time::getHighResolutionTicksPerSecond();
+    const auto firstTicks = spans.empty() ? (juce::int64) 0 : spans.front().startTicks;
+
+    juce::String json;
+    json.preallocateBytes ((size_t) spans.size() * 128 + 256);
+
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+         << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"juce_native_macos_dialogs\"}}";
+
+    for (auto& span : spans)
+    {
+        json << ",\n{\"name\":";
+        TraceHelpers::appendEscaped (json, span.name);
+        json << ",\"cat\":";
+        TraceHelpers::appendEscaped (json, span.category);
+        json << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << (int) span.threadID
+             << ",\"ts\":" << juce::String ((double) (span.startTicks - firstTicks) * ticksToMicroseconds, 3)
+             << ",\"dur\":" << juce::String ((double) span.durationTicks * ticksToMicroseconds, 3) << "}";
+    }
+
+    json << "\n]}\n";
+    return json;
+}
+
+bool NativeMacTrace::writeChromeTrace (const juce::File& file)
+{
+    return file.replaceWithText (toChromeTraceJSON());
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacTraceTests  : public juce::UnitTest
+{
+public:
+    NativeMacTraceTests()
+        : juce::UnitTest ("NativeMacTrace", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        constexpr auto numSpans = NativeMacTrace::spansPerThread;
+
+        beginTest ("Record");
+        {
+            NativeMacTrace::clear();
+            NativeMacTrace::record (testCategory, "b", 200, 250);
+            NativeMacTrace::record (testCategory, "a", 100, 400);
+            NativeMacTrace::record (testCategory, "c", 300, 300);
+
+            const auto spans = getTestSpans();
+            expectEquals ((int) spans.size(), 3);
+
+            if (spans.size() == 3)
+            {
+                // Ordered by start time, not by when they were recorded
+                expectEquals (juce::String (spans[0].name) + spans[1].name + spans[2].name, juce::String ("abc"));
+                expectEquals (spans[0].startTicks, (juce::int64) 100);
+                expectEquals (spans[0].durationTicks, (juce::int64) 300);
+                expectEquals (spans[2].durationTicks, (juce::int64) 0);
+                expect (spans[0].threadID != 0 && spans[0].threadID == spans[2].threadID);
+            }
+
+            {
+                const NativeMacTrace::ScopedSpan span (testCategory, "scoped");
+            }
+
+            const auto withScoped = getTestSpans();
+            expectEquals ((int) withScoped.size(), 4);
+            expectEquals (juce::String (withScoped.back().name), juce::String ("scoped"));
+            expectGreaterOrEqual (withScoped.back().durationTicks, (juce::int64) 0);
+        }
+
+        beginTest ("Ring wraps");
+        {
+            NativeMacTrace::clear();
+
+            for (int i = 0; i < numSpans + 100; ++i)
+                NativeMacTrace::record (testCategory, "span", i, i + 1);
+
+            // Only the newest spans are kept
+            const auto spans = getTestSpans();
+            expectEquals ((int) spans.size(), numSpans);
+            expectEquals (spans.front().startTicks, (juce::int64) 100);
+            expectEquals (spans.back().startTicks, (juce::int64) numSpans + 99);
+        }
+
+        beginTest ("Clear");
+        {
+            NativeMacTrace::record (testCategory, "before", 0, 1);
+            NativeMacTrace::clear();
+            expect (getTestSpans().empty());
+
+            NativeMacTrace::record (testCategory, "after", 5, 6);
+
+            const auto spans = getTestSpans();
+            expectEquals ((int) spans.size(), 1);
+            expectEquals (juce::String (spans.front().name), juce::String ("after"));
+
+            // A wrapped ring is cleared too
+            for (int i = 0; i < numSpans * 2; ++i)
+                NativeMacTrace::record (testCategory, "span", i, i);
+
+            NativeMacTrace::clear();
+            expect (getTestSpans().empty());
+        }
+
+        beginTest ("Threads");
+        {
+            NativeMacTrace::clear();
+            NativeMacTrace::record (testCategory, "main", 0, 0);
+
+            constexpr int numThreads = 4, numPerThread = 100;
+
+            // Run one after another, so later threads can take over the rings of earlier ones
+            for (int i = 0; i < numThreads; ++i)
+            {
+                std::thread ([]
+                {
+                    for (int n = 0; n < numPerThread; ++n)
+                        NativeMacTrace::record (testCategory, "worker", n + 1, n + 1);
+                }).join();
+            }
+
+            const auto spans = getTestSpans();
+            expectEquals ((int) spans.size(), 1 + numThreads * numPerThread);
+
+            std::map<juce::uint32, int> spansPerThreadID;
+
+            for (auto& span : spans)
+                ++spansPerThreadID[span.threadID];
+
+            expectEquals ((int) spansPerThreadID.size(), 1 + numThreads);
+
+            for (auto& entry : spansPerThreadID)
+                expect (entry.second == 1 || entry.second == numPerThread);
+        }
+
+        beginTest ("Reading while recording");
+        {
+            NativeMacTrace::clear();
+
+            // Each span's fields are derived from its start, so a torn copy would show
+            constexpr juce::int64 numToRecord = 200000;
+            std::atomic<bool> finished { false };
+
+            std::thread writer ([&finished]
+            {
+                for (juce::int64 n = 1; n <= numToRecord; ++n)
+                    NativeMacTrace::record (testCategory, (n & 1) != 0 ? "odd" : "even", n, 3 * n);
+
+                finished = true;
+            });
+
+            int numReads = 0, numTorn = 0;
+
+            while (! finished || numReads == 0)
+            {
+                ++numReads;
+
+                for (auto& span : getTestSpans())
+                {
+                    const auto isOdd = (span.startTicks & 1) != 0;
+
+                    if (span.durationTicks != 2 * span.startTicks
+                         || juce::String (span.name) != (isOdd ? "odd" : "even"))
+                        ++numTorn;
+                }
+            }
+
+            writer.join();
+
+            expectEquals (numTorn, 0);
+            expectEquals ((int) getTestSpans().size(), numSpans);
+        }
+
+        beginTest ("Chrome trace");
+        {
+            NativeMacTrace::clear();
+
+            const auto ticksPerMs = juce::Time::getHighResolutionTicksPerSecond() / 1000;
+
+            NativeMacTrace::record (testCategory, "say \"hi\"\\\t", 10 * ticksPerMs, 12 * ticksPerMs);
+            NativeMacTrace::record (testCategory, "second", 11 * ticksPerMs, 11 * ticksPerMs);
+
+            const auto spans = getTestSpans();
+            const auto json = NativeMacTrace::toChromeTraceJSON();
+
+            // Times are in microseconds from the first span
+            const auto tid = juce::String ((int) spans.front().threadID);
+
+            expect (json.startsWith ("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+            expect (json.contains ("{\"name\":\"say \\\"hi\\\"\\\\ \",\"cat\":\"traceTests\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                                     + tid + ",\"ts\":0.000,\"dur\":2000.000}"));
+            expect (json.contains ("{\"name\":\"second\",\"cat\":\"traceTests\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                                     + tid + ",\"ts\":1000.000,\"dur\":0.000}"));
+            expect (json.endsWith ("\n]}\n"));
+
+            const auto file = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                                 .getNonexistentChildFile ("juce_trace_tests", ".json", false);
+
+            expect (NativeMacTrace::writeChromeTrace (file));
+            expectEquals (file.loadFileAsString(), json);
+            file.deleteFile();
+
+            NativeMacTrace::clear();
+            expect (! NativeMacTrace::toChromeTraceJSON().contains ("traceTests"));
+        }
+    }
+
+private:
+    static constexpr const char* testCategory = "traceTests";
+
+    // Spans the module records itself, when tracing is enabled, are left out
+    static std::vector<NativeMacTrace::Span> getTestSpans()
+    {
+        auto spans = NativeMacTrace::getSpans();
+
+        spans.erase (std::remove_if (spans.begin(), spans.end(), [] (const NativeMacTrace::Span& span)
+                                     {
+                                         return std::strcmp (span.category, testCategory) != 0;
+                                     }),
+                     spans.end());
+
+        return spans;
+    }
+};
+
+static NativeMacTraceTests nativeMacTraceTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,116 @@
+/*******************************************************************************
+ Tracing
+
+ Timed spans around the module's entry points and internal phases, recorded
+ into per-thread ring buffers and exported as Chrome trace JSON.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Records where the time goes inside dialogs, menus and the clipboard.
+
+    When the module is compiled with JUCE_NATIVE_MACOS_ENABLE_TRACING=1, every
+    public entry point and its phases (building the alert or menu, string
+    conversion, the modal loop, focus restoration, encoding, ...) record a span.
+    With the flag off, JUCE_NATIVE_MACOS_TRACE expands to nothing.
+
+    Each thread writes into its own fixed-size ring, without locks or
+    allocation once the thread's first span has been recorded; the oldest spans
+    are overwritten when a ring is full. Spans can be read and exported from any
+    thread while others keep recording:
+
+    @code
+    juce::NativeMacPopupMenu::showPopupMenu (presetMenu);
+
+    juce::NativeMacTrace::writeChromeTrace (juce::File::getSpecialLocation (juce::File::userDesktopDirectory)
+                                                .getChildFile ("menu-trace.json"));
+    @endcode
+
+    Open the file in chrome://tracing or https://ui.perfetto.dev.
+
+    The recorder itself is always compiled, so it can also be used directly,
+    and on every platform.
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacTrace
+{
+public:
+    //==============================================================================
+    /** The number of spans each thread's ring holds. */
+    static constexpr int spansPerThread = 2048;
+
+    struct Span
+    {
+        const char* category = "";        /**< A string literal, e.g. "menus". */
+        const char* name = "";            /**< A string literal, e.g. "buildMenu". */
+        juce::int64 startTicks = 0;       /**< Time::getHighResolutionTicks() at the start. */
+        juce::int64 durationTicks = 0;
+        juce::uint32 threadID = 0;        /**< Numbered from 1 in the order threads first record. */
+    };
+
+    //==============================================================================
+    /** Records a span on the calling thread.
+
+        The strings must stay valid for as long as the span may be read; use
+        string literals.
+    */
+    static void record (const char* category, const char* name,
+                        juce::int64 startTicks, juce::int64 endTicks) noexcept;
+
+    /** Returns the spans recorded on all threads since the last clear(), ordered by start time. */
+    static std::vector<Span> getSpans();
+
+    /** Forgets the spans recorded so far. */
+    static void clear() noexcept;
+
+    //==============================================================================
+    /** Returns the spans in Chrome trace event format, with times in microseconds. */
+    static juce::String toChromeTraceJSON();
+
+    /** Writes toChromeTraceJSON() to a file. */
+    static bool writeChromeTrace (const juce::File& file);
+
+    //==============================================================================
+    /** Records the time between its construction and destruction. */
+    class ScopedSpan
+    {
+    public:
+        ScopedSpan (const char* categoryToUse, const char* nameToUse) noexcept
+            : category (categoryToUse), name (nameToUse),
+              startTicks (juce::Time::getHighResolutionTicks())
+        {
+        }
+
+        ~ScopedSpan()
+        {
+            record (category, name, startTicks, juce::Time::getHighResolutionTicks());
+        }
+
+    private:
+        const char* category;
+        const char* name;
+        const juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedSpan)
+    };
+
+private:
+    NativeMacTrace() = delete;
+};
+
+} // namespace juce
+
+//==============================================================================
+/** Records a span from here to the end of the enclosing scope, when tracing is enabled. */
+#if JUCE_NATIVE_MACOS_ENABLE_TRACING
+ #define JUCE_NATIVE_MACOS_TRACE(category, name) \
+    const juce::NativeMacTrace::ScopedSpan JUCE_JOIN_MACRO (nativeMacTraceSpan_, __LINE__) (category, name)
+#else
+ #define JUCE_NATIVE_MACOS_TRACE(category, name)
+#endif
@@ -0,0 +1,481 @@
+/*******************************************************************************
+ Reusable alert templates - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+NativeMacAlertTemplate::NativeMacAlertTemplate (Kind k,
+                                                const juce::StringArray& titles,
+                                                std::shared_ptr<NativeMacDialogBackend> b)
+    : kind (k),
+      buttonTitles (titles),
+      backend (std::move (b))
+{
+    jassert (buttonTitles.size() > 0);
+}
+
+NativeMacAlertTemplate::~NativeMacAlertTemplate()
+{
+    // Deleted from inside its own modal loop: the shows in progress hold the alert and
+    // finish without coming back here
+    for (auto* show = activeShows; show != nullptr; show = show->outer)
+        show->templateDeleted = true;
+}
+
+//==============================================================================
+NativeMacDialogBackend::AlertContent NativeMacAlertTemplate::makeContent (const juce::String& title,
+                                                                          const juce::String& message) const
+{
+    NativeMacDialogBackend::AlertContent content;
+    content.title = title;
+    content.message = message;
+    content.buttons = buttonTitles;
+    content.hasTextField = (kind == Kind::textInput);
+    return content;
+}
+
+std::shared_ptr<NativeMacDialogBackend> NativeMacAlertTemplate::getBackendToUse() const
+{
+    return backend != nullptr ? backend : NativeMacDialogs::getBackend();
+}
+
+std::unique_ptr<NativeMacDialogBackend::Alert> NativeMacAlertTemplate::build (NativeMacDialogBackend& backendToUse,
+                                                                             const NativeMacDialogBackend::AlertContent& content)
+{
+    const auto style = kind == Kind::info ? NativeMacDialogBackend::AlertStyle::informational
+                                          : NativeMacDialogBackend::AlertStyle::warning;
+
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+    auto newAlert = backendToUse.createAlert (style, content);
+    stats.lastBuildMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+    ++stats.numBuilds;
+
+    return newAlert;
+}
+
+void NativeMacAlertTemplate::prepare()
+{
+    JUCE_NATIVE_MACOS_TRACE ("dialogs", "prepareAlertTemplate");
+
+    if (alert == nullptr)
+    {
+        alertBackend = getBackendToUse();
+        alert = build (*alertBackend, makeContent ({}, {}));
+    }
+}
+
+void NativeMacAlertTemplate::releaseAlert()
+{
+    // A show in progress holds its own references, so an alert on screen stays until it closes
+    alert.reset();
+    alertBackend.reset();
+}
+
+void NativeMacAlertTemplate::setButtonTitles (const juce::StringArray& newTitles)
+{
+    jassert (newTitles.size() == buttonTitles.size());
+
+    if (newTitles.size() == buttonTitles.size())
+        buttonTitles = newTitles;
+}
+
+//==============================================================================
+int NativeMacAlertTemplate::show (const juce::String& title, const juce::String& message)
+{
+    return run (makeContent (title, message), nullptr);
+}
+
+bool NativeMacAlertTemplate::showTextInput (const juce::String& title,
+                                            const juce::String& message,
+                                            const juce::String& currentText,
+                                            int maxLength,
+                                            juce::String& outText)
+{
+    return showTextInput (title, message, currentText, maxLength, outText, NativeMacTextInputOptions());
+}
+
+bool NativeMacAlertTemplate::showTextInput (const juce::String& title,
+                                            const juce::String& message,
+                                            const juce::String& currentText,
+                                            int maxLength,
+                                            juce::String& outText,
+                                            NativeMacTextValidator& validator)
+{
+    NativeMacTextInputOptions options;
+    options.validator = &validator;
+
+    return showTextInput (title, message, currentText, maxLength, outText, options);
+}
+
+bool NativeMacAlertTemplate::showTextInput (const juce::String& title,
+                                            const juce::String& message,
+                                            const juce::String& currentText,
+                                            int maxLength,
+                                            juce::String& outText,
+                                            const NativeMacTextInputOptions& options)
+{
+    jassert (kind == Kind::textInput);
+
+    auto content = makeContent (title, message);
+    content.text = currentText;
+    content.maxLength = maxLength;
+    content.textInput = options;
+
+    return run (content, &outText) == 0;
+}
+
+int NativeMacAlertTemplate::run (const NativeMacDialogBackend::AlertContent& content, juce::String* outText)
+{
+    JUCE_NATIVE_MACOS_TRACE ("dialogs", "showAlertTemplate");
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (showAlertTemplate);
+    NativeMacLatencyStats::ScopedCall call (NativeMacLatencyStats::Function::showAlertTemplate);
+
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+    double openedMs = -1.0;
+
+    const auto onOpened = [&openedMs, callOpened = call.getOpenedCallback()]
+    {
+        openedMs = juce::Time::getMillisecondCounterHiRes();
+        callOpened();
+    };
+
+    // The show holds its own references, so that the alert stays up if the template is
+    // released or deleted meanwhile
+    std::shared_ptr<NativeMacDialogBackend> runningBackend;
+    std::shared_ptr<NativeMacDialogBackend::Alert> runningAlert;
+    const auto wasShowing = showing;
+
+    if (wasShowing)
+    {
+        // Shown again from inside its own modal loop - use a one-off alert rather than
+        // touching the one on screen
+        runningBackend = getBackendToUse();
+        runningAlert = build (*runningBackend, content);
+    }
+    else
+    {
+        if (alert == nullptr)
+        {
+            alertBackend = getBackendToUse();
+            alert = build (*alertBackend, content);
+        }
+        else
+        {
+            alert->setContent (content);
+        }
+
+        runningBackend = alertBackend;
+        runningAlert = alert;
+    }
+
+    ActiveShow activeShow { activeShows };
+    activeShows = &activeShow;
+    showing = true;
+
+    const auto result = runningAlert->runModal (onOpened);
+
+    if (outText != nullptr && result == 0)
+        *outText = runningAlert->getText();
+
+    if (activeShow.templateDeleted)
+        return result;
+
+    activeShows = activeShow.outer;
+    showing = wasShowing;
+
+    ++stats.numShows;
+
+    if (openedMs >= 0.0)
+    {
+        const auto latencyMs = openedMs - startMs;
+        stats.lastOpenLatencyMs = latencyMs;
+        stats.maxOpenLatencyMs = jmax (stats.maxOpenLatencyMs, latencyMs);
+        stats.totalOpenLatencyMs += latencyMs;
+    }
+
+    return result;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacAlertTemplateTests  : public juce::UnitTest
+{
+public:
+    NativeMacAlertTemplateTests()
+        : juce::UnitTest ("NativeMacAlertTemplate", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        using Content = NativeMacDialogBackend::AlertContent;
+        using Kind = NativeMacAlertTemplate::Kind;
+
+        // Each test sets how the simulated user answers
+        std::function<int (const Content&, juce::String&)> respond;
+        juce::StringArray shown;
+
+        const auto backend = std::make_shared<NativeMacHeadlessDialogBackend> ([&] (const Content& content, juce::String& text)
+        {
+            shown.add (content.title + ": " + content.message + " [" + content.buttons.joinIntoString (",") + "]");
+            return respond != nullptr ? respond (content, text) : 0;
+        });
+
+        const auto reset = [&]
+        {
+            respond = nullptr;
+            shown.clear();
+            backend->resetStats();
+        };
+
+        beginTest ("Create, show and reuse");
+        {
+            reset();
+            NativeMacAlertTemplate alert (Kind::confirm, { "Delete", "Keep" }, backend);
+
+            expect (! alert.isPrepared());
+            expectEquals (backend->getStats().numAlertsCreated, (juce::int64) 0);
+
+            respond = [] (const Content& content, juce::String&) { return content.title == "Second" ? 1 : 0; };
+
+            expectEquals (alert.show ("First", "Delete one?"), 0);
+            expect (alert.isPrepared());
+            expectEquals (alert.show ("Second", "Delete two?"), 1);
+            expectEquals (alert.show ("Third", "Delete three?"), 0);
+
+            expectEquals (shown.joinIntoString ("|"), juce::String ("First: Delete one? [Delete,Keep]|"
+                                                                    "Second: Delete two? [Delete,Keep]|"
+                                                                    "Third: Delete three? [Delete,Keep]"));
+
+            // Built once, then updated with each show's text
+            const auto stats = backend->getStats();
+            expectEquals (stats.numAlertsCreated, (juce::int64) 1);
+            expectEquals (stats.numAlertsAlive, (juce::int64) 1);
+            expectEquals (stats.numContentUpdates, (juce::int64) 3);
+            expectEquals (stats.numRuns, (juce::int64) 3);
+            expectEquals (alert.getStats().numShows, (juce::int64) 3);
+            expectEquals (alert.getStats().numBuilds, (juce::int64) 1);
+
+            // Released, it's built again by the next show
+            alert.releaseAlert();
+            expect (! alert.isPrepared());
+            expectEquals (backend->getStats().numAlertsAlive, (juce::int64) 0);
+
+            expectEquals (alert.show ("Fourth", "Delete four?"), 0);
+            expectEquals (backend->getStats().numAlertsCreated, (juce::int64) 2);
+            expectEquals (alert.getStats().numBuilds, (juce::int64) 2);
+
+            // Prepared ahead, the first show only updates the text
+            NativeMacAlertTemplate prepared (Kind::info, { "OK" }, backend);
+            prepared.prepare();
+            prepared.prepare();
+
+            expect (prepared.isPrepared());
+            expectEquals (backend->getStats().numAlertsCreated, (juce::int64) 3);
+
+            expectEquals (prepared.show ("Saved", "The preset was saved."), 0);
+            expectEquals (backend->getStats().numAlertsCreated, (juce::int64) 3);
+            expectEquals (prepared.getStats().numBuilds, (juce::int64) 1);
+            expectEquals (prepared.getStats().numShows, (juce::int64) 1);
+
+            // New button titles are used from the next show on
+            alert.setButtonTitles ({ "Remove", "Cancel" });
+            alert.show ("Fifth", "Remove five?");
+            expect (shown[shown.size() - 1].endsWith ("[Remove,Cancel]"), shown[shown.size() - 1]);
+        }
+
+        beginTest ("Text input");
+        {
+            reset();
+            NativeMacAlertTemplate rename (Kind::textInput, { "Rename", "Cancel" }, backend);
+
+            respond = [] (const Content& content, juce::String& text)
+            {
+                text = content.text + " 2";
+                return 0;
+            };
+
+            juce::String newName ("unchanged");
+            expect (rename.showTextInput ("Rename Preset", "Name:", "Pad", 0, newName));
+            expectEquals (newName, juce::String ("Pad 2"));
+
+            // The reused alert starts from each show's text, not the text typed last time
+            expect (rename.showTextInput ("Rename Preset", "Name:", "Lead", 0, newName));
+            expectEquals (newName, juce::String ("Lead 2"));
+
+            expect (rename.showTextInput ("Rename Preset", "Name:", "Bass", 4, newName));
+            expectEquals (newName, juce::String ("Bass"));
+
+            // Cancelled or dismissed, the text is left alone
+            respond = [] (const Content&, juce::String& text) { text = "typed"; return 1; };
+            newName = "unchanged";
+            expect (! rename.showTextInput ("Rename Preset", "Name:", "Pad", 0, newName));
+            expectEquals (newName, juce::String ("unchanged"));
+
+            respond = [] (const Content&, juce::String& text) { text = "typed"; return -1; };
+            expect (! rename.showTextInput ("Rename Preset", "Name:", "Pad", 0, newName));
+            expectEquals (newName, juce::String ("unchanged"));
+
+            // Text the validator rejects can't be confirmed
+            NativeMacTextValidator validator;
+            validator.forbidFileNameCharacters ("Bad name");
+
+            respond = [] (const Content&, juce::String& text) { text = "a/b"; return 0; };
+            expect (! rename.showTextInput ("Rename Preset", "Name:", "Pad", 0, newName, validator));
+            expectEquals (newName, juce::String ("unchanged"));
+
+            respond = [] (const Content&, juce::String& text) { text = "a-b"; return 0; };
+            expect (rename.showTextInput ("Rename Preset", "Name:", "Pad", 0, newName, validator));
+            expectEquals (newName, juce::String ("a-b"));
+
+            expectEquals (backend->getStats().numAlertsCreated, (juce::int64) 1);
+        }
+
+        beginTest ("Updating while showing");
+        {
+            reset();
+            NativeMacAlertTemplate rename (Kind::textInput, { "Rename", "Cancel" }, backend);
+            juce::String innerName, outerName;
+            bool innerResult = false;
+
+            respond = [&] (const Content& content, juce::String& text)
+            {
+                if (content.title == "Outer")
+                {
+                    expect (rename.isShowing());
+                    text = "outer";
+
+                    // Changing the titles doesn't touch the alert on screen...
+                    rename.setButtonTitles ({ "OK", "Cancel" });
+
+                    // ...and neither does showing the template again, which uses a one-off alert
+                    innerResult = rename.showTextInput ("Inner", "Name:", "Pad", 0, innerName);
+
+                    expect (rename.isShowing());
+                    expectEquals (content.title, juce::String ("Outer"));
+                    expectEquals (content.buttons.joinIntoString (","), juce::String ("Rename,Cancel"));
+                    return 0;
+                }
+
+                text = "inner";
+                return 0;
+            };
+
+            expect (rename.showTextInput ("Outer", "Name:", "Lead", 0, outerName));
+            expect (! rename.isShowing());
+
+            expect (innerResult);
+            expectEquals (innerName, juce::String ("inner"));
+            expectEquals (outerName, juce::String ("outer"));
+            expectEquals (shown.joinIntoString ("|"), juce::String ("Outer: Name: [Rename,Cancel]|Inner: Name: [OK,Cancel]"));
+
+            // The one-off alert is gone; the template's own alert is kept for the next show
+            expectEquals (backend->getStats().numAlertsCreated, (juce::int64) 2);
+            expectEquals (backend->getStats().numAlertsAlive, (juce::int64) 1);
+            expectEquals (rename.getStats().numShows, (juce::int64) 2);
+
+            respond = nullptr;
+            rename.show ("Again", "Name:");
+            expectEquals (backend->getStats().numAlertsCreated, (juce::int64) 2);
+            expectEquals (shown[shown.size() - 1], juce::String ("Again: Name: [OK,Cancel]"));
+        }
+
+        beginTest ("Released while showing");
+        {
+            reset();
+            NativeMacAlertTemplate rename (Kind::textInput, { "Rename", "Cancel" }, backend);
+
+            respond = [&] (const Content&, juce::String& text)
+            {
+                rename.releaseAlert();
+                expect (! rename.isPrepared());
+                expectEquals (backend->getStats().numAlertsAlive, (juce::int64) 1);
+
+                text = "typed";
+                return 0;
+            };
+
+            juce::String newName;
+            expect (rename.showTextInput ("Rename Preset", "Name:", "Pad", 0, newName));
+            expectEquals (newName, juce::String ("typed"));
+
+            // Closed, the released alert is gone and the next show builds a new one
+            expect (! rename.isShowing());
+            expect (! rename.isPrepared());
+            expectEquals (backend->getStats().numAlertsAlive, (juce::int64) 0);
+
+            respond = nullptr;
+            expectEquals (rename.show ("Again", "Name:"), 0);
+            expectEquals (backend->getStats().numAlertsCreated, (juce::int64) 2);
+            expectEquals (rename.getStats().numShows, (juce::int64) 2);
+        }
+
+        beginTest ("Deleted while showing");
+        {
+            reset();
+            auto rename = std::make_unique<NativeMacAlertTemplate> (Kind::textInput, juce::StringArray { "Rename", "Cancel" }, backend);
+            auto* renamePtr = rename.get();
+
+            respond = [&] (const Content&, juce::String& text)
+            {
+                rename.reset();
+                text = "typed";
+                return 0;
+            };
+
+            juce::String newName;
+            expect (renamePtr->showTextInput ("Rename Preset", "Name:", "Pad", 0, newName));
+            expectEquals (newName, juce::String ("typed"));
+            expect (rename == nullptr);
+            expectEquals (backend->getStats().numAlertsAlive, (juce::int64) 0);
+
+            // Deleted from inside a nested show, both shows finish
+            rename = std::make_unique<NativeMacAlertTemplate> (Kind::confirm, juce::StringArray { "Delete", "Keep" }, backend);
+            renamePtr = rename.get();
+            int innerResult = -2;
+
+            respond = [&] (const Content& content, juce::String&)
+            {
+                if (content.title == "Outer")
+                {
+                    innerResult = renamePtr->show ("Inner", "Delete?");
+                    return 1;
+                }
+
+                rename.reset();
+                return 0;
+            };
+
+            expectEquals (renamePtr->show ("Outer", "Delete?"), 1);
+            expectEquals (innerResult, 0);
+            expect (rename == nullptr);
+            expectEquals (backend->getStats().numAlertsAlive, (juce::int64) 0);
+        }
+
+        beginTest ("Dismissed");
+        {
+            reset();
+            NativeMacAlertTemplate alert (Kind::confirm, { "Delete", "Keep" }, backend);
+
+            respond = [] (const Content&, juce::String&) { return -1; };
+            expectEquals (alert.show ("Delete", "Delete the preset?"), -1);
+
+            // A button that doesn't exist counts as a dismissal
+            respond = [] (const Content&, juce::String&) { return 2; };
+            expectEquals (alert.show ("Delete", "Delete the preset?"), -1);
+
+            expect (! alert.isShowing());
+            expectEquals (alert.getStats().numShows, (juce::int64) 2);
+        }
+    }
+};
+
+static NativeMacAlertTemplateTests nativeMacAlertTemplateTests;
+
+#endif
+
+} // namespace juce
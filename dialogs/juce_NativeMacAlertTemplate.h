@@ -0,0 +1,176 @@
+/*******************************************************************************
+ Reusable alert templates
+
+ Builds a native alert once and reruns it with new text, for dialogs that are
+ shown over and over (rename, overwrite confirmation, ...).
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A pre-built alert that is reused for every show.
+
+    The NativeMacDialogs functions build a new NSAlert, text field and buttons
+    on every call. A template builds them once - either lazily on the first
+    show or ahead of time with prepare() - and afterwards only swaps in the
+    title, message, button titles and text before running the alert again.
+
+    Each show records how long it took for the alert to reach the screen, so
+    you can compare a prepared template against a cold build.
+
+    @code
+    // e.g. a member of the preset browser
+    NativeMacAlertTemplate renameAlert { NativeMacAlertTemplate::Kind::textInput, { "Rename", "Cancel" } };
+
+    // when the browser opens
+    renameAlert.prepare();
+
+    // on every rename
+    String newName;
+    if (renameAlert.showTextInput ("Rename Preset", "Enter a new name:", preset.getName(), 64, newName))
+        preset.rename (newName);
+    @endcode
+
+    Templates must only be used on the message thread. A template can be
+    released or deleted from inside its own modal loop, e.g. by a callback
+    that runs while the alert is up; the alert on screen stays until it closes.
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacAlertTemplate
+{
+public:
+    //==============================================================================
+    /** The dialog shapes provided by NativeMacDialogs. */
+    enum class Kind
+    {
+        info,        /**< Informational style, typically one button. */
+        confirm,     /**< Warning style, typically two buttons. */
+        textInput    /**< Warning style with a text field. */
+    };
+
+    /** Creates a template. Nothing is built until prepare() or the first show.
+
+        @param kind           The dialog shape
+        @param buttonTitles   Button titles, first one is the default button. The
+                              number of buttons can't change afterwards.
+        @param backend        Backend to build with; if null, NativeMacDialogs::getBackend()
+                              is used when the alert is built
+    */
+    NativeMacAlertTemplate (Kind kind,
+                            const juce::StringArray& buttonTitles,
+                            std::shared_ptr<NativeMacDialogBackend> backend = nullptr);
+
+    /** Destructor. Releases the native alert, or leaves it to close by itself if it is on screen. */
+    ~NativeMacAlertTemplate();
+
+    //==============================================================================
+    /** Builds the native alert now, so that the first show is as fast as the rest. */
+    void prepare();
+
+    /** Returns true if the native alert has been built. */
+    bool isPrepared() const noexcept                { return alert != nullptr; }
+
+    /** Releases the native alert; the next show builds it again. If the alert is on
+        screen, it stays there until it closes.
+    */
+    void releaseAlert();
+
+    /** Returns true while the alert is on screen. */
+    bool isShowing() const noexcept                 { return showing; }
+
+    /** Changes the button titles. The number of titles must match the original. */
+    void setButtonTitles (const juce::StringArray& newTitles);
+
+    //==============================================================================
+    /** Shows the alert.
+
+        @returns the index of the clicked button, or -1 if it was dismissed
+    */
+    int show (const juce::String& title, const juce::String& message);
+
+    /** Shows a textInput alert.
+
+        @param title        The dialog title
+        @param message      The informative message to display
+        @param currentText  The initial text of the text field
+        @param maxLength    Maximum number of characters (grapheme clusters) allowed (0 = no limit)
+        @param outText      Receives the entered text if the first button was clicked
+        @returns true if the first button was clicked
+    */
+    bool showTextInput (const juce::String& title,
+                        const juce::String& message,
+                        const juce::String& currentText,
+                        int maxLength,
+                        juce::String& outText);
+
+    /** Shows a textInput alert whose text is checked with a validator on every
+        keystroke; the first button is disabled while the text is invalid.
+    */
+    bool showTextInput (const juce::String& title,
+                        const juce::String& message,
+                        const juce::String& currentText,
+                        int maxLength,
+                        juce::String& outText,
+                        NativeMacTextValidator& validator);
+
+    /** Shows a textInput alert with a validator, completions or both. */
+    bool showTextInput (const juce::String& title,
+                        const juce::String& message,
+                        const juce::String& currentText,
+                        int maxLength,
+                        juce::String& outText,
+                        const NativeMacTextInputOptions& options);
+
+    //==============================================================================
+    /** Build and open timings, in milliseconds. */
+    struct Stats
+    {
+        juce::int64 numShows = 0;
+        juce::int64 numBuilds = 0;          /**< Times the native alert was built, including prepare(). */
+        double lastBuildMs = 0.0;
+        double lastOpenLatencyMs = 0.0;     /**< From the show call until the alert was on screen. */
+        double maxOpenLatencyMs = 0.0;
+        double totalOpenLatencyMs = 0.0;    /**< Divide by numShows for the mean. */
+    };
+
+    /** Returns the timings accumulated since creation or the last resetStats(). */
+    Stats getStats() const noexcept                 { return stats; }
+
+    /** Resets the timings. */
+    void resetStats() noexcept                      { stats = {}; }
+
+private:
+    //==============================================================================
+    NativeMacDialogBackend::AlertContent makeContent (const juce::String& title,
+                                                      const juce::String& message) const;
+    std::shared_ptr<NativeMacDialogBackend> getBackendToUse() const;
+    std::unique_ptr<NativeMacDialogBackend::Alert> build (NativeMacDialogBackend&, const NativeMacDialogBackend::AlertContent&);
+    int run (const NativeMacDialogBackend::AlertContent&, juce::String* outText);
+
+    // One per show in progress, innermost first, so that a template deleted from inside
+    // its own modal loop can tell them not to touch it afterwards
+    struct ActiveShow
+    {
+        ActiveShow* outer;
+        bool templateDeleted = false;
+    };
+
+    const Kind kind;
+    juce::StringArray buttonTitles;
+    std::shared_ptr<NativeMacDialogBackend> backend;
+
+    std::shared_ptr<NativeMacDialogBackend> alertBackend;   // keeps the backend that built the alert alive
+    std::shared_ptr<NativeMacDialogBackend::Alert> alert;   // shared with the show in progress, if any
+    ActiveShow* activeShows = nullptr;
+    bool showing = false;
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacAlertTemplate)
+};
+
+} // namespace juce
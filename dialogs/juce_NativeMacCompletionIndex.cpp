@@ -0,0 +1,438 @@
+/*******************************************************************************
+ Completion index - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+namespace CompletionIndexHelpers
+{
+    // Compares the first prefixLength bytes of a key with a prefix; shorter keys compare
+    // as if cut off there, so they sort before any longer prefix they start
+    static int comparePrefix (const char* key, size_t keyLength, const char* prefix, size_t prefixLength) noexcept
+    {
+        const auto n = jmin (keyLength, prefixLength);
+        const auto result = n > 0 ? std::memcmp (key, prefix, n) : 0;
+
+        if (result != 0 || keyLength >= prefixLength)
+            return result;
+
+        return -1;
+    }
+
+    static int compareKeys (const char* a, size_t aLength, const char* b, size_t bLength) noexcept
+    {
+        const auto result = std::memcmp (a, b, jmin (aLength, bLength));
+
+        if (result != 0)
+            return result;
+
+        return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+    }
+}
+
+//==============================================================================
+NativeMacCompletionIndex::NativeMacCompletionIndex (const juce::StringArray& names, bool shouldIgnoreCase)
+    : ignoreCase (shouldIgnoreCase)
+{
+    build (names, nullptr);
+}
+
+NativeMacCompletionIndex::NativeMacCompletionIndex (const juce::StringArray& names,
+                                                    const juce::Array<float>& weights,
+                                                    bool shouldIgnoreCase)
+    : ignoreCase (shouldIgnoreCase)
+{
+    jassert (weights.size() == names.size());
+    build (names, &weights);
+}
+
+void NativeMacCompletionIndex::build (const juce::StringArray& names, const juce::Array<float>* weights)
+{
+    hasWeights = (weights != nullptr);
+
+    std::vector<Entry> unsorted;
+    unsorted.reserve ((size_t) names.size());
+
+    const auto append = [this] (const juce::String& s)
+    {
+        const auto offset = (uint32) bytes.size();
+        const auto length = (uint32) s.getNumBytesAsUTF8();
+        bytes.insert (bytes.end(), s.toRawUTF8(), s.toRawUTF8() + length);
+        return std::make_pair (offset, length);
+    };
+
+    for (int i = 0; i < names.size(); ++i)
+    {
+        Entry entry;
+        std::tie (entry.nameOffset, entry.nameLength) = append (names[i]);
+
+        if (ignoreCase)
+            std::tie (entry.keyOffset, entry.keyLength) = append (names[i].toLowerCase());
+        else
+            std::tie (entry.keyOffset, entry.keyLength) = std::make_pair (entry.nameOffset, entry.nameLength);
+
+        entry.weight = (weights != nullptr && i < weights->size()) ? (*weights)[i] : 0.0f;
+        unsorted.push_back (entry);
+    }
+
+    const auto* data = bytes.data();
+
+    const auto compare = [data] (const Entry& a, const Entry& b)
+    {
+        return CompletionIndexHelpers::compareKeys (data + a.keyOffset, a.keyLength,
+                                                    data + b.keyOffset, b.keyLength);
+    };
+
+    // Sorted by key, heaviest first among duplicates, so that the first of each run is kept
+    std::stable_sort (unsorted.begin(), unsorted.end(), [&compare] (const Entry& a, const Entry& b)
+    {
+        const auto result = compare (a, b);
+        return result != 0 ? result < 0 : a.weight > b.weight;
+    });
+
+    entries.reserve (unsorted.size());
+
+    for (auto& entry : unsorted)
+        if (entries.empty() || compare (entries.back(), entry) != 0)
+            entries.push_back (entry);
+
+    if (! hasWeights || entries.empty())
+        return;
+
+    // Bottom-up segment tree: leaves at [n, 2n), node i covers nodes 2i and 2i + 1
+    const auto n = entries.size();
+    heaviest.assign (2 * n, 0);
+
+    for (size_t i = 0; i < n; ++i)
+        heaviest[n + i] = (uint32) i;
+
+    for (auto i = n; --i > 0;)
+    {
+        const auto left = heaviest[2 * i], right = heaviest[2 * i + 1];
+        heaviest[i] = entries[right].weight > entries[left].weight ? right : left;
+    }
+}
+
+//==============================================================================
+NativeMacCompletionIndex::Range NativeMacCompletionIndex::findRange (const juce::String& prefix) const
+{
+    const auto key = ignoreCase ? prefix.toLowerCase() : prefix;
+    const auto* keyData = key.toRawUTF8();
+    const auto keyLength = key.getNumBytesAsUTF8();
+    const auto* data = bytes.data();
+
+    const auto compareEntry = [=] (const Entry& entry)
+    {
+        return CompletionIndexHelpers::comparePrefix (data + entry.keyOffset, entry.keyLength, keyData, keyLength);
+    };
+
+    const auto begin = std::partition_point (entries.begin(), entries.end(),
+                                             [&] (const Entry& e) { return compareEntry (e) < 0; });
+    const auto end = std::partition_point (begin, entries.end(),
+                                           [&] (const Entry& e) { return compareEntry (e) == 0; });
+
+    return { (size_t) (begin - entries.begin()), (size_t) (end - entries.begin()) };
+}
+
+size_t NativeMacCompletionIndex::findHeaviest (size_t begin, size_t end) const noexcept
+{
+    // Ties go to the lower index, i.e. the alphabetically first name
+    const auto n = entries.size();
+    auto best = begin;
+
+    const auto consider = [&] (uint32 candidate)
+    {
+        if (entries[candidate].weight > entries[best].weight
+             || (entries[candidate].weight == entries[best].weight && candidate < best))
+            best = candidate;
+    };
+
+    for (auto l = begin + n, r = end + n; l < r; l >>= 1, r >>= 1)
+    {
+        if (l & 1)  consider (heaviest[l++]);
+        if (r & 1)  consider (heaviest[--r]);
+    }
+
+    return best;
+}
+
+juce::String NativeMacCompletionIndex::getName (size_t index) const
+{
+    const auto& entry = entries[index];
+    return juce::String::fromUTF8 (bytes.data() + entry.nameOffset, (int) entry.nameLength);
+}
+
+//==============================================================================
+void NativeMacCompletionIndex::getCompletions (const juce::String& prefix,
+                                               int maxResults,
+                                               juce::StringArray& results) const
+{
+    results.clear();
+
+    if (maxResults <= 0)
+        return;
+
+    const auto range = findRange (prefix);
+
+    if (! hasWeights)
+    {
+        for (auto i = range.begin; i < jmin (range.end, range.begin + (size_t) maxResults); ++i)
+            results.add (getName (i));
+
+        return;
+    }
+
+    // Best-first search: each candidate range is keyed by its heaviest entry; taking that
+    // entry splits the range in two around it
+    struct Candidate
+    {
+        size_t begin, end, best;
+    };
+
+    const auto lighter = [this] (const Candidate& a, const Candidate& b)
+    {
+        const auto wa = entries[a.best].weight, wb = entries[b.best].weight;
+        return wa < wb || (wa == wb && a.best > b.best);
+    };
+
+    std::vector<Candidate> queue;
+    queue.reserve ((size_t) maxResults * 2 + 1);
+
+    const auto push = [&] (size_t begin, size_t end)
+    {
+        if (begin < end)
+        {
+            queue.push_back ({ begin, end, findHeaviest (begin, end) });
+            std::push_heap (queue.begin(), queue.end(), lighter);
+        }
+    };
+
+    push (range.begin, range.end);
+
+    while (! queue.empty() && results.size() < maxResults)
+    {
+        std::pop_heap (queue.begin(), queue.end(), lighter);
+        const auto next = queue.back();
+        queue.pop_back();
+
+        results.add (getName (next.best));
+        push (next.begin, next.best);
+        push (next.best + 1, next.end);
+    }
+}
+
+juce::StringArray NativeMacCompletionIndex::getCompletions (const juce::String& prefix, int maxResults) const
+{
+    juce::StringArray results;
+    getCompletions (prefix, maxResults, results);
+    return results;
+}
+
+int NativeMacCompletionIndex::countCompletions (const juce::String& prefix) const
+{
+    const auto range = findRange (prefix);
+    return (int) (range.end - range.begin);
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacCompletionIndexTests  : public juce::UnitTest
+{
+public:
+    NativeMacCompletionIndexTests()
+        : juce::UnitTest ("NativeMacCompletionIndex", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        const juce::StringArray presets { "Pad", "Bass", "Lead", "Bassline", "Zither", "Bass 2", "Brass", "Arp" };
+        const NativeMacCompletionIndex index (presets);
+
+        beginTest ("Empty index");
+        {
+            const NativeMacCompletionIndex empty ({});
+
+            expectEquals (empty.size(), 0);
+            expectEquals (empty.countCompletions ({}), 0);
+            expectEquals (empty.countCompletions ("a"), 0);
+            expect (empty.getCompletions ({}, 10).isEmpty());
+
+            const NativeMacCompletionIndex emptyWeighted ({}, juce::Array<float>());
+            expect (emptyWeighted.getCompletions ("a", 10).isEmpty());
+        }
+
+        beginTest ("Prefix ranges");
+        {
+            expectEquals (index.size(), 8);
+
+            // The empty prefix matches everything, in order
+            expectEquals (index.countCompletions ({}), 8);
+            expectCompletions (index.getCompletions ({}, 100), "Arp,Bass,Bass 2,Bassline,Brass,Lead,Pad,Zither");
+            expectCompletions (index.getCompletions ({}, 3), "Arp,Bass,Bass 2");
+
+            expectEquals (index.countCompletions ("b"), 4);
+            expectEquals (index.countCompletions ("bass"), 3);
+            expectEquals (index.countCompletions ("bass "), 1);
+            expectEquals (index.countCompletions ("bassl"), 1);
+            expectCompletions (index.getCompletions ("bas", 2), "Bass,Bass 2");
+
+            // Prefixes matching nothing, before, between and after the keys, and longer than a key
+            for (auto missing : { " ", "0", "Aa", "Arpeggio", "Bb", "C", "Zz", "Zithers", "~" })
+            {
+                expectEquals (index.countCompletions (missing), 0, missing);
+                expect (index.getCompletions (missing, 10).isEmpty(), missing);
+            }
+
+            // The first and last keys
+            expectCompletions (index.getCompletions ("a", 10), "Arp");
+            expectCompletions (index.getCompletions ("arp", 10), "Arp");
+            expectCompletions (index.getCompletions ("z", 10), "Zither");
+            expectCompletions (index.getCompletions ("ZITHER", 10), "Zither");
+        }
+
+        beginTest ("Case");
+        {
+            const NativeMacCompletionIndex caseSensitive (presets, false);
+
+            expect (! caseSensitive.isCaseInsensitive());
+            expectEquals (caseSensitive.countCompletions ("b"), 0);
+            expectEquals (caseSensitive.countCompletions ("B"), 4);
+            expectCompletions (caseSensitive.getCompletions ("Ba", 10), "Bass,Bass 2,Bassline");
+
+            // Duplicates differing only in case are one name when case is ignored
+            const NativeMacCompletionIndex folded ({ "Bass", "BASS", "bass", "Lead" });
+            expectEquals (folded.size(), 2);
+            expectCompletions (folded.getCompletions ("b", 10), "Bass");
+
+            const NativeMacCompletionIndex unfolded ({ "Bass", "BASS", "bass", "Lead" }, false);
+            expectEquals (unfolded.size(), 4);
+            expectCompletions (unfolded.getCompletions ({}, 10), "BASS,Bass,Lead,bass");
+        }
+
+        beginTest ("Result limits");
+        {
+            juce::StringArray results { "stale" };
+            index.getCompletions ("b", 0, results);
+            expect (results.isEmpty());
+
+            index.getCompletions ("b", -1, results);
+            expect (results.isEmpty());
+
+            index.getCompletions ("b", 2, results);
+            expectCompletions (results, "Bass,Bass 2");
+
+            index.getCompletions ("l", 2, results);
+            expectCompletions (results, "Lead");
+        }
+
+        beginTest ("Weights");
+        {
+            const NativeMacCompletionIndex weighted (presets, { 5.0f, 1.0f, 0.0f, 3.0f, 0.0f, 3.0f, 2.0f, 1.0f });
+
+            expectCompletions (weighted.getCompletions ({}, 100), "Pad,Bass 2,Bassline,Brass,Arp,Bass,Lead,Zither");
+            expectCompletions (weighted.getCompletions ("b", 3), "Bass 2,Bassline,Brass");
+            expectCompletions (weighted.getCompletions ("bass", 10), "Bass 2,Bassline,Bass");
+            expectCompletions (weighted.getCompletions ("zither", 10), "Zither");
+            expect (weighted.getCompletions ("q", 10).isEmpty());
+
+            // Of duplicates, the heaviest is kept, with the case it was added with
+            const NativeMacCompletionIndex duplicates ({ "bass", "Bass", "BASS", "Lead" }, { 1.0f, 4.0f, 2.0f, 3.0f });
+            expectEquals (duplicates.size(), 2);
+            expectCompletions (duplicates.getCompletions ({}, 10), "Bass,Lead");
+        }
+
+        beginTest ("Random prefixes match a brute-force search");
+        {
+            auto random = getRandom();
+
+            for (int i = 0; i < 50; ++i)
+            {
+                // Short names over a small alphabet share many prefixes, and a few distinct weights
+                // make plenty of ties
+                juce::StringArray names;
+                juce::Array<float> weights;
+                std::set<juce::String> keys;
+
+                for (int j = random.nextInt (200); --j >= 0;)
+                {
+                    const auto candidate = randomText (random, 1 + random.nextInt (5));
+
+                    if (keys.insert (candidate.toLowerCase()).second)
+                    {
+                        names.add (candidate);
+                        weights.add ((float) random.nextInt (4));
+                    }
+                }
+
+                const NativeMacCompletionIndex unweighted (names);
+                const NativeMacCompletionIndex weighted (names, weights);
+
+                for (int j = 0; j < 50; ++j)
+                {
+                    const auto prefix = randomText (random, random.nextInt (4));
+                    const auto maxResults = random.nextInt (names.size() + 5);
+
+                    std::vector<int> matches;
+
+                    for (int k = 0; k < names.size(); ++k)
+                        if (names[k].toLowerCase().startsWith (prefix.toLowerCase()))
+                            matches.push_back (k);
+
+                    // Alphabetical by key
+                    std::sort (matches.begin(), matches.end(), [&] (int a, int b)
+                    {
+                        return names[a].toLowerCase().compare (names[b].toLowerCase()) < 0;
+                    });
+
+                    expectEquals (unweighted.countCompletions (prefix), (int) matches.size(), prefix);
+                    expectCompletions (unweighted.getCompletions (prefix, maxResults), bestOf (names, matches, maxResults));
+
+                    // Heaviest first, ties alphabetically
+                    std::stable_sort (matches.begin(), matches.end(), [&] (int a, int b)
+                    {
+                        return weights[a] > weights[b];
+                    });
+
+                    expectEquals (weighted.countCompletions (prefix), (int) matches.size(), prefix);
+                    expectCompletions (weighted.getCompletions (prefix, maxResults), bestOf (names, matches, maxResults));
+                }
+            }
+        }
+    }
+
+private:
+    void expectCompletions (const juce::StringArray& actual, const juce::String& expected)
+    {
+        expectEquals (actual.joinIntoString (","), expected);
+    }
+
+    static juce::String bestOf (const juce::StringArray& names, const std::vector<int>& matches, int maxResults)
+    {
+        juce::StringArray best;
+
+        for (size_t i = 0; i < jmin (matches.size(), (size_t) maxResults); ++i)
+            best.add (names[matches[i]]);
+
+        return best.joinIntoString (",");
+    }
+
+    static juce::String randomText (juce::Random& random, int length)
+    {
+        juce::String text;
+
+        for (int i = 0; i < length; ++i)
+            text += juce::String::charToString (juce::String ("abAB ")[random.nextInt (5)]);
+
+        return text;
+    }
+};
+
+static NativeMacCompletionIndexTests nativeMacCompletionIndexTests;
+
+#endif
+
+} // namespace juce
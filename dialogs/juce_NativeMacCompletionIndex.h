@@ -0,0 +1,113 @@
+/*******************************************************************************
+ Completion index
+
+ Prefix completion over a large, fixed corpus of names.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A sorted, packed index of names that returns the best completions for a
+    prefix.
+
+    All names live in one contiguous byte buffer, sorted by their UTF-8 bytes
+    (which sorts them by code point). The names starting with a prefix form a
+    contiguous run, found with two binary searches, so a lookup costs
+    O(log n) regardless of the corpus size:
+
+    - without weights, the first maxResults names of the run are returned, in
+      alphabetical order
+    - with weights (e.g. how often each preset is used), the run is searched
+      with a max-segment tree and the heaviest names are returned first, in
+      O(maxResults * log n)
+
+    Build it once and share it between dialogs with a shared_ptr; it never
+    changes after construction, so lookups need no locking.
+
+    @code
+    auto presetNames = std::make_shared<NativeMacCompletionIndex> (library.getAllNames(),
+                                                                   library.getUseCounts());
+
+    NativeMacTextInputOptions options;
+    options.completions = presetNames;
+
+    String name;
+    NativeMacDialogs::showTextInputDialog ("Load Preset", "Name:", {}, 0, "Load", "Cancel", name, options);
+    @endcode
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacCompletionIndex
+{
+public:
+    //==============================================================================
+    /** Builds an index in which all names rank equally.
+
+        @param names        The names to complete; duplicates are stored once
+        @param ignoreCase   If true, prefixes match regardless of case
+    */
+    explicit NativeMacCompletionIndex (const juce::StringArray& names, bool ignoreCase = true);
+
+    /** Builds an index in which names with higher weights are offered first.
+
+        @param names        The names to complete; of duplicates, the heaviest is kept
+        @param weights      One weight per name
+        @param ignoreCase   If true, prefixes match regardless of case
+    */
+    NativeMacCompletionIndex (const juce::StringArray& names,
+                              const juce::Array<float>& weights,
+                              bool ignoreCase = true);
+
+    //==============================================================================
+    /** Fills results with up to maxResults names starting with the prefix, best first.
+
+        The names keep the case they were added with. results is cleared first,
+        so passing the same array for every keystroke reuses its storage.
+    */
+    void getCompletions (const juce::String& prefix, int maxResults, juce::StringArray& results) const;
+
+    /** Returns up to maxResults names starting with the prefix, best first. */
+    juce::StringArray getCompletions (const juce::String& prefix, int maxResults) const;
+
+    /** Returns how many names start with the prefix. */
+    int countCompletions (const juce::String& prefix) const;
+
+    /** Returns the number of distinct names. */
+    int size() const noexcept                         { return (int) entries.size(); }
+
+    /** Returns true if prefixes match regardless of case. */
+    bool isCaseInsensitive() const noexcept           { return ignoreCase; }
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        uint32 keyOffset, keyLength;     // normalised name, the sort key
+        uint32 nameOffset, nameLength;   // name as added; same as the key if case matters
+        float weight;
+    };
+
+    struct Range
+    {
+        size_t begin, end;
+    };
+
+    void build (const juce::StringArray& names, const juce::Array<float>* weights);
+    Range findRange (const juce::String& prefix) const;
+    size_t findHeaviest (size_t begin, size_t end) const noexcept;
+    juce::String getName (size_t index) const;
+
+    const bool ignoreCase;
+    bool hasWeights = false;
+    std::vector<char> bytes;
+    std::vector<Entry> entries;      // sorted by key
+    std::vector<uint32> heaviest;    // segment tree over entries: index of the heaviest entry in each node
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacCompletionIndex)
+};
+
+} // namespace juce
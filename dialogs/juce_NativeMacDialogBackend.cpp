@@ -0,0 +1,207 @@
+/*******************************************************************************
+ Dialog backends - headless implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+class NativeMacHeadlessDialogBackend::HeadlessAlert  : public NativeMacDialogBackend::Alert
+{
+public:
+    HeadlessAlert (std::shared_ptr<SharedState> s, const AlertContent& initialContent)
+        : state (std::move (s))
+    {
+        ++state->numAlertsCreated;
+        ++state->numAlertsAlive;
+        setContent (initialContent);
+    }
+
+    ~HeadlessAlert() override
+    {
+        --state->numAlertsAlive;
+    }
+
+    void setContent (const AlertContent& newContent) override
+    {
+        ++state->numContentUpdates;
+        content = newContent;
+        text = newContent.text;
+    }
+
+    int runModal (std::function<void()> onOpened) override
+    {
+        ++state->numRuns;
+        suppressionChecked = false;
+
+        const auto result = run (std::move (onOpened));
+
+        suppressionChecked = result >= 0 && content.suppressionText.isNotEmpty() && state->suppressionChecked;
+        return result;
+    }
+
+    juce::String getText() const override
+    {
+        return text;
+    }
+
+    bool isSuppressionChecked() const override
+    {
+        return suppressionChecked;
+    }
+
+private:
+    int run (std::function<void()> onOpened)
+    {
+        if (onOpened != nullptr)
+            onOpened();
+
+        Responder responder;
+
+        {
+            const juce::ScopedLock sl (state->lock);
+            responder = state->responder;
+        }
+
+        if (responder == nullptr)
+            return -1;
+
+        if (content.form != nullptr)
+            return runForm (responder, *content.form);
+
+        auto result = responder (content, text);
+
+        text = NativeMacTextLimiter::truncate (text, content.maxLength, content.textInput.lengthUnit);
+
+        auto* validator = content.textInput.validator;
+
+        if (result == 0 && validator != nullptr)
+        {
+            validator->reset();
+
+            if (validator->validate (text).failed())
+                return -1;
+        }
+
+        return isPositiveAndBelow (result, content.buttons.size()) ? result : -1;
+    }
+
+    int runForm (const Responder& responder, NativeMacForm& form)
+    {
+        std::vector<NativeMacForm::Field> original;
+        original.reserve ((size_t) form.getNumFields());
+
+        for (int i = 0; i < form.getNumFields(); ++i)
+            original.push_back (form.getField (i));
+
+        auto result = responder (content, text);
+
+        for (int i = 0; i < form.getNumFields(); ++i)
+        {
+            auto& field = form.getField (i);
+            field.text = NativeMacTextLimiter::truncate (field.text, field.maxLength, field.textInput.lengthUnit);
+        }
+
+        if (result == 0 && form.findInvalidField() >= 0)
+            result = -1;
+
+        if (! isPositiveAndBelow (result, content.buttons.size()))
+            result = -1;
+
+        if (result != 0)
+            for (int i = 0; i < form.getNumFields(); ++i)
+                form.getField (i) = original[(size_t) i];
+
+        return result;
+    }
+
+    std::shared_ptr<SharedState> state;
+    AlertContent content;
+    juce::String text;
+    bool suppressionChecked = false;
+};
+
+//==============================================================================
+class NativeMacHeadlessDialogBackend::HeadlessProgressWindow  : public NativeMacDialogBackend::ProgressWindow
+{
+public:
+    explicit HeadlessProgressWindow (std::shared_ptr<SharedState> s)
+        : state (std::move (s))
+    {
+        ++state->numProgressWindows;
+    }
+
+    void update (double fraction, const juce::String* newStatus) override
+    {
+        juce::ignoreUnused (fraction, newStatus);
+        ++state->numProgressUpdates;
+    }
+
+private:
+    std::shared_ptr<SharedState> state;
+};
+
+//==============================================================================
+std::unique_ptr<NativeMacDialogBackend::ProgressWindow> NativeMacDialogBackend::createProgressWindow (const juce::String& title,
+                                                                                                       const juce::String& cancelButtonText,
+                                                                                                       std::function<void()> onCancel)
+{
+    juce::ignoreUnused (title, cancelButtonText, onCancel);
+    return nullptr;
+}
+
+//==============================================================================
+NativeMacHeadlessDialogBackend::NativeMacHeadlessDialogBackend (Responder responder)
+    : state (std::make_shared<SharedState>())
+{
+    state->responder = std::move (responder);
+}
+
+void NativeMacHeadlessDialogBackend::setResponder (Responder newResponder)
+{
+    const juce::ScopedLock sl (state->lock);
+    state->responder = std::move (newResponder);
+}
+
+void NativeMacHeadlessDialogBackend::setSuppressionChecked (bool shouldBeChecked) noexcept
+{
+    state->suppressionChecked = shouldBeChecked;
+}
+
+std::unique_ptr<NativeMacDialogBackend::Alert> NativeMacHeadlessDialogBackend::createAlert (AlertStyle style,
+                                                                                            const AlertContent& content)
+{
+    juce::ignoreUnused (style);
+    return std::make_unique<HeadlessAlert> (state, content);
+}
+
+std::unique_ptr<NativeMacDialogBackend::ProgressWindow> NativeMacHeadlessDialogBackend::createProgressWindow (const juce::String& title,
+                                                                                                               const juce::String& cancelButtonText,
+                                                                                                               std::function<void()> onCancel)
+{
+    juce::ignoreUnused (title, cancelButtonText, onCancel);
+    return std::make_unique<HeadlessProgressWindow> (state);
+}
+
+NativeMacHeadlessDialogBackend::Stats NativeMacHeadlessDialogBackend::getStats() const noexcept
+{
+    Stats stats;
+    stats.numAlertsCreated   = state->numAlertsCreated.load();
+    stats.numAlertsAlive     = state->numAlertsAlive.load();
+    stats.numContentUpdates  = state->numContentUpdates.load();
+    stats.numRuns            = state->numRuns.load();
+    stats.numProgressWindows = state->numProgressWindows.load();
+    stats.numProgressUpdates = state->numProgressUpdates.load();
+    return stats;
+}
+
+void NativeMacHeadlessDialogBackend::resetStats() noexcept
+{
+    state->numAlertsCreated = 0;
+    state->numContentUpdates = 0;
+    state->numRuns = 0;
+    state->numProgressWindows = 0;
+    state->numProgressUpdates = 0;
+}
+
+} // namespace juce
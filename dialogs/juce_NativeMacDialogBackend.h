@@ -0,0 +1,231 @@
+/*******************************************************************************
+ Dialog backends
+
+ The interface NativeMacDialogs and NativeMacAlertTemplate build their alerts
+ with, plus a headless implementation that works on every platform.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+class NativeMacForm;
+
+//==============================================================================
+/**
+    Optional behaviour of the text field of a text input dialog.
+
+    @see NativeMacDialogs::showTextInputDialog, NativeMacAlertTemplate::showTextInput
+
+    @tags{GUI}
+*/
+struct NativeMacTextInputOptions
+{
+    /** Checks the text on every change; while it fails, the OK button is disabled
+        and the failure message is shown. Not owned, may be null.
+    */
+    NativeMacTextValidator* validator = nullptr;
+
+    /** Offers completions for the text typed so far; may be null. */
+    std::shared_ptr<const NativeMacCompletionIndex> completions;
+
+    /** The maximum number of completions offered at once. */
+    int maxCompletions = 10;
+
+    /** The unit maxLength is measured in. */
+    NativeMacTextLimiter::Unit lengthUnit = NativeMacTextLimiter::Unit::graphemes;
+};
+
+//==============================================================================
+/**
+    Creates and runs the alerts shown by NativeMacDialogs.
+
+    On macOS the default backend builds NSAlerts. Other implementations can be
+    installed with NativeMacDialogs::setBackend(), e.g. a
+    NativeMacHeadlessDialogBackend to exercise dialog code without a window
+    server.
+
+    Alerts are created and run on the message thread.
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacDialogBackend
+{
+public:
+    //==============================================================================
+    virtual ~NativeMacDialogBackend() = default;
+
+    enum class AlertStyle
+    {
+        informational,
+        warning
+    };
+
+    /** The parts of an alert that can change between runs. */
+    struct AlertContent
+    {
+        juce::String title;
+        juce::String message;
+        juce::StringArray buttons;        /**< Button titles, first one is the default button. */
+        bool hasTextField = false;
+        juce::String text;                /**< Initial text of the text field. */
+        int maxLength = 0;                /**< Length limit of the text field in textInput.lengthUnit (0 = no limit). */
+        NativeMacTextInputOptions textInput;
+        NativeMacForm* form = nullptr;    /**< The fields of a form dialog, shown instead of the text field. Not owned. */
+        juce::String suppressionText;     /**< Title of a "Don't ask again" checkbox; empty for none. */
+    };
+
+    //==============================================================================
+    /**
+        A built alert that can be run any number of times.
+
+        The style, the number of buttons, the presence of a text field and the
+        fields of a form are fixed when the alert is created; everything else
+        can be changed with setContent().
+
+        When a form alert is closed with the first button, the values of its
+        fields are written back to the NativeMacForm.
+    */
+    class JUCE_API  Alert
+    {
+    public:
+        virtual ~Alert() = default;
+
+        /** Updates the text of the alert, its buttons and its text field. */
+        virtual void setContent (const AlertContent& content) = 0;
+
+        /** Runs the alert modally.
+
+            @param onOpened   Called once the alert is on screen; may be empty
+            @returns the index of the button that was clicked, or -1 if the
+                     alert was dismissed without one
+        */
+        virtual int runModal (std::function<void()> onOpened) = 0;
+
+        /** Returns the contents of the text field after the last run. */
+        virtual juce::String getText() const = 0;
+
+        /** Returns true if the suppression checkbox was ticked when the last run ended.
+            The checkbox starts unticked on every run.
+        */
+        virtual bool isSuppressionChecked() const     { return false; }
+    };
+
+    /** Builds an alert. */
+    virtual std::unique_ptr<Alert> createAlert (AlertStyle style, const AlertContent& content) = 0;
+
+    //==============================================================================
+    /** A modeless window showing the progress of a task; it closes when deleted. */
+    class JUCE_API  ProgressWindow
+    {
+    public:
+        virtual ~ProgressWindow() = default;
+
+        /** Shows new values.
+
+            @param fraction    The progress from 0 to 1, or negative if indeterminate
+            @param newStatus   The new status line, or null if it hasn't changed
+        */
+        virtual void update (double fraction, const juce::String* newStatus) = 0;
+    };
+
+    /** Builds a progress window and puts it on screen.
+
+        The default implementation has nothing to show and returns nullptr.
+
+        @param title             The window title
+        @param cancelButtonText  The title of the cancel button, or empty for none
+        @param onCancel          Called when the cancel button is clicked
+    */
+    virtual std::unique_ptr<ProgressWindow> createProgressWindow (const juce::String& title,
+                                                                  const juce::String& cancelButtonText,
+                                                                  std::function<void()> onCancel);
+};
+
+//==============================================================================
+/**
+    A dialog backend that never shows anything.
+
+    Each run is answered by a responder function, which gets the alert's
+    content and can change the text of its text field. Without a responder
+    every alert is dismissed (runModal() returns -1), which is what
+    NativeMacDialogs does on platforms other than macOS.
+
+    If the content has a validator, the responder's text is checked with it;
+    choosing the first button while the text is invalid counts as a dismissal,
+    as the button would be disabled on screen.
+
+    For a form, the responder changes the fields of content.form directly. The
+    changes are kept only if it chooses the first button and every field is
+    valid; otherwise the fields are put back as they were.
+
+    Alerts with a suppression checkbox report it as ticked after any run that
+    chose a button, if setSuppressionChecked (true) was called.
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacHeadlessDialogBackend  : public NativeMacDialogBackend
+{
+public:
+    //==============================================================================
+    /** Answers an alert: returns the index of the button to click (-1 to dismiss),
+        and may change text to simulate typing.
+    */
+    using Responder = std::function<int (const AlertContent& content, juce::String& text)>;
+
+    /** Creates a headless backend. */
+    explicit NativeMacHeadlessDialogBackend (Responder responder = nullptr);
+
+    /** Replaces the responder. */
+    void setResponder (Responder newResponder);
+
+    /** Sets whether suppression checkboxes are ticked by the simulated user. */
+    void setSuppressionChecked (bool shouldBeChecked) noexcept;
+
+    std::unique_ptr<Alert> createAlert (AlertStyle style, const AlertContent& content) override;
+
+    std::unique_ptr<ProgressWindow> createProgressWindow (const juce::String& title,
+                                                          const juce::String& cancelButtonText,
+                                                          std::function<void()> onCancel) override;
+
+    //==============================================================================
+    /** Counters for checking how alerts are built and reused. */
+    struct Stats
+    {
+        juce::int64 numAlertsCreated = 0;    /**< createAlert() calls. */
+        juce::int64 numAlertsAlive = 0;      /**< Alerts created and not yet destroyed. */
+        juce::int64 numContentUpdates = 0;   /**< setContent() calls, including the initial one. */
+        juce::int64 numRuns = 0;             /**< runModal() calls. */
+        juce::int64 numProgressWindows = 0;  /**< createProgressWindow() calls. */
+        juce::int64 numProgressUpdates = 0;  /**< ProgressWindow::update() calls. */
+    };
+
+    /** Returns the counters accumulated since creation or the last resetStats(). */
+    Stats getStats() const noexcept;
+
+    /** Resets the counters, except numAlertsAlive. */
+    void resetStats() noexcept;
+
+private:
+    //==============================================================================
+    class HeadlessAlert;
+    class HeadlessProgressWindow;
+
+    struct SharedState
+    {
+        juce::CriticalSection lock;
+        Responder responder;
+        std::atomic<bool> suppressionChecked { false };
+
+        std::atomic<juce::int64> numAlertsCreated { 0 }, numAlertsAlive { 0 },
+                                 numContentUpdates { 0 }, numRuns { 0 },
+                                 numProgressWindows { 0 }, numProgressUpdates { 0 };
+    };
+
+    std::shared_ptr<SharedState> state;   // outlives the backend if alerts are still around
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacHeadlessDialogBackend)
+};
+
+} // namespace juce
@@ -0,0 +1,657 @@
+/*******************************************************************************
+ Dialog queue - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+struct NativeMacDialogQueue::Node
+{
+    std::atomic<Node*> next { nullptr };
+    Request request;
+};
+
+namespace DialogQueueHelpers
+{
+    static juce::String getKey (const NativeMacDialogQueue::Request& request)
+    {
+        if (request.key.isNotEmpty())
+            return request.key;
+
+        return request.title + juce::String::charToString (0x1f) + request.message;
+    }
+
+    static juce::uint64 hashKey (const juce::String& key) noexcept
+    {
+        return NativeMacClipboardPayload::Checksum::hash64 (key.toRawUTF8(), key.getNumBytesAsUTF8());
+    }
+
+    // Deleted along with the other DeletedAtShutdown objects, while the message thread still exists
+    struct SharedQueue  : public NativeMacDialogQueue,
+                          private juce::DeletedAtShutdown
+    {
+        ~SharedQueue() override   { instance = nullptr; }
+
+        static std::atomic<SharedQueue*> instance;
+    };
+
+    std::atomic<SharedQueue*> SharedQueue::instance { nullptr };
+}
+
+//==============================================================================
+NativeMacDialogQueue::NativeMacDialogQueue()
+    : NativeMacDialogQueue (Options())
+{
+}
+
+NativeMacDialogQueue::NativeMacDialogQueue (Options o, std::function<double()> c)
+    : options (o),
+      clock (c != nullptr ? std::move (c) : [] { return juce::Time::getMillisecondCounterHiRes(); }),
+      stub (std::make_unique<Node>()),
+      head (stub.get()),
+      tail (stub.get()),
+      tokens ((double) o.burstSize)
+{
+    jassert (options.burstSize > 0 && options.refillIntervalMs > 0 && options.maxPending > 0);
+}
+
+NativeMacDialogQueue::~NativeMacDialogQueue()
+{
+    cancelPendingUpdate();
+    stopTimer();
+
+    for (auto* node = popNode(); node != nullptr; node = popNode())
+        delete node;
+}
+
+NativeMacDialogQueue& NativeMacDialogQueue::getShared()
+{
+    using DialogQueueHelpers::SharedQueue;
+
+    if (auto* queue = SharedQueue::instance.load (std::memory_order_acquire))
+        return *queue;
+
+    static juce::SpinLock lock;
+    const juce::SpinLock::ScopedLockType sl (lock);
+
+    auto* queue = SharedQueue::instance.load (std::memory_order_acquire);
+
+    if (queue == nullptr)
+    {
+        queue = new SharedQueue();
+        SharedQueue::instance.store (queue, std::memory_order_release);
+    }
+
+    return *queue;
+}
+
+//==============================================================================
+// Vyukov's intrusive MPSC queue: a producer swaps itself in as the new head and then
+// links the old head to it, so pushing is one exchange and one store
+void NativeMacDialogQueue::pushNode (Node* node) noexcept
+{
+    node->next.store (nullptr, std::memory_order_relaxed);
+    auto* previous = head.exchange (node, std::memory_order_acq_rel);
+    previous->next.store (node, std::memory_order_release);
+}
+
+NativeMacDialogQueue::Node* NativeMacDialogQueue::popNode() noexcept
+{
+    auto* first = tail;
+    auto* next = first->next.load (std::memory_order_acquire);
+
+    if (first == stub.get())
+    {
+        if (next == nullptr)
+            return nullptr;
+
+        tail = next;
+        first = next;
+        next = next->next.load (std::memory_order_acquire);
+    }
+
+    if (next != nullptr)
+    {
+        tail = next;
+        return first;
+    }
+
+    // A producer has swapped the head but not linked it yet; its node is picked up on a later
+    // poll, which its own wake-up guarantees
+    if (first != head.load (std::memory_order_acquire))
+        return nullptr;
+
+    // first is the only node: put the stub behind it so it can be taken out
+    pushNode (stub.get());
+    next = first->next.load (std::memory_order_acquire);
+
+    if (next != nullptr)
+    {
+        tail = next;
+        return first;
+    }
+
+    return nullptr;
+}
+
+void NativeMacDialogQueue::post (Request request)
+{
+    auto* node = new Node();
+    node->request = std::move (request);
+    pushNode (node);
+
+    ++numPosted;
+    triggerAsyncUpdate();
+}
+
+void NativeMacDialogQueue::postInfo (const juce::String& title, const juce::String& message, Priority priority)
+{
+    Request request;
+    request.priority = priority;
+    request.title = title;
+    request.message = message;
+    post (std::move (request));
+}
+
+//==============================================================================
+void NativeMacDialogQueue::handleAsyncUpdate()
+{
+    timerCallback();
+}
+
+void NativeMacDialogQueue::timerCallback()
+{
+    const auto delayMs = poll (clock());
+
+    if (delayMs < 0)
+        stopTimer();
+    else
+        startTimer (jmax (1, (int) std::ceil (delayMs)));
+}
+
+double NativeMacDialogQueue::poll (double nowMs)
+{
+    // Polls from inside a running dialog (a Timer firing in its modal loop, or a result
+    // callback) are ignored; the outer poll picks up where they would have
+    if (polling)
+        return -1.0;
+
+    const juce::ScopedValueSetter<bool> svs (polling, true);
+
+    drainPosted (nowMs);
+    refill (nowMs);
+
+    auto delayMs = getDelay (nowMs);
+
+    if (delayMs == 0.0)
+    {
+        showNext();
+
+        nowMs = clock();
+        drainPosted (nowMs);
+        refill (nowMs);
+        delayMs = getDelay (nowMs);
+    }
+
+    return delayMs;
+}
+
+//==============================================================================
+void NativeMacDialogQueue::drainPosted (double nowMs)
+{
+    for (auto* node = popNode(); node != nullptr; node = popNode())
+    {
+        std::unique_ptr<Node> owned (node);
+        addPending (std::move (owned->request), nowMs);
+    }
+
+    // The recently shown list only needs the entries still inside the window
+    for (auto it = recentlyShown.begin(); it != recentlyShown.end();)
+    {
+        if (nowMs - it->second.second >= options.duplicateWindowMs)
+            it = recentlyShown.erase (it);
+        else
+            ++it;
+    }
+}
+
+void NativeMacDialogQueue::addPending (Request&& request, double nowMs)
+{
+    auto key = DialogQueueHelpers::getKey (request);
+    const auto hash = DialogQueueHelpers::hashKey (key);
+
+    if (isRecentlyShown (hash, key, nowMs))
+    {
+        ++stats.numSuppressed;
+
+        if (request.onResult != nullptr)
+            request.onResult (-1);
+
+        return;
+    }
+
+    const auto existing = pendingByHash.find (hash);
+
+    if (existing != pendingByHash.end() && existing->second->key == key)
+    {
+        auto& waiting = *existing->second;
+        ++stats.numMerged;
+
+        if (request.onResult != nullptr)
+            waiting.callbacks.push_back (std::move (request.onResult));
+
+        // A more urgent duplicate is counted, but keeps the original's place in line
+        return;
+    }
+
+    Pending entry;
+    entry.key = std::move (key);
+    entry.hash = hash;
+
+    if (request.onResult != nullptr)
+        entry.callbacks.push_back (std::move (request.onResult));
+
+    entry.request = std::move (request);
+
+    auto& fifo = pending[(size_t) entry.request.priority];
+    fifo.push_back (std::move (entry));
+
+    // On a hash collision between different keys, only the first is found for merging
+    if (existing == pendingByHash.end())
+        pendingByHash[hash] = &fifo.back();
+
+    ++numPending;
+    stats.maxPending = jmax (stats.maxPending, numPending);
+
+    if (numPending > options.maxPending)
+        evictOne();
+}
+
+void NativeMacDialogQueue::evictOne()
+{
+    for (auto& fifo : pending)
+    {
+        if (fifo.empty())
+            continue;
+
+        auto evicted = std::move (fifo.front());
+        removeFront (fifo);
+        ++stats.numDropped;
+
+        for (auto& callback : evicted.callbacks)
+            callback (-1);
+
+        return;
+    }
+}
+
+void NativeMacDialogQueue::removeFront (std::deque<Pending>& fifo)
+{
+    const auto it = pendingByHash.find (fifo.front().hash);
+
+    if (it != pendingByHash.end() && it->second == &fifo.front())
+        pendingByHash.erase (it);
+
+    fifo.pop_front();
+    --numPending;
+}
+
+bool NativeMacDialogQueue::isRecentlyShown (juce::uint64 hash, const juce::String& key, double nowMs) const
+{
+    const auto it = recentlyShown.find (hash);
+
+    return it != recentlyShown.end()
+            && it->second.first == key
+            && nowMs - it->second.second < options.duplicateWindowMs;
+}
+
+//==============================================================================
+void NativeMacDialogQueue::refill (double nowMs)
+{
+    if (lastRefillMs >= 0 && nowMs > lastRefillMs)
+        tokens = jmin ((double) options.burstSize, tokens + (nowMs - lastRefillMs) / options.refillIntervalMs);
+
+    lastRefillMs = jmax (lastRefillMs, nowMs);
+}
+
+NativeMacDialogQueue::Pending* NativeMacDialogQueue::getNext() noexcept
+{
+    for (auto fifo = pending.rbegin(); fifo != pending.rend(); ++fifo)
+        if (! fifo->empty())
+            return &fifo->front();
+
+    return nullptr;
+}
+
+double NativeMacDialogQueue::getDelay (double nowMs)
+{
+    auto* next = getNext();
+
+    if (next == nullptr)
+        return -1.0;
+
+    auto delayMs = jmax (0.0, lastClosedMs + options.minGapMs - nowMs);
+
+    if (next->request.priority != Priority::critical && tokens < 1.0)
+    {
+        ++stats.numRateLimited;
+        delayMs = jmax (delayMs, (1.0 - tokens) * options.refillIntervalMs);
+    }
+
+    return delayMs;
+}
+
+void NativeMacDialogQueue::showNext()
+{
+    auto* next = getNext();
+    jassert (next != nullptr);
+
+    auto& fifo = pending[(size_t) next->request.priority];
+    auto shown = std::move (fifo.front());
+    removeFront (fifo);
+
+    if (shown.request.priority != Priority::critical)
+        tokens = jmax (0.0, tokens - 1.0);
+
+    NativeMacDialogBackend::AlertContent content;
+    content.title = shown.request.title;
+    content.message = shown.request.message;
+    content.buttons = shown.request.buttons;
+
+    if (content.buttons.isEmpty())
+        content.buttons.add ("OK");
+
+    int result = -1;
+
+    {
+        const juce::ScopedValueSetter<bool> svs (showing, true);
+        ++stats.numShown;
+
+        auto backend = NativeMacDialogs::getBackend();
+        auto alert = backend->createAlert (shown.request.style, content);
+        result = alert->runModal (nullptr);
+    }
+
+    lastClosedMs = clock();
+    recentlyShown[shown.hash] = std::make_pair (shown.key, lastClosedMs);
+
+    for (auto& callback : shown.callbacks)
+        callback (result);
+}
+
+//==============================================================================
+NativeMacDialogQueue::Stats NativeMacDialogQueue::getStats() const noexcept
+{
+    auto result = stats;
+    result.numPosted = numPosted.load();
+    return result;
+}
+
+void NativeMacDialogQueue::resetStats() noexcept
+{
+    stats = {};
+    stats.maxPending = numPending;
+    numPosted = 0;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacDialogQueueTests  : public juce::UnitTest
+{
+public:
+    NativeMacDialogQueueTests()
+        : juce::UnitTest ("NativeMacDialogQueue", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        using Priority = NativeMacDialogQueue::Priority;
+
+        const auto previousBackend = NativeMacDialogs::getBackend();
+
+        // Records each dialog's title and clicks the first button
+        juce::StringArray shown;
+        std::function<void()> onShow;
+
+        NativeMacDialogs::setBackend (std::make_shared<NativeMacHeadlessDialogBackend> (
+            [&] (const NativeMacDialogBackend::AlertContent& content, juce::String&)
+            {
+                shown.add (content.title);
+
+                if (onShow != nullptr)
+                    onShow();
+
+                return 0;
+            }));
+
+        double nowMs = 0.0;
+        const auto clock = [&nowMs] { return nowMs; };
+
+        beginTest ("Multiple producers");
+        {
+            constexpr int numProducers = 8, numPerProducer = 2000, total = numProducers * numPerProducer;
+
+            NativeMacDialogQueue::Options options;
+            options.minGapMs = 0.0;
+            options.burstSize = total;
+            options.maxPending = total;
+            NativeMacDialogQueue queue (options, clock);
+
+            std::atomic<int> numResults { 0 };
+            std::vector<std::thread> producers;
+
+            for (int producer = 0; producer < numProducers; ++producer)
+            {
+                producers.emplace_back ([&queue, &numResults, producer]
+                {
+                    for (int i = 0; i < numPerProducer; ++i)
+                    {
+                        NativeMacDialogQueue::Request request;
+                        request.title = juce::String (producer) + ":" + juce::String (i);
+                        request.onResult = [&numResults] (int) { ++numResults; };
+                        queue.post (std::move (request));
+                    }
+                });
+            }
+
+            // Consumes while the producers are still pushing, so half-linked nodes are seen
+            for (int attempts = 0; shown.size() < total && attempts < 100 * total; ++attempts)
+            {
+                if (queue.poll (nowMs) < 0)
+                    std::this_thread::yield();
+            }
+
+            for (auto& producer : producers)
+                producer.join();
+
+            while (queue.poll (nowMs) >= 0) {}
+
+            expectEquals (shown.size(), total);
+            expectEquals (numResults.load(), total);
+            expectEquals (queue.getStats().numPosted, (juce::int64) total);
+            expectEquals (queue.getStats().numShown, (juce::int64) total);
+
+            // Each producer's dialogs are shown once each, in the order it posted them
+            std::vector<int> nextIndex (numProducers, 0);
+            bool inOrder = true;
+
+            for (auto& title : shown)
+            {
+                const auto producer = title.upToFirstOccurrenceOf (":", false, false).getIntValue();
+                const auto index = title.fromFirstOccurrenceOf (":", false, false).getIntValue();
+
+                inOrder = inOrder && index == nextIndex[(size_t) producer]++;
+            }
+
+            expect (inOrder);
+            shown.clear();
+        }
+
+        beginTest ("Priorities");
+        {
+            NativeMacDialogQueue queue (NativeMacDialogQueue::Options(), clock);
+
+            for (auto priority : { Priority::low, Priority::normal, Priority::high, Priority::critical })
+                queue.postInfo (juce::String ((int) priority), {}, priority);
+
+            for (nowMs = 0.0; queue.poll (nowMs) >= 0; nowMs += 250.0) {}
+
+            expectEquals (shown.joinIntoString (","), juce::String ("3,2,1,0"));
+            shown.clear();
+        }
+
+        beginTest ("Rate limit");
+        {
+            nowMs = 0.0;
+            NativeMacDialogQueue queue (NativeMacDialogQueue::Options(), clock);
+
+            for (int i = 0; i < 5; ++i)
+                queue.postInfo (juce::String (i), {});
+
+            // Three back to back, 250 ms apart, then one per 2 s as the allowance refills.
+            // A critical request skips the allowance but still waits for the gap
+            juce::StringArray times;
+
+            onShow = [&]
+            {
+                times.add (juce::String (juce::roundToInt (nowMs)));
+
+                if (shown.size() == 4)
+                    queue.postInfo ("critical", {}, Priority::critical);
+            };
+
+            for (auto delayMs = queue.poll (nowMs); delayMs >= 0; delayMs = queue.poll (nowMs))
+                nowMs += delayMs;
+
+            onShow = nullptr;
+
+            expectEquals (shown.joinIntoString (","), juce::String ("0,1,2,3,critical,4"));
+            expectEquals (times.joinIntoString (","), juce::String ("0,250,500,2000,2250,4000"));
+            expectGreaterThan (queue.getStats().numRateLimited, (juce::int64) 0);
+            shown.clear();
+        }
+
+        beginTest ("Duplicates");
+        {
+            nowMs = 0.0;
+            NativeMacDialogQueue queue (NativeMacDialogQueue::Options(), clock);
+
+            juce::Array<int> results;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                NativeMacDialogQueue::Request request;
+                request.title = "Disk full";
+                request.onResult = [&results] (int buttonIndex) { results.add (buttonIndex); };
+                queue.post (std::move (request));
+            }
+
+            queue.poll (nowMs);
+            expectEquals (shown.size(), 1);
+            expectEquals (results.size(), 3);
+            expectEquals (queue.getStats().numMerged, (juce::int64) 2);
+
+            // Suppressed while the shown dialog is recent
+            NativeMacDialogQueue::Request repeat;
+            repeat.title = "Disk full";
+            repeat.onResult = [&results] (int buttonIndex) { results.add (buttonIndex); };
+            queue.post (repeat);
+
+            nowMs = 1000.0;
+            expectEquals (queue.poll (nowMs), -1.0);
+            expectEquals (results.getLast(), -1);
+            expectEquals (queue.getStats().numSuppressed, (juce::int64) 1);
+
+            nowMs = 5000.0;
+            queue.post (repeat);
+            queue.poll (nowMs);
+            expectEquals (shown.size(), 2);
+            expectEquals (results.getLast(), 0);
+            shown.clear();
+        }
+
+        beginTest ("Overflow drops the oldest, least urgent requests");
+        {
+            nowMs = 0.0;
+            NativeMacDialogQueue::Options options;
+            options.maxPending = 3;
+            NativeMacDialogQueue queue (options, clock);
+
+            juce::StringArray dropped;
+
+            for (auto title : { "high", "low 1", "normal", "low 2", "critical" })
+            {
+                NativeMacDialogQueue::Request request;
+                request.title = title;
+                request.priority = juce::String (title).startsWith ("low") ? Priority::low
+                                 : juce::String (title) == "high"          ? Priority::high
+                                 : juce::String (title) == "critical"      ? Priority::critical
+                                                                           : Priority::normal;
+                request.onResult = [&dropped, title] (int buttonIndex) { if (buttonIndex < 0) dropped.add (title); };
+                queue.post (std::move (request));
+            }
+
+            for (; queue.poll (nowMs) >= 0; nowMs += 250.0) {}
+
+            expectEquals (dropped.joinIntoString (","), juce::String ("low 1,low 2"));
+            expectEquals (shown.joinIntoString (","), juce::String ("critical,high,normal"));
+            expectEquals (queue.getStats().numDropped, (juce::int64) 2);
+            expectEquals (queue.getStats().maxPending, 4);
+            shown.clear();
+        }
+
+        beginTest ("Polls from inside a dialog are ignored");
+        {
+            nowMs = 0.0;
+            NativeMacDialogQueue queue (NativeMacDialogQueue::Options(), clock);
+
+            queue.postInfo ("first", {});
+            queue.postInfo ("second", {});
+
+            bool wasShowing = false;
+            double nestedDelay = 0.0;
+
+            onShow = [&]
+            {
+                wasShowing = queue.isShowing();
+                nestedDelay = queue.poll (nowMs);
+                onShow = nullptr;
+            };
+
+            expectEquals (queue.poll (nowMs), 250.0);
+            expect (wasShowing);
+            expectEquals (nestedDelay, -1.0);
+            expectEquals (shown.size(), 1);
+            expectEquals (queue.getNumPending(), 1);
+            shown.clear();
+        }
+
+        beginTest ("Requests never shown are discarded");
+        {
+            auto numResults = 0;
+
+            {
+                NativeMacDialogQueue queue (NativeMacDialogQueue::Options(), clock);
+
+                NativeMacDialogQueue::Request request;
+                request.onResult = [&numResults] (int) { ++numResults; };
+                queue.post (std::move (request));
+            }
+
+            expectEquals (numResults, 0);
+            expect (shown.isEmpty());
+        }
+
+        NativeMacDialogs::setBackend (previousBackend);
+    }
+};
+
+static NativeMacDialogQueueTests nativeMacDialogQueueTests;
+
+#endif
+
+} // namespace juce
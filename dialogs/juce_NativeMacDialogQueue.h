@@ -0,0 +1,208 @@
+/*******************************************************************************
+ Dialog queue
+
+ Lets any thread ask for a dialog; the message thread shows them one at a
+ time, by priority, with duplicates merged and bursts rate limited.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Shows dialogs requested from any thread, one at a time.
+
+    Background tasks (imports, licence checks, exports) can post a dialog
+    request without hopping to the message thread themselves. Posting never
+    waits for the message thread or for other producers: each request is
+    pushed onto a multi-producer, single-consumer linked list with a single
+    atomic exchange, and the message thread drains it. The message thread
+    then applies the queue's policy:
+
+    - Priority: higher priorities are shown first; requests of equal
+      priority keep their posting order. Critical requests are exempt from
+      the token bucket.
+    - Duplicates: a request with the same key as one that is still waiting
+      is merged into it, and one that repeats a dialog shown less than
+      duplicateWindowMs ago is suppressed.
+    - Rate limiting: a token bucket allows a burst of dialogs, then one per
+      refill interval, with at least minGapMs between one dialog closing
+      and the next opening.
+    - Bounds: at most maxPending requests wait; beyond that the oldest
+      request of the lowest priority is dropped.
+
+    Only one dialog is ever on screen: while it runs modally, the queue keeps
+    accepting requests but shows nothing else.
+
+    @code
+    // On a worker thread
+    NativeMacDialogQueue::getShared().postInfo ("Import", "3 presets could not be read.");
+
+    NativeMacDialogQueue::Request request;
+    request.priority = NativeMacDialogQueue::Priority::high;
+    request.title = "Licence";
+    request.message = "Your licence expires tomorrow. Renew now?";
+    request.buttons = { "Renew", "Later" };
+    request.onResult = [] (int button) { if (button == 0) openRenewalPage(); };
+    NativeMacDialogQueue::getShared().post (std::move (request));
+    @endcode
+
+    Dialogs are built by the current NativeMacDialogBackend. All scheduling
+    decisions are made by poll(), which takes the current time as an
+    argument; call it directly with a virtual clock to drive a queue
+    deterministically. Otherwise posting wakes the message thread, which
+    polls from a Timer until the queue is empty.
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacDialogQueue  : private juce::Timer,
+                                        private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    enum class Priority
+    {
+        low,
+        normal,
+        high,
+        critical
+    };
+
+    /** A dialog to show. */
+    struct Request
+    {
+        Priority priority = Priority::normal;
+        NativeMacDialogBackend::AlertStyle style = NativeMacDialogBackend::AlertStyle::informational;
+        juce::String title;
+        juce::String message;
+        juce::StringArray buttons;     /**< Button titles; a single "OK" button if empty. */
+
+        /** Requests with the same key are duplicates; if empty, the title and message are the key. */
+        juce::String key;
+
+        /** Called on the message thread with the index of the clicked button, or -1 if
+            the dialog was dismissed, dropped or suppressed. Merged duplicates all get
+            the result of the dialog they were merged into.
+        */
+        std::function<void (int buttonIndex)> onResult;
+    };
+
+    struct Options
+    {
+        double minGapMs = 250.0;            /**< Between one dialog closing and the next opening. */
+        int burstSize = 3;                  /**< Dialogs that can be shown back to back. */
+        double refillIntervalMs = 2000.0;   /**< Time for the burst allowance to grow by one dialog. */
+        double duplicateWindowMs = 5000.0;  /**< How long a shown dialog suppresses its duplicates. */
+        int maxPending = 64;                /**< Requests that can wait at once. */
+    };
+
+    struct Stats
+    {
+        juce::int64 numPosted = 0;
+        juce::int64 numShown = 0;
+        juce::int64 numMerged = 0;         /**< Duplicates folded into a waiting request. */
+        juce::int64 numSuppressed = 0;     /**< Duplicates of a recently shown dialog. */
+        juce::int64 numDropped = 0;        /**< Requests evicted because too many were waiting. */
+        juce::int64 numRateLimited = 0;    /**< Polls that held back a dialog to respect the rate limit. */
+        int maxPending = 0;                /**< The most requests that waited at once. */
+    };
+
+    //==============================================================================
+    /** Creates a queue with the default options. */
+    NativeMacDialogQueue();
+
+    /** Creates a queue.
+
+        @param options   Rate limits and bounds
+        @param clock     Returns the current time in milliseconds; if empty,
+                         Time::getMillisecondCounterHiRes() is used
+    */
+    explicit NativeMacDialogQueue (Options options, std::function<double()> clock = nullptr);
+
+    /** Destructor. Requests that were never shown are discarded without calling back. */
+    ~NativeMacDialogQueue() override;
+
+    /** Returns the process-wide queue. Can be called from any thread. */
+    static NativeMacDialogQueue& getShared();
+
+    //==============================================================================
+    /** Queues a dialog. Can be called from any thread; never waits for the message thread. */
+    void post (Request request);
+
+    /** Queues an informational dialog with an OK button. Can be called from any thread. */
+    void postInfo (const juce::String& title, const juce::String& message, Priority priority = Priority::normal);
+
+    //==============================================================================
+    /** Takes in posted requests and shows the next dialog if one is allowed at the
+        given time. Shows at most one dialog, and returns straight away if called
+        while a dialog of this queue is on screen. Message thread only.
+
+        @param nowMs   The current time in milliseconds
+        @returns the delay in milliseconds until the next poll is due, or -1 if
+                 nothing is waiting
+    */
+    double poll (double nowMs);
+
+    /** Returns the number of requests waiting to be shown, as of the last poll. */
+    int getNumPending() const noexcept               { return numPending; }
+
+    /** Returns true while one of this queue's dialogs is on screen. */
+    bool isShowing() const noexcept                  { return showing; }
+
+    /** Returns the accumulated counters. */
+    Stats getStats() const noexcept;
+
+    /** Resets the counters. */
+    void resetStats() noexcept;
+
+private:
+    //==============================================================================
+    struct Node;
+
+    struct Pending
+    {
+        Request request;
+        juce::String key;
+        juce::uint64 hash = 0;
+        std::vector<std::function<void (int)>> callbacks;   // the request's own and its merged duplicates'
+    };
+
+    void timerCallback() override;
+    void handleAsyncUpdate() override;
+
+    void pushNode (Node* node) noexcept;
+    Node* popNode() noexcept;
+
+    void drainPosted (double nowMs);
+    void addPending (Request&& request, double nowMs);
+    void evictOne();
+    void removeFront (std::deque<Pending>& fifo);
+    bool isRecentlyShown (juce::uint64 hash, const juce::String& key, double nowMs) const;
+    void refill (double nowMs);
+    Pending* getNext() noexcept;
+    double getDelay (double nowMs);
+    void showNext();
+
+    const Options options;
+    const std::function<double()> clock;
+
+    // Producers exchange the head; the message thread owns the tail
+    std::unique_ptr<Node> stub;
+    std::atomic<Node*> head;
+    Node* tail;
+    std::atomic<juce::int64> numPosted { 0 };
+
+    std::array<std::deque<Pending>, 4> pending;          // one FIFO per priority
+    std::unordered_map<juce::uint64, Pending*> pendingByHash;
+    std::unordered_map<juce::uint64, std::pair<juce::String, double>> recentlyShown;
+    int numPending = 0;
+    bool showing = false, polling = false;
+    double tokens, lastRefillMs = -1.0, lastClosedMs = -1.0e9;
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacDialogQueue)
+};
+
+} // namespace juce
@@ -0,0 +1,266 @@
+/*******************************************************************************
+ NativeMacDialogs - platform independent implementation
+
+ All dialogs are built by the current NativeMacDialogBackend. The NSAlert
+ backend lives in juce_native_macos_dialogs.mm.
+*******************************************************************************/
+
+namespace juce
+{
+
+#if JUCE_MAC
+ // Defined in juce_native_macos_dialogs.mm
+ std::shared_ptr<NativeMacDialogBackend> createNativeMacAlertDialogBackend();
+#endif
+
+namespace DialogHelpers
+{
+    static std::shared_ptr<NativeMacDialogBackend> createDefaultBackend()
+    {
+       #if JUCE_MAC
+        return createNativeMacAlertDialogBackend();
+       #else
+        // Nothing to show dialogs with on this platform, so every dialog is dismissed
+        return std::make_shared<NativeMacHeadlessDialogBackend>();
+       #endif
+    }
+
+    struct BackendHolder
+    {
+        juce::SpinLock lock;
+        std::shared_ptr<NativeMacDialogBackend> backend;
+    };
+
+    static BackendHolder& getBackendHolder()
+    {
+        static BackendHolder holder;
+        return holder;
+    }
+
+    struct SuppressionStoreHolder
+    {
+        juce::SpinLock lock;
+        std::shared_ptr<NativeMacSuppressionStore> store;
+    };
+
+    static SuppressionStoreHolder& getSuppressionStoreHolder()
+    {
+        static SuppressionStoreHolder holder;
+        return holder;
+    }
+
+    static NativeMacDialogBackend::AlertContent makeContent (const juce::String& title,
+                                                             const juce::String& message,
+                                                             const juce::String& button1Text,
+                                                             const juce::String& button2Text = {})
+    {
+        NativeMacDialogBackend::AlertContent content;
+        content.title = title;
+        content.message = message;
+        content.buttons.add (button1Text);
+
+        if (button2Text.isNotEmpty())
+            content.buttons.add (button2Text);
+
+        return content;
+    }
+
+    static bool runTextInput (const juce::String& title,
+                              const juce::String& message,
+                              const juce::String& currentText,
+                              int maxLength,
+                              const juce::String& okButtonText,
+                              const juce::String& cancelButtonText,
+                              juce::String& outText,
+                              const NativeMacTextInputOptions& options)
+    {
+        JUCE_NATIVE_MACOS_TRACE ("dialogs", "showTextInputDialog");
+        JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (showTextInputDialog);
+        NativeMacLatencyStats::ScopedCall call (NativeMacLatencyStats::Function::showTextInputDialog);
+
+        auto content = makeContent (title, message, okButtonText, cancelButtonText);
+        content.hasTextField = true;
+        content.text = currentText;
+        content.maxLength = maxLength;
+        content.textInput = options;
+
+        auto backend = NativeMacDialogs::getBackend();
+        auto alert = backend->createAlert (NativeMacDialogBackend::AlertStyle::warning, content);
+
+        if (alert->runModal (call.getOpenedCallback()) != 0)
+            return false;
+
+        outText = alert->getText();
+        return true;
+    }
+}
+
+//==============================================================================
+void NativeMacDialogs::setBackend (std::shared_ptr<NativeMacDialogBackend> newBackend)
+{
+    auto& holder = DialogHelpers::getBackendHolder();
+
+    const juce::SpinLock::ScopedLockType sl (holder.lock);
+    holder.backend = std::move (newBackend);
+}
+
+std::shared_ptr<NativeMacDialogBackend> NativeMacDialogs::getBackend()
+{
+    auto& holder = DialogHelpers::getBackendHolder();
+
+    const juce::SpinLock::ScopedLockType sl (holder.lock);
+
+    if (holder.backend == nullptr)
+        holder.backend = DialogHelpers::createDefaultBackend();
+
+    return holder.backend;
+}
+
+void NativeMacDialogs::setSuppressionStore (std::shared_ptr<NativeMacSuppressionStore> newStore)
+{
+    auto& holder = DialogHelpers::getSuppressionStoreHolder();
+
+    const juce::SpinLock::ScopedLockType sl (holder.lock);
+    holder.store = std::move (newStore);
+}
+
+std::shared_ptr<NativeMacSuppressionStore> NativeMacDialogs::getSuppressionStore()
+{
+    auto& holder = DialogHelpers::getSuppressionStoreHolder();
+
+    const juce::SpinLock::ScopedLockType sl (holder.lock);
+
+    if (holder.store == nullptr)
+        holder.store = std::make_shared<NativeMacSuppressionStore>();
+
+    return holder.store;
+}
+
+//==============================================================================
+bool NativeMacDialogs::showTextInputDialog (const juce::String& title,
+                                            const juce::String& message,
+                                            const juce::String& currentText,
+                                            int maxLength,
+                                            const juce::String& okButtonText,
+                                            const juce::String& cancelButtonText,
+                                            juce::String& outText)
+{
+    return DialogHelpers::runTextInput (title, message, currentText, maxLength,
+                                        okButtonText, cancelButtonText, outText, {});
+}
+
+bool NativeMacDialogs::showTextInputDialog (const juce::String& title,
+                                            const juce::String& message,
+                                            const juce::String& currentText,
+                                            int maxLength,
+                                            const juce::String& okButtonText,
+                                            const juce::String& cancelButtonText,
+                                            juce::String& outText,
+                                            NativeMacTextValidator& validator)
+{
+    NativeMacTextInputOptions options;
+    options.validator = &validator;
+
+    return DialogHelpers::runTextInput (title, message, currentText, maxLength,
+                                        okButtonText, cancelButtonText, outText, options);
+}
+
+bool NativeMacDialogs::showTextInputDialog (const juce::String& title,
+                                            const juce::String& message,
+                                            const juce::String& currentText,
+                                            int maxLength,
+                                            const juce::String& okButtonText,
+                                            const juce::String& cancelButtonText,
+                                            juce::String& outText,
+                                            const NativeMacTextInputOptions& options)
+{
+    return DialogHelpers::runTextInput (title, message, currentText, maxLength,
+                                        okButtonText, cancelButtonText, outText, options);
+}
+
+//==============================================================================
+void NativeMacDialogs::showInfoDialog (const juce::String& title,
+                                       const juce::String& message,
+                                       const juce::String& buttonText)
+{
+    JUCE_NATIVE_MACOS_TRACE ("dialogs", "showInfoDialog");
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (showInfoDialog);
+    NativeMacLatencyStats::ScopedCall call (NativeMacLatencyStats::Function::showInfoDialog);
+
+    auto backend = getBackend();
+    auto alert = backend->createAlert (NativeMacDialogBackend::AlertStyle::informational,
+                                       DialogHelpers::makeContent (title, message, buttonText));
+    alert->runModal (call.getOpenedCallback());
+}
+
+//==============================================================================
+bool NativeMacDialogs::showConfirmDialog (const juce::String& title,
+                                          const juce::String& message,
+                                          const juce::String& button1Text,
+                                          const juce::String& button2Text)
+{
+    JUCE_NATIVE_MACOS_TRACE ("dialogs", "showConfirmDialog");
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (showConfirmDialog);
+    NativeMacLatencyStats::ScopedCall call (NativeMacLatencyStats::Function::showConfirmDialog);
+
+    auto backend = getBackend();
+    auto alert = backend->createAlert (NativeMacDialogBackend::AlertStyle::warning,
+                                       DialogHelpers::makeContent (title, message, button1Text, button2Text));
+    return alert->runModal (call.getOpenedCallback()) == 0;
+}
+
+bool NativeMacDialogs::showConfirmDialog (const juce::String& title,
+                                          const juce::String& message,
+                                          const juce::String& button1Text,
+                                          const juce::String& button2Text,
+                                          const NativeMacConfirmOptions& options)
+{
+    if (options.suppressionID.isEmpty())
+        return showConfirmDialog (title, message, button1Text, button2Text);
+
+    JUCE_NATIVE_MACOS_TRACE ("dialogs", "showConfirmDialog");
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (showConfirmDialog);
+
+    auto store = getSuppressionStore();
+    int answer = -1;
+
+    if (store->getAnswer (options.suppressionID, answer))
+        return answer == 0;
+
+    // Only timed when the dialog is actually shown
+    NativeMacLatencyStats::ScopedCall call (NativeMacLatencyStats::Function::showConfirmDialog);
+
+    auto content = DialogHelpers::makeContent (title, message, button1Text, button2Text);
+    content.suppressionText = options.suppressionText;
+
+    auto backend = getBackend();
+    auto alert = backend->createAlert (NativeMacDialogBackend::AlertStyle::warning, content);
+    const auto result = alert->runModal (call.getOpenedCallback());
+
+    // A dismissal isn't an answer, so it is never remembered
+    if (result >= 0 && alert->isSuppressionChecked())
+        store->suppress (options.suppressionID, result);
+
+    return result == 0;
+}
+
+//==============================================================================
+bool NativeMacDialogs::showFormDialog (const juce::String& title,
+                                       const juce::String& message,
+                                       NativeMacForm& form,
+                                       const juce::String& okButtonText,
+                                       const juce::String& cancelButtonText)
+{
+    JUCE_NATIVE_MACOS_TRACE ("dialogs", "showFormDialog");
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (showFormDialog);
+    NativeMacLatencyStats::ScopedCall call (NativeMacLatencyStats::Function::showFormDialog);
+
+    auto content = DialogHelpers::makeContent (title, message, okButtonText, cancelButtonText);
+    content.form = &form;
+
+    auto backend = getBackend();
+    auto alert = backend->createAlert (NativeMacDialogBackend::AlertStyle::warning, content);
+    return alert->runModal (call.getOpenedCallback()) == 0;
+}
+
+} // namespace juce
@@ -0,0 +1,473 @@
+/*******************************************************************************
+ Focus restoration after native dialogs - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+NativeMacFocusRestorer::NativeMacFocusRestorer()
+    : NativeMacFocusRestorer (Options())
+{
+}
+
+NativeMacFocusRestorer::NativeMacFocusRestorer (Options o, std::function<double()> c)
+    : options (o),
+      clock (c != nullptr ? std::move (c) : [] { return juce::Time::getMillisecondCounterHiRes(); })
+{
+    jassert (options.dialogPollMs > 0 && options.initialRetryMs > 0);
+    jassert (options.maxRetryMs >= options.initialRetryMs && options.backoffFactor >= 1.0);
+}
+
+NativeMacFocusRestorer::~NativeMacFocusRestorer()
+{
+    stopTimer();
+    target.reset();
+}
+
+namespace FocusRestorerHelpers
+{
+    // Deleted along with the other DeletedAtShutdown objects, while the message thread still exists
+    struct SharedRestorer  : public NativeMacFocusRestorer,
+                             private juce::DeletedAtShutdown
+    {
+        ~SharedRestorer() override   { instance = nullptr; }
+
+        static SharedRestorer* instance;
+    };
+
+    SharedRestorer* SharedRestorer::instance = nullptr;
+}
+
+NativeMacFocusRestorer& NativeMacFocusRestorer::getShared()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    using FocusRestorerHelpers::SharedRestorer;
+
+    if (SharedRestorer::instance == nullptr)
+        SharedRestorer::instance = new SharedRestorer();
+
+    return *SharedRestorer::instance;
+}
+
+//==============================================================================
+void NativeMacFocusRestorer::restore (std::unique_ptr<Target> newTarget)
+{
+    begin (std::move (newTarget), clock());
+
+    // The first check runs from the message loop, once the dialog's modal session has unwound
+    startTimer (1);
+}
+
+void NativeMacFocusRestorer::begin (std::unique_ptr<Target> newTarget, double nowMs)
+{
+    jassert (newTarget != nullptr);
+
+    if (isActive())
+        ++stats.numSuperseded;
+
+    target = std::move (newTarget);
+    state = State::waitingForDialog;
+    dueTimeMs = nowMs;
+    numAttempts = 0;
+    ++stats.numRestores;
+
+   #if JUCE_NATIVE_MACOS_ENABLE_TRACING
+    traceStartTicks = juce::Time::getHighResolutionTicks();
+   #endif
+
+    target->setFocusChangeCallback ([this]
+    {
+        notifyFocusChanged (clock());
+
+        // Deferred, so that focus is never requested from inside AppKit's own notification
+        if (isTimerRunning())
+            startTimer (1);
+    });
+}
+
+void NativeMacFocusRestorer::cancel()
+{
+    stopTimer();
+    target.reset();
+    state = State::idle;
+}
+
+void NativeMacFocusRestorer::notifyFocusChanged (double nowMs)
+{
+    if (state == State::restoring || state == State::confirming)
+        dueTimeMs = jmin (dueTimeMs, nowMs);
+}
+
+//==============================================================================
+bool NativeMacFocusRestorer::isActive() const noexcept
+{
+    return state == State::waitingForDialog || state == State::restoring || state == State::confirming;
+}
+
+double NativeMacFocusRestorer::poll (double nowMs)
+{
+    while (isActive() && nowMs >= dueTimeMs)
+        step (nowMs);
+
+    return isActive() ? dueTimeMs - nowMs : -1.0;
+}
+
+void NativeMacFocusRestorer::timerCallback()
+{
+    const auto delayMs = poll (clock());
+
+    if (delayMs < 0)
+        stopTimer();
+    else
+        startTimer (jmax (1, (int) std::ceil (delayMs)));
+}
+
+void NativeMacFocusRestorer::step (double nowMs)
+{
+    switch (state)
+    {
+        case State::waitingForDialog:
+        {
+            if (! target->isDialogClosed())
+            {
+                dueTimeMs = nowMs + options.dialogPollMs;
+                break;
+            }
+
+            closedTimeMs = nowMs;
+            retryIntervalMs = options.initialRetryMs;
+            state = State::restoring;
+            dueTimeMs = nowMs + options.settleDelayMs;
+            break;
+        }
+
+        case State::restoring:
+        {
+            if (! target->isAvailable())
+            {
+                finish (State::failed);
+                break;
+            }
+
+            if (! target->hasFocus())
+            {
+                if (numAttempts >= options.maxAttempts)
+                {
+                    finish (State::failed);
+                    break;
+                }
+
+                target->requestFocus();
+                ++numAttempts;
+                ++stats.numRequests;
+
+                if (! target->hasFocus())
+                {
+                    dueTimeMs = nowMs + retryIntervalMs;
+                    retryIntervalMs = jmin (retryIntervalMs * options.backoffFactor, options.maxRetryMs);
+                    break;
+                }
+            }
+
+            focusSeenTimeMs = nowMs;
+            state = State::confirming;
+            dueTimeMs = nowMs + options.confirmMs;
+            break;
+        }
+
+        case State::confirming:
+        {
+            if (! (target->isAvailable() && target->hasFocus()))
+            {
+                // The host took focus back - keep trying, with the backoff carried over
+                state = State::restoring;
+                dueTimeMs = nowMs;
+                break;
+            }
+
+            if (nowMs < focusSeenTimeMs + options.confirmMs)
+            {
+                dueTimeMs = focusSeenTimeMs + options.confirmMs;
+                break;
+            }
+
+            const auto latencyMs = focusSeenTimeMs - closedTimeMs;
+            stats.lastLatencyMs = latencyMs;
+            stats.maxLatencyMs = jmax (stats.maxLatencyMs, latencyMs);
+            stats.totalLatencyMs += latencyMs;
+
+            finish (State::succeeded);
+            break;
+        }
+
+        case State::idle:
+        case State::succeeded:
+        case State::failed:
+        default:
+            break;
+    }
+}
+
+void NativeMacFocusRestorer::finish (State finalState)
+{
+    state = finalState;
+
+    if (finalState == State::succeeded)
+        ++stats.numSucceeded;
+    else
+        ++stats.numFailed;
+
+    // Releases the windows and stops focus notifications
+    target.reset();
+
+   #if JUCE_NATIVE_MACOS_ENABLE_TRACING
+    // Spans the whole restore, from the end of the modal loop until focus is confirmed or given up on
+    NativeMacTrace::record ("dialogs", "restoreFocus", traceStartTicks, juce::Time::getHighResolutionTicks());
+   #endif
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacFocusRestorerTests  : public juce::UnitTest
+{
+public:
+    NativeMacFocusRestorerTests()
+        : juce::UnitTest ("NativeMacFocusRestorer", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        using State = NativeMacFocusRestorer::State;
+
+        beginTest ("Focus on the first request");
+        {
+            World world;
+            auto restorer = createRestorer (world);
+
+            restorer->begin (world.createTarget(), 0.0);
+            expect (restorer->getState() == State::waitingForDialog);
+
+            expectEquals (restorer->poll (0.0), 50.0);
+            expect (restorer->getState() == State::confirming);
+            expectEquals (restorer->poll (49.0), 1.0);
+            expectEquals (restorer->poll (50.0), -1.0);
+            expect (restorer->getState() == State::succeeded);
+
+            const auto stats = restorer->getStats();
+            expectEquals (stats.numSucceeded, (juce::int64) 1);
+            expectEquals (stats.numRequests, (juce::int64) 1);
+            expectEquals (stats.lastLatencyMs, 0.0);
+            expectEquals (world.numTargetsAlive, 0);
+        }
+
+        beginTest ("Waits for the dialog to close");
+        {
+            World world;
+            world.dialogClosedAtMs = 12.0;
+            auto restorer = createRestorer (world);
+
+            restorer->begin (world.createTarget(), 0.0);
+            runUntil (*restorer, world, 1000.0);
+
+            // Polled at 0, 5 and 10 before seeing it closed at 15
+            expect (restorer->getState() == State::succeeded);
+            expectEquals (world.requestTimesMs.joinIntoString (","), juce::String ("15"));
+            expectEquals (world.nowMs, 65.0);
+        }
+
+        beginTest ("Retries back off");
+        {
+            World world;
+            world.numRequestsUntilFocus = 4;
+            auto restorer = createRestorer (world);
+
+            restorer->begin (world.createTarget(), 0.0);
+            runUntil (*restorer, world, 1000.0);
+
+            expect (restorer->getState() == State::succeeded);
+            expectEquals (world.requestTimesMs.joinIntoString (","), juce::String ("0,16,48,112"));
+            expectEquals (restorer->getStats().lastLatencyMs, 112.0);
+            expectEquals (restorer->getNumAttempts(), 4);
+        }
+
+        beginTest ("Gives up after the maximum number of attempts");
+        {
+            World world;
+            world.numRequestsUntilFocus = 100;
+            auto restorer = createRestorer (world);
+
+            restorer->begin (world.createTarget(), 0.0);
+            runUntil (*restorer, world, 10000.0);
+
+            expect (restorer->getState() == State::failed);
+            expectEquals (world.requestTimesMs.joinIntoString (","), juce::String ("0,16,48,112,240,490,740,990"));
+            expectEquals (world.nowMs, 1240.0);
+            expectEquals (restorer->getStats().numFailed, (juce::int64) 1);
+            expectEquals (world.numTargetsAlive, 0);
+        }
+
+        beginTest ("Fails when the window goes away");
+        {
+            World world;
+            world.numRequestsUntilFocus = 100;
+            auto restorer = createRestorer (world);
+
+            restorer->begin (world.createTarget(), 0.0);
+            runUntil (*restorer, world, 20.0);
+            expect (restorer->getState() == State::restoring);
+
+            world.isAvailable = false;
+            runUntil (*restorer, world, 1000.0);
+
+            expect (restorer->getState() == State::failed);
+            expectEquals (world.nowMs, 48.0);
+            expectEquals (world.requestTimesMs.size(), 2);
+        }
+
+        beginTest ("Focus taken back while confirming");
+        {
+            World world;
+            auto restorer = createRestorer (world);
+
+            restorer->begin (world.createTarget(), 0.0);
+            runUntil (*restorer, world, 20.0);
+            expect (restorer->getState() == State::confirming);
+
+            // The host steals focus and the target reports it
+            world.hasFocus = false;
+            world.focusChangeCallback();
+
+            runUntil (*restorer, world, 1000.0);
+
+            expect (restorer->getState() == State::succeeded);
+            expectEquals (world.requestTimesMs.joinIntoString (","), juce::String ("0,20"));
+            expectEquals (world.nowMs, 70.0);
+            expectEquals (restorer->getStats().lastLatencyMs, 20.0);
+        }
+
+        beginTest ("Settle delay");
+        {
+            World world;
+            NativeMacFocusRestorer::Options options;
+            options.settleDelayMs = 30.0;
+            auto restorer = createRestorer (world, options);
+
+            restorer->begin (world.createTarget(), 0.0);
+            runUntil (*restorer, world, 1000.0);
+
+            expectEquals (world.requestTimesMs.joinIntoString (","), juce::String ("30"));
+        }
+
+        beginTest ("Superseded and cancelled restores");
+        {
+            World world;
+            world.dialogClosedAtMs = 1000.0;
+            auto restorer = createRestorer (world);
+
+            restorer->begin (world.createTarget(), 0.0);
+            restorer->poll (0.0);
+            restorer->begin (world.createTarget(), 0.0);
+
+            expectEquals (world.numTargetsAlive, 1);
+            expectEquals (restorer->getStats().numSuperseded, (juce::int64) 1);
+            expectEquals (restorer->getStats().numRestores, (juce::int64) 2);
+
+            restorer->cancel();
+            expect (restorer->getState() == State::idle);
+            expectEquals (world.numTargetsAlive, 0);
+            expectEquals (restorer->poll (0.0), -1.0);
+
+            // A finished restore isn't superseded by the next one
+            world.dialogClosedAtMs = 0.0;
+            restorer->begin (world.createTarget(), 0.0);
+            runUntil (*restorer, world, 1000.0);
+            restorer->begin (world.createTarget(), world.nowMs);
+
+            expectEquals (restorer->getStats().numSuperseded, (juce::int64) 1);
+        }
+    }
+
+private:
+    //==============================================================================
+    // Simulated windows and a virtual clock, shared with the targets the restorer owns
+    struct World
+    {
+        double nowMs = 0.0;
+        double dialogClosedAtMs = 0.0;
+        bool isAvailable = true;
+        bool hasFocus = false;
+        int numRequestsUntilFocus = 1;
+        int numTargetsAlive = 0;
+        juce::StringArray requestTimesMs;
+        std::function<void()> focusChangeCallback;
+
+        std::unique_ptr<NativeMacFocusRestorer::Target> createTarget()
+        {
+            hasFocus = false;
+            requestTimesMs.clear();
+            return std::make_unique<FakeTarget> (*this);
+        }
+    };
+
+    struct FakeTarget  : public NativeMacFocusRestorer::Target
+    {
+        explicit FakeTarget (World& w) : world (w)     { ++world.numTargetsAlive; }
+        ~FakeTarget() override                         { --world.numTargetsAlive; }
+
+        bool isDialogClosed() override    { return world.nowMs >= world.dialogClosedAtMs; }
+        bool isAvailable() override       { return world.isAvailable; }
+        bool hasFocus() override          { return world.hasFocus; }
+
+        void requestFocus() override
+        {
+            world.requestTimesMs.add (juce::String (juce::roundToInt (world.nowMs)));
+
+            if (--world.numRequestsUntilFocus <= 0)
+                world.hasFocus = true;
+        }
+
+        void setFocusChangeCallback (std::function<void()> callback) override
+        {
+            world.focusChangeCallback = std::move (callback);
+        }
+
+        World& world;
+    };
+
+    static std::unique_ptr<NativeMacFocusRestorer> createRestorer (World& world,
+                                                                   NativeMacFocusRestorer::Options options = {})
+    {
+        return std::make_unique<NativeMacFocusRestorer> (options, [&world] { return world.nowMs; });
+    }
+
+    // Polls whenever the restorer asks to, until it finishes or the clock reaches endMs
+    static void runUntil (NativeMacFocusRestorer& restorer, World& world, double endMs)
+    {
+        for (;;)
+        {
+            const auto delayMs = restorer.poll (world.nowMs);
+
+            if (delayMs < 0)
+                return;
+
+            if (world.nowMs + delayMs > endMs)
+            {
+                world.nowMs = endMs;
+                return;
+            }
+
+            world.nowMs += delayMs;
+        }
+    }
+};
+
+static NativeMacFocusRestorerTests nativeMacFocusRestorerTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,174 @@
+/*******************************************************************************
+ Focus restoration after native dialogs
+
+ Returns keyboard focus to the host window once a modal dialog has gone,
+ retrying with bounded backoff until the focus is confirmed.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Gives keyboard focus back to the window that had it before a dialog was shown.
+
+    Plugin hosts often re-activate their own windows right after a modal dialog
+    closes, so a single makeKeyAndOrderFront can lose the race. The restorer
+    runs a small state machine instead:
+
+    - waitingForDialog: polls until the dialog window has actually gone
+    - restoring: requests focus, then checks it again after a retry interval
+      that grows by the backoff factor up to a maximum; gives up after
+      maxAttempts requests or if the window disappears
+    - confirming: focus was seen on the window; it must still be there after
+      confirmMs, otherwise restoring resumes
+
+    Focus-change notifications (see notifyFocusChanged()) make the next check
+    happen immediately, so a restore normally finishes as soon as the window
+    becomes key rather than after a fixed delay.
+
+    All scheduling decisions are made by poll(), which takes the current time
+    as an argument; call it directly with a virtual clock to drive a restorer
+    deterministically, or let restore() drive it from a Timer on the message
+    thread. A restorer must only be used from one thread (normally the message
+    thread).
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacFocusRestorer  : private juce::Timer
+{
+public:
+    //==============================================================================
+    struct Options
+    {
+        double settleDelayMs = 0.0;      /**< Wait after the dialog has gone before the first focus request. */
+        double dialogPollMs = 5.0;       /**< How often to check whether the dialog has gone. */
+        double initialRetryMs = 16.0;    /**< Delay between the first focus request and the next check. */
+        double maxRetryMs = 250.0;       /**< Upper bound for the retry interval. */
+        double backoffFactor = 2.0;      /**< Retry interval growth after each failed check. */
+        double confirmMs = 50.0;         /**< How long focus has to stay before the restore counts as done. */
+        int maxAttempts = 8;             /**< Focus requests before giving up. */
+    };
+
+    /** The windows a restore operates on. Implemented with NSWindow in the .mm. */
+    class JUCE_API  Target
+    {
+    public:
+        virtual ~Target() = default;
+
+        /** Returns true once the dialog window has closed. */
+        virtual bool isDialogClosed() = 0;
+
+        /** Returns true while the window to restore still exists and is visible. */
+        virtual bool isAvailable() = 0;
+
+        /** Returns true if the window to restore is the key window. */
+        virtual bool hasFocus() = 0;
+
+        /** Asks for the window to become the key window. */
+        virtual void requestFocus() = 0;
+
+        /** Lets the target report focus changes as they happen. Optional. */
+        virtual void setFocusChangeCallback (std::function<void()> callback)  { juce::ignoreUnused (callback); }
+    };
+
+    enum class State
+    {
+        idle,
+        waitingForDialog,
+        restoring,
+        confirming,
+        succeeded,
+        failed
+    };
+
+    /** Counters and latencies, in milliseconds from the dialog closing to focus being seen. */
+    struct Stats
+    {
+        juce::int64 numRestores = 0;      /**< Restores started. */
+        juce::int64 numSucceeded = 0;     /**< Restores that confirmed focus. */
+        juce::int64 numFailed = 0;        /**< Restores that gave up or lost their window. */
+        juce::int64 numSuperseded = 0;    /**< Restores replaced by a newer one before finishing. */
+        juce::int64 numRequests = 0;      /**< Focus requests made in total. */
+        double lastLatencyMs = 0.0;
+        double maxLatencyMs = 0.0;
+        double totalLatencyMs = 0.0;      /**< Divide by numSucceeded for the mean. */
+    };
+
+    //==============================================================================
+    /** Creates a restorer with the default options. */
+    NativeMacFocusRestorer();
+
+    /** Creates a restorer.
+
+        @param options   Timing and retry limits
+        @param clock     Returns the current time in milliseconds; if empty,
+                         Time::getMillisecondCounterHiRes() is used
+    */
+    explicit NativeMacFocusRestorer (Options options, std::function<double()> clock = nullptr);
+
+    /** Destructor. */
+    ~NativeMacFocusRestorer() override;
+
+    /** Returns the process-wide restorer used by NativeMacDialogs. */
+    static NativeMacFocusRestorer& getShared();
+
+    //==============================================================================
+    /** Starts restoring focus to a target, replacing any restore still in progress,
+        and drives it from a Timer on the message thread.
+    */
+    void restore (std::unique_ptr<Target> target);
+
+    /** Starts restoring focus to a target without starting the Timer; drive it with poll(). */
+    void begin (std::unique_ptr<Target> target, double nowMs);
+
+    /** Advances the state machine to the given time.
+
+        @param nowMs   The current time in milliseconds
+        @returns the delay in milliseconds until the next poll is due, or -1 once
+                 the restore has finished
+    */
+    double poll (double nowMs);
+
+    /** Makes the next check due immediately. Targets call this through their focus-change callback. */
+    void notifyFocusChanged (double nowMs);
+
+    /** Abandons the current restore, if any. */
+    void cancel();
+
+    //==============================================================================
+    /** Returns the current state. */
+    State getState() const noexcept                  { return state; }
+
+    /** Returns the number of focus requests made by the current restore. */
+    int getNumAttempts() const noexcept              { return numAttempts; }
+
+    /** Returns the accumulated counters. */
+    Stats getStats() const noexcept                  { return stats; }
+
+    /** Resets the counters. */
+    void resetStats() noexcept                       { stats = {}; }
+
+private:
+    //==============================================================================
+    void timerCallback() override;
+    bool isActive() const noexcept;
+    void step (double nowMs);
+    void finish (State finalState);
+
+    const Options options;
+    const std::function<double()> clock;
+
+    std::unique_ptr<Target> target;
+    State state = State::idle;
+    double dueTimeMs = 0.0, closedTimeMs = 0.0, focusSeenTimeMs = 0.0, retryIntervalMs = 0.0;
+    int numAttempts = 0;
+    juce::int64 traceStartTicks = 0;       // for the "restoreFocus" trace span
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacFocusRestorer)
+};
+
+} // namespace juce
@@ -0,0 +1,138 @@
+/*******************************************************************************
+ Form dialogs - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+NativeMacForm::NativeMacForm() = default;
+NativeMacForm::~NativeMacForm() = default;
+
+NativeMacForm& NativeMacForm::addTextField (const juce::String& id,
+                                            const juce::String& label,
+                                            const juce::String& initialText,
+                                            int maxLength,
+                                            const NativeMacTextInputOptions& options)
+{
+    jassert (indexOf (id) < 0);   // IDs must be unique
+
+    Field field;
+    field.type = FieldType::text;
+    field.id = id;
+    field.label = label;
+    field.text = initialText;
+    field.maxLength = maxLength;
+    field.textInput = options;
+    fields.push_back (std::move (field));
+    return *this;
+}
+
+NativeMacForm& NativeMacForm::addCheckbox (const juce::String& id, const juce::String& label, bool initiallyChecked)
+{
+    jassert (indexOf (id) < 0);
+
+    Field field;
+    field.type = FieldType::checkbox;
+    field.id = id;
+    field.label = label;
+    field.checked = initiallyChecked;
+    fields.push_back (std::move (field));
+    return *this;
+}
+
+NativeMacForm& NativeMacForm::addPopup (const juce::String& id,
+                                        const juce::String& label,
+                                        const juce::StringArray& items,
+                                        int initialIndex)
+{
+    jassert (indexOf (id) < 0);
+    jassert (items.size() > 0);
+
+    Field field;
+    field.type = FieldType::popup;
+    field.id = id;
+    field.label = label;
+    field.items = items;
+    field.selectedIndex = jlimit (0, jmax (0, items.size() - 1), initialIndex);
+    fields.push_back (std::move (field));
+    return *this;
+}
+
+//==============================================================================
+int NativeMacForm::indexOf (const juce::String& id) const noexcept
+{
+    for (size_t i = 0; i < fields.size(); ++i)
+        if (fields[i].id == id)
+            return (int) i;
+
+    return -1;
+}
+
+const NativeMacForm::Field* NativeMacForm::find (const juce::String& id, FieldType type) const
+{
+    const auto index = indexOf (id);
+
+    if (index < 0 || fields[(size_t) index].type != type)
+    {
+        jassertfalse;   // no field of that type with this ID
+        return nullptr;
+    }
+
+    return &fields[(size_t) index];
+}
+
+juce::String NativeMacForm::getText (const juce::String& id) const
+{
+    auto* field = find (id, FieldType::text);
+    return field != nullptr ? field->text : juce::String();
+}
+
+bool NativeMacForm::isChecked (const juce::String& id) const
+{
+    auto* field = find (id, FieldType::checkbox);
+    return field != nullptr && field->checked;
+}
+
+int NativeMacForm::getSelectedIndex (const juce::String& id) const
+{
+    auto* field = find (id, FieldType::popup);
+    return field != nullptr ? field->selectedIndex : -1;
+}
+
+juce::String NativeMacForm::getSelectedItem (const juce::String& id) const
+{
+    auto* field = find (id, FieldType::popup);
+
+    if (field == nullptr || ! isPositiveAndBelow (field->selectedIndex, field->items.size()))
+        return {};
+
+    return field->items[field->selectedIndex];
+}
+
+int NativeMacForm::findInvalidField() const
+{
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        auto& field = fields[i];
+
+        if (field.type != FieldType::text)
+            continue;
+
+        if (field.maxLength > 0
+             && NativeMacTextLimiter::count (field.text, field.textInput.lengthUnit) > field.maxLength)
+            return (int) i;
+
+        if (auto* validator = field.textInput.validator)
+        {
+            validator->reset();
+
+            if (validator->validate (field.text).failed())
+                return (int) i;
+        }
+    }
+
+    return -1;
+}
+
+} // namespace juce
@@ -0,0 +1,133 @@
+/*******************************************************************************
+ Form dialogs
+
+ A declarative description of a dialog with several fields, shown in one
+ modal session.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    The fields of a form dialog, and their values.
+
+    Describe the fields once, show the form with NativeMacDialogs::showFormDialog(),
+    and read every value back when it returns. This replaces a chain of text
+    input and confirm dialogs with a single alert, so the user sees one dialog
+    and focus is restored once.
+
+    @code
+    NativeMacTextValidator nameValidator;
+    nameValidator.requireNonEmpty ("Enter a name").forbidFileNameCharacters();
+
+    NativeMacTextInputOptions nameOptions;
+    nameOptions.validator = &nameValidator;
+
+    NativeMacForm form;
+    form.addTextField ("name", "Name:", {}, 64, nameOptions)
+        .addTextField ("author", "Author:", lastAuthor)
+        .addPopup ("category", "Category:", { "Bass", "Lead", "Pad" })
+        .addCheckbox ("favourite", "Add to favourites");
+
+    if (NativeMacDialogs::showFormDialog ("Save Preset", "Describe the preset:", form, "Save", "Cancel"))
+        savePreset (form.getText ("name"), form.getText ("author"),
+                    form.getSelectedItem ("category"), form.isChecked ("favourite"));
+    @endcode
+
+    The values are only updated when the first button is clicked, so showing
+    the same form again starts from the last accepted values.
+
+    @see NativeMacFormLayout
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacForm
+{
+public:
+    //==============================================================================
+    enum class FieldType
+    {
+        text,
+        checkbox,
+        popup
+    };
+
+    /** One field of the form. */
+    struct Field
+    {
+        FieldType type = FieldType::text;
+        juce::String id;
+        juce::String label;                   /**< For checkboxes, the checkbox title. */
+
+        juce::String text;                    /**< Text fields: the text. */
+        int maxLength = 0;                    /**< Text fields: length limit in textInput.lengthUnit (0 = no limit). */
+        NativeMacTextInputOptions textInput;  /**< Text fields: validator, completions and length unit. */
+
+        bool checked = false;                 /**< Checkboxes: the state. */
+
+        juce::StringArray items;              /**< Popups: the items. */
+        int selectedIndex = 0;                /**< Popups: the selected item. */
+    };
+
+    //==============================================================================
+    /** Creates an empty form. */
+    NativeMacForm();
+
+    /** Destructor. */
+    ~NativeMacForm();
+
+    /** Adds a text field. */
+    NativeMacForm& addTextField (const juce::String& id,
+                                 const juce::String& label,
+                                 const juce::String& initialText = {},
+                                 int maxLength = 0,
+                                 const NativeMacTextInputOptions& options = {});
+
+    /** Adds a checkbox; the label is shown as its title. */
+    NativeMacForm& addCheckbox (const juce::String& id, const juce::String& label, bool initiallyChecked = false);
+
+    /** Adds a popup menu button. */
+    NativeMacForm& addPopup (const juce::String& id,
+                             const juce::String& label,
+                             const juce::StringArray& items,
+                             int initialIndex = 0);
+
+    //==============================================================================
+    int getNumFields() const noexcept                      { return (int) fields.size(); }
+    const Field& getField (int index) const                { return fields[(size_t) index]; }
+    Field& getField (int index)                            { return fields[(size_t) index]; }
+
+    /** Returns the index of the field with this ID, or -1. */
+    int indexOf (const juce::String& id) const noexcept;
+
+    /** Returns a text field's text. */
+    juce::String getText (const juce::String& id) const;
+
+    /** Returns a checkbox's state. */
+    bool isChecked (const juce::String& id) const;
+
+    /** Returns a popup's selected index. */
+    int getSelectedIndex (const juce::String& id) const;
+
+    /** Returns a popup's selected item. */
+    juce::String getSelectedItem (const juce::String& id) const;
+
+    /** Checks every text field with its validator and length limit.
+
+        @returns the index of the first invalid field, or -1 if all are valid
+    */
+    int findInvalidField() const;
+
+private:
+    //==============================================================================
+    const Field* find (const juce::String& id, FieldType type) const;
+
+    std::vector<Field> fields;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacForm)
+};
+
+} // namespace juce
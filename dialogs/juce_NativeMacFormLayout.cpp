@@ -0,0 +1,242 @@
+/*******************************************************************************
+ Form layout - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+NativeMacFormLayout::NativeMacFormLayout (const NativeMacForm& form)
+    : NativeMacFormLayout (form, Metrics())
+{
+}
+
+NativeMacFormLayout::NativeMacFormLayout (const NativeMacForm& form, const Metrics& metrics, MeasureFunction measureLabel)
+    : width (metrics.width)
+{
+    using FieldType = NativeMacForm::FieldType;
+
+    if (measureLabel == nullptr)
+        measureLabel = [&metrics] (const juce::String& text) { return estimateTextWidth (text, metrics.averageCharWidth); };
+
+    // Checkboxes carry their own label, so only the other fields size the label column
+    for (int i = 0; i < form.getNumFields(); ++i)
+    {
+        auto& field = form.getField (i);
+
+        if (field.type != FieldType::checkbox && field.label.isNotEmpty())
+            labelColumnWidth = jmax (labelColumnWidth, std::ceil (measureLabel (field.label)));
+    }
+
+    labelColumnWidth = jmin (labelColumnWidth, metrics.maxLabelWidth);
+
+    const auto controlX = labelColumnWidth > 0 ? labelColumnWidth + metrics.labelGap : 0.0f;
+    const auto controlWidth = jmax (0.0f, width - controlX);
+
+    rows.reserve ((size_t) form.getNumFields());
+    float y = 0;
+
+    for (int i = 0; i < form.getNumFields(); ++i)
+    {
+        auto& field = form.getField (i);
+        const auto hasLabel = field.type != FieldType::checkbox && field.label.isNotEmpty();
+
+        const auto controlHeight = field.type == FieldType::text     ? metrics.textFieldHeight
+                                 : field.type == FieldType::checkbox ? metrics.checkboxHeight
+                                                                     : metrics.popupHeight;
+        const auto rowHeight = hasLabel ? jmax (controlHeight, metrics.labelHeight) : controlHeight;
+
+        if (i > 0)
+            y += metrics.rowGap;
+
+        Row row;
+        row.control = { controlX, y + (rowHeight - controlHeight) * 0.5f, controlWidth, controlHeight };
+
+        if (hasLabel)
+            row.label = { 0.0f, row.control.getCentreY() - metrics.labelHeight * 0.5f, labelColumnWidth, metrics.labelHeight };
+
+        y += rowHeight;
+
+        if (field.type == FieldType::text && field.textInput.validator != nullptr)
+        {
+            row.message = { controlX, y, controlWidth, metrics.messageHeight };
+            y += metrics.messageHeight;
+        }
+
+        rows.push_back (row);
+    }
+
+    height = y;
+}
+
+NativeMacFormLayout::~NativeMacFormLayout() = default;
+
+//==============================================================================
+float NativeMacFormLayout::estimateTextWidth (const juce::String& text, float averageCharWidth)
+{
+    return (float) NativeMacTextLimiter::count (text, NativeMacTextLimiter::Unit::graphemes) * averageCharWidth;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacFormLayoutTests  : public juce::UnitTest
+{
+public:
+    NativeMacFormLayoutTests()
+        : juce::UnitTest ("NativeMacFormLayout", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        using Rect = juce::Rectangle<float>;
+
+        NativeMacTextValidator validator;
+        validator.requireNonEmpty ("Choose a folder");
+
+        NativeMacTextInputOptions validated;
+        validated.validator = &validator;
+
+        beginTest ("Row geometry");
+        {
+            NativeMacForm form;
+            form.addTextField ("name", "Name")
+                .addCheckbox ("open", "Open the file after saving it")
+                .addPopup ("format", "Format", { "WAV", "AIFF" })
+                .addTextField ("folder", "Folder", {}, 0, validated);
+
+            // The default metrics, with labels estimated at 7 points a character
+            const NativeMacFormLayout layout (form);
+
+            expectEquals (layout.getNumRows(), 4);
+            expectEquals (layout.getLabelColumnWidth(), 42.0f);
+            expectEquals (layout.getWidth(), 320.0f);
+            expectEquals (layout.getHeight(), 128.0f);
+
+            expectRow (layout.getRow (0), { 0, 3, 42, 16 },  { 50, 0, 270, 22 },  {});
+            expectRow (layout.getRow (1), {},                { 50, 30, 270, 18 }, {});
+            expectRow (layout.getRow (2), { 0, 61, 42, 16 }, { 50, 56, 270, 26 }, {});
+            expectRow (layout.getRow (3), { 0, 93, 42, 16 }, { 50, 90, 270, 22 }, { 50, 112, 270, 16 });
+        }
+
+        beginTest ("Label column");
+        {
+            NativeMacFormLayout::Metrics metrics;
+            metrics.width = 400.0f;
+            metrics.maxLabelWidth = 100.0f;
+
+            NativeMacForm form;
+            form.addTextField ("a", "Short").addTextField ("b", "A much longer label");
+
+            // Measured widths are rounded up, and clamped to the maximum
+            expectEquals (NativeMacFormLayout (form, metrics, [] (const juce::String&) { return 30.2f; }).getLabelColumnWidth(), 31.0f);
+            expectEquals (NativeMacFormLayout (form, metrics, [] (const juce::String& t) { return (float) t.length() * 10.0f; }).getLabelColumnWidth(), 100.0f);
+
+            // Controls take the whole width when no field has a label
+            NativeMacForm unlabelled;
+            unlabelled.addTextField ("a", {}).addCheckbox ("b", "Checkbox titles aren't labels");
+
+            const NativeMacFormLayout layout (unlabelled, metrics);
+            expectEquals (layout.getLabelColumnWidth(), 0.0f);
+            expect (layout.getRow (0).label.isEmpty());
+            expect (layout.getRow (0).control == Rect (0, 0, 400, 22));
+        }
+
+        beginTest ("Labels taller than their controls");
+        {
+            NativeMacFormLayout::Metrics metrics;
+            metrics.labelHeight = 30.0f;
+
+            NativeMacForm form;
+            form.addTextField ("a", "Name").addCheckbox ("b", "Checkbox");
+
+            const NativeMacFormLayout layout (form, metrics);
+            expectRow (layout.getRow (0), { 0, 0, 28, 30 }, { 36, 4, 284, 22 }, {});
+            expectRow (layout.getRow (1), {}, { 36, 38, 284, 18 }, {});
+            expectEquals (layout.getHeight(), 56.0f);
+        }
+
+        beginTest ("Estimated label widths count grapheme clusters");
+        {
+            expectEquals (NativeMacFormLayout::estimateTextWidth ("abc", 7.0f), 21.0f);
+            expectEquals (NativeMacFormLayout::estimateTextWidth (juce::CharPointer_UTF8 ("e\xcc\x81te\xcc\x81"), 7.0f), 21.0f);
+            expectEquals (NativeMacFormLayout::estimateTextWidth ({}, 7.0f), 0.0f);
+        }
+
+        beginTest ("Random forms");
+        {
+            auto random = getRandom();
+
+            for (int i = 0; i < 200; ++i)
+            {
+                NativeMacForm form;
+                const auto numFields = random.nextInt (8);
+
+                for (int j = 0; j < numFields; ++j)
+                {
+                    const auto label = juce::String ("Label").substring (0, random.nextInt (6));
+
+                    switch (random.nextInt (4))
+                    {
+                        case 0:   form.addCheckbox (juce::String (j), label); break;
+                        case 1:   form.addPopup (juce::String (j), label, { "One" }); break;
+                        case 2:   form.addTextField (juce::String (j), label, {}, 0, validated); break;
+                        default:  form.addTextField (juce::String (j), label); break;
+                    }
+                }
+
+                NativeMacFormLayout::Metrics metrics;
+                metrics.width = 100.0f + (float) random.nextInt (400);
+                metrics.labelHeight = 10.0f + (float) random.nextInt (20);
+
+                const NativeMacFormLayout layout (form, metrics);
+                expectEquals (layout.getNumRows(), numFields);
+
+                auto bottom = 0.0f;
+
+                for (int j = 0; j < layout.getNumRows(); ++j)
+                {
+                    const auto& row = layout.getRow (j);
+                    const auto top = j > 0 ? bottom + metrics.rowGap : 0.0f;
+
+                    expectGreaterOrEqual (row.control.getY(), top);
+                    expectLessOrEqual (row.control.getRight(), metrics.width);
+
+                    if (! row.label.isEmpty())
+                    {
+                        expectGreaterOrEqual (row.label.getY(), top);
+                        expectLessOrEqual (row.label.getRight(), row.control.getX());
+                        expectEquals (row.label.getCentreY(), row.control.getCentreY());
+                    }
+
+                    bottom = jmax (row.control.getBottom(), row.label.getBottom());
+
+                    if (! row.message.isEmpty())
+                    {
+                        expectEquals (row.message.getY(), bottom);
+                        bottom = row.message.getBottom();
+                    }
+                }
+
+                expectEquals (layout.getHeight(), bottom);
+            }
+        }
+    }
+
+private:
+    void expectRow (const NativeMacFormLayout::Row& row,
+                    juce::Rectangle<float> label, juce::Rectangle<float> control, juce::Rectangle<float> message)
+    {
+        expect (row.label == label, "label " + row.label.toString());
+        expect (row.control == control, "control " + row.control.toString());
+        expect (row.message == message, "message " + row.message.toString());
+    }
+};
+
+static NativeMacFormLayoutTests nativeMacFormLayoutTests;
+
+#endif
+
+} // namespace juce
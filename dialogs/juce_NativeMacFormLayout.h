@@ -0,0 +1,94 @@
+/*******************************************************************************
+ Form layout
+
+ Computes where the controls of a form dialog go, without any AppKit code.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    The layout of a form dialog's accessory view.
+
+    Every field gets one row. Labels of text fields and popups are right-aligned
+    in a column as wide as the widest label (up to Metrics::maxLabelWidth), the
+    controls fill the rest of the width, and checkboxes line up with the
+    controls with their label as the title. A text field with a validator gets
+    a message line below it for the validation error.
+
+    Rectangles are in top-down coordinates, with the origin at the top-left of
+    the view; AppKit callers flip them. Label widths come from the measure
+    function, so the platform code can pass in real text metrics; without one
+    they are estimated from Metrics::averageCharWidth, which is enough for
+    tests and headless use.
+
+    @see NativeMacForm
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacFormLayout
+{
+public:
+    //==============================================================================
+    /** Sizes and spacing, in points. The defaults match the AppKit controls. */
+    struct Metrics
+    {
+        float width = 320.0f;              /**< Width of the whole view. */
+        float maxLabelWidth = 140.0f;
+        float labelGap = 8.0f;             /**< Between the label column and the controls. */
+        float rowGap = 8.0f;
+        float labelHeight = 16.0f;
+        float textFieldHeight = 22.0f;
+        float checkboxHeight = 18.0f;
+        float popupHeight = 26.0f;
+        float messageHeight = 16.0f;       /**< The validation message below a text field. */
+        float averageCharWidth = 7.0f;     /**< Used to estimate label widths without a measure function. */
+    };
+
+    /** Returns the width of a label's text. */
+    using MeasureFunction = std::function<float (const juce::String& text)>;
+
+    /** The rectangles of one field. Empty rectangles mean the part isn't there. */
+    struct Row
+    {
+        juce::Rectangle<float> label;
+        juce::Rectangle<float> control;
+        juce::Rectangle<float> message;
+    };
+
+    //==============================================================================
+    /** Lays out a form with the default metrics and estimated label widths. */
+    explicit NativeMacFormLayout (const NativeMacForm& form);
+
+    /** Lays out a form.
+
+        @param form          The fields; there is one row per field
+        @param metrics       Sizes and spacing
+        @param measureLabel  Returns label widths; if null they are estimated
+    */
+    NativeMacFormLayout (const NativeMacForm& form, const Metrics& metrics, MeasureFunction measureLabel = nullptr);
+
+    /** Destructor. */
+    ~NativeMacFormLayout();
+
+    //==============================================================================
+    int getNumRows() const noexcept                      { return (int) rows.size(); }
+    const Row& getRow (int index) const                  { return rows[(size_t) index]; }
+
+    float getWidth() const noexcept                      { return width; }
+    float getHeight() const noexcept                     { return height; }
+    float getLabelColumnWidth() const noexcept           { return labelColumnWidth; }
+
+    /** Estimates a text's width from its length in grapheme clusters. */
+    static float estimateTextWidth (const juce::String& text, float averageCharWidth);
+
+private:
+    //==============================================================================
+    std::vector<Row> rows;
+    float width = 0, height = 0, labelColumnWidth = 0;
+};
+
+} // namespace juce
@@ -0,0 +1,154 @@
+/*******************************************************************************
+ Grapheme cluster break data
+
+ Generated from the Unicode 14.0 Grapheme_Cluster_Break and
+ Extended_Pictographic properties (GraphemeBreakProperty.txt, emoji-data.txt).
+
+ Each entry is (first code point << 5) | property, sorted by code point; an
+ entry covers every code point up to the next entry. The property values are
+ those of TextLimiterHelpers::GraphemeProperty. Hangul syllables U+AC00..U+D7A3
+ are a single entry and are split into LV and LVT algorithmically.
+
+ Included by juce_NativeMacTextLimiter.cpp.
+*******************************************************************************/
+
+namespace juce
+{
+namespace TextLimiterHelpers
+{
+
+static const uint32 graphemeBreakTable[] =
+{
+    0x00000003, 0x00000142, 0x00000163, 0x000001a1, 0x000001c3, 0x00000400, 0x00000fe3, 0x00001400,
+    0x0000152d, 0x00001540, 0x000015a3, 0x000015cd, 0x000015e0, 0x00006004, 0x00006e00, 0x00009064,
+    0x00009140, 0x0000b224, 0x0000b7c0, 0x0000b7e4, 0x0000b800, 0x0000b824, 0x0000b860, 0x0000b884,
+    0x0000b8c0, 0x0000b8e4, 0x0000b900, 0x0000c007, 0x0000c0c0, 0x0000c204, 0x0000c360, 0x0000c383,
+    0x0000c3a0, 0x0000c964, 0x0000cc00, 0x0000ce04, 0x0000ce20, 0x0000dac4, 0x0000dba7, 0x0000dbc0,
+    0x0000dbe4, 0x0000dca0, 0x0000dce4, 0x0000dd20, 0x0000dd44, 0x0000ddc0, 0x0000e1e7, 0x0000e200,
+    0x0000e224, 0x0000e240, 0x0000e604, 0x0000e960, 0x0000f4c4, 0x0000f620, 0x0000fd64, 0x0000fe80,
+    0x0000ffa4, 0x0000ffc0, 0x000102c4, 0x00010340, 0x00010364, 0x00010480, 0x000104a4, 0x00010500,
+    0x00010524, 0x000105c0, 0x00010b24, 0x00010b80, 0x00011207, 0x00011240, 0x00011304, 0x00011400,
+    0x00011944, 0x00011c47, 0x00011c64, 0x00012068, 0x00012080, 0x00012744, 0x00012768, 0x00012784,
+    0x000127a0, 0x000127c8, 0x00012824, 0x00012928, 0x000129a4, 0x000129c8, 0x00012a00, 0x00012a24,
+    0x00012b00, 0x00012c44, 0x00012c80, 0x00013024, 0x00013048, 0x00013080, 0x00013784, 0x000137a0,
+    0x000137c4, 0x000137e8, 0x00013824, 0x000138a0, 0x000138e8, 0x00013920, 0x00013968, 0x000139a4,
+    0x000139c0, 0x00013ae4, 0x00013b00, 0x00013c44, 0x00013c80, 0x00013fc4, 0x00013fe0, 0x00014024,
+    0x00014068, 0x00014080, 0x00014784, 0x000147a0, 0x000147c8, 0x00014824, 0x00014860, 0x000148e4,
+    0x00014920, 0x00014964, 0x000149c0, 0x00014a24, 0x00014a40, 0x00014e04, 0x00014e40, 0x00014ea4,
+    0x00014ec0, 0x00015024, 0x00015068, 0x00015080, 0x00015784, 0x000157a0, 0x000157c8, 0x00015824,
+    0x000158c0, 0x000158e4, 0x00015928, 0x00015940, 0x00015968, 0x000159a4, 0x000159c0, 0x00015c44,
+    0x00015c80, 0x00015f44, 0x00016000, 0x00016024, 0x00016048, 0x00016080, 0x00016784, 0x000167a0,
+    0x000167c4, 0x00016808, 0x00016824, 0x000168a0, 0x000168e8, 0x00016920, 0x00016968, 0x000169a4,
+    0x000169c0, 0x00016aa4, 0x00016b00, 0x00016c44, 0x00016c80, 0x00017044, 0x00017060, 0x000177c4,
+    0x000177e8, 0x00017804, 0x00017828, 0x00017860, 0x000178c8, 0x00017920, 0x00017948, 0x000179a4,
+    0x000179c0, 0x00017ae4, 0x00017b00, 0x00018004, 0x00018028, 0x00018084, 0x000180a0, 0x00018784,
+    0x000187a0, 0x000187c4, 0x00018828, 0x000188a0, 0x000188c4, 0x00018920, 0x00018944, 0x000189c0,
+    0x00018aa4, 0x00018ae0, 0x00018c44, 0x00018c80, 0x00019024, 0x00019048, 0x00019080, 0x00019784,
+    0x000197a0, 0x000197c8, 0x000197e4, 0x00019808, 0x00019844, 0x00019868, 0x000198a0, 0x000198c4,
+    0x000198e8, 0x00019920, 0x00019948, 0x00019984, 0x000199c0, 0x00019aa4, 0x00019ae0, 0x00019c44,
+    0x00019c80, 0x0001a004, 0x0001a048, 0x0001a080, 0x0001a764, 0x0001a7a0, 0x0001a7c4, 0x0001a7e8,
+    0x0001a824, 0x0001a8a0, 0x0001a8c8, 0x0001a920, 0x0001a948, 0x0001a9a4, 0x0001a9c7, 0x0001a9e0,
+    0x0001aae4, 0x0001ab00, 0x0001ac44, 0x0001ac80, 0x0001b024, 0x0001b048, 0x0001b080, 0x0001b944,
+    0x0001b960, 0x0001b9e4, 0x0001ba08, 0x0001ba44, 0x0001baa0, 0x0001bac4, 0x0001bae0, 0x0001bb08,
+    0x0001bbe4, 0x0001bc00, 0x0001be48, 0x0001be80, 0x0001c624, 0x0001c640, 0x0001c668, 0x0001c684,
+    0x0001c760, 0x0001c8e4, 0x0001c9e0, 0x0001d624, 0x0001d640, 0x0001d668, 0x0001d684, 0x0001d7a0,
+    0x0001d904, 0x0001d9c0, 0x0001e304, 0x0001e340, 0x0001e6a4, 0x0001e6c0, 0x0001e6e4, 0x0001e700,
+    0x0001e724, 0x0001e740, 0x0001e7c8, 0x0001e800, 0x0001ee24, 0x0001efe8, 0x0001f004, 0x0001f0a0,
+    0x0001f0c4, 0x0001f100, 0x0001f1a4, 0x0001f300, 0x0001f324, 0x0001f7a0, 0x0001f8c4, 0x0001f8e0,
+    0x000205a4, 0x00020628, 0x00020644, 0x00020700, 0x00020724, 0x00020768, 0x000207a4, 0x000207e0,
+    0x00020ac8, 0x00020b04, 0x00020b40, 0x00020bc4, 0x00020c20, 0x00020e24, 0x00020ea0, 0x00021044,
+    0x00021060, 0x00021088, 0x000210a4, 0x000210e0, 0x000211a4, 0x000211c0, 0x000213a4, 0x000213c0,
+    0x00022009, 0x00022c0a, 0x0002350b, 0x00024000, 0x00026ba4, 0x00026c00, 0x0002e244, 0x0002e2a8,
+    0x0002e2c0, 0x0002e644, 0x0002e688, 0x0002e6a0, 0x0002ea44, 0x0002ea80, 0x0002ee44, 0x0002ee80,
+    0x0002f684, 0x0002f6c8, 0x0002f6e4, 0x0002f7c8, 0x0002f8c4, 0x0002f8e8, 0x0002f924, 0x0002fa80,
+    0x0002fba4, 0x0002fbc0, 0x00030164, 0x000301c3, 0x000301e4, 0x00030200, 0x000310a4, 0x000310e0,
+    0x00031524, 0x00031540, 0x00032404, 0x00032468, 0x000324e4, 0x00032528, 0x00032580, 0x00032608,
+    0x00032644, 0x00032668, 0x00032724, 0x00032780, 0x000342e4, 0x00034328, 0x00034364, 0x00034380,
+    0x00034aa8, 0x00034ac4, 0x00034ae8, 0x00034b04, 0x00034be0, 0x00034c04, 0x00034c20, 0x00034c44,
+    0x00034c60, 0x00034ca4, 0x00034da8, 0x00034e64, 0x00034fa0, 0x00034fe4, 0x00035000, 0x00035604,
+    0x000359e0, 0x00036004, 0x00036088, 0x000360a0, 0x00036684, 0x00036768, 0x00036784, 0x000367a8,
+    0x00036844, 0x00036868, 0x000368a0, 0x00036d64, 0x00036e80, 0x00037004, 0x00037048, 0x00037060,
+    0x00037428, 0x00037444, 0x000374c8, 0x00037504, 0x00037548, 0x00037564, 0x000375c0, 0x00037cc4,
+    0x00037ce8, 0x00037d04, 0x00037d48, 0x00037da4, 0x00037dc8, 0x00037de4, 0x00037e48, 0x00037e80,
+    0x00038488, 0x00038584, 0x00038688, 0x000386c4, 0x00038700, 0x00039a04, 0x00039a60, 0x00039a84,
+    0x00039c28, 0x00039c44, 0x00039d20, 0x00039da4, 0x00039dc0, 0x00039e84, 0x00039ea0, 0x00039ee8,
+    0x00039f04, 0x00039f40, 0x0003b804, 0x0003c000, 0x00040163, 0x00040184, 0x000401a5, 0x000401c3,
+    0x00040200, 0x00040503, 0x000405e0, 0x0004078d, 0x000407a0, 0x0004092d, 0x00040940, 0x00040c03,
+    0x00040e00, 0x00041a04, 0x00041e20, 0x0004244d, 0x00042460, 0x0004272d, 0x00042740, 0x0004328d,
+    0x00043340, 0x0004352d, 0x00043560, 0x0004634d, 0x00046380, 0x0004650d, 0x00046520, 0x0004710d,
+    0x00047120, 0x000479ed, 0x00047a00, 0x00047d2d, 0x00047e80, 0x00047f0d, 0x00047f60, 0x0004984d,
+    0x00049860, 0x0004b54d, 0x0004b580, 0x0004b6cd, 0x0004b6e0, 0x0004b80d, 0x0004b820, 0x0004bf6d,
+    0x0004bfe0, 0x0004c00d, 0x0004c0c0, 0x0004c0ed, 0x0004c260, 0x0004c28d, 0x0004d0c0, 0x0004d20d,
+    0x0004e0c0, 0x0004e10d, 0x0004e260, 0x0004e28d, 0x0004e2a0, 0x0004e2cd, 0x0004e2e0, 0x0004e3ad,
+    0x0004e3c0, 0x0004e42d, 0x0004e440, 0x0004e50d, 0x0004e520, 0x0004e66d, 0x0004e6a0, 0x0004e88d,
+    0x0004e8a0, 0x0004e8ed, 0x0004e900, 0x0004e98d, 0x0004e9a0, 0x0004e9cd, 0x0004e9e0, 0x0004ea6d,
+    0x0004eac0, 0x0004eaed, 0x0004eb00, 0x0004ec6d, 0x0004ed00, 0x0004f2ad, 0x0004f300, 0x0004f42d,
+    0x0004f440, 0x0004f60d, 0x0004f620, 0x0004f7ed, 0x0004f800, 0x0005268d, 0x000526c0, 0x000560ad,
+    0x00056100, 0x0005636d, 0x000563a0, 0x00056a0d, 0x00056a20, 0x00056aad, 0x00056ac0, 0x00059de4,
+    0x00059e40, 0x0005afe4, 0x0005b000, 0x0005bc04, 0x0005c000, 0x00060544, 0x0006060d, 0x00060620,
+    0x000607ad, 0x000607c0, 0x00061324, 0x00061360, 0x000652ed, 0x00065300, 0x0006532d, 0x00065340,
+    0x0014cde4, 0x0014ce60, 0x0014ce84, 0x0014cfc0, 0x0014d3c4, 0x0014d400, 0x0014de04, 0x0014de40,
+    0x00150044, 0x00150060, 0x001500c4, 0x001500e0, 0x00150164, 0x00150180, 0x00150468, 0x001504a4,
+    0x001504e8, 0x00150500, 0x00150584, 0x001505a0, 0x00151008, 0x00151040, 0x00151688, 0x00151884,
+    0x001518c0, 0x00151c04, 0x00151e40, 0x00151fe4, 0x00152000, 0x001524c4, 0x001525c0, 0x001528e4,
+    0x00152a48, 0x00152a80, 0x00152c09, 0x00152fa0, 0x00153004, 0x00153068, 0x00153080, 0x00153664,
+    0x00153688, 0x001536c4, 0x00153748, 0x00153784, 0x001537c8, 0x00153820, 0x00153ca4, 0x00153cc0,
+    0x00154524, 0x001545e8, 0x00154624, 0x00154668, 0x001546a4, 0x001546e0, 0x00154864, 0x00154880,
+    0x00154984, 0x001549a8, 0x001549c0, 0x00154f84, 0x00154fa0, 0x00155604, 0x00155620, 0x00155644,
+    0x001556a0, 0x001556e4, 0x00155720, 0x001557c4, 0x00155800, 0x00155824, 0x00155840, 0x00155d68,
+    0x00155d84, 0x00155dc8, 0x00155e00, 0x00155ea8, 0x00155ec4, 0x00155ee0, 0x00157c68, 0x00157ca4,
+    0x00157cc8, 0x00157d04, 0x00157d28, 0x00157d60, 0x00157d88, 0x00157da4, 0x00157dc0, 0x0015800c,
+    0x001af480, 0x001af60a, 0x001af8e0, 0x001af96b, 0x001aff80, 0x001f63c4, 0x001f63e0, 0x001fc004,
+    0x001fc200, 0x001fc404, 0x001fc600, 0x001fdfe3, 0x001fe000, 0x001ff3c4, 0x001ff400, 0x001ffe03,
+    0x001fff80, 0x00203fa4, 0x00203fc0, 0x00205c04, 0x00205c20, 0x00206ec4, 0x00206f60, 0x00214024,
+    0x00214080, 0x002140a4, 0x002140e0, 0x00214184, 0x00214200, 0x00214704, 0x00214760, 0x002147e4,
+    0x00214800, 0x00215ca4, 0x00215ce0, 0x0021a484, 0x0021a500, 0x0021d564, 0x0021d5a0, 0x0021e8c4,
+    0x0021ea20, 0x0021f044, 0x0021f0c0, 0x00220008, 0x00220024, 0x00220048, 0x00220060, 0x00220704,
+    0x002208e0, 0x00220e04, 0x00220e20, 0x00220e64, 0x00220ea0, 0x00220fe4, 0x00221048, 0x00221060,
+    0x00221608, 0x00221664, 0x002216e8, 0x00221724, 0x00221760, 0x002217a7, 0x002217c0, 0x00221844,
+    0x00221860, 0x002219a7, 0x002219c0, 0x00222004, 0x00222060, 0x002224e4, 0x00222588, 0x002225a4,
+    0x002226a0, 0x002228a8, 0x002228e0, 0x00222e64, 0x00222e80, 0x00223004, 0x00223048, 0x00223060,
+    0x00223668, 0x002236c4, 0x002237e8, 0x00223820, 0x00223847, 0x00223880, 0x00223924, 0x002239a0,
+    0x002239c8, 0x002239e4, 0x00223a00, 0x00224588, 0x002245e4, 0x00224648, 0x00224684, 0x002246a8,
+    0x002246c4, 0x00224700, 0x002247c4, 0x002247e0, 0x00225be4, 0x00225c08, 0x00225c64, 0x00225d60,
+    0x00226004, 0x00226048, 0x00226080, 0x00226764, 0x002267a0, 0x002267c4, 0x002267e8, 0x00226804,
+    0x00226828, 0x002268a0, 0x002268e8, 0x00226920, 0x00226968, 0x002269c0, 0x00226ae4, 0x00226b00,
+    0x00226c48, 0x00226c80, 0x00226cc4, 0x00226da0, 0x00226e04, 0x00226ea0, 0x002286a8, 0x00228704,
+    0x00228808, 0x00228844, 0x002288a8, 0x002288c4, 0x002288e0, 0x00228bc4, 0x00228be0, 0x00229604,
+    0x00229628, 0x00229664, 0x00229728, 0x00229744, 0x00229768, 0x002297a4, 0x002297c8, 0x002297e4,
+    0x00229828, 0x00229844, 0x00229880, 0x0022b5e4, 0x0022b608, 0x0022b644, 0x0022b6c0, 0x0022b708,
+    0x0022b784, 0x0022b7c8, 0x0022b7e4, 0x0022b820, 0x0022bb84, 0x0022bbc0, 0x0022c608, 0x0022c664,
+    0x0022c768, 0x0022c7a4, 0x0022c7c8, 0x0022c7e4, 0x0022c820, 0x0022d564, 0x0022d588, 0x0022d5a4,
+    0x0022d5c8, 0x0022d604, 0x0022d6c8, 0x0022d6e4, 0x0022d700, 0x0022e3a4, 0x0022e400, 0x0022e444,
+    0x0022e4c8, 0x0022e4e4, 0x0022e580, 0x00230588, 0x002305e4, 0x00230708, 0x00230724, 0x00230760,
+    0x00232604, 0x00232628, 0x002326c0, 0x002326e8, 0x00232720, 0x00232764, 0x002327a8, 0x002327c4,
+    0x002327e7, 0x00232808, 0x00232827, 0x00232848, 0x00232864, 0x00232880, 0x00233a28, 0x00233a84,
+    0x00233b00, 0x00233b44, 0x00233b88, 0x00233c04, 0x00233c20, 0x00233c88, 0x00233ca0, 0x00234024,
+    0x00234160, 0x00234664, 0x00234728, 0x00234747, 0x00234764, 0x002347e0, 0x002348e4, 0x00234900,
+    0x00234a24, 0x00234ae8, 0x00234b24, 0x00234b80, 0x00235087, 0x00235144, 0x002352e8, 0x00235304,
+    0x00235340, 0x002385e8, 0x00238604, 0x002386e0, 0x00238704, 0x002387c8, 0x002387e4, 0x00238800,
+    0x00239244, 0x00239500, 0x00239528, 0x00239544, 0x00239628, 0x00239644, 0x00239688, 0x002396a4,
+    0x002396e0, 0x0023a624, 0x0023a6e0, 0x0023a744, 0x0023a760, 0x0023a784, 0x0023a7c0, 0x0023a7e4,
+    0x0023a8c7, 0x0023a8e4, 0x0023a900, 0x0023b148, 0x0023b1e0, 0x0023b204, 0x0023b240, 0x0023b268,
+    0x0023b2a4, 0x0023b2c8, 0x0023b2e4, 0x0023b300, 0x0023de64, 0x0023dea8, 0x0023dee0, 0x00268603,
+    0x00268720, 0x002d5e04, 0x002d5ea0, 0x002d6604, 0x002d66e0, 0x002de9e4, 0x002dea00, 0x002dea28,
+    0x002df100, 0x002df1e4, 0x002df260, 0x002dfc84, 0x002dfca0, 0x002dfe08, 0x002dfe40, 0x003793a4,
+    0x003793e0, 0x00379403, 0x00379480, 0x0039e004, 0x0039e5c0, 0x0039e604, 0x0039e8e0, 0x003a2ca4,
+    0x003a2cc8, 0x003a2ce4, 0x003a2d40, 0x003a2da8, 0x003a2dc4, 0x003a2e63, 0x003a2f64, 0x003a3060,
+    0x003a30a4, 0x003a3180, 0x003a3544, 0x003a35c0, 0x003a4844, 0x003a48a0, 0x003b4004, 0x003b46e0,
+    0x003b4764, 0x003b4da0, 0x003b4ea4, 0x003b4ec0, 0x003b5084, 0x003b50a0, 0x003b5364, 0x003b5400,
+    0x003b5424, 0x003b5600, 0x003c0004, 0x003c00e0, 0x003c0104, 0x003c0320, 0x003c0364, 0x003c0440,
+    0x003c0464, 0x003c04a0, 0x003c04c4, 0x003c0560, 0x003c2604, 0x003c26e0, 0x003c55c4, 0x003c55e0,
+    0x003c5d84, 0x003c5e00, 0x003d1a04, 0x003d1ae0, 0x003d2884, 0x003d2960, 0x003e000d, 0x003e2000,
+    0x003e21ad, 0x003e2200, 0x003e25ed, 0x003e2600, 0x003e2d8d, 0x003e2e40, 0x003e2fcd, 0x003e3000,
+    0x003e31cd, 0x003e31e0, 0x003e322d, 0x003e3360, 0x003e35ad, 0x003e3cc6, 0x003e4000, 0x003e402d,
+    0x003e4200, 0x003e434d, 0x003e4360, 0x003e45ed, 0x003e4600, 0x003e464d, 0x003e4760, 0x003e478d,
+    0x003e4800, 0x003e492d, 0x003e7f64, 0x003e800d, 0x003ea7c0, 0x003ea8cd, 0x003eca00, 0x003ed00d,
+    0x003ee000, 0x003eee8d, 0x003ef000, 0x003efaad, 0x003f0000, 0x003f018d, 0x003f0200, 0x003f090d,
+    0x003f0a00, 0x003f0b4d, 0x003f0c00, 0x003f110d, 0x003f1200, 0x003f15cd, 0x003f2000, 0x003f218d,
+    0x003f2760, 0x003f278d, 0x003f28c0, 0x003f28ed, 0x003f6000, 0x003f800d, 0x003fffc0, 0x01c00003,
+    0x01c00404, 0x01c01003, 0x01c02004, 0x01c03e03, 0x01c20000,
+};
+
+} // namespace TextLimiterHelpers
+} // namespace juce
@@ -0,0 +1,520 @@
+/*******************************************************************************
+ Message aggregation - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+namespace MessageAggregatorHelpers
+{
+    static juce::String truncateLine (const juce::String& text, int maxLength)
+    {
+        if (maxLength <= 0 || NativeMacTextLimiter::count (text, NativeMacTextLimiter::Unit::graphemes) <= maxLength)
+            return text;
+
+        return NativeMacTextLimiter::truncate (text, maxLength - 1, NativeMacTextLimiter::Unit::graphemes)
+                 + juce::String::charToString ((juce::juce_wchar) 0x2026);
+    }
+}
+
+//==============================================================================
+juce::String NativeMacMessageAggregator::Summary::toText (int maxDetailLines) const
+{
+    juce::String text;
+
+    for (auto& category : categories)
+        text << category.name << ": " << juce::String (category.count) << "\n";
+
+    juce::int64 numListed = 0;
+
+    for (auto& category : categories)
+    {
+        for (auto& detail : category.details)
+        {
+            if (numListed >= maxDetailLines)
+                break;
+
+            text << (numListed == 0 ? "\n" : "") << category.name << " - " << detail << "\n";
+            ++numListed;
+        }
+    }
+
+    if (numListed > 0 && totalCount > numListed)
+        text << "...and " << juce::String (totalCount - numListed) << " more\n";
+
+    return text.trimEnd();
+}
+
+//==============================================================================
+NativeMacMessageAggregator::Task::Task (NativeMacMessageAggregator& o)
+    : owner (o)
+{
+    owner.beginTask();
+}
+
+NativeMacMessageAggregator::Task::~Task()
+{
+    owner.endTask();
+}
+
+//==============================================================================
+NativeMacMessageAggregator::NativeMacMessageAggregator (const juce::String& t)
+    : NativeMacMessageAggregator (t, Options())
+{
+}
+
+NativeMacMessageAggregator::NativeMacMessageAggregator (const juce::String& t,
+                                                        Options o,
+                                                        Emitter e,
+                                                        std::function<double()> c)
+    : title (t),
+      options (std::move (o)),
+      emitter (std::move (e)),
+      clock (c != nullptr ? std::move (c) : [] { return juce::Time::getMillisecondCounterHiRes(); })
+{
+    jassert (options.maxCategories > 0 && options.maxDetailsPerCategory >= 0 && options.maxDetailLines >= 0);
+}
+
+NativeMacMessageAggregator::~NativeMacMessageAggregator()
+{
+    jassert (numOpenTasks == 0);   // a Task must not outlive its aggregator
+
+    cancelPendingUpdate();
+    stopTimer();
+}
+
+//==============================================================================
+void NativeMacMessageAggregator::add (const juce::String& category, const juce::String& detail)
+{
+    // Segmenting and copying the text is the expensive part, so it's done before taking the
+    // lock, even for details that turn out not to be kept
+    const auto line = detail.isNotEmpty() ? MessageAggregatorHelpers::truncateLine (detail, options.maxLineLength)
+                                          : juce::String();
+
+    bool isFirst = false;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (lock);
+
+        isFirst = (batch.totalCount == 0);
+        ++batch.totalCount;
+        ++stats.numMessages;
+
+        auto& categories = batch.categories;
+
+        const auto findCategory = [&categories] (const juce::String& name)
+        {
+            for (size_t i = 0; i < categories.size(); ++i)
+                if (categories[i].name == name)
+                    return i;
+
+            return categories.size();
+        };
+
+        auto index = findCategory (category);
+
+        if (index == categories.size())
+        {
+            if ((int) categories.size() < options.maxCategories)
+            {
+                categories.push_back ({ category, 0, {} });
+            }
+            else
+            {
+                ++stats.numCategoriesFolded;
+                index = findCategory (options.otherCategoryName);
+
+                if (index == categories.size())
+                    categories.push_back ({ options.otherCategoryName, 0, {} });
+            }
+        }
+
+        auto& entry = categories[index];
+        ++entry.count;
+
+        if (line.isNotEmpty())
+        {
+            if (entry.details.size() < options.maxDetailsPerCategory)
+                entry.details.add (line);
+            else
+                ++stats.numDetailsDropped;
+        }
+    }
+
+    // Only the first message of a batch needs to wake the message thread
+    if (isFirst)
+        triggerAsyncUpdate();
+}
+
+void NativeMacMessageAggregator::beginTask()
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+    ++numOpenTasks;
+}
+
+void NativeMacMessageAggregator::endTask()
+{
+    {
+        const juce::SpinLock::ScopedLockType sl (lock);
+        jassert (numOpenTasks > 0);
+
+        if (--numOpenTasks == 0)
+            tasksFinished = true;
+    }
+
+    triggerAsyncUpdate();
+}
+
+//==============================================================================
+void NativeMacMessageAggregator::handleAsyncUpdate()
+{
+    timerCallback();
+}
+
+void NativeMacMessageAggregator::timerCallback()
+{
+    const auto delayMs = poll (clock());
+
+    if (delayMs < 0)
+        stopTimer();
+    else
+        startTimer (jmax (1, (int) std::ceil (delayMs)));
+}
+
+double NativeMacMessageAggregator::poll (double nowMs)
+{
+    Summary due;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (lock);
+
+        if (batch.totalCount == 0)
+        {
+            tasksFinished = false;
+            batchStartMs = -1.0;
+            return -1.0;
+        }
+
+        // The window starts when the message thread first sees the batch
+        if (batchStartMs < 0)
+            batchStartMs = nowMs;
+
+        // While a task is open, its end wakes the message thread
+        if (numOpenTasks > 0)
+            return -1.0;
+
+        if (! tasksFinished)
+        {
+            if (options.windowMs <= 0)
+                return -1.0;
+
+            if (nowMs - batchStartMs < options.windowMs)
+                return batchStartMs + options.windowMs - nowMs;
+        }
+
+        std::swap (due, batch);
+        tasksFinished = false;
+        batchStartMs = -1.0;
+    }
+
+    emit (std::move (due));
+    return -1.0;
+}
+
+void NativeMacMessageAggregator::flush()
+{
+    Summary due;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (lock);
+        std::swap (due, batch);
+        tasksFinished = false;
+        batchStartMs = -1.0;
+    }
+
+    if (due.totalCount > 0)
+        emit (std::move (due));
+}
+
+void NativeMacMessageAggregator::emit (Summary&& summary)
+{
+    summary.title = title;
+
+    // Most frequent first; the catch-all category goes last whatever its count
+    const auto& otherName = options.otherCategoryName;
+
+    std::stable_sort (summary.categories.begin(), summary.categories.end(),
+                      [&otherName] (const Summary::Category& a, const Summary::Category& b)
+                      {
+                          const auto aIsOther = (a.name == otherName), bIsOther = (b.name == otherName);
+
+                          if (aIsOther != bIsOther)
+                              return bIsOther;
+
+                          return a.count > b.count;
+                      });
+
+    {
+        const juce::SpinLock::ScopedLockType sl (lock);
+        ++stats.numSummaries;
+    }
+
+    if (emitter != nullptr)
+    {
+        emitter (summary);
+        return;
+    }
+
+    NativeMacDialogQueue::Request request;
+    request.style = NativeMacDialogBackend::AlertStyle::warning;
+    request.title = summary.title;
+    request.message = summary.toText (options.maxDetailLines);
+    NativeMacDialogQueue::getShared().post (std::move (request));
+}
+
+//==============================================================================
+juce::int64 NativeMacMessageAggregator::getNumPending() const
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+    return batch.totalCount;
+}
+
+NativeMacMessageAggregator::Stats NativeMacMessageAggregator::getStats() const
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+    return stats;
+}
+
+void NativeMacMessageAggregator::resetStats()
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+    stats = {};
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacMessageAggregatorTests  : public juce::UnitTest
+{
+public:
+    NativeMacMessageAggregatorTests()
+        : juce::UnitTest ("NativeMacMessageAggregator", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        using Aggregator = NativeMacMessageAggregator;
+
+        beginTest ("Window");
+        {
+            Sink sink;
+            Aggregator aggregator ("Import", Aggregator::Options(), sink.getEmitter(), [] { return 0.0; });
+
+            expectEquals (aggregator.poll (0.0), -1.0);
+
+            aggregator.add ("Missing");
+            expectEquals (aggregator.poll (100.0), 2000.0);
+
+            // Later messages join the batch without moving its deadline
+            aggregator.add ("Missing");
+            aggregator.add ("Corrupted");
+            expectEquals (aggregator.poll (1600.0), 500.0);
+            expect (sink.summaries.empty());
+            expectEquals (aggregator.getNumPending(), (juce::int64) 3);
+
+            expectEquals (aggregator.poll (2100.0), -1.0);
+            expectEquals ((int) sink.summaries.size(), 1);
+            expectEquals (sink.summaries[0].title, juce::String ("Import"));
+            expectEquals (sink.summaries[0].totalCount, (juce::int64) 3);
+            expectEquals (aggregator.getNumPending(), (juce::int64) 0);
+
+            // The next batch's window starts when it is first polled
+            aggregator.add ("Missing");
+            expectEquals (aggregator.poll (5000.0), 2000.0);
+            expectEquals (aggregator.poll (6999.0), 1.0);
+            aggregator.poll (7000.0);
+            expectEquals ((int) sink.summaries.size(), 2);
+            expectEquals (aggregator.getStats().numSummaries, (juce::int64) 2);
+            expectEquals (aggregator.getStats().numMessages, (juce::int64) 4);
+        }
+
+        beginTest ("No window");
+        {
+            Sink sink;
+            Aggregator::Options options;
+            options.windowMs = 0.0;
+            Aggregator aggregator ("Import", options, sink.getEmitter(), [] { return 0.0; });
+
+            aggregator.add ("Missing");
+            expectEquals (aggregator.poll (0.0), -1.0);
+            expectEquals (aggregator.poll (1.0e9), -1.0);
+            expect (sink.summaries.empty());
+
+            aggregator.flush();
+            expectEquals ((int) sink.summaries.size(), 1);
+
+            // Nothing to flush
+            aggregator.flush();
+            expectEquals ((int) sink.summaries.size(), 1);
+        }
+
+        beginTest ("Tasks");
+        {
+            Sink sink;
+            Aggregator aggregator ("Import", Aggregator::Options(), sink.getEmitter(), [] { return 0.0; });
+
+            {
+                Aggregator::Task outer (aggregator);
+
+                {
+                    Aggregator::Task inner (aggregator);
+                    aggregator.add ("Missing");
+                    expectEquals (aggregator.poll (0.0), -1.0);
+                }
+
+                // Held past the window while a task is still open
+                aggregator.add ("Missing");
+                expectEquals (aggregator.poll (0.0), -1.0);
+                expectEquals (aggregator.poll (10000.0), -1.0);
+                expect (sink.summaries.empty());
+            }
+
+            // The end of the last task emits without waiting for the window
+            aggregator.poll (10001.0);
+            expectEquals ((int) sink.summaries.size(), 1);
+            expectEquals (sink.summaries[0].totalCount, (juce::int64) 2);
+
+            // A task that ends with nothing added doesn't affect the next batch
+            {
+                Aggregator::Task task (aggregator);
+            }
+
+            expectEquals (aggregator.poll (20000.0), -1.0);
+            aggregator.add ("Missing");
+            expectEquals (aggregator.poll (20000.0), 2000.0);
+            expectEquals ((int) sink.summaries.size(), 1);
+        }
+
+        beginTest ("Categories and details");
+        {
+            Sink sink;
+            Aggregator::Options options;
+            options.maxCategories = 3;
+            options.maxDetailsPerCategory = 2;
+            options.maxLineLength = 10;
+            Aggregator aggregator ("Import", options, sink.getEmitter(), [] { return 0.0; });
+
+            aggregator.add ("A", "a1");
+            aggregator.add ("B", "b1");
+            aggregator.add ("B", "b2");
+            aggregator.add ("B", "b3");
+            aggregator.add ("C");
+            aggregator.add ("D", "d1");
+            aggregator.add ("E");
+            aggregator.add ("E");
+            aggregator.add ("E");
+            aggregator.add ("E");
+            aggregator.add ("A", "abcdefghijklmnop");
+            aggregator.flush();
+
+            expectEquals ((int) sink.summaries.size(), 1);
+            const auto& summary = sink.summaries[0];
+
+            // Most frequent first, with the catch-all last whatever its count
+            juce::StringArray names;
+
+            for (auto& entry : summary.categories)
+                names.add (entry.name + "=" + juce::String (entry.count));
+
+            expectEquals (names.joinIntoString (","), juce::String ("B=3,A=2,C=1,Other=5"));
+            expectEquals (summary.totalCount, (juce::int64) 11);
+
+            expectEquals (summary.categories[0].details.joinIntoString (","), juce::String ("b1,b2"));
+            expectEquals (summary.categories[1].details[1],
+                          juce::String ("abcdefghi") + juce::String::charToString ((juce::juce_wchar) 0x2026));
+            expectEquals (summary.categories[3].details.joinIntoString (","), juce::String ("d1"));
+
+            const auto stats = aggregator.getStats();
+            expectEquals (stats.numCategoriesFolded, (juce::int64) 5);
+            expectEquals (stats.numDetailsDropped, (juce::int64) 1);
+
+            aggregator.resetStats();
+            expectEquals (aggregator.getStats().numMessages, (juce::int64) 0);
+        }
+
+        beginTest ("Summary text");
+        {
+            Aggregator::Summary summary;
+            summary.totalCount = 7;
+            summary.categories.push_back ({ "Missing", 5, juce::StringArray { "a", "b", "c" } });
+            summary.categories.push_back ({ "Corrupted", 2, juce::StringArray { "d" } });
+
+            expectEquals (summary.toText (3),
+                          juce::String ("Missing: 5\nCorrupted: 2\n\nMissing - a\nMissing - b\nMissing - c\n...and 4 more"));
+
+            expectEquals (summary.toText (0), juce::String ("Missing: 5\nCorrupted: 2"));
+        }
+
+        beginTest ("Concurrent adds");
+        {
+            Sink sink;
+            Aggregator::Options options;
+            options.windowMs = 0.0;
+            Aggregator aggregator ("Import", options, sink.getEmitter(), [] { return 0.0; });
+
+            constexpr int numThreads = 8, numPerThread = 5000;
+            std::vector<std::thread> threads;
+
+            for (int i = 0; i < numThreads; ++i)
+            {
+                threads.emplace_back ([&aggregator, i]
+                {
+                    for (int j = 0; j < numPerThread; ++j)
+                        aggregator.add ("Category " + juce::String (i % 4), juce::String (j));
+                });
+            }
+
+            // Batches taken while the threads are adding must still add up
+            while (aggregator.getStats().numMessages < numThreads * numPerThread)
+                aggregator.flush();
+
+            for (auto& thread : threads)
+                thread.join();
+
+            aggregator.flush();
+
+            juce::int64 total = 0, totalOfCategories = 0;
+
+            for (auto& summary : sink.summaries)
+            {
+                total += summary.totalCount;
+
+                for (auto& entry : summary.categories)
+                    totalOfCategories += entry.count;
+            }
+
+            expectEquals (total, (juce::int64) numThreads * numPerThread);
+            expectEquals (totalOfCategories, total);
+            expectEquals (aggregator.getStats().numSummaries, (juce::int64) sink.summaries.size());
+        }
+    }
+
+private:
+    struct Sink
+    {
+        NativeMacMessageAggregator::Emitter getEmitter()
+        {
+            return [this] (const NativeMacMessageAggregator::Summary& summary) { summaries.push_back (summary); };
+        }
+
+        std::vector<NativeMacMessageAggregator::Summary> summaries;
+    };
+};
+
+static NativeMacMessageAggregatorTests nativeMacMessageAggregatorTests;
+
+#endif
+
+} // namespace juce
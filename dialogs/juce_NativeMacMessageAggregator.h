@@ -0,0 +1,177 @@
+/*******************************************************************************
+ Message aggregation
+
+ Collects many messages, e.g. one per failed file of an import, into one
+ summary dialog.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Turns a stream of messages into one summary dialog per batch.
+
+    Instead of one dialog per error, a long-running task adds each message
+    with a category. The aggregator counts messages per category and keeps
+    only a few example details, so its memory stays bounded however many
+    messages arrive. A batch is emitted as a single summary when either
+
+    - windowMs has passed since the batch's first message, and no task is
+      open, or
+    - the last open task ends (see Task), or
+    - flush() is called.
+
+    The summary lists the categories by count, followed by a detail section
+    truncated to a fixed number of lines, each cut to a maximum length:
+
+    @code
+    NativeMacMessageAggregator problems ("Preset Import");
+
+    {
+        NativeMacMessageAggregator::Task task (problems);   // hold the summary until the import is done
+
+        for (auto& file : files)                            // on any thread
+            if (! importPreset (file))
+                problems.add ("Corrupted presets", file.getFileName());
+    }
+    // -> one dialog: "Corrupted presets: 400" and the first few file names
+    @endcode
+
+    add() can be called from any thread. Summaries are emitted on the message
+    thread, by default as a warning posted to NativeMacDialogQueue::getShared().
+    All timing decisions are made by poll(), which takes the current time as
+    an argument; call it directly with a virtual clock to drive an aggregator
+    deterministically.
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacMessageAggregator  : private juce::Timer,
+                                              private juce::AsyncUpdater
+{
+public:
+    //==============================================================================
+    struct Options
+    {
+        double windowMs = 2000.0;          /**< Time from a batch's first message to its summary (0 = only on task end or flush()). */
+        int maxCategories = 16;            /**< Further categories are counted under otherCategoryName. */
+        int maxDetailsPerCategory = 5;     /**< Example details kept per category. */
+        int maxDetailLines = 20;           /**< Detail lines shown in a summary, over all categories. */
+        int maxLineLength = 120;           /**< Details are cut to this many characters (grapheme clusters). */
+        juce::String otherCategoryName = "Other";
+    };
+
+    /** A batch of messages, as passed to the emitter. */
+    struct Summary
+    {
+        struct Category
+        {
+            juce::String name;
+            juce::int64 count = 0;
+            juce::StringArray details;     /**< The first few details, already truncated. */
+        };
+
+        juce::String title;
+        juce::int64 totalCount = 0;
+        std::vector<Category> categories;  /**< Most frequent first. */
+
+        /** Formats the counts and up to maxDetailLines details as dialog text. */
+        juce::String toText (int maxDetailLines) const;
+    };
+
+    /** Receives each summary on the message thread. */
+    using Emitter = std::function<void (const Summary& summary)>;
+
+    /** Holds back a batch's summary while a task is still producing messages. */
+    class JUCE_API  Task
+    {
+    public:
+        explicit Task (NativeMacMessageAggregator& owner);
+        ~Task();
+
+    private:
+        NativeMacMessageAggregator& owner;
+
+        JUCE_DECLARE_NON_COPYABLE (Task)
+    };
+
+    struct Stats
+    {
+        juce::int64 numMessages = 0;
+        juce::int64 numSummaries = 0;
+        juce::int64 numDetailsDropped = 0;    /**< Details counted but not kept. */
+        juce::int64 numCategoriesFolded = 0;  /**< Messages counted under otherCategoryName. */
+    };
+
+    //==============================================================================
+    /** Creates an aggregator with the default options, emitting to NativeMacDialogQueue. */
+    explicit NativeMacMessageAggregator (const juce::String& title);
+
+    /** Creates an aggregator.
+
+        @param title     The title of the summary dialogs
+        @param options   Window and bounds
+        @param emitter   Receives the summaries; if empty, they are posted to
+                         NativeMacDialogQueue::getShared() as warnings
+        @param clock     Returns the current time in milliseconds; if empty,
+                         Time::getMillisecondCounterHiRes() is used
+    */
+    NativeMacMessageAggregator (const juce::String& title,
+                                Options options,
+                                Emitter emitter = nullptr,
+                                std::function<double()> clock = nullptr);
+
+    /** Destructor. Messages not yet emitted are discarded. */
+    ~NativeMacMessageAggregator() override;
+
+    //==============================================================================
+    /** Adds a message. Can be called from any thread; O(number of categories). */
+    void add (const juce::String& category, const juce::String& detail = {});
+
+    /** Emits the current batch now, if it has any messages. Message thread only. */
+    void flush();
+
+    /** Emits the current batch if it is due at the given time. Message thread only.
+
+        @param nowMs   The current time in milliseconds
+        @returns the delay in milliseconds until the next poll is due, or -1 if
+                 nothing is waiting
+    */
+    double poll (double nowMs);
+
+    /** Returns the number of messages in the current batch. */
+    juce::int64 getNumPending() const;
+
+    /** Returns the accumulated counters. */
+    Stats getStats() const;
+
+    /** Resets the counters. */
+    void resetStats();
+
+private:
+    //==============================================================================
+    void timerCallback() override;
+    void handleAsyncUpdate() override;
+    void beginTask();
+    void endTask();
+    void emit (Summary&& summary);
+
+    const juce::String title;
+    const Options options;
+    const Emitter emitter;
+    const std::function<double()> clock;
+
+    mutable juce::SpinLock lock;           // guards everything below except batchStartMs
+    Summary batch;
+    int numOpenTasks = 0;
+    bool tasksFinished = false;
+    Stats stats;
+
+    double batchStartMs = -1.0;            // message thread only
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacMessageAggregator)
+};
+
+} // namespace juce
@@ -0,0 +1,213 @@
+/*******************************************************************************
+ Name index - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+NativeMacNameIndex::NativeMacNameIndex (const juce::StringArray& sourceNames, bool shouldIgnoreCase)
+    : ignoreCase (shouldIgnoreCase)
+{
+    // Kept at most half full, so probe sequences stay short
+    size_t capacity = 16;
+
+    while (capacity < (size_t) sourceNames.size() * 2)
+        capacity <<= 1;
+
+    slots.assign (capacity, 0);
+    names.reserve ((size_t) sourceNames.size());
+    hashes.reserve ((size_t) sourceNames.size());
+
+    for (auto& name : sourceNames)
+    {
+        auto normalised = normalise (name);
+        const auto hash = hashName (normalised);
+        const auto slot = findSlot (normalised, hash);
+
+        if (slots[(size_t) slot] != 0)
+            continue;   // duplicate
+
+        names.push_back (std::move (normalised));
+        hashes.push_back (hash);
+        slots[(size_t) slot] = (uint32) names.size();
+    }
+}
+
+juce::String NativeMacNameIndex::normalise (const juce::String& name) const
+{
+    return ignoreCase ? name.toLowerCase() : name;
+}
+
+uint64 NativeMacNameIndex::hashName (const juce::String& normalisedName) noexcept
+{
+    return NativeMacClipboardPayload::Checksum::hash64 (normalisedName.toRawUTF8(),
+                                                        normalisedName.getNumBytesAsUTF8());
+}
+
+int NativeMacNameIndex::findSlot (const juce::String& normalisedName, uint64 hash) const noexcept
+{
+    // Linear probing: returns the slot holding the name, or the empty slot where it would go
+    const auto mask = slots.size() - 1;
+
+    for (auto slot = (size_t) hash & mask;; slot = (slot + 1) & mask)
+    {
+        const auto entry = slots[slot];
+
+        if (entry == 0)
+            return (int) slot;
+
+        const auto index = (size_t) entry - 1;
+
+        if (hashes[index] == hash && names[index] == normalisedName)
+            return (int) slot;
+    }
+}
+
+bool NativeMacNameIndex::contains (const juce::String& name) const
+{
+    const auto normalised = normalise (name);
+    return slots[(size_t) findSlot (normalised, hashName (normalised))] != 0;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacNameIndexTests  : public juce::UnitTest
+{
+public:
+    NativeMacNameIndexTests()
+        : juce::UnitTest ("NativeMacNameIndex", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest ("Empty");
+        {
+            const NativeMacNameIndex index ({});
+
+            expectEquals (index.size(), 0);
+            expect (! index.contains ({}));
+            expect (! index.contains ("Bass"));
+        }
+
+        beginTest ("Contains");
+        {
+            const NativeMacNameIndex index ({ "Bass", "Lead", "", "Pad 2" });
+
+            expectEquals (index.size(), 4);
+
+            for (auto existing : { "Bass", "Lead", "", "Pad 2" })
+                expect (index.contains (existing), existing);
+
+            for (auto missing : { "Bas", "Bass ", "Pad", "Pad 22", "Keys" })
+                expect (! index.contains (missing), missing);
+        }
+
+        beginTest ("Duplicates are stored once");
+        {
+            const NativeMacNameIndex index ({ "Bass", "Lead", "Bass", "BASS", "Lead" });
+
+            expectEquals (index.size(), 2);
+            expect (index.contains ("bass"));
+            expect (index.contains ("LEAD"));
+
+            const NativeMacNameIndex caseSensitive ({ "Bass", "Lead", "Bass", "BASS", "Lead" }, false);
+            expectEquals (caseSensitive.size(), 3);
+        }
+
+        beginTest ("Case folding");
+        {
+            const auto accented = juce::String (juce::CharPointer_UTF8 ("Caf\xc3\xa9"));
+            const auto accentedUpper = juce::String (juce::CharPointer_UTF8 ("CAF\xc3\x89"));
+
+            juce::StringArray names { "Bass" };
+            names.add (accented);
+
+            const NativeMacNameIndex index (names);
+
+            expect (index.isCaseInsensitive());
+            expectEquals (index.normalise ("Bass"), juce::String ("bass"));
+
+            for (auto variant : { "Bass", "bass", "BASS", "bAsS" })
+                expect (index.contains (variant), variant);
+
+            expect (index.contains (accented));
+            expect (index.contains (accented.toLowerCase()));
+            expect (index.contains (accentedUpper));
+
+            const NativeMacNameIndex caseSensitive (names, false);
+
+            expect (! caseSensitive.isCaseInsensitive());
+            expectEquals (caseSensitive.normalise ("Bass"), juce::String ("Bass"));
+            expect (caseSensitive.contains ("Bass"));
+            expect (! caseSensitive.contains ("bass"));
+            expect (! caseSensitive.contains ("BASS"));
+            expect (caseSensitive.contains (accented));
+            expect (! caseSensitive.contains (accentedUpper));
+        }
+
+        beginTest ("Large libraries");
+        {
+            // Enough names to grow the table far past its initial size, with collisions in the
+            // low bits of the hash for the linear probing to resolve
+            auto random = getRandom();
+
+            for (auto numNames : { 7, 8, 9, 15, 16, 17, 1000, 10000 })
+            {
+                juce::StringArray names;
+
+                for (int i = 0; i < numNames; ++i)
+                    names.add ("Preset " + juce::String (i));
+
+                const NativeMacNameIndex index (names);
+                expectEquals (index.size(), numNames);
+
+                for (auto& existing : names)
+                    if (! index.contains (existing.toUpperCase()))
+                        expect (false, existing);
+
+                for (int i = 0; i < 1000; ++i)
+                {
+                    const auto missing = "Preset " + juce::String (numNames + random.nextInt (1000000));
+                    expect (! index.contains (missing), missing);
+                }
+            }
+        }
+
+        beginTest ("Shared between threads");
+        {
+            juce::StringArray names;
+
+            for (int i = 0; i < 5000; ++i)
+                names.add ("Preset " + juce::String (i));
+
+            const auto index = std::make_shared<const NativeMacNameIndex> (names);
+            std::atomic<int> numFound { 0 };
+            std::vector<std::thread> threads;
+
+            for (int t = 0; t < 4; ++t)
+            {
+                threads.emplace_back ([index, &numFound]
+                {
+                    for (int i = 0; i < 10000; ++i)
+                        if (index->contains ("preset " + juce::String (i)))
+                            ++numFound;
+                });
+            }
+
+            for (auto& thread : threads)
+                thread.join();
+
+            expectEquals (numFound.load(), 4 * 5000);
+        }
+    }
+};
+
+static NativeMacNameIndexTests nativeMacNameIndexTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,64 @@
+/*******************************************************************************
+ Name index
+
+ An immutable hashed set of names, for uniqueness checks against large
+ preset libraries.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A prebuilt set of names with constant-time membership tests.
+
+    Build it once from the existing names (e.g. every preset in the library)
+    and share it between dialogs; it never changes after construction, so it
+    can be used from any thread without locking.
+
+    Names are stored in an open-addressing table keyed by a 64-bit hash of
+    their UTF-8 bytes, so contains() costs one hash of the candidate plus,
+    almost always, a single string comparison.
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacNameIndex
+{
+public:
+    //==============================================================================
+    /** Builds an index.
+
+        @param names        The names to index; duplicates are stored once
+        @param ignoreCase   If true, names differing only in case count as equal,
+                            as they do on the default macOS file system
+    */
+    explicit NativeMacNameIndex (const juce::StringArray& names, bool ignoreCase = true);
+
+    /** Returns true if the index holds the name. */
+    bool contains (const juce::String& name) const;
+
+    /** Returns the number of distinct names. */
+    int size() const noexcept                         { return (int) names.size(); }
+
+    /** Returns true if the index ignores case. */
+    bool isCaseInsensitive() const noexcept           { return ignoreCase; }
+
+    /** Returns a name in the form it is compared in (lower case if case is ignored). */
+    juce::String normalise (const juce::String& name) const;
+
+private:
+    //==============================================================================
+    static uint64 hashName (const juce::String& normalisedName) noexcept;
+    int findSlot (const juce::String& normalisedName, uint64 hash) const noexcept;
+
+    const bool ignoreCase;
+    std::vector<juce::String> names;     // normalised
+    std::vector<uint64> hashes;          // parallel to names
+    std::vector<uint32> slots;           // index into names + 1, or 0 if empty; size is a power of two
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacNameIndex)
+};
+
+} // namespace juce
@@ -0,0 +1,611 @@
+/*******************************************************************************
+ Progress dialogs - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+namespace ProgressDialogHelpers
+{
+    // Each thread keeps to one stripe, handed out round-robin as threads first count
+    static size_t getStripeIndex (size_t numStripes) noexcept
+    {
+        static std::atomic<size_t> nextStripe { 0 };
+        static thread_local const size_t stripe = nextStripe.fetch_add (1, std::memory_order_relaxed);
+        return stripe % numStripes;
+    }
+
+    // The longest prefix of at most maxBytes that doesn't end inside a UTF-8 sequence
+    static size_t clipUTF8 (const char* text, size_t numBytes, size_t maxBytes) noexcept
+    {
+        if (numBytes <= maxBytes)
+            return numBytes;
+
+        auto length = maxBytes;
+
+        while (length > 0 && (((juce::uint8) text[length]) & 0xc0) == 0x80)
+            --length;
+
+        return length;
+    }
+}
+
+//==============================================================================
+NativeMacProgressState::NativeMacProgressState()
+{
+    for (auto& slot : statusSlots)
+        for (auto& word : slot.words)
+            word.store (0, std::memory_order_relaxed);
+}
+
+NativeMacProgressState::~NativeMacProgressState() = default;
+
+void NativeMacProgressState::setProgress (double newFraction) noexcept
+{
+    fraction.store (newFraction, std::memory_order_relaxed);
+}
+
+void NativeMacProgressState::setTotal (juce::int64 totalUnits) noexcept
+{
+    total.store (totalUnits, std::memory_order_relaxed);
+}
+
+void NativeMacProgressState::advance (juce::int64 numUnits) noexcept
+{
+    stripes[ProgressDialogHelpers::getStripeIndex (numStripes)].count.fetch_add (numUnits, std::memory_order_relaxed);
+}
+
+void NativeMacProgressState::finish() noexcept
+{
+    finished.store (true, std::memory_order_release);
+}
+
+void NativeMacProgressState::cancel() noexcept
+{
+    cancelled.store (true, std::memory_order_relaxed);
+}
+
+double NativeMacProgressState::getProgress() const noexcept
+{
+    const auto totalUnits = total.load (std::memory_order_relaxed);
+
+    if (totalUnits <= 0)
+        return jmin (1.0, fraction.load (std::memory_order_relaxed));
+
+    juce::int64 done = 0;
+
+    for (auto& stripe : stripes)
+        done += stripe.count.load (std::memory_order_relaxed);
+
+    return jlimit (0.0, 1.0, (double) done / (double) totalUnits);
+}
+
+//==============================================================================
+// Each status goes to the next slot in turn, under that slot's sequence counter (a seqlock).
+// The text is stored in atomic words, so a reader racing a writer sees a torn copy rather
+// than undefined behaviour, and throws it away when the sequence has moved
+void NativeMacProgressState::setStatus (const juce::String& status) noexcept
+{
+    const auto* utf8 = status.toRawUTF8();
+    const auto numBytes = ProgressDialogHelpers::clipUTF8 (utf8, status.getNumBytesAsUTF8(), maxStatusBytes);
+
+    const auto version = numStatusWrites.fetch_add (1, std::memory_order_relaxed) + 1;
+    auto& slot = statusSlots[(size_t) (version % numStatusSlots)];
+
+    // Another writer still owns this slot; it's writing an older status, so just skip
+    auto sequence = slot.sequence.load (std::memory_order_relaxed);
+
+    if ((sequence & 1) != 0
+         || ! slot.sequence.compare_exchange_strong (sequence, sequence + 1, std::memory_order_relaxed))
+        return;
+
+    std::atomic_thread_fence (std::memory_order_release);
+
+    // A writer that lapped this one has already filled the slot with a newer status
+    if (slot.version.load (std::memory_order_relaxed) > version)
+    {
+        slot.sequence.store (sequence + 2, std::memory_order_release);
+        return;
+    }
+
+    slot.version.store (version, std::memory_order_relaxed);
+    slot.numBytes.store ((juce::uint32) numBytes, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < (numBytes + 7) / 8; ++i)
+    {
+        juce::uint64 word = 0;
+        std::memcpy (&word, utf8 + i * 8, jmin ((size_t) 8, numBytes - i * 8));
+        slot.words[i].store (word, std::memory_order_relaxed);
+    }
+
+    slot.sequence.store (sequence + 2, std::memory_order_release);
+
+    // Publish, unless a newer status has been published meanwhile
+    auto latest = latestStatus.load (std::memory_order_relaxed);
+
+    while (latest < version
+            && ! latestStatus.compare_exchange_weak (latest, version, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+bool NativeMacProgressState::readStatus (juce::String& status, juce::uint64& lastVersion) const
+{
+    char buffer[maxStatusBytes];
+
+    // A writer can only keep a reader retrying by lapping all the slots, so this rarely loops
+    for (int attempt = 0; attempt < 16; ++attempt)
+    {
+        const auto version = latestStatus.load (std::memory_order_acquire);
+
+        if (version == lastVersion)
+            return false;
+
+        auto& slot = statusSlots[(size_t) (version % numStatusSlots)];
+        const auto sequence = slot.sequence.load (std::memory_order_acquire);
+
+        if ((sequence & 1) != 0)
+            continue;
+
+        const auto slotVersion = slot.version.load (std::memory_order_relaxed);
+        const auto numBytes = jmin ((size_t) slot.numBytes.load (std::memory_order_relaxed), maxStatusBytes);
+
+        for (size_t i = 0; i < (numBytes + 7) / 8; ++i)
+        {
+            const auto word = slot.words[i].load (std::memory_order_relaxed);
+            std::memcpy (buffer + i * 8, &word, jmin ((size_t) 8, numBytes - i * 8));
+        }
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+
+        if (slot.sequence.load (std::memory_order_relaxed) != sequence || slotVersion != version)
+            continue;
+
+        status = juce::String::fromUTF8 (buffer, (int) numBytes);
+        lastVersion = version;
+        return true;
+    }
+
+    return false;
+}
+
+//==============================================================================
+NativeMacProgressDialog::NativeMacProgressDialog (const juce::String& t)
+    : NativeMacProgressDialog (t, Options())
+{
+}
+
+NativeMacProgressDialog::NativeMacProgressDialog (const juce::String& t, Options o, std::function<double()> c)
+    : title (t),
+      options (std::move (o)),
+      clock (c != nullptr ? std::move (c) : [] { return juce::Time::getMillisecondCounterHiRes(); }),
+      state (std::make_shared<NativeMacProgressState>())
+{
+    jassert (options.refreshHz > 0);
+}
+
+NativeMacProgressDialog::~NativeMacProgressDialog()
+{
+    stopTimer();
+    window.reset();
+}
+
+//==============================================================================
+void NativeMacProgressDialog::start()
+{
+    begin (clock());
+    startTimer (jmax (1, (int) std::ceil (1000.0 / options.refreshHz)));
+}
+
+void NativeMacProgressDialog::begin (double nowMs)
+{
+    startMs = nowMs;
+    done = false;
+}
+
+void NativeMacProgressDialog::timerCallback()
+{
+    if (poll (clock()) < 0)
+        stopTimer();
+}
+
+double NativeMacProgressDialog::poll (double nowMs)
+{
+    if (done || startMs < 0)
+        return -1.0;
+
+    ++stats.numSamples;
+
+    if (state->isFinished())
+    {
+        window.reset();
+        done = true;
+
+        if (onFinished != nullptr)
+            onFinished();
+
+        return -1.0;
+    }
+
+    if (window == nullptr && nowMs - startMs >= options.showDelayMs)
+    {
+        const auto cancelText = options.canCancel ? options.cancelButtonText : juce::String();
+        window = NativeMacDialogs::getBackend()->createProgressWindow (title, cancelText, [this] { cancelClicked(); });
+    }
+
+    if (window != nullptr)
+    {
+        // Changes smaller than a pixel of a progress bar aren't worth redrawing
+        const auto fraction = state->getProgress();
+        const auto fractionChanged = std::abs (fraction - shownFraction) >= 0.001
+                                       || ((fraction < 0) != (shownFraction < 0));
+        const auto statusChanged = state->readStatus (status, statusVersion);
+
+        if (fractionChanged || statusChanged)
+        {
+            window->update (fraction, statusChanged ? &status : nullptr);
+            shownFraction = fraction;
+            ++stats.numWindowUpdates;
+        }
+    }
+
+    return 1000.0 / options.refreshHz;
+}
+
+void NativeMacProgressDialog::cancelClicked()
+{
+    state->cancel();
+
+    if (onCancel != nullptr)
+        onCancel();
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacProgressDialogTests  : public juce::UnitTest
+{
+public:
+    NativeMacProgressDialogTests()
+        : juce::UnitTest ("NativeMacProgressDialog", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest ("Fractions");
+        {
+            NativeMacProgressState state;
+            expectLessThan (state.getProgress(), 0.0);
+
+            state.setProgress (0.25);
+            expectEquals (state.getProgress(), 0.25);
+
+            state.setProgress (1.5);
+            expectEquals (state.getProgress(), 1.0);
+
+            state.setProgress (-1.0);
+            expectLessThan (state.getProgress(), 0.0);
+
+            // Once counting, setProgress() is ignored and the count is clamped to the total
+            state.setTotal (8);
+            state.setProgress (0.9);
+            expectEquals (state.getProgress(), 0.0);
+
+            state.advance (2);
+            expectEquals (state.getProgress(), 0.25);
+
+            state.advance();
+            state.advance();
+            expectEquals (state.getProgress(), 0.5);
+
+            state.advance (100);
+            expectEquals (state.getProgress(), 1.0);
+        }
+
+        beginTest ("Counting across threads");
+        {
+            constexpr int numWorkers = 8, numPerWorker = 100000;
+
+            NativeMacProgressState state;
+            state.setTotal ((juce::int64) numWorkers * numPerWorker * 2);
+
+            std::atomic<bool> workersDone { false };
+            std::vector<std::thread> workers;
+
+            for (int i = 0; i < numWorkers; ++i)
+            {
+                workers.emplace_back ([&state, i]
+                {
+                    // Mixed step sizes adding up to two units per iteration
+                    for (int j = 0; j < numPerWorker; ++j)
+                    {
+                        if ((i + j) % 2 == 0)
+                            state.advance (2);
+                        else
+                        {
+                            state.advance();
+                            state.advance();
+                        }
+                    }
+                });
+            }
+
+            // The sum of the stripes only ever grows while the workers count
+            int numInvalid = 0;
+            auto last = 0.0;
+
+            std::thread reader ([&]
+            {
+                while (! workersDone.load())
+                {
+                    const auto progress = state.getProgress();
+
+                    if (progress < last || progress > 1.0)
+                        ++numInvalid;
+
+                    last = progress;
+                }
+            });
+
+            for (auto& worker : workers)
+                worker.join();
+
+            workersDone = true;
+            reader.join();
+
+            expectEquals (numInvalid, 0);
+            expectEquals (state.getProgress(), 1.0);
+        }
+
+        beginTest ("Status");
+        {
+            NativeMacProgressState state;
+            juce::String status ("unchanged");
+            juce::uint64 version = 0;
+
+            expect (! state.readStatus (status, version));
+            expectEquals (status, juce::String ("unchanged"));
+            expectEquals (version, (juce::uint64) 0);
+
+            state.setStatus ("Reading");
+            expect (state.readStatus (status, version));
+            expectEquals (status, juce::String ("Reading"));
+            expect (! state.readStatus (status, version));
+
+            state.setStatus ({});
+            expect (state.readStatus (status, version));
+            expect (status.isEmpty());
+
+            // Only the newest of several statuses set between reads is seen, even after the
+            // writes have gone round all the slots
+            for (int i = 0; i < 10; ++i)
+            {
+                const auto previousVersion = version;
+
+                for (int j = 0; j <= i; ++j)
+                    state.setStatus ("Status " + juce::String (i) + "." + juce::String (j));
+
+                expect (state.readStatus (status, version));
+                expectEquals (status, "Status " + juce::String (i) + "." + juce::String (i));
+                expectGreaterThan (version, previousVersion);
+                expect (! state.readStatus (status, version));
+            }
+
+            // Each reader keeps its own version
+            juce::String otherStatus;
+            juce::uint64 otherVersion = 0;
+            expect (state.readStatus (otherStatus, otherVersion));
+            expectEquals (otherStatus, status);
+        }
+
+        beginTest ("Long statuses");
+        {
+            const auto maxBytes = (int) NativeMacProgressState::maxStatusBytes;
+            const auto eAcute = juce::String::charToString (0xe9);       // 2 bytes
+            const auto ellipsis = juce::String::charToString (0x2026);   // 3 bytes
+            const auto piano = juce::String::charToString (0x1f3b9);     // 4 bytes
+
+            const auto a = [] (int n) { return juce::String::repeatedString ("a", n); };
+
+            expectClipped (a (maxBytes), a (maxBytes));
+            expectClipped (a (maxBytes + 1), a (maxBytes));
+            expectClipped (a (maxBytes - 1) + eAcute, a (maxBytes - 1));
+            expectClipped (a (maxBytes - 2) + eAcute, a (maxBytes - 2) + eAcute);
+            expectClipped (juce::String::repeatedString (ellipsis, 100), juce::String::repeatedString (ellipsis, maxBytes / 3));
+            expectClipped ("a" + juce::String::repeatedString (piano, 70), "a" + juce::String::repeatedString (piano, (maxBytes - 1) / 4));
+
+            // Every cut is at a character boundary, as late as possible
+            auto random = getRandom();
+            const juce::String characters[] = { "a", eAcute, ellipsis, piano };
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                juce::String text;
+
+                for (int j = random.nextInt (100); --j >= 0;)
+                    text += characters[random.nextInt (4)];
+
+                const auto* utf8 = text.toRawUTF8();
+                const auto numBytes = text.getNumBytesAsUTF8();
+                const auto maxLength = (size_t) random.nextInt ((int) numBytes + 2);
+                const auto length = ProgressDialogHelpers::clipUTF8 (utf8, numBytes, maxLength);
+
+                expectLessOrEqual (length, jmin (numBytes, maxLength));
+                expectGreaterThan (length + 4, jmin (numBytes, maxLength));
+                expect (length == numBytes || (((juce::uint8) utf8[length]) & 0xc0) != 0x80);
+            }
+        }
+
+        beginTest ("Status reads are never torn");
+        {
+            // Each status carries its own checksum: a number, then a run of letters whose
+            // length and letter both follow from the number
+            constexpr int numWriters = 4, numPerWriter = 20000;
+
+            NativeMacProgressState state;
+            std::atomic<int> numWritersDone { 0 };
+            std::vector<std::thread> writers;
+
+            for (int i = 0; i < numWriters; ++i)
+            {
+                writers.emplace_back ([&state, &numWritersDone, i]
+                {
+                    for (int j = 0; j < numPerWriter; ++j)
+                        state.setStatus (makeStatus (i * numPerWriter + j));
+
+                    ++numWritersDone;
+                });
+            }
+
+            int numReads = 0, numTorn = 0, numOutOfOrder = 0;
+            juce::String status;
+            juce::uint64 version = 0;
+
+            while (numWritersDone.load() < numWriters)
+            {
+                const auto previousVersion = version;
+
+                if (state.readStatus (status, version))
+                {
+                    ++numReads;
+
+                    if (status != makeStatus (status.upToFirstOccurrenceOf (":", false, false).getIntValue()))
+                        ++numTorn;
+
+                    if (version <= previousVersion)
+                        ++numOutOfOrder;
+                }
+            }
+
+            for (auto& writer : writers)
+                writer.join();
+
+            expectEquals (numTorn, 0);
+            expectEquals (numOutOfOrder, 0);
+            logMessage ("Statuses read while writing: " + juce::String (numReads));
+
+            // Once the writers have stopped, the newest status is the one read
+            state.setStatus ("Done");
+            expect (state.readStatus (status, version));
+            expectEquals (status, juce::String ("Done"));
+        }
+
+        beginTest ("Cancel");
+        {
+            const auto previousBackend = NativeMacDialogs::getBackend();
+            const auto backend = std::make_shared<RecordingBackend>();
+            NativeMacDialogs::setBackend (backend);
+
+            NativeMacProgressDialog::Options options;
+            options.showDelayMs = 250.0;
+            options.cancelButtonText = "Stop";
+
+            int numCancels = 0, numFinished = 0;
+            NativeMacProgressDialog dialog ("Exporting", options, [] { return 0.0; });
+            dialog.onCancel = [&numCancels] { ++numCancels; };
+            dialog.onFinished = [&numFinished] { ++numFinished; };
+
+            const auto state = dialog.getState();
+            state->setTotal (1000000);
+
+            // A worker that counts until it's cancelled
+            std::thread worker ([state]
+            {
+                while (! state->isCancelled())
+                {
+                    state->setStatus ("Working");
+                    state->advance();
+                    std::this_thread::yield();
+                }
+
+                state->finish();
+            });
+
+            dialog.begin (0.0);
+            expectGreaterThan (dialog.poll (100.0), 0.0);
+            expect (! dialog.isWindowOpen());
+
+            expectGreaterThan (dialog.poll (250.0), 0.0);
+            expect (dialog.isWindowOpen());
+            expectEquals (backend->cancelButtonText, juce::String ("Stop"));
+            expect (backend->onCancel != nullptr);
+            expect (! state->isCancelled());
+
+            // Clicking Cancel reaches both the dialog's owner and the worker
+            backend->onCancel();
+            expect (state->isCancelled());
+            expectEquals (numCancels, 1);
+
+            worker.join();
+            expect (state->isFinished());
+
+            expectEquals (dialog.poll (300.0), -1.0);
+            expect (! dialog.isWindowOpen());
+            expectEquals (numFinished, 1);
+            expectEquals (dialog.poll (400.0), -1.0);
+            expectEquals (numFinished, 1);
+
+            // Without a cancel button
+            options.canCancel = false;
+            NativeMacProgressDialog uncancellable ("Exporting", options, [] { return 0.0; });
+            uncancellable.begin (0.0);
+            uncancellable.poll (1000.0);
+
+            expect (uncancellable.isWindowOpen());
+            expect (backend->cancelButtonText.isEmpty());
+
+            NativeMacDialogs::setBackend (previousBackend);
+        }
+    }
+
+private:
+    // Keeps the last progress window's cancel button so that a test can click it
+    struct RecordingBackend  : public NativeMacDialogBackend
+    {
+        struct Window  : public ProgressWindow
+        {
+            void update (double, const juce::String*) override {}
+        };
+
+        std::unique_ptr<Alert> createAlert (AlertStyle, const AlertContent&) override
+        {
+            return nullptr;
+        }
+
+        std::unique_ptr<ProgressWindow> createProgressWindow (const juce::String&,
+                                                              const juce::String& newCancelButtonText,
+                                                              std::function<void()> newOnCancel) override
+        {
+            cancelButtonText = newCancelButtonText;
+            onCancel = std::move (newOnCancel);
+            return std::make_unique<Window>();
+        }
+
+        juce::String cancelButtonText;
+        std::function<void()> onCancel;
+    };
+
+    void expectClipped (const juce::String& text, const juce::String& expected)
+    {
+        NativeMacProgressState state;
+        juce::String status;
+        juce::uint64 version = 0;
+
+        state.setStatus (text);
+        expect (state.readStatus (status, version));
+        expectEquals (status, expected);
+    }
+
+    static juce::String makeStatus (int n)
+    {
+        return juce::String (n) + ":" + juce::String::repeatedString (juce::String::charToString ((juce_wchar) ('a' + n % 26)), n % 200);
+    }
+};
+
+static NativeMacProgressDialogTests nativeMacProgressDialogTests;
+
+#endif
+
+} // namespace juce
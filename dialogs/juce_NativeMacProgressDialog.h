@@ -0,0 +1,250 @@
+/*******************************************************************************
+ Progress dialogs
+
+ Progress state that worker threads update without locks, and a native
+ progress window that samples it at display rate.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    The progress of a task, shared between the workers doing it and the
+    dialog showing it.
+
+    Every worker-side call is lock-free and never allocates:
+
+    - setProgress() is a single relaxed atomic store.
+    - advance() adds to one of several counters, each on its own cache line
+      and picked per thread, so workers counting in parallel don't contend.
+      Use it after setTotal() when several workers share a task.
+    - setStatus() copies the text into one of a few slots guarded by a
+      sequence counter. Readers retry if they catch a slot being written.
+    - isCancelled() is a relaxed atomic load; poll it in the work loop.
+
+    The dialog reads the state when it redraws, not when it changes, so a
+    worker can update it millions of times a second at no cost to the UI.
+
+    @see NativeMacProgressDialog
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacProgressState
+{
+public:
+    //==============================================================================
+    /** Creates a state with no progress and no status. */
+    NativeMacProgressState();
+
+    /** Destructor. */
+    ~NativeMacProgressState();
+
+    //==============================================================================
+    /** Sets the progress, from 0 to 1; a negative value means indeterminate.
+        Ignored once setTotal() has been called with a positive total.
+    */
+    void setProgress (double fraction) noexcept;
+
+    /** Switches to counted progress: the fraction becomes the sum of all advance()
+        calls divided by this total. Call it before the workers start.
+    */
+    void setTotal (juce::int64 totalUnits) noexcept;
+
+    /** Adds completed units towards the total given to setTotal(). */
+    void advance (juce::int64 numUnits = 1) noexcept;
+
+    /** Sets the status line. Text longer than maxStatusBytes of UTF-8 is cut at a
+        character boundary. If more threads than there are slots set a status at
+        the same instant, some of those updates may be skipped; a later one always
+        shows.
+    */
+    void setStatus (const juce::String& status) noexcept;
+
+    /** Marks the task as finished; the dialog closes on its next sample. */
+    void finish() noexcept;
+
+    /** Returns true once the user has cancelled. */
+    bool isCancelled() const noexcept               { return cancelled.load (std::memory_order_relaxed); }
+
+    //==============================================================================
+    /** Marks the task as cancelled. Called by the dialog's Cancel button. */
+    void cancel() noexcept;
+
+    /** Returns true once finish() has been called. */
+    bool isFinished() const noexcept                { return finished.load (std::memory_order_acquire); }
+
+    /** Returns the current progress from 0 to 1, or a negative value if indeterminate. */
+    double getProgress() const noexcept;
+
+    /** Reads the status line if it changed since the given version.
+
+        @param status    Receives the status
+        @param version   The version last read (0 initially); updated on success
+        @returns true if the status changed and was read
+    */
+    bool readStatus (juce::String& status, juce::uint64& version) const;
+
+    /** The longest status, in UTF-8 bytes. */
+    static constexpr size_t maxStatusBytes = 240;
+
+private:
+    //==============================================================================
+    static constexpr size_t numStripes = 16;
+    static constexpr size_t numStatusSlots = 4;
+    static constexpr size_t numStatusWords = maxStatusBytes / 8;
+
+    struct alignas (64) Stripe
+    {
+        std::atomic<juce::int64> count { 0 };
+    };
+
+    struct alignas (64) StatusSlot
+    {
+        std::atomic<juce::uint32> sequence { 0 };      // odd while being written
+        std::atomic<juce::uint32> numBytes { 0 };
+        std::atomic<juce::uint64> version { 0 };
+        std::atomic<juce::uint64> words[numStatusWords];
+    };
+
+    std::array<Stripe, numStripes> stripes;
+    alignas (64) std::atomic<double> fraction { -1.0 };
+    std::atomic<juce::int64> total { 0 };
+    std::atomic<bool> cancelled { false }, finished { false };
+
+    alignas (64) std::atomic<juce::uint64> numStatusWrites { 0 };
+    std::atomic<juce::uint64> latestStatus { 0 };
+    std::array<StatusSlot, numStatusSlots> statusSlots;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacProgressState)
+};
+
+//==============================================================================
+/**
+    A native progress window for a task running on other threads.
+
+    @code
+    auto dialog = std::make_unique<NativeMacProgressDialog> ("Exporting");
+    dialog->onFinished = [this] { dialog.reset(); };
+    dialog->start();
+
+    std::thread ([state = dialog->getState(), files]
+    {
+        state->setTotal (files.size());
+
+        for (auto& file : files)
+        {
+            if (state->isCancelled())
+                break;
+
+            state->setStatus (file.getFileName());
+            exportFile (file);
+            state->advance();
+        }
+
+        state->finish();
+    }).detach();
+    @endcode
+
+    The dialog samples the state from a Timer at refreshHz and only updates the
+    window when something visible changed. The window is built by the current
+    NativeMacDialogBackend, and only once showDelayMs has passed, so tasks that
+    finish quickly never flash a window. When the window closes, focus goes back
+    to the window that had it.
+
+    All scheduling decisions are made by poll(), which takes the current time as
+    an argument; call it directly with a virtual clock to drive a dialog
+    deterministically. The dialog itself is used on the message thread only;
+    its state can be used from any thread and outlives the dialog if a worker
+    still holds it.
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacProgressDialog  : private juce::Timer
+{
+public:
+    //==============================================================================
+    struct Options
+    {
+        double refreshHz = 60.0;           /**< How often the state is sampled. */
+        double showDelayMs = 250.0;        /**< The window only appears if the task is still running by then. */
+        bool canCancel = true;
+        juce::String cancelButtonText = "Cancel";
+    };
+
+    /** Counters for checking how much work the UI side does. */
+    struct Stats
+    {
+        juce::int64 numSamples = 0;
+        juce::int64 numWindowUpdates = 0;   /**< Samples that changed what the window shows. */
+    };
+
+    //==============================================================================
+    /** Creates a dialog with the default options. */
+    explicit NativeMacProgressDialog (const juce::String& title);
+
+    /** Creates a dialog.
+
+        @param title     The window title
+        @param options   Sampling rate, show delay and cancel button
+        @param clock     Returns the current time in milliseconds; if empty,
+                         Time::getMillisecondCounterHiRes() is used
+    */
+    NativeMacProgressDialog (const juce::String& title, Options options, std::function<double()> clock = nullptr);
+
+    /** Destructor. Closes the window if it is open. */
+    ~NativeMacProgressDialog() override;
+
+    /** Returns the state for the workers to update. */
+    std::shared_ptr<NativeMacProgressState> getState() const noexcept   { return state; }
+
+    //==============================================================================
+    /** Starts sampling from a Timer on the message thread. */
+    void start();
+
+    /** Starts the show delay without starting the Timer; drive it with poll(). */
+    void begin (double nowMs);
+
+    /** Samples the state and updates the window.
+
+        @param nowMs   The current time in milliseconds
+        @returns the delay in milliseconds until the next sample is due, or -1 once
+                 the task has finished and the window is closed
+    */
+    double poll (double nowMs);
+
+    /** Returns true while the window is on screen. */
+    bool isWindowOpen() const noexcept               { return window != nullptr; }
+
+    /** Called on the message thread when the user clicks Cancel. */
+    std::function<void()> onCancel;
+
+    /** Called on the message thread once the task has finished and the window has closed. */
+    std::function<void()> onFinished;
+
+    /** Returns the accumulated counters. */
+    Stats getStats() const noexcept                  { return stats; }
+
+private:
+    //==============================================================================
+    void timerCallback() override;
+    void cancelClicked();
+
+    const juce::String title;
+    const Options options;
+    const std::function<double()> clock;
+    const std::shared_ptr<NativeMacProgressState> state;
+
+    std::unique_ptr<NativeMacDialogBackend::ProgressWindow> window;
+    double startMs = -1.0, shownFraction = -2.0;
+    juce::uint64 statusVersion = 0;
+    juce::String status;
+    bool done = false;
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacProgressDialog)
+};
+
+} // namespace juce
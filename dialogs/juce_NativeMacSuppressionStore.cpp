@@ -0,0 +1,633 @@
+/*******************************************************************************
+ Dialog suppression - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+namespace SuppressionStoreHelpers
+{
+    // One line per dialog: the answer, a tab, and the ID with backslashes and line
+    // breaks escaped, so any ID round-trips
+    static const char* const fileHeader = "# Suppressed dialogs\n";
+
+    static void appendEntry (juce::MemoryBlock& data, const juce::String& dialogID, int answer)
+    {
+        const auto number = juce::String (answer);
+        data.append (number.toRawUTF8(), number.getNumBytesAsUTF8());
+        data.append ("\t", 1);
+
+        const auto* id = dialogID.toRawUTF8();
+        const auto numBytes = dialogID.getNumBytesAsUTF8();
+        size_t start = 0;
+
+        for (size_t i = 0; i < numBytes; ++i)
+        {
+            const char* escaped = id[i] == '\\' ? "\\\\" : id[i] == '\n' ? "\\n" : id[i] == '\r' ? "\\r" : nullptr;
+
+            if (escaped == nullptr)
+                continue;
+
+            data.append (id + start, i - start);
+            data.append (escaped, 2);
+            start = i + 1;
+        }
+
+        data.append (id + start, numBytes - start);
+        data.append ("\n", 1);
+    }
+
+    static bool parseEntry (const char* line, size_t length, juce::String& dialogID, int& answer)
+    {
+        size_t tab = 0;
+
+        while (tab < length && line[tab] != '\t')
+            ++tab;
+
+        if (tab == 0 || tab >= length)
+            return false;
+
+        answer = 0;
+        bool negative = false;
+
+        for (size_t i = 0; i < tab; ++i)
+        {
+            if (i == 0 && line[i] == '-')
+                negative = true;
+            else if (line[i] >= '0' && line[i] <= '9' && answer < 100000)
+                answer = answer * 10 + (line[i] - '0');
+            else
+                return false;
+        }
+
+        if (negative)
+            answer = -answer;
+
+        juce::MemoryBlock id;
+
+        for (size_t i = tab + 1; i < length; ++i)
+        {
+            auto c = line[i];
+
+            if (c == '\\' && i + 1 < length)
+            {
+                c = line[++i];
+                c = c == 'n' ? '\n' : c == 'r' ? '\r' : c;
+            }
+
+            id.append (&c, 1);
+        }
+
+        dialogID = juce::String::fromUTF8 (static_cast<const char*> (id.getData()), (int) id.getSize());
+        return dialogID.isNotEmpty();
+    }
+}
+
+//==============================================================================
+size_t NativeMacSuppressionStore::KeyHash::operator() (const juce::String& key) const noexcept
+{
+    return (size_t) NativeMacClipboardPayload::Checksum::hash64 (key.toRawUTF8(), key.getNumBytesAsUTF8());
+}
+
+//==============================================================================
+// Waits for a change, lets further changes collect for writeDelayMs, then writes them
+// all at once
+class NativeMacSuppressionStore::Writer  : public juce::Thread
+{
+public:
+    explicit Writer (NativeMacSuppressionStore& s)
+        : juce::Thread ("Suppression Store Writer"), store (s)
+    {
+    }
+
+    ~Writer() override
+    {
+        signalThreadShouldExit();
+        wakeUp.signal();
+        stopThread (-1);
+    }
+
+    void changed()
+    {
+        wakeUp.signal();
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wakeUp.wait();
+
+            if (threadShouldExit())
+                break;
+
+            // Changes made meanwhile signal the event again; they are in this write anyway
+            cancelled.wait (store.options.writeDelayMs);
+            wakeUp.reset();
+            store.flush();
+        }
+    }
+
+    void cancelDelay()
+    {
+        cancelled.signal();
+    }
+
+private:
+    NativeMacSuppressionStore& store;
+    juce::WaitableEvent wakeUp, cancelled;
+};
+
+//==============================================================================
+NativeMacSuppressionStore::NativeMacSuppressionStore()
+    : NativeMacSuppressionStore (juce::File(), Options())
+{
+}
+
+NativeMacSuppressionStore::NativeMacSuppressionStore (const juce::File& f)
+    : NativeMacSuppressionStore (f, Options())
+{
+}
+
+NativeMacSuppressionStore::NativeMacSuppressionStore (const juce::File& f, Options o)
+    : file (f),
+      options (o)
+{
+    if (file == juce::File())
+        return;
+
+    load();
+
+    writer = std::make_unique<Writer> (*this);
+    writer->startThread();
+}
+
+NativeMacSuppressionStore::~NativeMacSuppressionStore()
+{
+    if (writer != nullptr)
+    {
+        writer->cancelDelay();
+        writer.reset();
+    }
+
+    flush();
+}
+
+//==============================================================================
+void NativeMacSuppressionStore::load()
+{
+    juce::MemoryBlock data;
+
+    if (! file.existsAsFile() || ! file.loadFileAsData (data))
+        return;
+
+    const auto* text = static_cast<const char*> (data.getData());
+    const auto size = data.getSize();
+
+    const juce::SpinLock::ScopedLockType sl (lock);
+
+    for (size_t start = 0; start < size;)
+    {
+        auto end = start;
+
+        while (end < size && text[end] != '\n')
+            ++end;
+
+        auto length = end - start;
+
+        if (length > 0 && text[start + length - 1] == '\r')
+            --length;
+
+        juce::String dialogID;
+        int answer = 0;
+
+        // Comments and lines that don't parse (e.g. from a newer format) are skipped
+        if (length > 0 && text[start] != '#'
+             && SuppressionStoreHelpers::parseEntry (text + start, length, dialogID, answer))
+            answers[dialogID] = answer;
+
+        start = end + 1;
+    }
+}
+
+void NativeMacSuppressionStore::changed()
+{
+    // Called with the lock held
+    ++version;
+    ++stats.numChanges;
+
+    if (writer != nullptr)
+        writer->changed();
+}
+
+bool NativeMacSuppressionStore::flush()
+{
+    if (file == juce::File())
+        return true;
+
+    const juce::ScopedLock wl (writeLock);
+
+    juce::MemoryBlock data;
+    juce::uint64 versionToWrite = 0;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (lock);
+
+        if (version == writtenVersion)
+            return true;
+
+        versionToWrite = version;
+        data.append (SuppressionStoreHelpers::fileHeader, std::strlen (SuppressionStoreHelpers::fileHeader));
+
+        // Sorted, so the file doesn't change order between writes
+        std::vector<std::pair<juce::String, int>> sorted (answers.begin(), answers.end());
+        std::sort (sorted.begin(), sorted.end());
+
+        for (auto& entry : sorted)
+            SuppressionStoreHelpers::appendEntry (data, entry.first, entry.second);
+    }
+
+    const auto ok = file.getParentDirectory().createDirectory().wasOk()
+                     && file.replaceWithData (data.getData(), data.getSize());
+
+    const juce::SpinLock::ScopedLockType sl (lock);
+
+    if (ok)
+    {
+        writtenVersion = jmax (writtenVersion, versionToWrite);
+        ++stats.numWrites;
+    }
+    else
+    {
+        ++stats.numWriteFailures;
+    }
+
+    return ok;
+}
+
+//==============================================================================
+bool NativeMacSuppressionStore::getAnswer (const juce::String& dialogID, int& answer) const
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+    ++stats.numLookups;
+
+    const auto it = answers.find (dialogID);
+
+    if (it == answers.end())
+        return false;
+
+    ++stats.numHits;
+    answer = it->second;
+    return true;
+}
+
+bool NativeMacSuppressionStore::isSuppressed (const juce::String& dialogID) const
+{
+    int answer = 0;
+    return getAnswer (dialogID, answer);
+}
+
+void NativeMacSuppressionStore::suppress (const juce::String& dialogID, int answer)
+{
+    jassert (dialogID.isNotEmpty());
+
+    const juce::SpinLock::ScopedLockType sl (lock);
+    auto it = answers.find (dialogID);
+
+    if (it != answers.end() && it->second == answer)
+        return;
+
+    answers[dialogID] = answer;
+    changed();
+}
+
+void NativeMacSuppressionStore::unsuppress (const juce::String& dialogID)
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+
+    if (answers.erase (dialogID) > 0)
+        changed();
+}
+
+void NativeMacSuppressionStore::clear()
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+
+    if (answers.empty())
+        return;
+
+    answers.clear();
+    changed();
+}
+
+juce::StringArray NativeMacSuppressionStore::getSuppressedIDs() const
+{
+    juce::StringArray ids;
+
+    const juce::SpinLock::ScopedLockType sl (lock);
+
+    for (auto& entry : answers)
+        ids.add (entry.first);
+
+    return ids;
+}
+
+//==============================================================================
+NativeMacSuppressionStore::Stats NativeMacSuppressionStore::getStats() const
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+    return stats;
+}
+
+void NativeMacSuppressionStore::resetStats()
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+    stats = {};
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacSuppressionStoreTests  : public juce::UnitTest
+{
+public:
+    NativeMacSuppressionStoreTests()
+        : juce::UnitTest ("NativeMacSuppressionStore", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        using Store = NativeMacSuppressionStore;
+
+        const auto directory = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                                  .getNonexistentChildFile ("juce_suppression_store_tests", {}, false);
+
+        // Nothing is written unless asked to, so the tests don't depend on the writer's timing
+        Store::Options noDelay, longDelay;
+        noDelay.writeDelayMs = 0.0;
+        longDelay.writeDelayMs = 1.0e9;
+
+        beginTest ("In memory");
+        {
+            Store store;
+
+            int answer = -1;
+            expect (! store.getAnswer ("deletePreset", answer));
+            expectEquals (answer, -1);
+
+            store.suppress ("deletePreset", 1);
+            expect (store.getAnswer ("deletePreset", answer));
+            expectEquals (answer, 1);
+
+            // Same answer again isn't a change
+            store.suppress ("deletePreset", 1);
+            store.suppress ("deletePreset", 0);
+            store.suppress ("overwrite", 0);
+            expect (store.getAnswer ("deletePreset", answer));
+            expectEquals (answer, 0);
+
+            store.unsuppress ("deletePreset");
+            store.unsuppress ("deletePreset");
+            expect (! store.isSuppressed ("deletePreset"));
+            expectEquals (store.getSuppressedIDs().joinIntoString (","), juce::String ("overwrite"));
+
+            store.clear();
+            store.clear();
+            expect (store.getSuppressedIDs().isEmpty());
+
+            const auto stats = store.getStats();
+            expectEquals (stats.numChanges, (juce::int64) 5);
+            expectEquals (stats.numLookups, (juce::int64) 4);
+            expectEquals (stats.numHits, (juce::int64) 2);
+
+            expect (store.flush());
+            expectEquals (store.getStats().numWrites, (juce::int64) 0);
+            expect (store.getFile() == juce::File());
+
+            store.resetStats();
+            expectEquals (store.getStats().numChanges, (juce::int64) 0);
+        }
+
+        beginTest ("Round trip");
+        {
+            const auto file = directory.getChildFile ("RoundTrip/SuppressedDialogs.txt");
+
+            const std::map<juce::String, int> expected { { "deletePreset", 1 },
+                                                         { "back\\slash", 2 },
+                                                         { "line\nbreak\r\n", -3 },
+                                                         { "tab\tinside", 4 },
+                                                         { "#notAComment", 5 },
+                                                         { "\\n", 6 },
+                                                         { juce::CharPointer_UTF8 ("caf\xc3\xa9"), 7 } };
+
+            {
+                Store store (file, longDelay);
+
+                for (auto& entry : expected)
+                    store.suppress (entry.first, entry.second);
+
+                expect (store.flush());
+                expectEquals (store.getStats().numWrites, (juce::int64) 1);
+
+                // Nothing new to write
+                expect (store.flush());
+                expectEquals (store.getStats().numWrites, (juce::int64) 1);
+            }
+
+            expectAnswers (load (file), expected);
+            expect (file.loadFileAsString().startsWith ("# Suppressed dialogs\n"));
+
+            // Changes still pending are written by the destructor
+            {
+                Store store (file, longDelay);
+                store.unsuppress ("deletePreset");
+                store.suppress ("added", 0);
+            }
+
+            auto changed = expected;
+            changed.erase ("deletePreset");
+            changed["added"] = 0;
+            expectAnswers (load (file), changed);
+        }
+
+        beginTest ("Random round trip");
+        {
+            auto random = getRandom();
+            const auto file = directory.getChildFile ("Random.txt");
+            const juce::juce_wchar chars[] = { 'a', 'b', 'Z', '0', ' ', '#', '-', '\t', '\\', '\n', '\r', 0xe9, 0x1f600 };
+
+            for (int iteration = 0; iteration < 20; ++iteration)
+            {
+                file.deleteFile();
+                std::map<juce::String, int> expected;
+
+                {
+                    Store store (file, longDelay);
+
+                    for (int i = random.nextInt (50); --i >= 0;)
+                    {
+                        juce::String id;
+
+                        for (int length = 1 + random.nextInt (12); --length >= 0;)
+                            id += juce::String::charToString (chars[random.nextInt (numElementsInArray (chars))]);
+
+                        const auto answer = random.nextInt (20) - 5;
+                        store.suppress (id, answer);
+                        expected[id] = answer;
+
+                        if (random.nextInt (8) == 0)
+                        {
+                            store.unsuppress (id);
+                            expected.erase (id);
+                        }
+                    }
+
+                    expect (store.flush());
+                }
+
+                expectAnswers (load (file), expected);
+            }
+        }
+
+        beginTest ("Loading skips what doesn't parse");
+        {
+            const auto file = directory.getChildFile ("Malformed.txt");
+
+            file.replaceWithText ("# Suppressed dialogs\r\n"
+                                  "1\tdeletePreset\r\n"
+                                  "\n"
+                                  "no tab\n"
+                                  "x\tnotANumber\n"
+                                  "2\t\n"
+                                  "\tnoAnswer\n"
+                                  "1-2\tbadNumber\n"
+                                  "-1\tnegative\n"
+                                  "3\tlast");
+
+            Store store (file, longDelay);
+
+            expectAnswers (load (file), std::map<juce::String, int> { { "deletePreset", 1 }, { "negative", -1 }, { "last", 3 } });
+            expectEquals (store.getSuppressedIDs().size(), 3);
+        }
+
+        beginTest ("Batched writes");
+        {
+            const auto file = directory.getChildFile ("Batched.txt");
+            Store::Options options;
+            options.writeDelayMs = 200.0;
+            Store store (file, options);
+
+            for (int i = 0; i < 100; ++i)
+                store.suppress ("dialog" + juce::String (i), i % 3);
+
+            for (int attempts = 0; attempts < 500 && store.getStats().numWrites == 0; ++attempts)
+                juce::Thread::sleep (10);
+
+            expectEquals (load (file).size(), (size_t) 100);
+
+            juce::Thread::sleep (300);
+            expectEquals (store.getStats().numWrites, (juce::int64) 1);
+        }
+
+        beginTest ("Concurrent changes");
+        {
+            const auto file = directory.getChildFile ("Concurrent.txt");
+            constexpr int numThreads = 4, numPerThread = 500;
+
+            {
+                Store store (file, noDelay);
+                std::vector<std::thread> threads;
+
+                for (int i = 0; i < numThreads; ++i)
+                {
+                    threads.emplace_back ([&store, i]
+                    {
+                        for (int j = 0; j < numPerThread; ++j)
+                        {
+                            const auto id = juce::String (i) + "/" + juce::String (j);
+                            store.suppress (id, j);
+
+                            if (j % 2 != 0)
+                                store.unsuppress (id);
+                        }
+                    });
+                }
+
+                // Lookups meanwhile, as a dialog would make
+                while (store.getSuppressedIDs().size() < numThreads * numPerThread / 2)
+                    store.isSuppressed ("0/0");
+
+                for (auto& thread : threads)
+                    thread.join();
+            }
+
+            const auto loaded = load (file);
+            expectEquals (loaded.size(), (size_t) (numThreads * numPerThread / 2));
+            expectEquals (loaded.count ("3/498"), (size_t) 1);
+            expectEquals (loaded.count ("3/499"), (size_t) 0);
+        }
+
+        beginTest ("Write failures");
+        {
+            const auto blocker = directory.getChildFile ("NotADirectory");
+            blocker.replaceWithText ("x");
+
+            Store store (blocker.getChildFile ("SuppressedDialogs.txt"), longDelay);
+            store.suppress ("deletePreset", 1);
+
+            expect (! store.flush());
+            expectEquals (store.getStats().numWriteFailures, (juce::int64) 1);
+
+            // Still answered from memory, and retried on the next flush
+            expect (store.isSuppressed ("deletePreset"));
+            expect (! store.flush());
+            expectEquals (store.getStats().numWriteFailures, (juce::int64) 2);
+            expectEquals (store.getStats().numWrites, (juce::int64) 0);
+
+            blocker.deleteFile();
+            expect (store.flush());
+            expectEquals (store.getStats().numWrites, (juce::int64) 1);
+        }
+
+        directory.deleteRecursively();
+    }
+
+private:
+    static std::map<juce::String, int> load (const juce::File& file)
+    {
+        NativeMacSuppressionStore store (file);
+        std::map<juce::String, int> result;
+
+        for (auto& id : store.getSuppressedIDs())
+            store.getAnswer (id, result[id]);
+
+        return result;
+    }
+
+    void expectAnswers (const std::map<juce::String, int>& actual, const std::map<juce::String, int>& expected)
+    {
+        juce::String difference;
+
+        for (auto& entry : expected)
+        {
+            const auto it = actual.find (entry.first);
+
+            if (it == actual.end() || it->second != entry.second)
+                difference << "missing or changed: " << entry.first << "\n";
+        }
+
+        for (auto& entry : actual)
+            if (expected.count (entry.first) == 0)
+                difference << "unexpected: " << entry.first << "\n";
+
+        expect (difference.isEmpty(), difference);
+    }
+};
+
+static NativeMacSuppressionStoreTests nativeMacSuppressionStoreTests;
+
+#endif
+
+} // namespace juce
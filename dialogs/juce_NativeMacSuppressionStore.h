@@ -0,0 +1,151 @@
+/*******************************************************************************
+ Dialog suppression
+
+ Remembers the answers of dialogs the user asked not to see again.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Adds a "Don't ask again" checkbox to a confirmation dialog.
+
+    @see NativeMacDialogs::showConfirmDialog, NativeMacSuppressionStore
+
+    @tags{GUI}
+*/
+struct NativeMacConfirmOptions
+{
+    /** Identifies the dialog in the suppression store; empty for no checkbox. Use a
+        stable name such as "deletePreset", not the dialog's (translated) text.
+    */
+    juce::String suppressionID;
+
+    /** The title of the checkbox. */
+    juce::String suppressionText = "Don't ask again";
+};
+
+//==============================================================================
+/**
+    The answers of dialogs the user has asked not to see again, keyed by dialog ID.
+
+    Lookups are served from memory by a hash map, so a suppressed dialog costs
+    one hash and no disk access. Changes are written back in batches: a
+    background thread waits writeDelayMs after the first change, so a burst of
+    changes becomes a single write, and then replaces the whole file. The file
+    is read once, when the store is created.
+
+    @code
+    NativeMacDialogs::setSuppressionStore (std::make_shared<NativeMacSuppressionStore> (
+        File::getSpecialLocation (File::userApplicationDataDirectory)
+            .getChildFile ("MyCompany/MyPlugin/SuppressedDialogs.txt")));
+    @endcode
+
+    A store without a file only keeps answers for the lifetime of the process,
+    which is what NativeMacDialogs uses until another store is installed.
+
+    All methods can be called from any thread.
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacSuppressionStore
+{
+public:
+    //==============================================================================
+    struct Options
+    {
+        double writeDelayMs = 1000.0;   /**< How long changes are collected before a write. */
+    };
+
+    struct Stats
+    {
+        juce::int64 numLookups = 0;
+        juce::int64 numHits = 0;        /**< Lookups that found a stored answer. */
+        juce::int64 numChanges = 0;     /**< suppress(), unsuppress() and clear() calls that changed something. */
+        juce::int64 numWrites = 0;      /**< Times the file was written. */
+        juce::int64 numWriteFailures = 0;
+    };
+
+    //==============================================================================
+    /** Creates a store that is not persisted. */
+    NativeMacSuppressionStore();
+
+    /** Creates a store persisted to a file, loading what the file already holds. */
+    explicit NativeMacSuppressionStore (const juce::File& file);
+
+    /** Creates a store persisted to a file, with custom options. */
+    NativeMacSuppressionStore (const juce::File& file, Options options);
+
+    /** Destructor. Writes any changes that are still pending. */
+    ~NativeMacSuppressionStore();
+
+    //==============================================================================
+    /** Looks up the stored answer of a dialog.
+
+        @param dialogID   The dialog's ID
+        @param answer     Receives the stored answer, if there is one
+        @returns true if the dialog is suppressed
+    */
+    bool getAnswer (const juce::String& dialogID, int& answer) const;
+
+    /** Returns true if the dialog is suppressed. */
+    bool isSuppressed (const juce::String& dialogID) const;
+
+    /** Suppresses a dialog, answering it with the given button index from now on. */
+    void suppress (const juce::String& dialogID, int answer);
+
+    /** Shows a dialog again. */
+    void unsuppress (const juce::String& dialogID);
+
+    /** Shows every dialog again, e.g. for a "Reset warnings" preferences button. */
+    void clear();
+
+    /** Returns the IDs of all suppressed dialogs. */
+    juce::StringArray getSuppressedIDs() const;
+
+    //==============================================================================
+    /** Writes pending changes now, on the calling thread.
+
+        @returns false if writing the file failed
+    */
+    bool flush();
+
+    /** Returns the file the store is persisted to, or File() if it isn't. */
+    const juce::File& getFile() const noexcept      { return file; }
+
+    /** Returns the accumulated counters. */
+    Stats getStats() const;
+
+    /** Resets the counters. */
+    void resetStats();
+
+private:
+    //==============================================================================
+    class Writer;
+
+    struct KeyHash
+    {
+        size_t operator() (const juce::String& key) const noexcept;
+    };
+
+    void load();
+    void changed();
+
+    const juce::File file;
+    const Options options;
+
+    mutable juce::SpinLock lock;       // guards the members below
+    std::unordered_map<juce::String, int, KeyHash> answers;
+    juce::uint64 version = 0, writtenVersion = 0;
+    mutable Stats stats;
+
+    juce::CriticalSection writeLock;   // serialises writes from flush() and the writer
+    std::unique_ptr<Writer> writer;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacSuppressionStore)
+};
+
+} // namespace juce
@@ -0,0 +1,657 @@
+/*******************************************************************************
+ Text length limits - implementation
+
+ Grapheme clusters follow the extended grapheme cluster rules of UAX #29
+ (Unicode 14): GB3 - GB13 and GB999.
+*******************************************************************************/
+
+#include "juce_NativeMacGraphemeBreakData.cpp"
+
+namespace juce
+{
+
+namespace TextLimiterHelpers
+{
+    enum class GraphemeProperty : uint8
+    {
+        other, cr, lf, control, extend, zwj, regionalIndicator, prepend, spacingMark,
+        l, v, t, hangulSyllable, extendedPictographic,
+        lv, lvt    // hangulSyllable, resolved
+    };
+
+    static GraphemeProperty getGraphemeProperty (juce_wchar c) noexcept
+    {
+        if (c < 0x7f)
+        {
+            if (c >= 0x20)   return GraphemeProperty::other;
+            if (c == '\r')   return GraphemeProperty::cr;
+            if (c == '\n')   return GraphemeProperty::lf;
+
+            return GraphemeProperty::control;
+        }
+
+        const auto key = ((uint32) c << 5) | 31;
+        const auto next = std::upper_bound (std::begin (graphemeBreakTable), std::end (graphemeBreakTable), key);
+        const auto property = (GraphemeProperty) (*(next - 1) & 31);
+
+        if (property == GraphemeProperty::hangulSyllable)
+            return ((uint32) c - 0xac00) % 28 == 0 ? GraphemeProperty::lv : GraphemeProperty::lvt;
+
+        return property;
+    }
+
+    //==============================================================================
+    enum class PairRule
+    {
+        breakHere,
+        noBreak,
+        dependsOnEmoji,      // GB11: ZWJ x ExtPict, if the ZWJ follows ExtPict Extend*
+        dependsOnRegional    // GB12/13: RI x RI, if an odd number of RIs precede
+    };
+
+    static PairRule getPairRule (GraphemeProperty previous, GraphemeProperty current) noexcept
+    {
+        using P = GraphemeProperty;
+
+        const auto isControl = [] (P p) { return p == P::control || p == P::cr || p == P::lf; };
+
+        if (previous == P::cr && current == P::lf)                          return PairRule::noBreak;            // GB3
+        if (isControl (previous) || isControl (current))                    return PairRule::breakHere;          // GB4, GB5
+        if (previous == P::l && (current == P::l || current == P::v
+                                  || current == P::lv || current == P::lvt)) return PairRule::noBreak;            // GB6
+        if ((previous == P::lv || previous == P::v)
+             && (current == P::v || current == P::t))                      return PairRule::noBreak;            // GB7
+        if ((previous == P::lvt || previous == P::t) && current == P::t)    return PairRule::noBreak;            // GB8
+        if (current == P::extend || current == P::zwj
+             || current == P::spacingMark)                                  return PairRule::noBreak;            // GB9, GB9a
+        if (previous == P::prepend)                                         return PairRule::noBreak;            // GB9b
+        if (previous == P::zwj && current == P::extendedPictographic)       return PairRule::dependsOnEmoji;     // GB11
+        if (previous == P::regionalIndicator
+             && current == P::regionalIndicator)                            return PairRule::dependsOnRegional;  // GB12, GB13
+
+        return PairRule::breakHere;                                                                              // GB999
+    }
+
+    // Segments a sequence of code points, fed one at a time from the start of a cluster
+    struct GraphemeBreaker
+    {
+        /** Returns true if a new cluster starts at this code point. */
+        bool startsCluster (juce_wchar c) noexcept
+        {
+            using P = GraphemeProperty;
+
+            const auto current = getGraphemeProperty (c);
+            bool result = true;
+
+            if (! atStart)
+            {
+                switch (getPairRule (previous, current))
+                {
+                    case PairRule::breakHere:          result = true; break;
+                    case PairRule::noBreak:            result = false; break;
+                    case PairRule::dependsOnEmoji:     result = ! pictographicZwj; break;
+                    case PairRule::dependsOnRegional:  result = (numRegional % 2) == 0; break;
+                }
+            }
+
+            // Tracks ExtPict Extend* ZWJ for GB11
+            pictographicZwj = (current == P::zwj && pictographic);
+
+            if (current == P::extendedPictographic)
+                pictographic = true;
+            else if (current != P::extend)
+                pictographic = false;
+
+            numRegional = current == P::regionalIndicator ? numRegional + 1 : 0;
+            previous = current;
+            atStart = false;
+
+            return result;
+        }
+
+        GraphemeProperty previous = GraphemeProperty::other;
+        bool atStart = true, pictographic = false, pictographicZwj = false;
+        int numRegional = 0;
+    };
+
+    //==============================================================================
+    static bool isHighSurrogate (uint32 u) noexcept   { return u >= 0xd800 && u < 0xdc00; }
+    static bool isLowSurrogate (uint32 u) noexcept    { return u >= 0xdc00 && u < 0xe000; }
+
+    // Reads the code point at index and moves past it; unpaired surrogates are read as themselves
+    static juce_wchar readForwards (const juce::uint16* data, size_t size, size_t& index) noexcept
+    {
+        const uint32 unit = data[index++];
+
+        if (isHighSurrogate (unit) && index < size && isLowSurrogate (data[index]))
+            return (juce_wchar) (0x10000 + ((unit - 0xd800) << 10) + ((uint32) data[index++] - 0xdc00));
+
+        return (juce_wchar) unit;
+    }
+
+    // Reads the code point that ends at index and moves before it
+    static juce_wchar readBackwards (const juce::uint16* data, size_t& index) noexcept
+    {
+        const uint32 unit = data[--index];
+
+        if (isLowSurrogate (unit) && index > 0 && isHighSurrogate (data[index - 1]))
+        {
+            const uint32 high = data[--index];
+            return (juce_wchar) (0x10000 + ((high - 0xd800) << 10) + (unit - 0xdc00));
+        }
+
+        return (juce_wchar) unit;
+    }
+
+    static void appendUTF16 (std::vector<juce::uint16>& dest, juce_wchar c)
+    {
+        if ((uint32) c >= 0x10000)
+        {
+            const auto v = (uint32) c - 0x10000;
+            dest.push_back ((juce::uint16) (0xd800 + (v >> 10)));
+            dest.push_back ((juce::uint16) (0xdc00 + (v & 0x3ff)));
+        }
+        else
+        {
+            dest.push_back ((juce::uint16) c);
+        }
+    }
+
+    static int getSizeInUnit (juce_wchar c, NativeMacTextLimiter::Unit unit) noexcept
+    {
+        const auto v = (uint32) c;
+
+        switch (unit)
+        {
+            case NativeMacTextLimiter::Unit::utf8Bytes:   return v < 0x80 ? 1 : (v < 0x800 ? 2 : (v < 0x10000 ? 3 : 4));
+            case NativeMacTextLimiter::Unit::utf16:       return v < 0x10000 ? 1 : 2;
+            case NativeMacTextLimiter::Unit::codePoints:
+            case NativeMacTextLimiter::Unit::graphemes:
+            default:                                      return 1;
+        }
+    }
+}
+
+//==============================================================================
+int NativeMacTextLimiter::count (const juce::String& text, Unit unit)
+{
+    if (unit == Unit::utf8Bytes)
+        return (int) text.getNumBytesAsUTF8();
+
+    int total = 0;
+    TextLimiterHelpers::GraphemeBreaker breaker;
+
+    for (auto p = text.getCharPointer(); ! p.isEmpty();)
+    {
+        const auto c = p.getAndAdvance();
+
+        if (unit == Unit::graphemes)
+            total += breaker.startsCluster (c) ? 1 : 0;
+        else
+            total += TextLimiterHelpers::getSizeInUnit (c, unit);
+    }
+
+    return total;
+}
+
+juce::String NativeMacTextLimiter::truncate (const juce::String& text, int maxLength, Unit unit)
+{
+    if (maxLength <= 0)
+        return text;
+
+    TextLimiterHelpers::GraphemeBreaker breaker;
+    int total = 0, numCodePoints = 0, numKept = 0;
+
+    for (auto p = text.getCharPointer(); ! p.isEmpty(); ++numCodePoints)
+    {
+        const auto c = p.getAndAdvance();
+
+        const auto startsCluster = breaker.startsCluster (c);
+
+        if (startsCluster)
+            numKept = numCodePoints;   // everything before this cluster fits
+
+        total += unit == Unit::graphemes ? (startsCluster ? 1 : 0)
+                                         : TextLimiterHelpers::getSizeInUnit (c, unit);
+
+        if (total > maxLength)
+            return text.substring (0, numKept);
+    }
+
+    return text;
+}
+
+//==============================================================================
+NativeMacTextLimiter::NativeMacTextLimiter (Unit u, int limit)
+    : unit (u), maxLength (limit)
+{
+}
+
+NativeMacTextLimiter::~NativeMacTextLimiter() = default;
+
+void NativeMacTextLimiter::setText (const juce::String& newText)
+{
+    text.clear();
+
+    for (auto p = newText.getCharPointer(); ! p.isEmpty();)
+        TextLimiterHelpers::appendUTF16 (text, p.getAndAdvance());
+
+    length = measure (text.data(), text.size());
+}
+
+void NativeMacTextLimiter::setText (const juce::uint16* utf16, size_t numUnits)
+{
+    text.assign (utf16, utf16 + numUnits);
+    length = measure (text.data(), text.size());
+}
+
+juce::String NativeMacTextLimiter::getText() const
+{
+    std::vector<juce_wchar> codePoints;
+    codePoints.reserve (text.size() + 1);
+
+    for (size_t i = 0; i < text.size();)
+        codePoints.push_back (TextLimiterHelpers::readForwards (text.data(), text.size(), i));
+
+    codePoints.push_back (0);
+    return juce::String (juce::CharPointer_UTF32 (codePoints.data()));
+}
+
+int NativeMacTextLimiter::measure (const juce::uint16* data, size_t numUnits) const
+{
+    if (unit == Unit::utf16)
+        return (int) numUnits;
+
+    int total = 0;
+    TextLimiterHelpers::GraphemeBreaker breaker;
+
+    for (size_t i = 0; i < numUnits;)
+    {
+        const auto c = TextLimiterHelpers::readForwards (data, numUnits, i);
+
+        if (unit == Unit::graphemes)
+            total += breaker.startsCluster (c) ? 1 : 0;
+        else
+            total += TextLimiterHelpers::getSizeInUnit (c, unit);
+    }
+
+    return total;
+}
+
+// Finds the last cluster boundary at or before position that holds whatever comes before
+// it, so that segmenting from there gives the same clusters as segmenting the whole text
+size_t NativeMacTextLimiter::findWindowStart (size_t position) const noexcept
+{
+    using namespace TextLimiterHelpers;
+
+    if (position == 0)
+        return 0;
+
+    auto boundary = position;
+    auto current = getGraphemeProperty (readBackwards (text.data(), boundary));
+
+    while (boundary > 0)
+    {
+        auto before = boundary;
+        const auto previous = getGraphemeProperty (readBackwards (text.data(), before));
+
+        if (getPairRule (previous, current) == PairRule::breakHere)
+            return boundary;
+
+        current = previous;
+        boundary = before;
+    }
+
+    return 0;
+}
+
+// Finds the first such boundary after the code point at position
+size_t NativeMacTextLimiter::findWindowEnd (size_t position) const noexcept
+{
+    using namespace TextLimiterHelpers;
+
+    const auto size = text.size();
+
+    if (position >= size)
+        return size;
+
+    auto boundary = position;
+    auto previous = getGraphemeProperty (readForwards (text.data(), size, boundary));
+
+    while (boundary < size)
+    {
+        auto after = boundary;
+        const auto current = getGraphemeProperty (readForwards (text.data(), size, after));
+
+        if (getPairRule (previous, current) == PairRule::breakHere)
+            return boundary;
+
+        previous = current;
+        boundary = after;
+    }
+
+    return size;
+}
+
+size_t NativeMacTextLimiter::applyEdit (size_t start, size_t numToRemove, const juce::uint16* inserted, size_t numToInsert)
+{
+    jassert (start <= text.size() && start + numToRemove <= text.size());
+
+    start = jmin (start, text.size());
+    numToRemove = jmin (numToRemove, text.size() - start);
+    const auto removedEnd = start + numToRemove;
+
+    ++stats.numEdits;
+
+    // Only the clusters between two context-free boundaries around the edit can change.
+    // A surrogate next to the edit can pair up with one the edit brings next to it, so
+    // the boundaries are looked for beyond it
+    auto searchStart = start, searchEnd = removedEnd;
+
+    if (searchStart > 0 && TextLimiterHelpers::isHighSurrogate (text[searchStart - 1]))
+        --searchStart;
+
+    if (searchEnd < text.size() && TextLimiterHelpers::isLowSurrogate (text[searchEnd]))
+        ++searchEnd;
+
+    const auto windowStart = findWindowStart (searchStart);
+    const auto windowEnd = findWindowEnd (searchEnd);
+    const auto oldWindowLength = measure (text.data() + windowStart, windowEnd - windowStart);
+
+    std::vector<juce::uint16> window;
+
+    const auto measureWithInserted = [&] (size_t numKept)
+    {
+        window.assign (text.begin() + (std::ptrdiff_t) windowStart, text.begin() + (std::ptrdiff_t) start);
+        window.insert (window.end(), inserted, inserted + numKept);
+        window.insert (window.end(), text.begin() + (std::ptrdiff_t) removedEnd, text.begin() + (std::ptrdiff_t) windowEnd);
+        stats.numUnitsScanned += (juce::int64) window.size();
+
+        return length - oldWindowLength + measure (window.data(), window.size());
+    };
+
+    stats.numUnitsScanned += (juce::int64) (windowEnd - windowStart);
+
+    auto numKept = numToInsert;
+    auto newLength = measureWithInserted (numToInsert);
+
+    // Edits that don't make the text longer are always allowed, even if it's over the limit
+    if (maxLength > 0 && newLength > maxLength && newLength > length && numToInsert > 0)
+    {
+        ++stats.numEditsClipped;
+
+        // Cut points: the cluster boundaries inside the inserted text
+        std::vector<size_t> cuts { 0 };
+        TextLimiterHelpers::GraphemeBreaker breaker;
+        const auto insertedStart = start - windowStart;
+
+        for (size_t i = 0; i < window.size();)
+        {
+            const auto position = i;
+            const auto c = TextLimiterHelpers::readForwards (window.data(), window.size(), i);
+
+            if (breaker.startsCluster (c) && position > insertedStart && position < insertedStart + numToInsert)
+                cuts.push_back (position - insertedStart);
+        }
+
+        // Binary search for the longest cut that fits; cut 0 always counts as fitting
+        size_t low = 0, high = cuts.size();
+
+        while (high - low > 1)
+        {
+            const auto middle = (low + high) / 2;
+
+            if (measureWithInserted (cuts[middle]) <= maxLength)
+                low = middle;
+            else
+                high = middle;
+        }
+
+        numKept = cuts[low];
+        newLength = measureWithInserted (numKept);
+    }
+
+    text.erase (text.begin() + (std::ptrdiff_t) start, text.begin() + (std::ptrdiff_t) removedEnd);
+    text.insert (text.begin() + (std::ptrdiff_t) start, inserted, inserted + numKept);
+    length = newLength;
+
+    return numKept;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacTextLimiterTests  : public juce::UnitTest
+{
+public:
+    NativeMacTextLimiterTests()
+        : juce::UnitTest ("NativeMacTextLimiter", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        using Unit = NativeMacTextLimiter::Unit;
+
+        beginTest ("Grapheme clusters");
+        {
+            for (auto* line : graphemeBreakTests)
+            {
+                const auto clusters = parseTestLine (line);
+                std::vector<juce_wchar> codePoints;
+
+                for (auto& cluster : clusters)
+                    codePoints.insert (codePoints.end(), cluster.begin(), cluster.end());
+
+                const auto units = toUTF16 (codePoints);
+
+                NativeMacTextLimiter limiter (Unit::graphemes, 0);
+                limiter.setText (units.data(), units.size());
+                expectEquals (limiter.getLength(), (int) clusters.size(), line);
+
+                // Typing one code point at a time segments incrementally
+                NativeMacTextLimiter typed (Unit::graphemes, 0);
+
+                for (auto c : codePoints)
+                {
+                    const auto unitsOfChar = toUTF16 ({ c });
+                    typed.applyEdit (typed.getNumUTF16Units(), 0, unitsOfChar.data(), unitsOfChar.size());
+                }
+
+                expectEquals (typed.getLength(), (int) clusters.size(), line);
+
+                // Truncating to each number of clusters finds each boundary
+                const auto text = toString (codePoints);
+                std::vector<juce_wchar> prefix;
+
+                expectEquals (NativeMacTextLimiter::count (text, Unit::graphemes), (int) clusters.size(), line);
+
+                for (size_t i = 0; i < clusters.size(); ++i)
+                {
+                    prefix.insert (prefix.end(), clusters[i].begin(), clusters[i].end());
+                    expectEquals (NativeMacTextLimiter::truncate (text, (int) i + 1, Unit::graphemes), toString (prefix), line);
+                }
+            }
+        }
+
+        beginTest ("Other units");
+        {
+            const auto text = toString ({ 'a', 0xe9, 0x20ac, 0x1f600 });
+
+            expectEquals (NativeMacTextLimiter::count (text, Unit::utf8Bytes), 10);
+            expectEquals (NativeMacTextLimiter::count (text, Unit::codePoints), 4);
+            expectEquals (NativeMacTextLimiter::count (text, Unit::utf16), 5);
+            expectEquals (NativeMacTextLimiter::count (text, Unit::graphemes), 4);
+
+            expectEquals (NativeMacTextLimiter::truncate (text, 9, Unit::utf8Bytes), toString ({ 'a', 0xe9, 0x20ac }));
+            expectEquals (NativeMacTextLimiter::truncate (text, 4, Unit::utf16), toString ({ 'a', 0xe9, 0x20ac }));
+            expectEquals (NativeMacTextLimiter::truncate (text, 0, Unit::utf16), text);
+
+            // A cluster is never cut, even when its first code point would fit
+            expectEquals (NativeMacTextLimiter::truncate (toString ({ 'a', 'e', 0x301 }), 2, Unit::codePoints), juce::String ("a"));
+        }
+
+        beginTest ("Edits are clipped to whole clusters");
+        {
+            NativeMacTextLimiter limiter (Unit::graphemes, 5);
+            limiter.setText ("abc");
+
+            const auto inserted = toUTF16 ({ 'd', 'e', 0x301, 'f', 'g' });
+            expectEquals (limiter.applyEdit (3, 0, inserted.data(), inserted.size()), (size_t) 3);
+            expectEquals (limiter.getText(), toString ({ 'a', 'b', 'c', 'd', 'e', 0x301 }));
+            expectEquals (limiter.getLength(), 5);
+
+            // Extending the last cluster doesn't make the text longer
+            const auto mark = toUTF16 ({ 0x308 });
+            expectEquals (limiter.applyEdit (limiter.getNumUTF16Units(), 0, mark.data(), mark.size()), (size_t) 1);
+
+            const auto letter = toUTF16 ({ 'h' });
+            expectEquals (limiter.applyEdit (0, 0, letter.data(), letter.size()), (size_t) 0);
+
+            // Replacing is measured after the removal
+            expectEquals (limiter.applyEdit (0, 1, letter.data(), letter.size()), (size_t) 1);
+            expectEquals (limiter.getLength(), 5);
+
+            expectEquals (limiter.applyEdit (0, 2, nullptr, 0), (size_t) 0);
+            expectEquals (limiter.getLength(), 3);
+
+            const auto stats = limiter.getStats();
+            expectEquals (stats.numEdits, (juce::int64) 5);
+            expectEquals (stats.numEditsClipped, (juce::int64) 2);
+
+            NativeMacTextLimiter bytes (Unit::utf8Bytes, 4);
+            const auto euro = toUTF16 ({ 'a', 0x20ac, 'b' });
+            expectEquals (bytes.applyEdit (0, 0, euro.data(), euro.size()), (size_t) 2);
+            expectEquals (bytes.getLength(), 4);
+        }
+
+        beginTest ("Random edits match a full recount");
+        {
+            auto random = getRandom();
+
+            const juce_wchar alphabet[] = { 'a', 'b', '\r', '\n', 0x301, 0x200d, 0x1f1e6, 0x1f1e7, 0x1f476, 0x1f3ff,
+                                            0x2701, 0x1100, 0x1160, 0x11a8, 0xac00, 0xac01, 0x600, 0x903, 0x646 };
+
+            for (auto unit : { Unit::graphemes, Unit::utf8Bytes, Unit::codePoints, Unit::utf16 })
+            {
+                const auto maxLength = random.nextInt (30);
+                NativeMacTextLimiter limiter (unit, maxLength);
+                std::vector<juce::uint16> expected;
+
+                for (int i = 0; i < 1000; ++i)
+                {
+                    const auto start = (size_t) random.nextInt ((int) expected.size() + 1);
+                    const auto numToRemove = (size_t) random.nextInt ((int) jmin ((size_t) 4, expected.size() - start) + 1);
+
+                    std::vector<juce_wchar> codePoints ((size_t) random.nextInt (6));
+
+                    for (auto& c : codePoints)
+                        c = alphabet[random.nextInt ((int) std::size (alphabet))];
+
+                    const auto inserted = toUTF16 (codePoints);
+                    const auto numKept = limiter.applyEdit (start, numToRemove, inserted.data(), inserted.size());
+
+                    expectLessOrEqual (numKept, inserted.size());
+
+                    expected.erase (expected.begin() + (std::ptrdiff_t) start, expected.begin() + (std::ptrdiff_t) (start + numToRemove));
+                    expected.insert (expected.begin() + (std::ptrdiff_t) start, inserted.begin(), inserted.begin() + (std::ptrdiff_t) numKept);
+
+                    NativeMacTextLimiter recount (unit, 0);
+                    recount.setText (expected.data(), expected.size());
+
+                    expectEquals (limiter.getNumUTF16Units(), expected.size());
+                    expectEquals (limiter.getLength(), recount.getLength());
+                }
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    /*  Lines from the Unicode 14.0 GraphemeBreakTest.txt, with its break and
+        no-break marks written as '|' and 'x' to keep this file ASCII. The table
+        pairs the property classes; the rest are the file's longer sequences.
+    */
+    static constexpr const char* graphemeBreakTests[] =
+    {
+        "| 0020 | 0020 |",                  "| 0020 x 0308 | 0020 |",
+        "| 000D x 000A |",                  "| 000D | 000D |",
+        "| 000A | 000D |",                  "| 000D | 0308 |",
+        "| 0001 | 0308 |",                  "| 0020 | 0001 |",
+        "| 0600 x 0020 |",                  "| 0600 | 000D |",
+        "| 0600 x 0600 |",                  "| 0903 | 0020 |",
+        "| 0020 x 0903 |",                  "| 000A | 0903 |",
+        "| 1100 x 1100 |",                  "| 1100 x 1160 |",
+        "| 1100 x AC00 |",                  "| 1100 x AC01 |",
+        "| 1160 x 1160 |",                  "| 1160 x 11A8 |",
+        "| 1160 | 1100 |",                  "| 11A8 x 11A8 |",
+        "| 11A8 | 1160 |",                  "| AC00 x 1160 |",
+        "| AC00 x 11A8 |",                  "| AC01 | 1160 |",
+        "| AC01 x 11A8 |",                  "| 1F1E6 x 1F1E6 |",
+        "| 231A | 231A |",                  "| 200D | 231A |",
+        "| 231A x 0308 x 200D x 231A |",
+
+        "| 000D x 000A | 0061 | 000A | 0308 |",
+        "| 0061 x 0308 |",
+        "| 0020 x 200D | 0646 |",
+        "| 0646 x 200D | 0020 |",
+        "| AC00 x 11A8 | 1100 |",
+        "| AC01 x 11A8 | 1100 |",
+        "| 1F1E6 x 1F1E7 | 1F1E8 | 0062 |",
+        "| 0061 | 1F1E6 x 1F1E7 | 1F1E8 | 0062 |",
+        "| 0061 | 1F1E6 x 1F1E7 x 200D | 1F1E8 | 0062 |",
+        "| 0061 | 1F1E6 x 200D | 1F1E7 x 1F1E8 | 0062 |",
+        "| 0061 | 1F1E6 x 1F1E7 | 1F1E8 x 1F1E9 | 0062 |",
+        "| 0061 x 200D |",
+        "| 0061 x 0308 | 0062 |",
+        "| 0061 x 0903 | 0062 |",
+        "| 0061 | 0600 x 0062 |",
+        "| 1F476 x 1F3FF | 1F476 |",
+        "| 0061 x 1F3FF | 1F476 |",
+        "| 0061 x 1F3FF | 1F476 x 200D x 1F6D1 |",
+        "| 1F476 x 1F3FF x 0308 x 200D x 1F476 x 1F3FF |",
+        "| 1F6D1 x 200D x 1F6D1 |",
+        "| 0061 x 200D | 1F6D1 |",
+        "| 2701 x 200D x 2701 |",
+        "| 0061 x 200D | 2701 |"
+    };
+
+    static std::vector<std::vector<juce_wchar>> parseTestLine (const char* line)
+    {
+        std::vector<std::vector<juce_wchar>> clusters;
+
+        for (auto& token : juce::StringArray::fromTokens (line, false))
+        {
+            if (token == "|")
+                clusters.emplace_back();
+            else if (token != "x")
+                clusters.back().push_back ((juce_wchar) token.getHexValue32());
+        }
+
+        clusters.pop_back();   // after the final break
+        return clusters;
+    }
+
+    static std::vector<juce::uint16> toUTF16 (const std::vector<juce_wchar>& codePoints)
+    {
+        std::vector<juce::uint16> units;
+
+        for (auto c : codePoints)
+            TextLimiterHelpers::appendUTF16 (units, c);
+
+        return units;
+    }
+
+    static juce::String toString (std::vector<juce_wchar> codePoints)
+    {
+        codePoints.push_back (0);
+        return juce::String (juce::CharPointer_UTF32 (codePoints.data()));
+    }
+};
+
+static NativeMacTextLimiterTests nativeMacTextLimiterTests;
+
+#endif
+
+} // namespace juce
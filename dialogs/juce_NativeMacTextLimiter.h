@@ -0,0 +1,137 @@
+/*******************************************************************************
+ Text length limits
+
+ Grapheme-correct length counting and limits for text input dialogs.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Counts and limits the length of edited text without rescanning it.
+
+    NSString lengths are in UTF-16 code units, so limiting a text field with
+    [text length] counts an emoji as two characters (or, for a family emoji,
+    as eleven) and cutting with substringToIndex: can split a surrogate pair
+    or a cluster of combining marks. The limiter measures text in a chosen
+    unit - user-perceived characters (extended grapheme clusters, as in
+    Unicode 14), UTF-8 bytes, code points or UTF-16 code units - and only
+    ever cuts between grapheme clusters.
+
+    A limiter instance tracks the text of one field. Each edit is described
+    by its position and the replacement text, and only the clusters around
+    the edit are re-segmented, so an edit costs O(edit) rather than
+    O(length). If an edit would go over the limit, applyEdit() keeps as many
+    whole clusters of the inserted text as fit.
+
+    Positions and lengths passed to instances are in UTF-16 code units, which
+    is what AppKit reports edits in.
+
+    @code
+    NativeMacTextLimiter limiter (NativeMacTextLimiter::Unit::graphemes, 32);
+    limiter.setText (initialText);
+
+    // for every edit reported by the text field
+    const auto numKept = limiter.applyEdit (start, numReplaced, insertedUTF16, numInserted);
+    @endcode
+
+    The static count() and truncate() functions measure and cut whole strings.
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacTextLimiter
+{
+public:
+    //==============================================================================
+    /** The unit a length limit is given in. */
+    enum class Unit
+    {
+        graphemes,    /**< User-perceived characters (extended grapheme clusters). */
+        utf8Bytes,    /**< Bytes of the UTF-8 encoding, e.g. for file systems or protocols with byte limits. */
+        codePoints,   /**< Unicode code points. */
+        utf16         /**< UTF-16 code units, i.e. what [NSString length] returns. */
+    };
+
+    /** Returns the length of a text in the given unit. */
+    static int count (const juce::String& text, Unit unit);
+
+    /** Returns the longest prefix of the text, made of whole grapheme clusters, that
+        is no longer than maxLength (0 = no limit).
+    */
+    static juce::String truncate (const juce::String& text, int maxLength, Unit unit);
+
+    //==============================================================================
+    /** Creates a limiter for an empty text.
+
+        @param unit         The unit of the limit
+        @param maxLength    The limit (0 = no limit)
+    */
+    NativeMacTextLimiter (Unit unit, int maxLength);
+
+    /** Destructor. */
+    ~NativeMacTextLimiter();
+
+    /** Replaces the whole text without applying the limit. This is O(length). */
+    void setText (const juce::String& text);
+
+    /** Replaces the whole text without applying the limit. This is O(length). */
+    void setText (const juce::uint16* utf16, size_t numUnits);
+
+    /** Replaces numToRemove code units at start with the inserted text.
+
+        If the result would be longer than the limit, only the longest run of whole
+        grapheme clusters from the start of the inserted text that fits is kept.
+        Removing text is never refused, even in the rare case where that splits a
+        cluster in two and so makes the text longer.
+
+        @returns the number of code units of the inserted text that were kept
+    */
+    size_t applyEdit (size_t start, size_t numToRemove, const juce::uint16* inserted, size_t numToInsert);
+
+    /** Returns the length of the text in the limiter's unit. */
+    int getLength() const noexcept                       { return length; }
+
+    /** Returns the length of the text in UTF-16 code units. */
+    size_t getNumUTF16Units() const noexcept             { return text.size(); }
+
+    /** Returns the text. This is O(length). */
+    juce::String getText() const;
+
+    Unit getUnit() const noexcept                        { return unit; }
+    int getMaxLength() const noexcept                    { return maxLength; }
+    void setMaxLength (int newMaxLength) noexcept        { maxLength = newMaxLength; }
+
+    //==============================================================================
+    /** Counters for checking how much text edits look at. */
+    struct Stats
+    {
+        juce::int64 numEdits = 0;
+        juce::int64 numEditsClipped = 0;   /**< Edits that had to drop some of the inserted text. */
+        juce::int64 numUnitsScanned = 0;   /**< UTF-16 code units segmented or counted by applyEdit(). */
+    };
+
+    /** Returns the counters accumulated since creation or the last resetStats(). */
+    Stats getStats() const noexcept                      { return stats; }
+
+    /** Resets the counters. */
+    void resetStats() noexcept                           { stats = {}; }
+
+private:
+    //==============================================================================
+    int measure (const juce::uint16* data, size_t numUnits) const;
+    size_t findWindowStart (size_t position) const noexcept;
+    size_t findWindowEnd (size_t position) const noexcept;
+
+    const Unit unit;
+    int maxLength;
+    std::vector<juce::uint16> text;
+    int length = 0;
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacTextLimiter)
+};
+
+} // namespace juce
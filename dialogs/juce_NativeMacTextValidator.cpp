@@ -0,0 +1,453 @@
+/*******************************************************************************
+ Text validation - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+void NativeMacTextValidator::CharacterSet::add (juce_wchar c)
+{
+    if ((uint32) c < 128)
+    {
+        ascii[(uint32) c >> 6] |= (uint64) 1 << ((uint32) c & 63);
+        return;
+    }
+
+    auto pos = std::lower_bound (others.begin(), others.end(), c);
+
+    if (pos == others.end() || *pos != c)
+        others.insert (pos, c);
+}
+
+void NativeMacTextValidator::CharacterSet::add (const juce::String& characters)
+{
+    for (auto p = characters.getCharPointer(); ! p.isEmpty();)
+        add (p.getAndAdvance());
+}
+
+void NativeMacTextValidator::CharacterSet::addRange (juce_wchar first, juce_wchar last)
+{
+    for (auto c = first; c <= last; ++c)
+        add (c);
+}
+
+bool NativeMacTextValidator::CharacterSet::contains (juce_wchar c) const noexcept
+{
+    if ((uint32) c < 128)
+        return (ascii[(uint32) c >> 6] >> ((uint32) c & 63)) & 1;
+
+    return std::binary_search (others.begin(), others.end(), c);
+}
+
+//==============================================================================
+NativeMacTextValidator::NativeMacTextValidator() = default;
+NativeMacTextValidator::~NativeMacTextValidator() = default;
+
+NativeMacTextValidator& NativeMacTextValidator::addCharacterRule (CharacterSet set,
+                                                                  bool allowed,
+                                                                  const juce::String& errorMessage)
+{
+    CharacterRule rule;
+    rule.set = std::move (set);
+    rule.allowed = allowed;
+    rule.errorMessage = errorMessage;
+    characterRules.push_back (std::move (rule));
+
+    reset();   // the new rule hasn't seen the previous text
+    return *this;
+}
+
+NativeMacTextValidator& NativeMacTextValidator::allowOnly (const juce::String& allowedCharacters,
+                                                           const juce::String& errorMessage)
+{
+    CharacterSet set;
+    set.add (allowedCharacters);
+    return addCharacterRule (std::move (set), true, errorMessage);
+}
+
+NativeMacTextValidator& NativeMacTextValidator::forbid (const juce::String& forbiddenCharacters,
+                                                        const juce::String& errorMessage)
+{
+    CharacterSet set;
+    set.add (forbiddenCharacters);
+    return addCharacterRule (std::move (set), false, errorMessage);
+}
+
+NativeMacTextValidator& NativeMacTextValidator::forbidFileNameCharacters (const juce::String& errorMessage)
+{
+    CharacterSet set;
+    set.add ("/\\:*?\"<>|");
+    set.addRange (0, 31);
+    set.add ((juce_wchar) 127);
+    addCharacterRule (std::move (set), false, errorMessage);
+
+    return addRule ([errorMessage] (const juce::String& text)
+    {
+        if (text == "." || text == ".."
+             || text.startsWithChar (' ')
+             || text.endsWithChar (' ') || text.endsWithChar ('.'))
+            return juce::Result::fail (errorMessage);
+
+        return juce::Result::ok();
+    });
+}
+
+NativeMacTextValidator& NativeMacTextValidator::requireNonEmpty (const juce::String& errorMessage)
+{
+    return addRule ([errorMessage] (const juce::String& text)
+    {
+        return text.trim().isEmpty() ? juce::Result::fail (errorMessage)
+                                     : juce::Result::ok();
+    });
+}
+
+NativeMacTextValidator& NativeMacTextValidator::requireUnique (std::shared_ptr<const NativeMacNameIndex> existingNames,
+                                                               const juce::String& errorMessage,
+                                                               const juce::String& ownName)
+{
+    jassert (existingNames != nullptr);
+
+    const auto normalisedOwnName = existingNames != nullptr ? existingNames->normalise (ownName) : ownName;
+
+    return addRule ([existingNames, errorMessage, normalisedOwnName] (const juce::String& text)
+    {
+        if (existingNames == nullptr || ! existingNames->contains (text))
+            return juce::Result::ok();
+
+        if (normalisedOwnName.isNotEmpty() && existingNames->normalise (text) == normalisedOwnName)
+            return juce::Result::ok();
+
+        return juce::Result::fail (errorMessage);
+    });
+}
+
+NativeMacTextValidator& NativeMacTextValidator::addRule (Rule rule)
+{
+    jassert (rule != nullptr);
+
+    if (rule != nullptr)
+        textRules.push_back (std::move (rule));
+
+    reset();
+    return *this;
+}
+
+//==============================================================================
+void NativeMacTextValidator::reset()
+{
+    previousText.clear();
+    hasPreviousText = false;
+
+    for (auto& rule : characterRules)
+        rule.numOffending = 0;
+}
+
+void NativeMacTextValidator::updateCharacterRules (const std::vector<juce_wchar>& newText)
+{
+    // An edit replaces one span of the old text with one span of new text; everything before
+    // the common prefix and after the common suffix is unchanged and has already been counted
+    const auto oldSize = previousText.size();
+    const auto newSize = newText.size();
+
+    size_t prefix = 0;
+    const auto maxPrefix = jmin (oldSize, newSize);
+
+    while (prefix < maxPrefix && previousText[prefix] == newText[prefix])
+        ++prefix;
+
+    size_t suffix = 0;
+    const auto maxSuffix = maxPrefix - prefix;
+
+    while (suffix < maxSuffix && previousText[oldSize - 1 - suffix] == newText[newSize - 1 - suffix])
+        ++suffix;
+
+    const auto removedEnd = oldSize - suffix;
+    const auto insertedEnd = newSize - suffix;
+
+    for (auto& rule : characterRules)
+    {
+        for (auto i = prefix; i < removedEnd; ++i)
+            if (rule.offends (previousText[i]))
+                --rule.numOffending;
+
+        for (auto i = prefix; i < insertedEnd; ++i)
+            if (rule.offends (newText[i]))
+                ++rule.numOffending;
+
+        jassert (rule.numOffending >= 0);
+    }
+
+    stats.numCharactersChecked += (juce::int64) ((removedEnd - prefix) + (insertedEnd - prefix))
+                                    * (juce::int64) characterRules.size();
+}
+
+juce::Result NativeMacTextValidator::validate (const juce::String& text)
+{
+    ++stats.numValidations;
+
+    currentText.clear();
+
+    for (auto p = text.getCharPointer(); ! p.isEmpty();)
+        currentText.push_back (p.getAndAdvance());
+
+    if (hasPreviousText && currentText == previousText)
+    {
+        ++stats.numUnchanged;
+        return lastResult;
+    }
+
+    updateCharacterRules (currentText);
+    std::swap (previousText, currentText);
+    hasPreviousText = true;
+
+    lastResult = juce::Result::ok();
+
+    for (auto& rule : characterRules)
+    {
+        if (rule.numOffending > 0)
+        {
+            lastResult = juce::Result::fail (rule.errorMessage);
+            return lastResult;
+        }
+    }
+
+    for (auto& rule : textRules)
+    {
+        auto result = rule (text);
+
+        if (result.failed())
+        {
+            lastResult = result;
+            break;
+        }
+    }
+
+    return lastResult;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacTextValidatorTests  : public juce::UnitTest
+{
+public:
+    NativeMacTextValidatorTests()
+        : juce::UnitTest ("NativeMacTextValidator", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest ("Character rules");
+        {
+            NativeMacTextValidator validator;
+            expect (validator.validate ("anything at all").wasOk());
+
+            validator.allowOnly ("abc" + juce::String (juce::CharPointer_UTF8 ("\xc3\xa9")), "Only a, b, c or e-acute")
+                     .forbid ("b", "No b");
+
+            expectResult (validator.validate ({}), {});
+            expectResult (validator.validate ("acca"), {});
+            expectResult (validator.validate (juce::CharPointer_UTF8 ("ac\xc3\xa9")), {});
+            expectResult (validator.validate ("acd"), "Only a, b, c or e-acute");
+            expectResult (validator.validate (juce::CharPointer_UTF8 ("ac\xc3\xa8")), "Only a, b, c or e-acute");
+            expectResult (validator.validate ("acb"), "No b");
+
+            // Character rules are checked in the order they were added
+            expectResult (validator.validate ("bd"), "Only a, b, c or e-acute");
+            expectResult (validator.getLastResult(), "Only a, b, c or e-acute");
+
+            // Character rules come before text rules, whatever order they were added in
+            NativeMacTextValidator ordered;
+            ordered.requireNonEmpty ("Empty")
+                   .addRule ([] (const juce::String& text) { return text.length() > 3 ? juce::Result::fail ("Too long")
+                                                                                      : juce::Result::ok(); })
+                   .forbid ("!", "No exclamation marks");
+
+            expectResult (ordered.validate ("  "), "Empty");
+            expectResult (ordered.validate ("ok"), {});
+            expectResult (ordered.validate ("long!"), "No exclamation marks");
+            expectResult (ordered.validate ("long"), "Too long");
+        }
+
+        beginTest ("File names");
+        {
+            NativeMacTextValidator validator;
+            validator.forbidFileNameCharacters ("Bad name");
+
+            for (auto candidate : { "Preset", "My Preset 2", "a.b", ".hidden", "-", "x" })
+                expectResult (validator.validate (candidate), {});
+
+            for (auto candidate : { "a/b", "a\\b", "a:b", "a*", "a?", "\"a\"", "<a>", "a|b",
+                               ".", "..", " a", "a ", "a." })
+                expectResult (validator.validate (candidate), "Bad name");
+
+            expectResult (validator.validate ("a" + juce::String::charToString (9) + "b"), "Bad name");
+            expectResult (validator.validate ("a" + juce::String::charToString (127)), "Bad name");
+            expectResult (validator.validate (juce::CharPointer_UTF8 ("Caf\xc3\xa9")), {});
+
+            NativeMacTextValidator defaultMessage;
+            defaultMessage.forbidFileNameCharacters();
+            expect (defaultMessage.validate ("a:b").getErrorMessage().isNotEmpty());
+        }
+
+        beginTest ("Unique names");
+        {
+            const auto existingNames = std::make_shared<NativeMacNameIndex> (juce::StringArray { "Bass", "Lead", "Pad" });
+
+            NativeMacTextValidator validator;
+            validator.requireUnique (existingNames, "Taken");
+
+            expectResult (validator.validate ("Keys"), {});
+            expectResult (validator.validate ("Bass"), "Taken");
+            expectResult (validator.validate ("bASS"), "Taken");
+            expectResult (validator.validate ("Bass 2"), {});
+
+            // The own name is allowed, in any case, but only that one
+            NativeMacTextValidator renaming;
+            renaming.requireUnique (existingNames, "Taken", "Lead");
+
+            expectResult (renaming.validate ("Lead"), {});
+            expectResult (renaming.validate ("LEAD"), {});
+            expectResult (renaming.validate ("Pad"), "Taken");
+            expectResult (renaming.validate ("Keys"), {});
+
+            // An own name that isn't in the index doesn't let anything else through
+            NativeMacTextValidator newName;
+            newName.requireUnique (existingNames, "Taken", "Keys");
+
+            expectResult (newName.validate ("Keys"), {});
+            expectResult (newName.validate ("Bass"), "Taken");
+
+            // With a case-sensitive index, only the exact own name is allowed
+            const auto caseSensitive = std::make_shared<NativeMacNameIndex> (juce::StringArray { "Bass", "Lead" }, false);
+
+            NativeMacTextValidator exact;
+            exact.requireUnique (caseSensitive, "Taken", "Lead");
+
+            expectResult (exact.validate ("Lead"), {});
+            expectResult (exact.validate ("lead"), {});
+            expectResult (exact.validate ("Bass"), "Taken");
+            expectResult (exact.validate ("bass"), {});
+        }
+
+        beginTest ("Unchanged text");
+        {
+            NativeMacTextValidator validator;
+            validator.forbid ("x", "No x");
+
+            expectResult (validator.validate ("abx"), "No x");
+            expectResult (validator.validate ("abx"), "No x");
+            expectResult (validator.validate ("ab"), {});
+
+            const auto stats = validator.getStats();
+            expectEquals (stats.numValidations, (juce::int64) 3);
+            expectEquals (stats.numUnchanged, (juce::int64) 1);
+
+            validator.resetStats();
+            expectEquals (validator.getStats().numValidations, (juce::int64) 0);
+        }
+
+        beginTest ("Only edited characters are checked");
+        {
+            NativeMacTextValidator validator;
+            validator.forbid ("!", "No exclamation marks")
+                     .allowOnly ("abcdefghijklmnopqrstuvwxyz!", "Lower case only");
+
+            const juce::String text ("abcdefghijklmnopqrstuvwxyz");
+            juce::String typed;
+
+            for (int i = 0; i < text.length(); ++i)
+            {
+                typed += text.substring (i, i + 1);
+                validator.validate (typed);
+            }
+
+            // Each keystroke inserts one character, checked by both rules
+            expectEquals (validator.getStats().numCharactersChecked, (juce::int64) (text.length() * 2));
+
+            // Replacing a character in the middle removes one and inserts one
+            validator.resetStats();
+            expectResult (validator.validate (typed.replaceCharacter ('m', 'M')), "Lower case only");
+            expectEquals (validator.getStats().numCharactersChecked, (juce::int64) 4);
+
+            // After reset() the whole text is checked again
+            validator.reset();
+            validator.resetStats();
+            expectResult (validator.validate (typed + "!"), "No exclamation marks");
+            expectEquals (validator.getStats().numCharactersChecked, (juce::int64) ((text.length() + 1) * 2));
+        }
+
+        beginTest ("Incremental edits agree with validating from scratch");
+        {
+            auto random = getRandom();
+            const juce::String alphabet (juce::CharPointer_UTF8 ("aab c.x/:\xc3\xa9\xe2\x80\xa6"));
+
+            NativeMacTextValidator incremental;
+            addRules (incremental);
+
+            juce::String text;
+
+            for (int i = 0; i < 2000; ++i)
+            {
+                // Replace a random span with a random run of characters, sometimes including repeats
+                // of the neighbouring text, so the common prefix and suffix overlap the edit
+                const auto start = random.nextInt (text.length() + 1);
+                const auto end = start + random.nextInt (jmin (3, text.length() - start) + 1);
+
+                juce::String inserted;
+
+                for (int j = random.nextInt (4); --j >= 0;)
+                    inserted += juce::String::charToString (alphabet[random.nextInt (alphabet.length())]);
+
+                text = text.substring (0, start) + inserted + text.substring (end);
+
+                if (text.length() > 24)
+                    text = text.substring (random.nextInt (text.length()));
+
+                NativeMacTextValidator fromScratch;
+                addRules (fromScratch);
+
+                const auto expected = fromScratch.validate (text);
+                const auto actual = incremental.validate (text);
+
+                expectEquals (actual.failed(), expected.failed(), text);
+                expectEquals (actual.getErrorMessage(), expected.getErrorMessage(), text);
+            }
+        }
+
+        beginTest ("Rules added later see the whole text");
+        {
+            NativeMacTextValidator validator;
+            expectResult (validator.validate ("a:b"), {});
+
+            validator.forbidFileNameCharacters ("Bad name");
+            expectResult (validator.validate ("a:b"), "Bad name");
+        }
+    }
+
+private:
+    void expectResult (const juce::Result& result, const juce::String& expectedError)
+    {
+        if (expectedError.isEmpty())
+            expect (result.wasOk(), "unexpected failure: " + result.getErrorMessage());
+        else
+            expectEquals (result.getErrorMessage(), expectedError);
+    }
+
+    static void addRules (NativeMacTextValidator& validator)
+    {
+        validator.forbid ("x", "No x")
+                 .allowOnly (juce::CharPointer_UTF8 ("abcx .:/\xc3\xa9"), "Unexpected character")
+                 .requireNonEmpty ("Empty")
+                 .forbidFileNameCharacters ("Bad name");
+    }
+};
+
+static NativeMacTextValidatorTests nativeMacTextValidatorTests;
+
+#endif
+
+} // namespace juce
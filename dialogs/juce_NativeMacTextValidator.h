@@ -0,0 +1,165 @@
+/*******************************************************************************
+ Text validation
+
+ Incremental validation of the text typed into a text input dialog.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A pipeline of rules that checks the text of a text input dialog on every
+    keystroke.
+
+    Pass a validator to NativeMacDialogs::showTextInputDialog() or
+    NativeMacAlertTemplate::showTextInput() and the OK button is disabled,
+    with the first failing rule's message shown under the text field, for as
+    long as the text is invalid.
+
+    There are two kinds of rule:
+    - character rules (allowOnly(), forbid(), forbidFileNameCharacters()) look
+      at single characters. The validator remembers the previous text and only
+      runs the rules on the characters that an edit removed or inserted,
+      keeping a count of offending characters per rule. Finding the edited
+      span still compares the new text against the previous one, so a
+      keystroke is O(n) in the length of the text, but that pass is a plain
+      comparison rather than a check against every rule.
+    - text rules (requireNonEmpty(), requireUnique(), addRule()) look at the
+      whole text and run on every change. requireUnique() checks against a
+      prebuilt NativeMacNameIndex, so it is a hash lookup rather than a scan
+      of the existing names.
+
+    Character rules are checked before text rules; within each kind, rules are
+    checked in the order they were added.
+
+    @code
+    auto existingNames = std::make_shared<NativeMacNameIndex> (presetLibrary.getAllNames());
+
+    NativeMacTextValidator validator;
+    validator.requireNonEmpty ("Enter a name")
+             .forbidFileNameCharacters()
+             .requireUnique (existingNames, "A preset with this name already exists");
+
+    String name;
+    if (NativeMacDialogs::showTextInputDialog ("Save Preset", "Name:", {}, 64, "Save", "Cancel", name, validator))
+        presetLibrary.save (name);
+    @endcode
+
+    A validator keeps state between calls, so use one per dialog at a time.
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacTextValidator
+{
+public:
+    //==============================================================================
+    /** A whole-text rule: returns Result::fail() with a message if the text is invalid. */
+    using Rule = std::function<juce::Result (const juce::String& text)>;
+
+    /** Creates a validator with no rules, which accepts everything. */
+    NativeMacTextValidator();
+
+    /** Destructor. */
+    ~NativeMacTextValidator();
+
+    //==============================================================================
+    /** Rejects any character that isn't in the given set. */
+    NativeMacTextValidator& allowOnly (const juce::String& allowedCharacters,
+                                       const juce::String& errorMessage);
+
+    /** Rejects every character in the given set. */
+    NativeMacTextValidator& forbid (const juce::String& forbiddenCharacters,
+                                    const juce::String& errorMessage);
+
+    /** Rejects text that can't be used as a file name on macOS, Windows or Linux:
+        path separators and the characters  : * ? " < > |, control characters,
+        "." and "..", and names starting with a space or ending with a space or dot.
+    */
+    NativeMacTextValidator& forbidFileNameCharacters (const juce::String& errorMessage = "The name contains characters that can't be used in a file name");
+
+    /** Rejects text that is empty or only whitespace. */
+    NativeMacTextValidator& requireNonEmpty (const juce::String& errorMessage);
+
+    /** Rejects text that is already in the index.
+
+        @param existingNames  The names to check against; shared, never copied
+        @param errorMessage   Message to show when the name is taken
+        @param ownName        A name that is allowed even though it is in the index,
+                              e.g. the current name when renaming
+    */
+    NativeMacTextValidator& requireUnique (std::shared_ptr<const NativeMacNameIndex> existingNames,
+                                           const juce::String& errorMessage,
+                                           const juce::String& ownName = {});
+
+    /** Adds a custom whole-text rule. */
+    NativeMacTextValidator& addRule (Rule rule);
+
+    //==============================================================================
+    /** Checks the text, reusing the work done for the previous call.
+
+        @returns Result::ok(), or the failure of the first rule that rejected the text
+    */
+    juce::Result validate (const juce::String& text);
+
+    /** Returns the result of the last validate() call. */
+    const juce::Result& getLastResult() const noexcept     { return lastResult; }
+
+    /** Forgets the previous text, so the next validate() checks every character. */
+    void reset();
+
+    //==============================================================================
+    /** Counters for checking how much work validation does. */
+    struct Stats
+    {
+        juce::int64 numValidations = 0;
+        juce::int64 numCharactersChecked = 0;   /**< Characters looked at by character rules. */
+        juce::int64 numUnchanged = 0;           /**< Calls answered from the previous result. */
+    };
+
+    /** Returns the counters accumulated since creation or the last resetStats(). */
+    Stats getStats() const noexcept                        { return stats; }
+
+    /** Resets the counters. */
+    void resetStats() noexcept                             { stats = {}; }
+
+private:
+    //==============================================================================
+    struct CharacterSet
+    {
+        void add (juce_wchar c);
+        void add (const juce::String& characters);
+        void addRange (juce_wchar first, juce_wchar last);
+        bool contains (juce_wchar c) const noexcept;
+
+        uint64 ascii[2] = { 0, 0 };
+        std::vector<juce_wchar> others;   // sorted
+    };
+
+    struct CharacterRule
+    {
+        CharacterSet set;
+        bool allowed;                     // true: characters must be in the set, false: must not be
+        juce::String errorMessage;
+        int numOffending = 0;
+
+        bool offends (juce_wchar c) const noexcept    { return set.contains (c) != allowed; }
+    };
+
+    NativeMacTextValidator& addCharacterRule (CharacterSet set, bool allowed, const juce::String& errorMessage);
+    void updateCharacterRules (const std::vector<juce_wchar>& newText);
+
+    std::vector<CharacterRule> characterRules;
+    std::vector<Rule> textRules;
+
+    std::vector<juce_wchar> previousText, currentText;
+    bool hasPreviousText = false;
+    juce::Result lastResult { juce::Result::ok() };
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacTextValidator)
+};
+
+} // namespace juce
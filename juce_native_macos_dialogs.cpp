@@ -0,0 +1,40 @@
+/*******************************************************************************
+ Native macOS Dialogs Module - platform independent code
+
+ On macOS this file is included by juce_native_macos_dialogs.mm. On other
+ platforms it is compiled on its own so that the portable parts of the
+ module (payload formats, data structures) remain available.
+*******************************************************************************/
+
+#include "juce_native_macos_dialogs.h"
+
+#include "diagnostics/juce_NativeMacTrace.cpp"
+#include "diagnostics/juce_NativeMacLatencyHistogram.cpp"
+#include "diagnostics/juce_NativeMacAllocationStats.cpp"
+#include "clipboard/juce_NativeMacClipboardPayload.cpp"
+#include "clipboard/juce_NativeMacClipboardSchema.cpp"
+#include "clipboard/juce_NativeMacClipboardFileReference.cpp"
+#include "clipboard/juce_NativeMacPasteboardBackend.cpp"
+#include "clipboard/juce_NativeMacPasteboard.cpp"
+#include "clipboard/juce_NativeMacClipboardFetcher.cpp"
+#include "clipboard/juce_NativeMacClipboardHistory.cpp"
+#include "clipboard/juce_NativeMacClipboardWatcher.cpp"
+#include "clipboard/juce_NativeMacClipboardConverterRegistry.cpp"
+#include "dialogs/juce_NativeMacFocusRestorer.cpp"
+#include "dialogs/juce_NativeMacNameIndex.cpp"
+#include "dialogs/juce_NativeMacTextValidator.cpp"
+#include "dialogs/juce_NativeMacCompletionIndex.cpp"
+#include "dialogs/juce_NativeMacTextLimiter.cpp"
+#include "dialogs/juce_NativeMacDialogBackend.cpp"
+#include "dialogs/juce_NativeMacForm.cpp"
+#include "dialogs/juce_NativeMacFormLayout.cpp"
+#include "dialogs/juce_NativeMacDialogs.cpp"
+#include "dialogs/juce_NativeMacAlertTemplate.cpp"
+#include "dialogs/juce_NativeMacDialogQueue.cpp"
+#include "dialogs/juce_NativeMacMessageAggregator.cpp"
+#include "dialogs/juce_NativeMacProgressDialog.cpp"
+#include "dialogs/juce_NativeMacSuppressionStore.cpp"
+#include "menus/juce_NativeMacMenuModel.cpp"
+#include "menus/juce_NativeMacMenuBackend.cpp"
+#include "menus/juce_NativeMacPopupMenu.cpp"
+#include "scripting/juce_NativeMacScriptedUI.cpp"
@@ -1,224 +1,578 @@
-/*******************************************************************************
- BEGIN_JUCE_MODULE_DECLARATION
-
-  ID:               juce_native_macos_dialogs
-  vendor:           discoDSP
-  version:          2.1.0
-  name:             Native macOS Dialog Components
-  description:      Native macOS dialogs, popup menus, and clipboard integration for JUCE
-  website:          https://discodsp.com/
-  license:          GPL
-  minimumCppStandard: 17
-
-  dependencies:     juce_core, juce_gui_basics
-  OSXFrameworks:    Cocoa AppKit Foundation
-  iOSFrameworks:
-
- END_JUCE_MODULE_DECLARATION
-*******************************************************************************/
-
-#pragma once
-#define JUCE_NATIVE_MACOS_DIALOGS_H_INCLUDED
-
-#include <juce_core/juce_core.h>
-#include <juce_gui_basics/juce_gui_basics.h>
-
-//==============================================================================
-/** Config: JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
-    Enables the native macOS pasteboard (clipboard) support.
-*/
-#ifndef JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
- #define JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD 1
-#endif
-
-//==============================================================================
-namespace juce
-{
-
-//==============================================================================
-/**
-    Native macOS dialog boxes using NSAlert and Cocoa frameworks.
-
-    This class provides native macOS dialogs that integrate better with the system
-    than JUCE's cross-platform dialogs. Particularly useful for AU/VST plugins
-    running in DAWs.
-
-    @tags{GUI}
-*/
-class JUCE_API  NativeMacDialogs
-{
-public:
-    //==============================================================================
-    /** Shows a native macOS text input dialog.
-
-        @param title          The dialog title
-        @param message        The informative message to display
-        @param currentText    The initial text to show in the input field
-        @param maxLength      Maximum number of characters allowed (0 = no limit)
-        @param okButtonText   Text for the OK/confirm button
-        @param cancelButtonText Text for the cancel button
-        @param outText        Reference to string that will receive the entered text
-
-        @returns true if the user clicked OK, false if cancelled
-    */
-    static bool showTextInputDialog (const juce::String& title,
-                                     const juce::String& message,
-                                     const juce::String& currentText,
-                                     int maxLength,
-                                     const juce::String& okButtonText,
-                                     const juce::String& cancelButtonText,
-                                     juce::String& outText);
-
-    //==============================================================================
-    /** Shows a native macOS information/error dialog.
-
-        @param title          The dialog title
-        @param message        The message to display
-        @param buttonText     Text for the OK button
-    */
-    static void showInfoDialog (const juce::String& title,
-                               const juce::String& message,
-                               const juce::String& buttonText = "OK");
-
-    //==============================================================================
-    /** Shows a native macOS confirmation dialog with two buttons.
-
-        @param title          The dialog title
-        @param message        The message to display
-        @param button1Text    Text for the first button (returns true)
-        @param button2Text    Text for the second button (returns false)
-
-        @returns true if button1 was clicked, false if button2 was clicked
-    */
-    static bool showConfirmDialog (const juce::String& title,
-                                   const juce::String& message,
-                                   const juce::String& button1Text = "OK",
-                                   const juce::String& button2Text = "Cancel");
-
-private:
-    NativeMacDialogs() = delete;
-    JUCE_DECLARE_NON_COPYABLE (NativeMacDialogs)
-};
-
-//==============================================================================
-#if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
-
-/**
-    Native macOS pasteboard (clipboard) with custom data type support.
-
-    Allows copying and pasting custom binary data to/from the system clipboard
-    using a custom UTI (Uniform Type Identifier).
-
-    @tags{Core}
-*/
-class JUCE_API  NativeMacPasteboard
-{
-public:
-    //==============================================================================
-    /** Copies binary data to the macOS clipboard with a custom type identifier.
-
-        @param data        Pointer to the data to copy
-        @param size        Size of the data in bytes
-        @param typeUTI     Custom UTI (e.g., "com.yourcompany.yourapp.datatype")
-    */
-    static void copyDataToClipboard (const void* data, size_t size,
-                                     const juce::String& typeUTI);
-
-    //==============================================================================
-    /** Checks if clipboard contains data of the specified custom type.
-
-        @param typeUTI     The custom UTI to check for
-        @returns true if clipboard contains data of this type
-    */
-    static bool clipboardContainsDataType (const juce::String& typeUTI);
-
-    //==============================================================================
-    /** Retrieves binary data from the clipboard.
-
-        @param memoryBlock  MemoryBlock that will receive the clipboard data
-        @param typeUTI      The custom UTI to retrieve
-        @returns true if data was successfully retrieved
-    */
-    static bool fetchDataFromClipboard (juce::MemoryBlock& memoryBlock,
-                                       const juce::String& typeUTI);
-
-private:
-    NativeMacPasteboard() = delete;
-    JUCE_DECLARE_NON_COPYABLE (NativeMacPasteboard)
-};
-
-#endif // JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
-
-//==============================================================================
-/**
-    Native macOS popup menus using NSMenu for better system integration.
-
-    Provides native macOS popup menus that look and behave like system menus,
-    with proper support for checkmarks, submenus, and auto-scrolling to
-    selected items.
-
-    @tags{GUI}
-*/
-class JUCE_API  NativeMacPopupMenu
-{
-public:
-    //==============================================================================
-    /** Shows a native macOS popup menu at the current mouse location.
-
-        @param menu                  The JUCE PopupMenu to display
-        @param parentComponent       Optional parent component for coordinate conversion
-        @param useSmallSize          If true, uses small menu font size (more compact)
-        @param centerOnCheckedItem   If true, centers menu on checked item (default: false)
-
-        @returns the selected menu item ID, or 0 if cancelled
-    */
-    static int showPopupMenu (const juce::PopupMenu& menu,
-                             juce::Component* parentComponent = nullptr,
-                             bool useSmallSize = false,
-                             bool centerOnCheckedItem = false);
-
-    //==============================================================================
-    /** Shows a native macOS popup menu at a specific screen position.
-
-        This version auto-scrolls to show checked items, making it ideal for
-        preset browsers and lists where the current selection should be visible.
-
-        When a menu item has a checkmark (isTicked), the menu automatically
-        positions itself so that the checked item appears at the cursor location.
-
-        @param menu              The JUCE PopupMenu to display
-        @param screenPosition    Position in screen coordinates (JUCE style, top-left origin)
-        @param useSmallSize      If true, uses small menu font size (more compact)
-
-        @returns the selected menu item ID, or 0 if cancelled
-    */
-    static int showPopupMenuAt (const juce::PopupMenu& menu,
-                               juce::Point<int> screenPosition,
-                               bool useSmallSize = false);
-
-    //==============================================================================
-    /** Shows a native macOS popup menu at a fixed position without auto-scroll.
-
-        This version positions the menu at the exact location without centering
-        on checked items. Ideal for ComboBox-style dropdowns where you want the
-        menu to appear directly below or above a component.
-
-        Unlike showPopupMenuAt, this does NOT reposition the menu based on
-        which item is checked, giving you precise control over menu placement.
-
-        @param menu              The JUCE PopupMenu to display
-        @param screenPosition    Position in screen coordinates (JUCE style, top-left origin)
-        @param useSmallSize      If true, uses small menu font size (more compact)
-
-        @returns the selected menu item ID, or 0 if cancelled
-    */
-    static int showPopupMenuAtFixed (const juce::PopupMenu& menu,
-                                    juce::Point<int> screenPosition,
-                                    bool useSmallSize = false);
-
-private:
-    NativeMacPopupMenu() = delete;
-    JUCE_DECLARE_NON_COPYABLE (NativeMacPopupMenu)
-};
-
-} // namespace juce
+/*******************************************************************************
+ BEGIN_JUCE_MODULE_DECLARATION
+
+  ID:               juce_native_macos_dialogs
+  vendor:           discoDSP
+  version:          2.1.0
+  name:             Native macOS Dialog Components
+  description:      Native macOS dialogs, popup menus, and clipboard integration for JUCE
+  website:          https://discodsp.com/
+  license:          GPL
+  minimumCppStandard: 17
+
+  dependencies:     juce_core, juce_gui_basics
+  OSXFrameworks:    Cocoa AppKit Foundation
+  iOSFrameworks:
+
+ END_JUCE_MODULE_DECLARATION
+*******************************************************************************/
+
+#pragma once
+#define JUCE_NATIVE_MACOS_DIALOGS_H_INCLUDED
+
+#include <juce_core/juce_core.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+//==============================================================================
+/** Config: JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+    Enables the native macOS pasteboard (clipboard) support.
+*/
+#ifndef JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+ #define JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD 1
+#endif
+
+/** Config: JUCE_NATIVE_MACOS_ENABLE_TRACING
+    Records timed spans around dialogs, menus and clipboard calls, which
+    NativeMacTrace exports as Chrome trace JSON. Adds no code when disabled.
+*/
+#ifndef JUCE_NATIVE_MACOS_ENABLE_TRACING
+ #define JUCE_NATIVE_MACOS_ENABLE_TRACING 0
+#endif
+
+/** Config: JUCE_NATIVE_MACOS_ENABLE_ALLOCATION_COUNTING
+    Counts the heap allocations and native objects of each dialog, menu and
+    clipboard call, reported by NativeMacAllocationStats. Replaces the global
+    operator new and delete, so enable it for test and profiling builds only.
+*/
+#ifndef JUCE_NATIVE_MACOS_ENABLE_ALLOCATION_COUNTING
+ #define JUCE_NATIVE_MACOS_ENABLE_ALLOCATION_COUNTING 0
+#endif
+
+//==============================================================================
+#include "diagnostics/juce_NativeMacTrace.h"
+#include "diagnostics/juce_NativeMacLatencyHistogram.h"
+#include "diagnostics/juce_NativeMacAllocationStats.h"
+#include "clipboard/juce_NativeMacClipboardPayload.h"
+#include "clipboard/juce_NativeMacClipboardSchema.h"
+#include "clipboard/juce_NativeMacPasteboardBackend.h"
+#include "clipboard/juce_NativeMacClipboardHistory.h"
+#include "clipboard/juce_NativeMacClipboardFileReference.h"
+#include "dialogs/juce_NativeMacFocusRestorer.h"
+#include "dialogs/juce_NativeMacNameIndex.h"
+#include "dialogs/juce_NativeMacTextValidator.h"
+#include "dialogs/juce_NativeMacCompletionIndex.h"
+#include "dialogs/juce_NativeMacTextLimiter.h"
+#include "dialogs/juce_NativeMacDialogBackend.h"
+#include "dialogs/juce_NativeMacForm.h"
+#include "dialogs/juce_NativeMacFormLayout.h"
+#include "dialogs/juce_NativeMacAlertTemplate.h"
+#include "dialogs/juce_NativeMacDialogQueue.h"
+#include "dialogs/juce_NativeMacMessageAggregator.h"
+#include "dialogs/juce_NativeMacProgressDialog.h"
+#include "dialogs/juce_NativeMacSuppressionStore.h"
+#include "menus/juce_NativeMacMenuModel.h"
+#include "menus/juce_NativeMacMenuBackend.h"
+#include "scripting/juce_NativeMacScriptedUI.h"
+
+//==============================================================================
+namespace juce
+{
+
+//==============================================================================
+/**
+    Native macOS dialog boxes using NSAlert and Cocoa frameworks.
+
+    This class provides native macOS dialogs that integrate better with the system
+    than JUCE's cross-platform dialogs. Particularly useful for AU/VST plugins
+    running in DAWs.
+
+    Alerts are built by a NativeMacDialogBackend. On macOS the default backend
+    uses NSAlert; on other platforms a NativeMacHeadlessDialogBackend dismisses
+    every dialog. For dialogs that are shown over and over, a
+    NativeMacAlertTemplate avoids rebuilding the alert each time.
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacDialogs
+{
+public:
+    //==============================================================================
+    /** Shows a native macOS text input dialog.
+
+        @param title          The dialog title
+        @param message        The informative message to display
+        @param currentText    The initial text to show in the input field
+        @param maxLength      Maximum number of characters allowed (0 = no limit). Characters are
+                              counted as the user sees them (grapheme clusters), so an emoji or
+                              a letter with combining accents counts as one; use the overload
+                              taking NativeMacTextInputOptions to count bytes instead.
+        @param okButtonText   Text for the OK/confirm button
+        @param cancelButtonText Text for the cancel button
+        @param outText        Reference to string that will receive the entered text
+
+        @returns true if the user clicked OK, false if cancelled
+    */
+    static bool showTextInputDialog (const juce::String& title,
+                                     const juce::String& message,
+                                     const juce::String& currentText,
+                                     int maxLength,
+                                     const juce::String& okButtonText,
+                                     const juce::String& cancelButtonText,
+                                     juce::String& outText);
+
+    /** Shows a native macOS text input dialog whose text is checked on every keystroke.
+
+        While the validator rejects the text, the OK button is disabled and the
+        validator's message is shown under the text field.
+
+        @see NativeMacTextValidator
+    */
+    static bool showTextInputDialog (const juce::String& title,
+                                     const juce::String& message,
+                                     const juce::String& currentText,
+                                     int maxLength,
+                                     const juce::String& okButtonText,
+                                     const juce::String& cancelButtonText,
+                                     juce::String& outText,
+                                     NativeMacTextValidator& validator);
+
+    /** Shows a native macOS text input dialog with a validator, completions or both.
+
+        @see NativeMacTextInputOptions
+    */
+    static bool showTextInputDialog (const juce::String& title,
+                                     const juce::String& message,
+                                     const juce::String& currentText,
+                                     int maxLength,
+                                     const juce::String& okButtonText,
+                                     const juce::String& cancelButtonText,
+                                     juce::String& outText,
+                                     const NativeMacTextInputOptions& options);
+
+    //==============================================================================
+    /** Shows a native macOS information/error dialog.
+
+        @param title          The dialog title
+        @param message        The message to display
+        @param buttonText     Text for the OK button
+    */
+    static void showInfoDialog (const juce::String& title,
+                               const juce::String& message,
+                               const juce::String& buttonText = "OK");
+
+    //==============================================================================
+    /** Shows a native macOS confirmation dialog with two buttons.
+
+        @param title          The dialog title
+        @param message        The message to display
+        @param button1Text    Text for the first button (returns true)
+        @param button2Text    Text for the second button (returns false)
+
+        @returns true if button1 was clicked, false if button2 was clicked
+    */
+    static bool showConfirmDialog (const juce::String& title,
+                                   const juce::String& message,
+                                   const juce::String& button1Text = "OK",
+                                   const juce::String& button2Text = "Cancel");
+
+    /** Shows a native macOS confirmation dialog with a "Don't ask again" checkbox.
+
+        If the user ticks the checkbox, the button they choose is stored under
+        options.suppressionID in the suppression store, and later calls with the
+        same ID return that answer straight away, without showing anything.
+
+        @see NativeMacConfirmOptions, setSuppressionStore
+    */
+    static bool showConfirmDialog (const juce::String& title,
+                                   const juce::String& message,
+                                   const juce::String& button1Text,
+                                   const juce::String& button2Text,
+                                   const NativeMacConfirmOptions& options);
+
+    //==============================================================================
+    /** Shows a native macOS dialog with several fields in one alert.
+
+        The form's text fields, checkboxes and popups are laid out by a
+        NativeMacFormLayout below the message. While any text field fails its
+        validator, the first button is disabled.
+
+        @param title          The dialog title
+        @param message        The message to display above the fields
+        @param form           The fields; their values are updated if the first button is clicked
+        @param okButtonText   Text for the first button (returns true)
+        @param cancelButtonText Text for the second button (returns false)
+
+        @returns true if the first button was clicked, false otherwise
+    */
+    static bool showFormDialog (const juce::String& title,
+                                const juce::String& message,
+                                NativeMacForm& form,
+                                const juce::String& okButtonText = "OK",
+                                const juce::String& cancelButtonText = "Cancel");
+
+    //==============================================================================
+    /** Replaces the backend used to build alerts.
+
+        Passing nullptr restores the default backend.
+    */
+    static void setBackend (std::shared_ptr<NativeMacDialogBackend> newBackend);
+
+    /** Returns the backend currently in use, creating the default one if needed. */
+    static std::shared_ptr<NativeMacDialogBackend> getBackend();
+
+    /** Replaces the store that remembers suppressed dialogs.
+
+        Passing nullptr restores the default store, which isn't persisted.
+    */
+    static void setSuppressionStore (std::shared_ptr<NativeMacSuppressionStore> newStore);
+
+    /** Returns the suppression store currently in use, creating the default one if needed. */
+    static std::shared_ptr<NativeMacSuppressionStore> getSuppressionStore();
+
+private:
+    NativeMacDialogs() = delete;
+    JUCE_DECLARE_NON_COPYABLE (NativeMacDialogs)
+};
+
+//==============================================================================
+#if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+/**
+    Native macOS pasteboard (clipboard) with custom data type support.
+
+    Allows copying and pasting custom binary data to/from the system clipboard
+    using a custom UTI (Uniform Type Identifier).
+
+    All operations go through a NativeMacPasteboardBackend. On macOS the default
+    backend is the system's general pasteboard; use setBackend() to substitute
+    another one, such as a NativeMacInMemoryPasteboard for testing. On other
+    platforms the default backend is an in-process NativeMacInMemoryPasteboard.
+
+    @tags{Core}
+*/
+class JUCE_API  NativeMacPasteboard
+{
+public:
+    //==============================================================================
+    /** Copies binary data to the macOS clipboard with a custom type identifier.
+
+        If this process wrote identical data of the same type last, and no one has
+        changed the clipboard since, the write is skipped so that the change count
+        isn't bumped for nothing (see setWriteDeduplicationEnabled()).
+
+        @param data        Pointer to the data to copy
+        @param size        Size of the data in bytes
+        @param typeUTI     Custom UTI (e.g., "com.yourcompany.yourapp.datatype")
+    */
+    static void copyDataToClipboard (const void* data, size_t size,
+                                     const juce::String& typeUTI);
+
+    //==============================================================================
+    /** Copies binary data to the clipboard wrapped in the framed payload format.
+
+        The data gets a versioned header and a CRC32C checksum, and is optionally
+        LZ compressed (see NativeMacClipboardPayload). All the fetch functions
+        recognise framed payloads and return the original data transparently.
+
+        @param data         Pointer to the data to copy
+        @param size         Size of the data in bytes
+        @param typeUTI      Custom UTI (e.g., "com.yourcompany.yourapp.datatype")
+        @param compression  Whether to compress the payload
+    */
+    static void copyDataToClipboard (const void* data, size_t size,
+                                     const juce::String& typeUTI,
+                                     NativeMacClipboardPayload::Compression compression);
+
+    //==============================================================================
+    /** Copies binary data to the clipboard and promises further types, whose data
+        is only produced by the provider if a reader actually asks for it.
+
+        Use this to offer derived formats without serialising into each of them on
+        every copy; NativeMacClipboardConverterRegistry::copyToClipboard() builds
+        the promises from its converters.
+
+        @param data           Pointer to the data to copy
+        @param size           Size of the data in bytes
+        @param typeUTI        Custom UTI of the data
+        @param promisedTypes  Additional UTIs to offer
+        @param provider       Produces the data for a promised type on demand. It may be
+                              called on another thread, or not at all.
+    */
+    static void copyDataToClipboard (const void* data, size_t size,
+                                     const juce::String& typeUTI,
+                                     const juce::StringArray& promisedTypes,
+                                     NativeMacPasteboardBackend::DataProvider provider);
+
+    //==============================================================================
+    /** Checks if clipboard contains data of the specified custom type.
+
+        @param typeUTI     The custom UTI to check for
+        @returns true if clipboard contains data of this type
+    */
+    static bool clipboardContainsDataType (const juce::String& typeUTI);
+
+    //==============================================================================
+    /** Retrieves binary data from the clipboard.
+
+        @param memoryBlock  MemoryBlock that will receive the clipboard data
+        @param typeUTI      The custom UTI to retrieve
+        @returns true if data was successfully retrieved
+    */
+    static bool fetchDataFromClipboard (juce::MemoryBlock& memoryBlock,
+                                       const juce::String& typeUTI);
+
+    //==============================================================================
+    /** Returns the size in bytes of the clipboard data of the specified type.
+
+        The system pasteboard can only hand out a payload as a whole, so this
+        costs a full read of the data, as much as fetching it. Don't call it
+        just to size a buffer before a fetch: the grow-only MemoryBlock version
+        of fetchDataFromClipboard() sizes and fills the buffer in one read, and
+        the caller-supplied buffer version reports the size it needed when the
+        data doesn't fit.
+
+        @param typeUTI      The custom UTI to query
+        @returns the number of bytes available, or -1 if the clipboard holds no
+                 data of this type
+    */
+    static juce::int64 getClipboardDataSize (const juce::String& typeUTI);
+
+    //==============================================================================
+    /** Copies clipboard data into a caller-supplied buffer without allocating.
+
+        If the data doesn't fit, nothing is copied and bytesNeeded tells you how
+        large the buffer has to be. Keep the buffer between calls and only grow
+        it then, so that a steady stream of pastes costs one read each.
+
+        @param destBuffer   Buffer that will receive the clipboard data
+        @param bufferSize   Capacity of destBuffer in bytes
+        @param bytesNeeded  Receives the size of the clipboard data (0 if there is none)
+        @param typeUTI      The custom UTI to retrieve
+        @returns true if data was present and has been copied into destBuffer
+    */
+    static bool fetchDataFromClipboard (void* destBuffer, size_t bufferSize,
+                                       size_t& bytesNeeded,
+                                       const juce::String& typeUTI);
+
+    //==============================================================================
+    /** Retrieves clipboard data into a reusable buffer.
+
+        Unlike the plain MemoryBlock version, the buffer is only ever grown: its
+        size is treated as capacity and is left alone when the data fits, so a
+        buffer kept between pastes stops reallocating once it is large enough.
+        Sizing and filling happen in a single read of the pasteboard.
+
+        @param buffer           Buffer that will receive the clipboard data
+        @param numBytesFetched  Receives the number of valid bytes at the start of buffer
+        @param typeUTI          The custom UTI to retrieve
+        @returns true if data was successfully retrieved
+    */
+    static bool fetchDataFromClipboard (juce::MemoryBlock& buffer,
+                                       size_t& numBytesFetched,
+                                       const juce::String& typeUTI);
+
+    //==============================================================================
+    /** Gives a callback direct read access to the clipboard data, without copying it.
+
+        The visitor is called synchronously as visitor (const void* data, size_t size),
+        and the pointer is only valid for the duration of that call. Framed payloads
+        have to be decoded first, so for those the visitor sees a temporary copy.
+
+        @param typeUTI      The custom UTI to retrieve
+        @param visitor      Callable invoked with the clipboard bytes
+        @returns true if data was present and the visitor was called
+    */
+    template <typename Visitor>
+    static bool visitClipboardData (const juce::String& typeUTI, Visitor&& visitor)
+    {
+        using VisitorType = std::remove_reference_t<Visitor>;
+
+        return visitClipboardData (typeUTI,
+                                   [] (void* context, const void* data, size_t size)
+                                   {
+                                       (*static_cast<VisitorType*> (context)) (data, size);
+                                   },
+                                   const_cast<void*> (static_cast<const void*> (std::addressof (visitor))));
+    }
+
+    //==============================================================================
+    /** Returns the current pasteboard's change count.
+
+        The count increases every time any application changes the clipboard
+        contents, so comparing it against a stored value is a cheap way to tell
+        whether cached clipboard state is still valid.
+    */
+    static juce::int64 getChangeCount();
+
+    //==============================================================================
+    /** Enables or disables skipping repeated writes of unchanged data (enabled by default).
+
+        Deduplication compares a 64-bit hash of the payload with the last one this
+        process wrote, and only skips the write while the pasteboard's change count
+        shows that nothing else has been copied in the meantime.
+    */
+    static void setWriteDeduplicationEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Returns true if repeated writes of unchanged data are skipped. */
+    static bool isWriteDeduplicationEnabled() noexcept;
+
+    /** Counters for copyDataToClipboard() calls. */
+    struct WriteStats
+    {
+        juce::int64 numWrites = 0;          /**< Writes that reached the pasteboard. */
+        juce::int64 numSkippedWrites = 0;   /**< Writes skipped because the data was unchanged. */
+        juce::int64 numBytesSkipped = 0;    /**< Total payload size of the skipped writes. */
+    };
+
+    /** Returns the write counters accumulated since startup or the last resetWriteStats(). */
+    static WriteStats getWriteStats() noexcept;
+
+    /** Resets the write counters. */
+    static void resetWriteStats() noexcept;
+
+    //==============================================================================
+    /** Makes copyDataToClipboard() write payloads of at least this size to a
+        temporary file, publishing only a small reference to it.
+
+        Readers using NativeMacPasteboard memory-map the file, so very large
+        payloads never have to pass through the pasteboard server or the heap.
+        The spill file is deleted when this process next changes the clipboard;
+        files left behind by earlier sessions are cleaned up after a day.
+        Note that other applications only see the reference record, and sandboxed
+        readers need access to the spill directory.
+
+        @param numBytes   The size threshold, or 0 to disable file-backed payloads (the default)
+        @param directory  Where spill files are created; defaults to
+                          NativeMacClipboardFileReference::getDefaultDirectory()
+    */
+    static void setFileBackedThreshold (size_t numBytes, const juce::File& directory = {});
+
+    /** Returns the current file-backed threshold (0 if disabled). */
+    static size_t getFileBackedThreshold();
+
+    //==============================================================================
+    /** Installs a history that records every payload written by copyDataToClipboard().
+
+        Payloads are recorded in their original (unframed) form, and only for the
+        types the history is configured to accept. Passing nullptr stops recording.
+    */
+    static void setHistory (std::shared_ptr<NativeMacClipboardHistory> history);
+
+    /** Returns the installed history, or nullptr if there is none. */
+    static std::shared_ptr<NativeMacClipboardHistory> getHistory();
+
+    //==============================================================================
+    /** Replaces the backend used by all NativeMacPasteboard functions.
+
+        Passing nullptr restores the default backend.
+    */
+    static void setBackend (std::shared_ptr<NativeMacPasteboardBackend> newBackend);
+
+    /** Returns the backend currently in use, creating the default one if needed. */
+    static std::shared_ptr<NativeMacPasteboardBackend> getBackend();
+
+private:
+    using DataVisitorFunction = NativeMacPasteboardBackend::DataVisitorFunction;
+
+    static bool visitClipboardData (const juce::String& typeUTI,
+                                    DataVisitorFunction visitorFunction,
+                                    void* context);
+
+    NativeMacPasteboard() = delete;
+    JUCE_DECLARE_NON_COPYABLE (NativeMacPasteboard)
+};
+
+#endif // JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+//==============================================================================
+/**
+    Native macOS popup menus using NSMenu for better system integration.
+
+    Provides native macOS popup menus that look and behave like system menus,
+    with proper support for checkmarks, submenus, and auto-scrolling to
+    selected items.
+
+    Menus are flattened into a NativeMacMenuModel and shown by a
+    NativeMacMenuBackend. On macOS the default backend uses NSMenu; on other
+    platforms a NativeMacHeadlessMenuBackend cancels every menu.
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacPopupMenu
+{
+public:
+    //==============================================================================
+    /** Shows a native macOS popup menu at the current mouse location.
+
+        @param menu                  The JUCE PopupMenu to display
+        @param parentComponent       Optional parent component for coordinate conversion
+        @param useSmallSize          If true, uses small menu font size (more compact)
+        @param centerOnCheckedItem   If true, centers menu on checked item (default: false)
+
+        @returns the selected menu item ID, or 0 if cancelled
+    */
+    static int showPopupMenu (const juce::PopupMenu& menu,
+                             juce::Component* parentComponent = nullptr,
+                             bool useSmallSize = false,
+                             bool centerOnCheckedItem = false);
+
+    //==============================================================================
+    /** Shows a native macOS popup menu at a specific screen position.
+
+        This version auto-scrolls to show checked items, making it ideal for
+        preset browsers and lists where the current selection should be visible.
+
+        When a menu item has a checkmark (isTicked), the menu automatically
+        positions itself so that the checked item appears at the cursor location.
+
+        @param menu              The JUCE PopupMenu to display
+        @param screenPosition    Position in screen coordinates (JUCE style, top-left origin)
+        @param useSmallSize      If true, uses small menu font size (more compact)
+
+        @returns the selected menu item ID, or 0 if cancelled
+    */
+    static int showPopupMenuAt (const juce::PopupMenu& menu,
+                               juce::Point<int> screenPosition,
+                               bool useSmallSize = false);
+
+    //==============================================================================
+    /** Shows a native macOS popup menu at a fixed position without auto-scroll.
+
+        This version positions the menu at the exact location without centering
+        on checked items. Ideal for ComboBox-style dropdowns where you want the
+        menu to appear directly below or above a component.
+
+        Unlike showPopupMenuAt, this does NOT reposition the menu based on
+        which item is checked, giving you precise control over menu placement.
+
+        @param menu              The JUCE PopupMenu to display
+        @param screenPosition    Position in screen coordinates (JUCE style, top-left origin)
+        @param useSmallSize      If true, uses small menu font size (more compact)
+
+        @returns the selected menu item ID, or 0 if cancelled
+    */
+    static int showPopupMenuAtFixed (const juce::PopupMenu& menu,
+                                    juce::Point<int> screenPosition,
+                                    bool useSmallSize = false);
+
+    //==============================================================================
+    /** Replaces the backend used to show menus.
+
+        Passing nullptr restores the default backend.
+    */
+    static void setBackend (std::shared_ptr<NativeMacMenuBackend> newBackend);
+
+    /** Returns the backend currently in use, creating the default one if needed. */
+    static std::shared_ptr<NativeMacMenuBackend> getBackend();
+
+private:
+    NativeMacPopupMenu() = delete;
+    JUCE_DECLARE_NON_COPYABLE (NativeMacPopupMenu)
+};
+
+} // namespace juce
+
+//==============================================================================
+#include "clipboard/juce_NativeMacClipboardFetcher.h"
+#include "clipboard/juce_NativeMacClipboardWatcher.h"
+#include "clipboard/juce_NativeMacClipboardConverterRegistry.h"
@@ -1,500 +1,1259 @@
-/*******************************************************************************
- Native macOS Dialogs Module Implementation
-
- This file provides native macOS dialog and popup menu implementations
- using Cocoa/AppKit/Foundation frameworks.
-*******************************************************************************/
-
-#include "juce_native_macos_dialogs.h"
-
-#if JUCE_MAC
-
-// Handle Carbon type conflicts with JUCE
-// These types conflict between Carbon and JUCE, so we need to hide Carbon's versions
-#define Point CarbonDummyPointName
-#define Component CarbonDummyCompName
-
-#import <Foundation/Foundation.h>
-#import <Cocoa/Cocoa.h>
-#import <AppKit/AppKit.h>
-
-// Restore JUCE types after importing macOS headers
-#undef Point
-#undef Component
-
-namespace juce
-{
-
-//==============================================================================
-// NativeMacDialogs Implementation
-//==============================================================================
-
-bool NativeMacDialogs::showTextInputDialog (const juce::String& title,
-                                            const juce::String& message,
-                                            const juce::String& currentText,
-                                            int maxLength,
-                                            const juce::String& okButtonText,
-                                            const juce::String& cancelButtonText,
-                                            juce::String& outText)
-{
-    @autoreleasepool
-    {
-        NSAlert* alert = [[NSAlert alloc] init];
-        [alert setMessageText: [NSString stringWithUTF8String: title.toRawUTF8()]];
-        [alert setInformativeText: [NSString stringWithUTF8String: message.toRawUTF8()]];
-
-        // Create text input field
-        NSTextField* input = [[NSTextField alloc] initWithFrame: NSMakeRect(0, 0, 250, 24)];
-        [input setStringValue: [NSString stringWithUTF8String: currentText.toRawUTF8()]];
-
-        // Add character limit observer if specified
-        id observer = nil;
-        if (maxLength > 0)
-        {
-            observer = [[NSNotificationCenter defaultCenter]
-                addObserverForName: NSControlTextDidChangeNotification
-                object: input
-                queue: nil
-                usingBlock: ^(NSNotification* note)
-                {
-                    NSString* text = [input stringValue];
-                    if ([text length] > (NSUInteger)maxLength)
-                    {
-                        [input setStringValue: [text substringToIndex: maxLength]];
-                    }
-                }];
-        }
-
-        [alert setAccessoryView: input];
-        [alert addButtonWithTitle: [NSString stringWithUTF8String: okButtonText.toRawUTF8()]];
-        [alert addButtonWithTitle: [NSString stringWithUTF8String: cancelButtonText.toRawUTF8()]];
-
-        // Store original window to restore focus (important for plugins)
-        NSWindow* originalWindow = [[NSApplication sharedApplication] keyWindow];
-
-        // Select all text when dialog appears
-        dispatch_async(dispatch_get_main_queue(), ^{
-            [input setEditable: YES];
-            [input setSelectable: YES];
-            [[alert window] makeFirstResponder: input];
-            [input selectText: nil];
-        });
-
-        NSInteger result = [alert runModal];
-
-        // Clean up observer
-        if (observer != nil)
-        {
-            [[NSNotificationCenter defaultCenter] removeObserver: observer];
-        }
-
-        // Restore focus to original window (important for AU/VST plugins)
-        if (originalWindow && [originalWindow isVisible])
-        {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                [originalWindow makeKeyAndOrderFront: nil];
-                dispatch_after(dispatch_time(DISPATCH_TIME_NOW, 0.05 * NSEC_PER_SEC),
-                              dispatch_get_main_queue(), ^{
-                    [originalWindow makeKeyAndOrderFront: nil];
-                });
-            });
-        }
-
-        if (result == NSAlertFirstButtonReturn)
-        {
-            NSString* newText = [input stringValue];
-            outText = juce::String::fromUTF8([newText UTF8String]);
-            return true;
-        }
-
-        return false;
-    }
-}
-
-//==============================================================================
-void NativeMacDialogs::showInfoDialog (const juce::String& title,
-                                       const juce::String& message,
-                                       const juce::String& buttonText)
-{
-    @autoreleasepool
-    {
-        NSAlert* alert = [[NSAlert alloc] init];
-        [alert setMessageText: [NSString stringWithUTF8String: title.toRawUTF8()]];
-        [alert setInformativeText: [NSString stringWithUTF8String: message.toRawUTF8()]];
-        [alert setAlertStyle: NSAlertStyleInformational];
-        [alert addButtonWithTitle: [NSString stringWithUTF8String: buttonText.toRawUTF8()]];
-
-        // Store original window to restore focus
-        NSWindow* originalWindow = [[NSApplication sharedApplication] keyWindow];
-
-        [alert runModal];
-
-        // Restore focus to original window
-        if (originalWindow && [originalWindow isVisible])
-        {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                [originalWindow makeKeyAndOrderFront: nil];
-                dispatch_after(dispatch_time(DISPATCH_TIME_NOW, 0.05 * NSEC_PER_SEC),
-                              dispatch_get_main_queue(), ^{
-                    [originalWindow makeKeyAndOrderFront: nil];
-                });
-            });
-        }
-    }
-}
-
-//==============================================================================
-bool NativeMacDialogs::showConfirmDialog (const juce::String& title,
-                                          const juce::String& message,
-                                          const juce::String& button1Text,
-                                          const juce::String& button2Text)
-{
-    @autoreleasepool
-    {
-        NSAlert* alert = [[NSAlert alloc] init];
-        [alert setMessageText: [NSString stringWithUTF8String: title.toRawUTF8()]];
-        [alert setInformativeText: [NSString stringWithUTF8String: message.toRawUTF8()]];
-        [alert setAlertStyle: NSAlertStyleWarning];
-        [alert addButtonWithTitle: [NSString stringWithUTF8String: button1Text.toRawUTF8()]];
-        [alert addButtonWithTitle: [NSString stringWithUTF8String: button2Text.toRawUTF8()]];
-
-        // Store original window to restore focus
-        NSWindow* originalWindow = [[NSApplication sharedApplication] keyWindow];
-
-        NSInteger result = [alert runModal];
-
-        // Restore focus to original window
-        if (originalWindow && [originalWindow isVisible])
-        {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                [originalWindow makeKeyAndOrderFront: nil];
-                dispatch_after(dispatch_time(DISPATCH_TIME_NOW, 0.05 * NSEC_PER_SEC),
-                              dispatch_get_main_queue(), ^{
-                    [originalWindow makeKeyAndOrderFront: nil];
-                });
-            });
-        }
-
-        return (result == NSAlertFirstButtonReturn);
-    }
-}
-
-//==============================================================================
-// NativeMacPasteboard Implementation
-//==============================================================================
-
-#if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
-
-void NativeMacPasteboard::copyDataToClipboard (const void* data, size_t size,
-                                               const juce::String& typeUTI)
-{
-    @autoreleasepool
-    {
-        NSData* dataToCopy = [NSData dataWithBytes: data length: size];
-        NSString* pasteboardType = [NSString stringWithUTF8String: typeUTI.toRawUTF8()];
-
-        [[NSPasteboard generalPasteboard] declareTypes: @[pasteboardType] owner: nil];
-        [[NSPasteboard generalPasteboard] setData: dataToCopy forType: pasteboardType];
-    }
-}
-
-//==============================================================================
-bool NativeMacPasteboard::clipboardContainsDataType (const juce::String& typeUTI)
-{
-    @autoreleasepool
-    {
-        NSString* pasteboardType = [NSString stringWithUTF8String: typeUTI.toRawUTF8()];
-        return [[NSPasteboard generalPasteboard]
-                canReadItemWithDataConformingToTypes: @[pasteboardType]];
-    }
-}
-
-//==============================================================================
-bool NativeMacPasteboard::fetchDataFromClipboard (juce::MemoryBlock& memoryBlock,
-                                                  const juce::String& typeUTI)
-{
-    @autoreleasepool
-    {
-        NSString* pasteboardType = [NSString stringWithUTF8String: typeUTI.toRawUTF8()];
-        NSData* data = [[NSPasteboard generalPasteboard] dataForType: pasteboardType];
-
-        if (data != nil)
-        {
-            memoryBlock.replaceAll(data.bytes, data.length);
-            return true;
-        }
-
-        return false;
-    }
-}
-
-#endif // JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
-
-} // namespace juce (temporarily close for Objective-C declarations)
-
-//==============================================================================
-// NativeMacPopupMenu Implementation - Objective-C declarations at global scope
-//==============================================================================
-
-// Static variable to store the selected menu item ID
-static int gSelectedMenuItemID = 0;
-
-// Target object to handle menu item selection - MUST be at global/file scope
-// Renamed to NativeMacMenuItemTarget to avoid conflicts with JUCE's internal MenuItemTarget
-@interface NativeMacMenuItemTarget : NSObject
-- (void)menuItemSelected:(id)sender;
-@end
-
-@implementation NativeMacMenuItemTarget
-- (void)menuItemSelected:(id)sender
-{
-    NSMenuItem* item = (NSMenuItem*)sender;
-    gSelectedMenuItemID = (int)[item tag];
-}
-@end
-
-namespace juce
-{
-
-//==============================================================================
-// Helper function to recursively build NSMenu from JUCE PopupMenu
-// Returns the menu and optionally the checked item (via output parameter)
-static NSMenu* buildNSMenuFromJuceMenu (const juce::PopupMenu& juceMenu,
-                                       NativeMacMenuItemTarget* target,
-                                       NSMenuItem** outCheckedItem = nullptr,
-                                       const juce::String& menuTitle = juce::String(),
-                                       bool useSmallSize = false)
-{
-    @autoreleasepool
-    {
-        NSMenu* nsMenu = [[NSMenu alloc] initWithTitle: [NSString stringWithUTF8String: menuTitle.toRawUTF8()]];
-        [nsMenu setAutoenablesItems: NO];
-
-        // Set small menu font size if requested
-        if (useSmallSize)
-        {
-            NSFont* smallFont = [NSFont menuFontOfSize: [NSFont systemFontSizeForControlSize: NSControlSizeSmall]];
-            [nsMenu setFont: smallFont];
-        }
-
-        // Get menu iterator
-        juce::PopupMenu::MenuItemIterator iterator (juceMenu);
-
-        while (iterator.next())
-        {
-            const auto& item = iterator.getItem();
-
-            if (item.isSeparator)
-            {
-                [nsMenu addItem: [NSMenuItem separatorItem]];
-            }
-            else if (item.subMenu != nullptr)
-            {
-                // Create submenu recursively
-                // IMPORTANT: DON'T pass outCheckedItem to submenus
-                // We only want to track checked items at the top level, not in submenus
-                // This prevents crashes when trying to position submenu items in parent menu
-                NSMenu* subMenu = buildNSMenuFromJuceMenu (*item.subMenu, target, nullptr, item.text, useSmallSize);
-                NSMenuItem* subMenuItem = [[NSMenuItem alloc]
-                    initWithTitle: [NSString stringWithUTF8String: item.text.toRawUTF8()]
-                    action: nil
-                    keyEquivalent: @""];
-                [subMenuItem setSubmenu: subMenu];
-                [subMenuItem setEnabled: item.isEnabled];
-                [nsMenu addItem: subMenuItem];
-            }
-            else
-            {
-                // Regular menu item
-                NSString* title = [NSString stringWithUTF8String: item.text.toRawUTF8()];
-                NSMenuItem* nsItem = [[NSMenuItem alloc]
-                    initWithTitle: title
-                    action: @selector(menuItemSelected:)
-                    keyEquivalent: @""];
-
-                // Store the item ID in the tag and set the target
-                [nsItem setTag: item.itemID];
-                [nsItem setTarget: target];
-                [nsItem setEnabled: item.isEnabled];
-                [nsItem setState: item.isTicked ? NSControlStateValueOn : NSControlStateValueOff];
-
-                // If this item is checked and we haven't found a checked item yet, store it
-                if (item.isTicked && outCheckedItem != nullptr && *outCheckedItem == nullptr)
-                {
-                    *outCheckedItem = nsItem;
-                }
-
-                [nsMenu addItem: nsItem];
-            }
-        }
-
-        return nsMenu;
-    }
-}
-
-//==============================================================================
-int NativeMacPopupMenu::showPopupMenu (const juce::PopupMenu& menu,
-                                      juce::Component* parentComponent,
-                                      bool useSmallSize,
-                                      bool centerOnCheckedItem)
-{
-    @autoreleasepool
-    {
-        // Reset the selected item ID
-        gSelectedMenuItemID = 0;
-
-        // Create target object
-        NativeMacMenuItemTarget* target = [[NativeMacMenuItemTarget alloc] init];
-
-        // Get current mouse location in screen coordinates
-        NSPoint mouseLocation = [NSEvent mouseLocation];
-
-        // Convert to view coordinates if we have a parent component
-        NSView* view = nullptr;
-        if (parentComponent != nullptr)
-        {
-            view = (NSView*) parentComponent->getWindowHandle();
-        }
-
-        // Build the native menu and optionally get the checked item
-        NSMenuItem* checkedItem = nullptr;
-        NSMenu* nsMenu = buildNSMenuFromJuceMenu (menu, target,
-                                                  centerOnCheckedItem ? &checkedItem : nullptr,
-                                                  juce::String(), useSmallSize);
-
-        // Get or create an event for the menu
-        NSEvent* currentEvent = [NSApp currentEvent];
-        if (currentEvent == nil)
-        {
-            currentEvent = [NSEvent mouseEventWithType: NSEventTypeLeftMouseDown
-                                              location: mouseLocation
-                                         modifierFlags: 0
-                                             timestamp: [[NSProcessInfo processInfo] systemUptime]
-                                          windowNumber: 0
-                                               context: nil
-                                           eventNumber: 0
-                                            clickCount: 1
-                                              pressure: 1.0];
-        }
-
-        // Show the menu
-        // Use view if available, otherwise use popUpMenuPositioningItem for positioning
-        if (view != nullptr)
-        {
-            [NSMenu popUpContextMenu: nsMenu withEvent: currentEvent forView: view];
-        }
-        else
-        {
-            // When no view is available, use the positioning method
-            // If centerOnCheckedItem is true, pass checkedItem to center on it
-            // Otherwise pass nil to show menu at exact mouse position
-            [nsMenu popUpMenuPositioningItem: (centerOnCheckedItem ? checkedItem : nil)
-                                  atLocation: mouseLocation
-                                      inView: nil];
-        }
-
-        int result = gSelectedMenuItemID;
-
-        // Clean up
-        [nsMenu release];
-        [target release];
-
-        return result;
-    }
-}
-
-//==============================================================================
-int NativeMacPopupMenu::showPopupMenuAt (const juce::PopupMenu& menu,
-                                        juce::Point<int> screenPosition,
-                                        bool useSmallSize)
-{
-    @autoreleasepool
-    {
-        // Reset the selected item ID
-        gSelectedMenuItemID = 0;
-
-        // Create target object
-        NativeMacMenuItemTarget* target = [[NativeMacMenuItemTarget alloc] init];
-
-        // Build the native menu and get the checked item if any
-        NSMenuItem* checkedItem = nullptr;
-        NSMenu* nsMenu = buildNSMenuFromJuceMenu (menu, target, &checkedItem, juce::String(), useSmallSize);
-
-        // Convert JUCE screen coordinates (top-left origin) to NSPoint (bottom-left origin)
-        NSScreen* mainScreen = [NSScreen mainScreen];
-        NSRect screenFrame = [mainScreen frame];
-
-        // JUCE uses top-left origin, macOS uses bottom-left origin
-        CGFloat yPos = screenFrame.size.height - (CGFloat) screenPosition.getY();
-
-        // When positioning a specific item, macOS centers it at the given Y coordinate
-        // Add a small offset (~10px, approximately half a menu item height) for proper alignment
-        if (checkedItem != nullptr)
-        {
-            yPos += 10.0;
-        }
-
-        NSPoint nsPosition = NSMakePoint ((CGFloat) screenPosition.getX(), yPos);
-
-        // Use popUpMenuPositioningItem:atLocation:inView: for proper positioning
-        // If we have a checked item, position it at the cursor so the menu scrolls to show it
-        // Otherwise, position the menu with its top at the cursor
-        [nsMenu popUpMenuPositioningItem: checkedItem
-                              atLocation: nsPosition
-                                  inView: nil];
-
-        int result = gSelectedMenuItemID;
-
-        // Clean up
-        [nsMenu release];
-        [target release];
-
-        return result;
-    }
-}
-
-//==============================================================================
-int NativeMacPopupMenu::showPopupMenuAtFixed (const juce::PopupMenu& menu,
-                                              juce::Point<int> screenPosition,
-                                              bool useSmallSize)
-{
-    @autoreleasepool
-    {
-        // Reset the selected item ID
-        gSelectedMenuItemID = 0;
-
-        // Create target object
-        NativeMacMenuItemTarget* target = [[NativeMacMenuItemTarget alloc] init];
-
-        // Build the native menu without tracking checked items
-        // This ensures the menu appears at the exact position without centering
-        NSMenu* nsMenu = buildNSMenuFromJuceMenu (menu, target, nullptr, juce::String(), useSmallSize);
-
-        // Convert JUCE screen coordinates (top-left origin) to NSPoint (bottom-left origin)
-        NSScreen* mainScreen = [NSScreen mainScreen];
-        NSRect screenFrame = [mainScreen frame];
-
-        // JUCE uses top-left origin, macOS uses bottom-left origin
-        CGFloat yPos = screenFrame.size.height - (CGFloat) screenPosition.getY();
-
-        NSPoint nsPosition = NSMakePoint ((CGFloat) screenPosition.getX(), yPos);
-
-        // Use popUpMenuPositioningItem with nil to position the menu at the exact location
-        // without centering on any checked item. Perfect for ComboBox-style dropdowns.
-        [nsMenu popUpMenuPositioningItem: nil
-                              atLocation: nsPosition
-                                  inView: nil];
-
-        int result = gSelectedMenuItemID;
-
-        // Clean up
-        [nsMenu release];
-        [target release];
-
-        return result;
-    }
-}
-
-} // namespace juce
-
-#endif // JUCE_MAC
+/*******************************************************************************
+ Native macOS Dialogs Module Implementation
+
+ This file provides native macOS dialog and popup menu implementations
+ using Cocoa/AppKit/Foundation frameworks.
+*******************************************************************************/
+
+#include "juce_native_macos_dialogs.cpp"
+
+#if JUCE_MAC
+
+// Handle Carbon type conflicts with JUCE
+// These types conflict between Carbon and JUCE, so we need to hide Carbon's versions
+#define Point CarbonDummyPointName
+#define Component CarbonDummyCompName
+
+#import <Foundation/Foundation.h>
+#import <Cocoa/Cocoa.h>
+#import <AppKit/AppKit.h>
+#import <objc/runtime.h>
+
+// Restore JUCE types after importing macOS headers
+#undef Point
+#undef Component
+
+#if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+//==============================================================================
+// NativeMacPasteboard Implementation - Objective-C declarations at global scope
+//==============================================================================
+
+// Owner of promised pasteboard types - AppKit asks it for the data of a type
+// only when some reader actually wants that type. MUST be at global/file scope
+@interface NativeMacPasteboardPromiseProvider : NSObject
+{
+    juce::NativeMacPasteboardBackend::DataProvider provider;
+}
+- (void)setProvider:(const juce::NativeMacPasteboardBackend::DataProvider&)newProvider;
+- (void)pasteboard:(NSPasteboard*)sender provideDataForType:(NSPasteboardType)type;
+- (void)pasteboardChangedOwner:(NSPasteboard*)sender;
+@end
+
+@implementation NativeMacPasteboardPromiseProvider
+- (void)setProvider:(const juce::NativeMacPasteboardBackend::DataProvider&)newProvider
+{
+    provider = newProvider;
+}
+
+- (void)pasteboard:(NSPasteboard*)sender provideDataForType:(NSPasteboardType)type
+{
+    juce::MemoryBlock block;
+
+    if (provider != nullptr && provider (juce::String::fromUTF8 ([type UTF8String]), block))
+        [sender setData: [NSData dataWithBytes: block.getData() length: block.getSize()] forType: type];
+}
+
+- (void)pasteboardChangedOwner:(NSPasteboard*)sender
+{
+    juce::ignoreUnused (sender);
+    provider = nullptr;   // our promises are gone, so release whatever they captured
+}
+@end
+
+#endif // JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+//==============================================================================
+// Text field delegate offering completions from a NativeMacCompletionIndex.
+// MUST be at global/file scope
+@interface NativeMacTextCompletionDelegate : NSObject <NSTextFieldDelegate>
+{
+    std::shared_ptr<const juce::NativeMacCompletionIndex> completions;
+    int maxCompletions;
+    juce::StringArray results;   // reused between keystrokes
+}
+- (void)setCompletions:(std::shared_ptr<const juce::NativeMacCompletionIndex>)newCompletions maxResults:(int)maxResults;
+- (BOOL)hasCompletions;
+@end
+
+@implementation NativeMacTextCompletionDelegate
+- (void)setCompletions:(std::shared_ptr<const juce::NativeMacCompletionIndex>)newCompletions maxResults:(int)maxResults
+{
+    completions = std::move (newCompletions);
+    maxCompletions = maxResults;
+}
+
+- (BOOL)hasCompletions
+{
+    return completions != nullptr;
+}
+
+- (NSArray<NSString*>*)control:(NSControl*)control
+                      textView:(NSTextView*)textView
+                   completions:(NSArray<NSString*>*)words
+           forPartialWordRange:(NSRange)charRange
+           indexOfSelectedItem:(NSInteger*)index
+{
+    juce::ignoreUnused (control, words);
+    *index = -1;   // offer, but don't insert anything until one is picked
+
+    if (completions == nullptr)
+        return @[];
+
+    // The whole text up to the cursor is the prefix, not just the word being typed
+    NSString* typed = [[textView string] substringToIndex: NSMaxRange (charRange)];
+    completions->getCompletions (juce::String::fromUTF8 ([typed UTF8String]), maxCompletions, results);
+
+    // AppKit replaces only the partial word, so drop everything before it
+    NSMutableArray<NSString*>* offered = [NSMutableArray arrayWithCapacity: (NSUInteger) results.size()];
+
+    for (auto& name : results)
+    {
+        NSString* completion = [NSString stringWithUTF8String: name.toRawUTF8()];
+
+        if ([completion length] >= charRange.location)
+            [offered addObject: [completion substringFromIndex: charRange.location]];
+    }
+
+    return offered;
+}
+@end
+
+//==============================================================================
+// Text field formatter enforcing a NativeMacTextLimiter. AppKit asks it about every
+// edit before applying it, with the selection before and after, which is enough to
+// know exactly what was replaced without comparing the whole strings.
+// MUST be at global/file scope
+@interface NativeMacTextLimitFormatter : NSFormatter
+{
+    juce::NativeMacTextLimiter* limiter;
+}
+- (void)setLimiter:(juce::NativeMacTextLimiter*)newLimiter;
+@end
+
+@implementation NativeMacTextLimitFormatter
+- (void)setLimiter:(juce::NativeMacTextLimiter*)newLimiter
+{
+    limiter = newLimiter;
+}
+
+- (NSString*)stringForObjectValue:(id)object
+{
+    return [object isKindOfClass: [NSString class]] ? (NSString*) object : @"";
+}
+
+- (BOOL)getObjectValue:(id*)object forString:(NSString*)string errorDescription:(NSString**)error
+{
+    juce::ignoreUnused (error);
+    *object = string;
+    return YES;
+}
+
+- (BOOL)isPartialStringValid:(NSString**)partialString
+       proposedSelectedRange:(NSRangePointer)proposedSelection
+              originalString:(NSString*)originalString
+       originalSelectedRange:(NSRange)originalSelection
+            errorDescription:(NSString**)error
+{
+    juce::ignoreUnused (error);
+
+    if (limiter == nullptr)
+        return YES;
+
+    NSString* proposed = *partialString;
+    const auto oldLength = (size_t) [originalString length];
+    const auto newLength = (size_t) [proposed length];
+
+    // The edit replaced the text from the start of the earlier selection up to where the
+    // new selection ends (the caret after typing or pasting, the selection after an undo)
+    const auto start = (size_t) juce::jmin (originalSelection.location, proposedSelection->location);
+    const auto insertedEnd = (size_t) NSMaxRange (*proposedSelection);
+    const auto numInserted = insertedEnd >= start ? insertedEnd - start : 0;
+    const auto numKeptAfter = newLength - numInserted;
+
+    if (limiter->getNumUTF16Units() != oldLength || insertedEnd < start || insertedEnd > newLength
+         || numKeptAfter > oldLength || numKeptAfter < start)
+    {
+        // Not a single replacement we can follow, so start again from the whole text
+        const auto limited = juce::NativeMacTextLimiter::truncate (juce::String::fromUTF8 ([proposed UTF8String]),
+                                                                   limiter->getMaxLength(), limiter->getUnit());
+        limiter->setText (limited);
+
+        if ((size_t) [proposed length] == limiter->getNumUTF16Units())
+            return YES;
+
+        *partialString = [NSString stringWithUTF8String: limited.toRawUTF8()];
+        *proposedSelection = NSMakeRange ([*partialString length], 0);
+        return NO;
+    }
+
+    const auto numRemoved = oldLength - numKeptAfter;
+
+    std::vector<unichar> inserted (numInserted);
+    [proposed getCharacters: inserted.data() range: NSMakeRange (start, numInserted)];
+
+    const auto numKept = limiter->applyEdit (start, numRemoved, inserted.data(), numInserted);
+
+    if (numKept == numInserted)
+        return YES;
+
+    // Only some of the inserted text fits
+    NSMutableString* clipped = [[originalString mutableCopy] autorelease];
+    [clipped replaceCharactersInRange: NSMakeRange (start, numRemoved)
+                           withString: [proposed substringWithRange: NSMakeRange (start, numKept)]];
+
+    *partialString = clipped;
+    *proposedSelection = NSMakeRange (start + numKept, 0);
+    return NO;
+}
+@end
+
+//==============================================================================
+// Action target for the cancel button of a progress window.
+// MUST be at global/file scope
+@interface NativeMacProgressCancelTarget : NSObject
+{
+    std::function<void()> onCancel;
+}
+- (void)setCallback:(std::function<void()>)callback;
+- (void)cancelClicked:(id)sender;
+@end
+
+@implementation NativeMacProgressCancelTarget
+- (void)setCallback:(std::function<void()>)callback
+{
+    onCancel = std::move (callback);
+}
+
+- (void)cancelClicked:(id)sender
+{
+    // One click is enough; the window stays up until the task notices and finishes
+    [(NSButton*) sender setEnabled: NO];
+
+    if (onCancel != nullptr)
+        onCancel();
+}
+@end
+
+namespace juce
+{
+
+// Reports an object the module creates to NativeMacAllocationStats
+static void countNativeObject (id object) noexcept
+{
+   #if JUCE_NATIVE_MACOS_ENABLE_ALLOCATION_COUNTING
+    if (object != nil)
+        NativeMacAllocationStats::noteNativeObject (class_getInstanceSize (object_getClass (object)));
+   #else
+    ignoreUnused (object);
+   #endif
+}
+
+//==============================================================================
+// NativeMacDialogs Implementation
+//==============================================================================
+
+// Focus target for the window that was key before a dialog, and the dialog's own window
+class NSWindowFocusTarget  : public NativeMacFocusRestorer::Target
+{
+public:
+    NSWindowFocusTarget (NSWindow* windowToRestore, NSWindow* dialog)
+        : originalWindow ([windowToRestore retain]),
+          dialogWindow ([dialog retain])
+    {
+    }
+
+    ~NSWindowFocusTarget() override
+    {
+        if (becameKeyObserver != nil)
+            [[NSNotificationCenter defaultCenter] removeObserver: becameKeyObserver];
+
+        if (resignedKeyObserver != nil)
+            [[NSNotificationCenter defaultCenter] removeObserver: resignedKeyObserver];
+
+        [dialogWindow release];
+        [originalWindow release];
+    }
+
+    bool isDialogClosed() override   { return dialogWindow == nil || ! [dialogWindow isVisible]; }
+    bool isAvailable() override      { return [originalWindow isVisible]; }
+    bool hasFocus() override         { return [originalWindow isKeyWindow]; }
+    void requestFocus() override     { [originalWindow makeKeyAndOrderFront: nil]; }
+
+    void setFocusChangeCallback (std::function<void()> callback) override
+    {
+        onFocusChange = std::move (callback);
+
+        if (becameKeyObserver != nil)
+            return;
+
+        // The observers are removed in the destructor, so the raw pointer never dangles
+        auto* owner = this;
+        void (^handler)(NSNotification*) = ^(NSNotification*)
+        {
+            if (owner->onFocusChange != nullptr)
+                owner->onFocusChange();
+        };
+
+        NSNotificationCenter* center = [NSNotificationCenter defaultCenter];
+        becameKeyObserver = [center addObserverForName: NSWindowDidBecomeKeyNotification
+                                                object: originalWindow
+                                                 queue: nil
+                                            usingBlock: handler];
+        resignedKeyObserver = [center addObserverForName: NSWindowDidResignKeyNotification
+                                                  object: originalWindow
+                                                   queue: nil
+                                              usingBlock: handler];
+    }
+
+private:
+    NSWindow* originalWindow;
+    NSWindow* dialogWindow;
+    id becameKeyObserver = nil;
+    id resignedKeyObserver = nil;
+    std::function<void()> onFocusChange;
+};
+
+// Hands focus back to the window that was key before the dialog (important for AU/VST
+// plugins, whose hosts tend to re-activate their own windows when a dialog closes)
+static void restoreFocusAfterDialog (NSWindow* originalWindow, NSWindow* dialogWindow)
+{
+    if (originalWindow != nil && [originalWindow isVisible])
+        NativeMacFocusRestorer::getShared().restore (std::make_unique<NSWindowFocusTarget> (originalWindow, dialogWindow));
+}
+
+//==============================================================================
+// Backend building NSAlerts; each alert is built once and can be run many times
+class NSAlertDialogBackend  : public NativeMacDialogBackend
+{
+public:
+    std::unique_ptr<Alert> createAlert (AlertStyle style, const AlertContent& content) override
+    {
+        return std::make_unique<NSAlertInstance> (style, content);
+    }
+
+    std::unique_ptr<ProgressWindow> createProgressWindow (const juce::String& title,
+                                                          const juce::String& cancelButtonText,
+                                                          std::function<void()> onCancel) override
+    {
+        return std::make_unique<NSProgressWindow> (title, cancelButtonText, std::move (onCancel));
+    }
+
+private:
+    //==============================================================================
+    // A small floating panel with a status line, a progress bar and an optional cancel
+    // button. It isn't modal, so the app stays usable while the task runs
+    class NSProgressWindow  : public ProgressWindow
+    {
+    public:
+        NSProgressWindow (const juce::String& title, const juce::String& cancelButtonText, std::function<void()> onCancel)
+        {
+            @autoreleasepool
+            {
+                originalWindow = [[[NSApplication sharedApplication] keyWindow] retain];
+
+                const auto hasCancel = cancelButtonText.isNotEmpty();
+                const CGFloat width = 360, margin = 20, buttonHeight = 32;
+                const CGFloat height = hasCancel ? 108 + buttonHeight : 108;
+
+                panel = [[NSPanel alloc] initWithContentRect: NSMakeRect (0, 0, width, height)
+                                                   styleMask: NSWindowStyleMaskTitled
+                                                     backing: NSBackingStoreBuffered
+                                                       defer: NO];
+                countNativeObject (panel);
+                [panel setReleasedWhenClosed: NO];
+                [panel setHidesOnDeactivate: NO];
+                [panel setLevel: NSFloatingWindowLevel];
+                [panel setTitle: [NSString stringWithUTF8String: title.toRawUTF8()]];
+
+                NSView* content = [panel contentView];
+
+                statusLabel = [[NSTextField alloc] initWithFrame: NSMakeRect (margin, height - 44, width - 2 * margin, 18)];
+                countNativeObject (statusLabel);
+                [statusLabel setBezeled: NO];
+                [statusLabel setDrawsBackground: NO];
+                [statusLabel setEditable: NO];
+                [statusLabel setSelectable: NO];
+                [[statusLabel cell] setLineBreakMode: NSLineBreakByTruncatingMiddle];
+                [statusLabel setStringValue: @""];
+                [content addSubview: statusLabel];
+
+                indicator = [[NSProgressIndicator alloc] initWithFrame: NSMakeRect (margin, height - 76, width - 2 * margin, 20)];
+                countNativeObject (indicator);
+                [indicator setStyle: NSProgressIndicatorStyleBar];
+                [indicator setMinValue: 0.0];
+                [indicator setMaxValue: 1.0];
+                [indicator setIndeterminate: YES];
+                [indicator startAnimation: nil];
+                [content addSubview: indicator];
+
+                if (hasCancel)
+                {
+                    cancelTarget = [[NativeMacProgressCancelTarget alloc] init];
+                    countNativeObject (cancelTarget);
+                    [cancelTarget setCallback: std::move (onCancel)];
+
+                    cancelButton = [[NSButton alloc] initWithFrame: NSMakeRect (width - margin - 96, margin - 6, 96, buttonHeight)];
+                    countNativeObject (cancelButton);
+                    [cancelButton setBezelStyle: NSBezelStyleRounded];
+                    [cancelButton setTitle: [NSString stringWithUTF8String: cancelButtonText.toRawUTF8()]];
+                    [cancelButton setKeyEquivalent: @"\033"];
+                    [cancelButton setTarget: cancelTarget];
+                    [cancelButton setAction: @selector (cancelClicked:)];
+                    [content addSubview: cancelButton];
+                }
+
+                [panel center];
+                [panel makeKeyAndOrderFront: nil];
+            }
+        }
+
+        ~NSProgressWindow() override
+        {
+            @autoreleasepool
+            {
+                [indicator stopAnimation: nil];
+                [panel orderOut: nil];
+
+                // Restore focus to original window (important for AU/VST plugins)
+                restoreFocusAfterDialog (originalWindow, panel);
+
+                [cancelButton setTarget: nil];
+                [cancelButton release];
+                [cancelTarget release];
+                [indicator release];
+                [statusLabel release];
+                [panel release];
+                [originalWindow release];
+            }
+        }
+
+        void update (double fraction, const juce::String* newStatus) override
+        {
+            @autoreleasepool
+            {
+                const BOOL indeterminate = fraction < 0 ? YES : NO;
+
+                if ([indicator isIndeterminate] != indeterminate)
+                {
+                    [indicator setIndeterminate: indeterminate];
+
+                    if (indeterminate)
+                        [indicator startAnimation: nil];
+                    else
+                        [indicator stopAnimation: nil];
+                }
+
+                if (! indeterminate)
+                    [indicator setDoubleValue: fraction];
+
+                if (newStatus != nullptr)
+                    [statusLabel setStringValue: [NSString stringWithUTF8String: newStatus->toRawUTF8()]];
+            }
+        }
+
+    private:
+        NSWindow* originalWindow = nil;
+        NSPanel* panel = nil;
+        NSTextField* statusLabel = nil;
+        NSProgressIndicator* indicator = nil;
+        NSButton* cancelButton = nil;
+        NativeMacProgressCancelTarget* cancelTarget = nil;
+    };
+
+    //==============================================================================
+    // A text field with its length limit, validator and completions, and a label for
+    // validation messages. Used for the field of a text input dialog and for each text
+    // field of a form
+    class TextInputField
+    {
+    public:
+        explicit TextInputField (std::function<void()> onValidityChanged)
+            : validityChanged (std::move (onValidityChanged))
+        {
+            input = [[NSTextField alloc] initWithFrame: NSMakeRect(0, 0, 250, 24)];
+            countNativeObject (input);
+
+            messageLabel = [[NSTextField alloc] initWithFrame: NSMakeRect(0, 0, 250, 16)];
+            countNativeObject (messageLabel);
+            [messageLabel setBezeled: NO];
+            [messageLabel setDrawsBackground: NO];
+            [messageLabel setEditable: NO];
+            [messageLabel setSelectable: NO];
+            [messageLabel setFont: [NSFont systemFontOfSize: [NSFont smallSystemFontSize]]];
+            [messageLabel setTextColor: [NSColor systemRedColor]];
+            [messageLabel setHidden: YES];
+
+            completionDelegate = [[NativeMacTextCompletionDelegate alloc] init];
+            countNativeObject (completionDelegate);
+            [input setDelegate: completionDelegate];
+
+            limitFormatter = [[NativeMacTextLimitFormatter alloc] init];
+            countNativeObject (limitFormatter);
+            [input setFormatter: limitFormatter];
+
+            // Validation and completion observer; the length limit is enforced by the formatter,
+            // before an edit is applied
+            auto* owner = this;
+            textObserver = [[NSNotificationCenter defaultCenter]
+                addObserverForName: NSControlTextDidChangeNotification
+                object: input
+                queue: nil
+                usingBlock: ^(NSNotification* note)
+                {
+                    owner->validateText();
+                    owner->offerCompletions ([[note userInfo] objectForKey: @"NSFieldEditor"]);
+                }];
+        }
+
+        ~TextInputField()
+        {
+            [[NSNotificationCenter defaultCenter] removeObserver: textObserver];
+
+            [input setDelegate: nil];
+            [input setFormatter: nil];
+            [limitFormatter release];
+            [completionDelegate release];
+            [messageLabel release];
+            [input release];
+        }
+
+        void setContent (const juce::String& text, int maxLength, const NativeMacTextInputOptions& options)
+        {
+            setLengthLimit (text, maxLength, options.lengthUnit);
+
+            validator = options.validator;
+
+            if (validator != nullptr)
+                validator->reset();
+
+            validateText();
+
+            [completionDelegate setCompletions: options.completions maxResults: options.maxCompletions];
+            previousLength = [[input stringValue] length];
+        }
+
+        // The validator is only valid for the duration of a run
+        void runFinished()                      { validator = nullptr; }
+
+        bool isValid() const noexcept           { return valid; }
+        bool hasValidator() const noexcept      { return validator != nullptr; }
+        juce::String getText() const            { return juce::String::fromUTF8 ([[input stringValue] UTF8String]); }
+
+        NSTextField* getInput() const noexcept          { return input; }
+        NSTextField* getMessageLabel() const noexcept   { return messageLabel; }
+
+    private:
+        void setLengthLimit (const juce::String& text, int maxLength, NativeMacTextLimiter::Unit unit)
+        {
+            auto initialText = text;
+
+            if (maxLength > 0)
+            {
+                initialText = NativeMacTextLimiter::truncate (initialText, maxLength, unit);
+
+                limiter = std::make_unique<NativeMacTextLimiter> (unit, maxLength);
+                limiter->setText (initialText);
+            }
+            else
+            {
+                limiter.reset();
+            }
+
+            [limitFormatter setLimiter: limiter.get()];
+            [input setStringValue: [NSString stringWithUTF8String: initialText.toRawUTF8()]];
+        }
+
+        void validateText()
+        {
+            if (validator == nullptr)
+            {
+                valid = true;
+                [messageLabel setHidden: YES];
+            }
+            else
+            {
+                const auto result = validator->validate (getText());
+
+                valid = result.wasOk();
+                [messageLabel setStringValue: [NSString stringWithUTF8String: result.getErrorMessage().toRawUTF8()]];
+                [messageLabel setHidden: valid];
+            }
+
+            if (validityChanged != nullptr)
+                validityChanged();
+        }
+
+        // Opens the completion list after text was typed, but not after deleting, so that
+        // backspace isn't fought by the list reappearing
+        void offerCompletions (NSTextView* fieldEditor)
+        {
+            const auto length = [[input stringValue] length];
+            const bool grew = length > previousLength;
+            previousLength = length;
+
+            if (! grew || isCompleting || fieldEditor == nil || ! [completionDelegate hasCompletions])
+                return;
+
+            const juce::ScopedValueSetter<bool> svs (isCompleting, true);   // complete: edits the text too
+            [fieldEditor complete: nil];
+        }
+
+        std::function<void()> validityChanged;
+        NSTextField* input = nil;
+        NSTextField* messageLabel = nil;
+        NativeMacTextCompletionDelegate* completionDelegate = nil;
+        NativeMacTextLimitFormatter* limitFormatter = nil;
+        id textObserver = nil;
+        std::unique_ptr<NativeMacTextLimiter> limiter;
+        NativeMacTextValidator* validator = nullptr;
+        NSUInteger previousLength = 0;
+        bool isCompleting = false;
+        bool valid = true;
+
+        JUCE_DECLARE_NON_COPYABLE (TextInputField)
+    };
+
+    //==============================================================================
+    class NSAlertInstance  : public Alert
+    {
+    public:
+        NSAlertInstance (AlertStyle style, const AlertContent& content)
+            : numButtons (content.buttons.size()),
+              form (content.form)
+        {
+            JUCE_NATIVE_MACOS_TRACE ("dialogs", "buildAlert");
+
+            @autoreleasepool
+            {
+                alert = [[NSAlert alloc] init];
+                countNativeObject (alert);
+                [alert setAlertStyle: style == AlertStyle::informational ? NSAlertStyleInformational
+                                                                          : NSAlertStyleWarning];
+
+                for (auto& buttonText : content.buttons)
+                    [alert addButtonWithTitle: [NSString stringWithUTF8String: buttonText.toRawUTF8()]];
+
+                if (form != nullptr)
+                {
+                    buildForm();
+                }
+                else if (content.hasTextField)
+                {
+                    // Create text input field, with a label under it for validation messages
+                    accessory = [[NSView alloc] initWithFrame: NSMakeRect(0, 0, 250, 24)];
+                    countNativeObject (accessory);
+                    addTextField();
+                    [accessory addSubview: textFields[0]->getInput()];
+                    [accessory addSubview: textFields[0]->getMessageLabel()];
+                }
+
+                if (accessory != nil)
+                    [alert setAccessoryView: accessory];
+
+                if (content.suppressionText.isNotEmpty())
+                    [alert setShowsSuppressionButton: YES];
+
+                setContent (content);
+            }
+        }
+
+        ~NSAlertInstance() override
+        {
+            textFields.clear();
+
+            for (auto* control : controls)
+                [control release];
+
+            [accessory release];
+            [alert release];
+        }
+
+        void setContent (const AlertContent& content) override
+        {
+            jassert (content.form == form);   // the fields are fixed when the alert is created
+
+            JUCE_NATIVE_MACOS_TRACE ("dialogs", "setAlertContent");
+
+            @autoreleasepool
+            {
+                [alert setMessageText: [NSString stringWithUTF8String: content.title.toRawUTF8()]];
+                [alert setInformativeText: [NSString stringWithUTF8String: content.message.toRawUTF8()]];
+
+                NSArray* buttons = [alert buttons];
+
+                for (int i = 0; i < jmin (numButtons, content.buttons.size()); ++i)
+                    [[buttons objectAtIndex: (NSUInteger) i] setTitle: [NSString stringWithUTF8String: content.buttons[i].toRawUTF8()]];
+
+                if ([alert showsSuppressionButton])
+                    [[alert suppressionButton] setTitle: [NSString stringWithUTF8String: content.suppressionText.toRawUTF8()]];
+
+                if (form != nullptr)
+                {
+                    showFormValues();
+                }
+                else if (! textFields.empty())
+                {
+                    auto& field = *textFields[0];
+                    field.setContent (content.text, content.maxLength, content.textInput);
+
+                    // The message label only takes up space when there is something to validate
+                    const CGFloat labelHeight = field.hasValidator() ? 18 : 0;
+                    [accessory setFrameSize: NSMakeSize (250, 24 + labelHeight)];
+                    [field.getInput() setFrameOrigin: NSMakePoint (0, labelHeight)];
+                }
+
+                // Builds the window now rather than when the alert is run
+                [alert layout];
+            }
+        }
+
+        int runModal (std::function<void()> onOpened) override
+        {
+            @autoreleasepool
+            {
+                // Store original window to restore focus (important for plugins)
+                NSWindow* originalWindow = [[NSApplication sharedApplication] keyWindow];
+
+                // Cleared after the run, in case the block below only executes once the caller has gone
+                auto openedCallback = std::make_shared<std::function<void()>> (std::move (onOpened));
+                NSAlert* runningAlert = alert;
+                NSTextField* textField = textFields.empty() ? nil : textFields[0]->getInput();
+
+                // Runs inside the modal session, once the alert is on screen
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    if (textField != nil)
+                    {
+                        // Select all text when dialog appears
+                        [textField setEditable: YES];
+                        [textField setSelectable: YES];
+                        [[runningAlert window] makeFirstResponder: textField];
+                        [textField selectText: nil];
+                    }
+
+                    if (*openedCallback != nullptr)
+                        (*openedCallback)();
+                });
+
+                if ([alert showsSuppressionButton])
+                    [[alert suppressionButton] setState: NSControlStateValueOff];
+
+                NSInteger result;
+
+                {
+                    JUCE_NATIVE_MACOS_TRACE ("dialogs", "alertModalLoop");
+                    result = [alert runModal];
+                }
+
+                *openedCallback = nullptr;
+
+                suppressionChecked = [alert showsSuppressionButton]
+                                      && [[alert suppressionButton] state] == NSControlStateValueOn;
+
+                const auto index = (int) (result - NSAlertFirstButtonReturn);
+
+                if (form != nullptr && index == 0)
+                    storeFormValues();
+                else if (form == nullptr && ! textFields.empty())
+                    text = textFields[0]->getText();
+
+                for (auto& field : textFields)
+                    field->runFinished();
+
+                // Restore focus to original window (important for AU/VST plugins)
+                restoreFocusAfterDialog (originalWindow, [alert window]);
+
+                return isPositiveAndBelow (index, numButtons) ? index : -1;
+            }
+        }
+
+        juce::String getText() const override
+        {
+            return text;
+        }
+
+        bool isSuppressionChecked() const override
+        {
+            return suppressionChecked;
+        }
+
+    private:
+        TextInputField& addTextField()
+        {
+            textFields.push_back (std::make_unique<TextInputField> ([this] { updateOkButton(); }));
+            return *textFields.back();
+        }
+
+        void updateOkButton()
+        {
+            bool allValid = true;
+
+            for (auto& field : textFields)
+                allValid = allValid && field->isValid();
+
+            [[[alert buttons] objectAtIndex: 0] setEnabled: allValid];
+        }
+
+        //==============================================================================
+        // Builds one control per field, placed by a NativeMacFormLayout that measures
+        // the labels with the system font
+        void buildForm()
+        {
+            NSDictionary* labelAttributes = @{ NSFontAttributeName: [NSFont systemFontOfSize: 0] };
+
+            const NativeMacFormLayout layout (*form, NativeMacFormLayout::Metrics(), [labelAttributes] (const juce::String& label)
+            {
+                return (float) [[NSString stringWithUTF8String: label.toRawUTF8()] sizeWithAttributes: labelAttributes].width;
+            });
+
+            const auto viewHeight = (CGFloat) layout.getHeight();
+            accessory = [[NSView alloc] initWithFrame: NSMakeRect (0, 0, (CGFloat) layout.getWidth(), viewHeight)];
+            countNativeObject (accessory);
+
+            // The layout is top-down, AppKit views are bottom-up
+            const auto toFrame = [viewHeight] (juce::Rectangle<float> r)
+            {
+                return NSMakeRect ((CGFloat) r.getX(), viewHeight - (CGFloat) r.getBottom(),
+                                   (CGFloat) r.getWidth(), (CGFloat) r.getHeight());
+            };
+
+            formControls.reserve ((size_t) form->getNumFields());
+
+            for (int i = 0; i < form->getNumFields(); ++i)
+            {
+                auto& field = form->getField (i);
+                auto& row = layout.getRow (i);
+                NSString* title = [NSString stringWithUTF8String: field.label.toRawUTF8()];
+
+                if (! row.label.isEmpty())
+                {
+                    NSTextField* label = [[NSTextField alloc] initWithFrame: toFrame (row.label)];
+                    countNativeObject (label);
+                    [label setBezeled: NO];
+                    [label setDrawsBackground: NO];
+                    [label setEditable: NO];
+                    [label setSelectable: NO];
+                    [label setAlignment: NSTextAlignmentRight];
+                    [[label cell] setLineBreakMode: NSLineBreakByTruncatingTail];
+                    [label setStringValue: title];
+                    [accessory addSubview: label];
+                    controls.push_back (label);
+                }
+
+                if (field.type == NativeMacForm::FieldType::text)
+                {
+                    auto& textField = addTextField();
+                    [textField.getInput() setFrame: toFrame (row.control)];
+                    [accessory addSubview: textField.getInput()];
+
+                    if (! row.message.isEmpty())
+                    {
+                        [textField.getMessageLabel() setFrame: toFrame (row.message)];
+                        [accessory addSubview: textField.getMessageLabel()];
+                    }
+
+                    formControls.push_back (textField.getInput());
+                }
+                else if (field.type == NativeMacForm::FieldType::checkbox)
+                {
+                    NSButton* checkbox = [[NSButton alloc] initWithFrame: toFrame (row.control)];
+                    countNativeObject (checkbox);
+                    [checkbox setButtonType: NSButtonTypeSwitch];
+                    [checkbox setTitle: title];
+                    [accessory addSubview: checkbox];
+                    controls.push_back (checkbox);
+                    formControls.push_back (checkbox);
+                }
+                else
+                {
+                    NSPopUpButton* popup = [[NSPopUpButton alloc] initWithFrame: toFrame (row.control) pullsDown: NO];
+                    countNativeObject (popup);
+
+                    for (auto& item : field.items)
+                        [popup addItemWithTitle: [NSString stringWithUTF8String: item.toRawUTF8()]];
+
+                    [accessory addSubview: popup];
+                    controls.push_back (popup);
+                    formControls.push_back (popup);
+                }
+            }
+        }
+
+        void showFormValues()
+        {
+            jassert ((size_t) form->getNumFields() == formControls.size());
+
+            size_t textIndex = 0;
+
+            for (int i = 0; i < form->getNumFields(); ++i)
+            {
+                auto& field = form->getField (i);
+
+                if (field.type == NativeMacForm::FieldType::text)
+                    textFields[textIndex++]->setContent (field.text, field.maxLength, field.textInput);
+                else if (field.type == NativeMacForm::FieldType::checkbox)
+                    [(NSButton*) formControls[(size_t) i] setState: field.checked ? NSControlStateValueOn : NSControlStateValueOff];
+                else
+                    [(NSPopUpButton*) formControls[(size_t) i] selectItemAtIndex: (NSInteger) field.selectedIndex];
+            }
+
+            updateOkButton();
+        }
+
+        void storeFormValues()
+        {
+            size_t textIndex = 0;
+
+            for (int i = 0; i < form->getNumFields(); ++i)
+            {
+                auto& field = form->getField (i);
+
+                if (field.type == NativeMacForm::FieldType::text)
+                    field.text = textFields[textIndex++]->getText();
+                else if (field.type == NativeMacForm::FieldType::checkbox)
+                    field.checked = [(NSButton*) formControls[(size_t) i] state] == NSControlStateValueOn;
+                else
+                    field.selectedIndex = (int) [(NSPopUpButton*) formControls[(size_t) i] indexOfSelectedItem];
+            }
+        }
+
+        //==============================================================================
+        NSAlert* alert = nil;
+        NSView* accessory = nil;
+        const int numButtons;
+        NativeMacForm* const form;
+        std::vector<std::unique_ptr<TextInputField>> textFields;
+        std::vector<NSView*> controls;         // labels, checkboxes and popups, owned
+        std::vector<NSControl*> formControls;  // the control of each form field, not owned
+        juce::String text;
+        bool suppressionChecked = false;
+    };
+};
+
+std::shared_ptr<NativeMacDialogBackend> createNativeMacAlertDialogBackend()
+{
+    return std::make_shared<NSAlertDialogBackend>();
+}
+
+//==============================================================================
+// NativeMacPasteboard Implementation
+//==============================================================================
+
+#if JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+// Backend wrapping the system-wide general pasteboard
+class NSPasteboardBackend  : public NativeMacPasteboardBackend
+{
+public:
+    ~NSPasteboardBackend() override
+    {
+        [promiseOwner release];
+    }
+
+    juce::int64 writeData (const void* data, size_t size, const juce::String& typeUTI) override
+    {
+        return writeDataWithPromises (data, size, typeUTI, {}, nullptr);
+    }
+
+    juce::int64 writeDataWithPromises (const void* data, size_t size, const juce::String& typeUTI,
+                                       const juce::StringArray& promisedTypes, DataProvider provider) override
+    {
+        const juce::ScopedLock sl (writeLock);
+
+        @autoreleasepool
+        {
+            NSData* dataToCopy = [NSData dataWithBytes: data length: size];
+            NSString* pasteboardType = [NSString stringWithUTF8String: typeUTI.toRawUTF8()];
+            NSMutableArray* types = [NSMutableArray arrayWithObject: pasteboardType];
+
+            // The pasteboard's reference to its owner isn't documented as strong, so we hold
+            // the owner ourselves until the next write replaces it
+            [promiseOwner release];
+            promiseOwner = nil;
+
+            if (provider != nullptr && ! promisedTypes.isEmpty())
+            {
+                for (auto& type : promisedTypes)
+                    [types addObject: [NSString stringWithUTF8String: type.toRawUTF8()]];
+
+                promiseOwner = [[NativeMacPasteboardPromiseProvider alloc] init];
+                countNativeObject (promiseOwner);
+                [promiseOwner setProvider: provider];
+            }
+
+            [[NSPasteboard generalPasteboard] declareTypes: types owner: promiseOwner];
+            [[NSPasteboard generalPasteboard] setData: dataToCopy forType: pasteboardType];
+
+            return (juce::int64) [[NSPasteboard generalPasteboard] changeCount];
+        }
+    }
+
+    bool containsDataType (const juce::String& typeUTI) override
+    {
+        @autoreleasepool
+        {
+            NSString* pasteboardType = [NSString stringWithUTF8String: typeUTI.toRawUTF8()];
+            return [[NSPasteboard generalPasteboard]
+                    canReadItemWithDataConformingToTypes: @[pasteboardType]];
+        }
+    }
+
+    bool readData (const juce::String& typeUTI, DataVisitorFunction visitorFunction, void* context) override
+    {
+        @autoreleasepool
+        {
+            NSString* pasteboardType = [NSString stringWithUTF8String: typeUTI.toRawUTF8()];
+            NSData* data = [[NSPasteboard generalPasteboard] dataForType: pasteboardType];
+
+            if (data == nil)
+                return false;
+
+            visitorFunction (context, data.bytes, (size_t) data.length);
+            return true;
+        }
+    }
+
+    juce::int64 getChangeCount() override
+    {
+        return (juce::int64) [[NSPasteboard generalPasteboard] changeCount];
+    }
+
+private:
+    juce::CriticalSection writeLock;
+    NativeMacPasteboardPromiseProvider* promiseOwner = nil;
+};
+
+std::shared_ptr<NativeMacPasteboardBackend> createNativeMacGeneralPasteboardBackend()
+{
+    return std::make_shared<NSPasteboardBackend>();
+}
+
+#endif // JUCE_NATIVE_MACOS_ENABLE_PASTEBOARD
+
+} // namespace juce (temporarily close for Objective-C declarations)
+
+//==============================================================================
+// NativeMacPopupMenu Implementation - Objective-C declarations at global scope
+//==============================================================================
+
+// Static variable to store the selected menu item ID
+static int gSelectedMenuItemID = 0;
+
+// Target object to handle menu item selection - MUST be at global/file scope
+// Renamed to NativeMacMenuItemTarget to avoid conflicts with JUCE's internal MenuItemTarget
+@interface NativeMacMenuItemTarget : NSObject
+- (void)menuItemSelected:(id)sender;
+@end
+
+@implementation NativeMacMenuItemTarget
+- (void)menuItemSelected:(id)sender
+{
+    NSMenuItem* item = (NSMenuItem*)sender;
+    gSelectedMenuItemID = (int)[item tag];
+}
+@end
+
+namespace juce
+{
+
+//==============================================================================
+// Backend showing NSMenus; a menu is built from the model each time it is shown
+class NSMenuBackend  : public NativeMacMenuBackend
+{
+public:
+    int showMenu (const NativeMacMenuModel& menu, const ShowOptions& options) override
+    {
+        @autoreleasepool
+        {
+            // Reset the selected item ID
+            gSelectedMenuItemID = 0;
+
+            NativeMacMenuItemTarget* target = [[NativeMacMenuItemTarget alloc] init];
+            countNativeObject (target);
+
+            // Only the ticked item of the top level can be positioned under the cursor
+            const auto tracksTickedItem = options.position == Position::atPoint
+                                           || (options.position == Position::mouse && options.centreOnTickedItem);
+
+            NSMenuItem* tickedItem = nil;
+            NSMenu* nsMenu = nil;
+
+            {
+                JUCE_NATIVE_MACOS_TRACE ("menus", "buildNSMenu");
+                nsMenu = buildMenu (menu, 0, menu.getNumItems(), target,
+                                    tracksTickedItem ? &tickedItem : nullptr,
+                                    juce::String(), options.useSmallSize);
+            }
+
+            // The menu is on screen once AppKit starts tracking it
+            id openedObserver = nil;
+
+            if (options.onOpened != nullptr)
+            {
+                const auto* onOpened = &options.onOpened;
+
+                openedObserver = [[NSNotificationCenter defaultCenter] addObserverForName: NSMenuDidBeginTrackingNotification
+                                                                                   object: nsMenu
+                                                                                    queue: nil
+                                                                               usingBlock: ^(NSNotification*)
+                                                                               {
+                                                                                   (*onOpened)();
+                                                                               }];
+            }
+
+            {
+                // Positioning and the menu's tracking loop, which only returns once the menu closes
+                JUCE_NATIVE_MACOS_TRACE ("menus", "menuModalLoop");
+
+                if (options.position == Position::mouse)
+                    showAtMouse (nsMenu, tickedItem, options.parentComponent);
+                else
+                    showAt (nsMenu, tickedItem, options.screenPosition);
+            }
+
+            if (openedObserver != nil)
+                [[NSNotificationCenter defaultCenter] removeObserver: openedObserver];
+
+            const int result = gSelectedMenuItemID;
+
+            // Clean up
+            [nsMenu release];
+            [target release];
+
+            return result;
+        }
+    }
+
+private:
+    //==============================================================================
+    // Builds the items in [begin, end) of the model, recursing into submenus.
+    // Returns the menu and optionally the first ticked item (via output parameter)
+    static NSMenu* buildMenu (const NativeMacMenuModel& menu, int begin, int end,
+                              NativeMacMenuItemTarget* target,
+                              NSMenuItem** outTickedItem,
+                              const juce::String& menuTitle,
+                              bool useSmallSize)
+    {
+        NSMenu* nsMenu = [[NSMenu alloc] initWithTitle: [NSString stringWithUTF8String: menuTitle.toRawUTF8()]];
+        countNativeObject (nsMenu);
+        [nsMenu setAutoenablesItems: NO];
+
+        // Set small menu font size if requested
+        if (useSmallSize)
+        {
+            NSFont* smallFont = [NSFont menuFontOfSize: [NSFont systemFontSizeForControlSize: NSControlSizeSmall]];
+            [nsMenu setFont: smallFont];
+        }
+
+        for (int i = begin; i < end; i = menu.getNextSibling (i))
+        {
+            const auto& item = menu.getItem (i);
+
+            if (item.type == NativeMacMenuModel::ItemType::separator)
+            {
+                NSMenuItem* separator = [NSMenuItem separatorItem];
+                countNativeObject (separator);
+                [nsMenu addItem: separator];
+                continue;
+            }
+
+            NSMenuItem* nsItem = [[NSMenuItem alloc] initWithTitle: [NSString stringWithUTF8String: item.text.toRawUTF8()]
+                                                            action: nil
+                                                     keyEquivalent: @""];
+            countNativeObject (nsItem);
+            [nsItem setEnabled: item.isEnabled];
+
+            if (item.type == NativeMacMenuModel::ItemType::submenu)
+            {
+                // IMPORTANT: DON'T pass outTickedItem to submenus
+                // Only ticked items at the top level can be positioned in the parent menu;
+                // trying to position a submenu item there crashes
+                NSMenu* subMenu = buildMenu (menu, i + 1, menu.getNextSibling (i), target,
+                                             nullptr, item.text, useSmallSize);
+                [nsItem setSubmenu: subMenu];
+                [subMenu release];
+            }
+            else if (item.type == NativeMacMenuModel::ItemType::item)
+            {
+                // Store the item ID in the tag and set the target
+                [nsItem setAction: @selector(menuItemSelected:)];
+                [nsItem setTag: item.itemID];
+                [nsItem setTarget: target];
+                [nsItem setState: item.isTicked ? NSControlStateValueOn : NSControlStateValueOff];
+
+                // If this item is ticked and we haven't found a ticked item yet, store it
+                if (item.isTicked && outTickedItem != nullptr && *outTickedItem == nil)
+                    *outTickedItem = nsItem;
+            }
+
+            // Section headers are disabled items without an action
+            [nsMenu addItem: nsItem];
+            [nsItem release];
+        }
+
+        return nsMenu;
+    }
+
+    static void showAtMouse (NSMenu* nsMenu, NSMenuItem* tickedItem, juce::Component* parentComponent)
+    {
+        // Get current mouse location in screen coordinates
+        NSPoint mouseLocation = [NSEvent mouseLocation];
+
+        NSView* view = parentComponent != nullptr ? (NSView*) parentComponent->getWindowHandle() : nil;
+
+        if (view == nil)
+        {
+            // When no view is available, use the positioning method; a nil item shows the
+            // menu at exactly the mouse position
+            [nsMenu popUpMenuPositioningItem: tickedItem
+                                  atLocation: mouseLocation
+                                      inView: nil];
+            return;
+        }
+
+        // Get or create an event for the menu
+        NSEvent* currentEvent = [NSApp currentEvent];
+
+        if (currentEvent == nil)
+        {
+            currentEvent = [NSEvent mouseEventWithType: NSEventTypeLeftMouseDown
+                                              location: mouseLocation
+                                         modifierFlags: 0
+                                             timestamp: [[NSProcessInfo processInfo] systemUptime]
+                                          windowNumber: 0
+                                               context: nil
+                                           eventNumber: 0
+                                            clickCount: 1
+                                              pressure: 1.0];
+        }
+
+        [NSMenu popUpContextMenu: nsMenu withEvent: currentEvent forView: view];
+    }
+
+    static void showAt (NSMenu* nsMenu, NSMenuItem* tickedItem, juce::Point<int> screenPosition)
+    {
+        // Convert JUCE screen coordinates (top-left origin) to NSPoint (bottom-left origin)
+        NSRect screenFrame = [[NSScreen mainScreen] frame];
+        CGFloat yPos = screenFrame.size.height - (CGFloat) screenPosition.getY();
+
+        // When positioning a specific item, macOS centers it at the given Y coordinate
+        // Add a small offset (~10px, approximately half a menu item height) for proper alignment
+        if (tickedItem != nil)
+            yPos += 10.0;
+
+        // With a ticked item, it is placed under the position so the menu scrolls to show it;
+        // otherwise the menu's top is placed at the position
+        [nsMenu popUpMenuPositioningItem: tickedItem
+                              atLocation: NSMakePoint ((CGFloat) screenPosition.getX(), yPos)
+                                  inView: nil];
+    }
+};
+
+std::shared_ptr<NativeMacMenuBackend> createNativeMacMenuBackend()
+{
+    return std::make_shared<NSMenuBackend>();
+}
+
+} // namespace juce
+
+#endif // JUCE_MAC
@@ -0,0 +1,77 @@
+/*******************************************************************************
+ Menu backends - headless implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+NativeMacHeadlessMenuBackend::NativeMacHeadlessMenuBackend (Responder r)
+    : responder (std::move (r))
+{
+}
+
+void NativeMacHeadlessMenuBackend::setResponder (Responder newResponder)
+{
+    const juce::ScopedLock sl (lock);
+    responder = std::move (newResponder);
+}
+
+int NativeMacHeadlessMenuBackend::showMenu (const NativeMacMenuModel& menu, const ShowOptions& options)
+{
+    ++numMenusShown;
+    numItemsShown += menu.getNumItems();
+
+    Responder responderToUse;
+
+    {
+        const juce::ScopedLock sl (lock);
+        responderToUse = responder;
+    }
+
+    if (options.onOpened != nullptr)
+        options.onOpened();
+
+    const auto itemID = responderToUse != nullptr ? responderToUse (menu, options) : 0;
+
+    if (itemID == 0 || ! canChoose (menu, itemID))
+    {
+        ++numCancelled;
+        return 0;
+    }
+
+    return itemID;
+}
+
+bool NativeMacHeadlessMenuBackend::canChoose (const NativeMacMenuModel& menu, int itemID)
+{
+    auto index = menu.indexOfItemID (itemID);
+
+    if (index < 0)
+        return false;
+
+    for (; index >= 0; index = menu.getItem (index).parent)
+        if (! menu.getItem (index).isEnabled)
+            return false;
+
+    return true;
+}
+
+//==============================================================================
+NativeMacHeadlessMenuBackend::Stats NativeMacHeadlessMenuBackend::getStats() const noexcept
+{
+    Stats stats;
+    stats.numMenusShown = numMenusShown.load();
+    stats.numItemsShown = numItemsShown.load();
+    stats.numCancelled  = numCancelled.load();
+    return stats;
+}
+
+void NativeMacHeadlessMenuBackend::resetStats() noexcept
+{
+    numMenusShown = 0;
+    numItemsShown = 0;
+    numCancelled = 0;
+}
+
+} // namespace juce
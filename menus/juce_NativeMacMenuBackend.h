@@ -0,0 +1,112 @@
+/*******************************************************************************
+ Menu backends
+
+ The interface NativeMacPopupMenu shows its menus with, plus a headless
+ implementation that works on every platform.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Shows the menus of NativeMacPopupMenu.
+
+    On macOS the default backend builds NSMenus. Other implementations can be
+    installed with NativeMacPopupMenu::setBackend(), e.g. a
+    NativeMacHeadlessMenuBackend to exercise menu code without a window server.
+
+    Menus are shown on the message thread.
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacMenuBackend
+{
+public:
+    //==============================================================================
+    virtual ~NativeMacMenuBackend() = default;
+
+    /** Where a menu appears. */
+    enum class Position
+    {
+        mouse,          /**< At the mouse, or as a context menu of parentComponent. */
+        atPoint,        /**< At screenPosition, with the first ticked item under it. */
+        atPointFixed    /**< With its top left corner at screenPosition. */
+    };
+
+    struct ShowOptions
+    {
+        Position position = Position::mouse;
+        juce::Point<int> screenPosition;                /**< JUCE screen coordinates (top-left origin). */
+        juce::Component* parentComponent = nullptr;     /**< Only used with Position::mouse. */
+        bool useSmallSize = false;
+        bool centreOnTickedItem = false;                /**< Only used with Position::mouse. */
+        std::function<void()> onOpened;                 /**< Called once the menu is on screen; may be empty. */
+    };
+
+    /** Shows a menu and waits for the user's choice.
+
+        @returns the ID of the chosen item, or 0 if the menu was cancelled
+    */
+    virtual int showMenu (const NativeMacMenuModel& menu, const ShowOptions& options) = 0;
+};
+
+//==============================================================================
+/**
+    A menu backend that never shows anything.
+
+    Each menu is answered by a responder function, which gets the menu and
+    returns the ID of the item to choose; the menu counts as opened just
+    before. Choosing an ID that isn't in the menu, or whose item or enclosing
+    submenu is disabled, counts as cancelling, as the item couldn't be clicked
+    on screen. Without a responder every menu is cancelled, which is what
+    NativeMacPopupMenu does on platforms other than macOS.
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacHeadlessMenuBackend  : public NativeMacMenuBackend
+{
+public:
+    //==============================================================================
+    /** Answers a menu: returns the ID of the item to choose, or 0 to cancel. */
+    using Responder = std::function<int (const NativeMacMenuModel& menu, const ShowOptions& options)>;
+
+    /** Creates a headless backend. */
+    explicit NativeMacHeadlessMenuBackend (Responder responder = nullptr);
+
+    /** Replaces the responder. */
+    void setResponder (Responder newResponder);
+
+    int showMenu (const NativeMacMenuModel& menu, const ShowOptions& options) override;
+
+    /** Returns true if the item can be chosen: it exists, is a plain item, and it
+        and every submenu around it are enabled.
+    */
+    static bool canChoose (const NativeMacMenuModel& menu, int itemID);
+
+    //==============================================================================
+    struct Stats
+    {
+        juce::int64 numMenusShown = 0;
+        juce::int64 numItemsShown = 0;     /**< Items over all menus, including submenus. */
+        juce::int64 numCancelled = 0;
+    };
+
+    /** Returns the counters accumulated since creation or the last resetStats(). */
+    Stats getStats() const noexcept;
+
+    /** Resets the counters. */
+    void resetStats() noexcept;
+
+private:
+    //==============================================================================
+    juce::CriticalSection lock;
+    Responder responder;
+    std::atomic<juce::int64> numMenusShown { 0 }, numItemsShown { 0 }, numCancelled { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacHeadlessMenuBackend)
+};
+
+} // namespace juce
@@ -0,0 +1,211 @@
+/*******************************************************************************
+ Menu model - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+NativeMacMenuModel::NativeMacMenuModel() = default;
+
+NativeMacMenuModel::NativeMacMenuModel (const juce::PopupMenu& menu)
+{
+    addMenu (menu);
+}
+
+void NativeMacMenuModel::addMenu (const juce::PopupMenu& menu)
+{
+    juce::PopupMenu::MenuItemIterator iterator (menu);
+
+    while (iterator.next())
+    {
+        const auto& item = iterator.getItem();
+
+        if (item.isSeparator)
+        {
+            addSeparator();
+        }
+        else if (item.isSectionHeader)
+        {
+            addSectionHeader (item.text);
+        }
+        else if (item.subMenu != nullptr)
+        {
+            beginSubmenu (item.text, item.isEnabled);
+            addMenu (*item.subMenu);
+            endSubmenu();
+        }
+        else
+        {
+            addItem (item.itemID, item.text, item.isEnabled, item.isTicked);
+        }
+    }
+}
+
+//==============================================================================
+void NativeMacMenuModel::add (Item item)
+{
+    const auto index = (int) items.size();
+
+    if (! openSubmenus.empty())
+    {
+        item.parent = openSubmenus.back();
+        item.depth = (int) openSubmenus.size();
+
+        for (auto submenu : openSubmenus)
+            ++items[(size_t) submenu].numDescendants;
+    }
+
+    if (item.type == ItemType::item)
+        indexByID.emplace (item.itemID, index);   // keeps the first item with an ID
+
+    items.push_back (std::move (item));
+}
+
+void NativeMacMenuModel::addItem (int itemID, const juce::String& text, bool isEnabled, bool isTicked)
+{
+    Item item;
+    item.itemID = itemID;
+    item.text = text;
+    item.isEnabled = isEnabled;
+    item.isTicked = isTicked;
+    add (std::move (item));
+}
+
+void NativeMacMenuModel::addSeparator()
+{
+    Item item;
+    item.type = ItemType::separator;
+    add (std::move (item));
+}
+
+void NativeMacMenuModel::addSectionHeader (const juce::String& text)
+{
+    Item item;
+    item.type = ItemType::sectionHeader;
+    item.text = text;
+    item.isEnabled = false;
+    add (std::move (item));
+}
+
+void NativeMacMenuModel::beginSubmenu (const juce::String& text, bool isEnabled)
+{
+    Item item;
+    item.type = ItemType::submenu;
+    item.text = text;
+    item.isEnabled = isEnabled;
+    add (std::move (item));
+
+    openSubmenus.push_back ((int) items.size() - 1);
+}
+
+void NativeMacMenuModel::endSubmenu()
+{
+    jassert (! openSubmenus.empty());   // no submenu to close
+
+    if (! openSubmenus.empty())
+        openSubmenus.pop_back();
+}
+
+//==============================================================================
+int NativeMacMenuModel::indexOfItemID (int itemID) const
+{
+    const auto it = indexByID.find (itemID);
+    return it != indexByID.end() ? it->second : -1;
+}
+
+int NativeMacMenuModel::indexOfItemText (const juce::String& text) const
+{
+    for (size_t i = 0; i < items.size(); ++i)
+        if (items[i].type == ItemType::item && items[i].text == text)
+            return (int) i;
+
+    return -1;
+}
+
+int NativeMacMenuModel::getFirstTickedTopLevelItem() const noexcept
+{
+    for (int i = 0; i < getNumItems(); i = getNextSibling (i))
+        if (items[(size_t) i].type == ItemType::item && items[(size_t) i].isTicked)
+            return i;
+
+    return -1;
+}
+
+juce::String NativeMacMenuModel::toText() const
+{
+    juce::String text;
+
+    for (auto& item : items)
+    {
+        text << juce::String::repeatedString ("    ", item.depth);
+
+        switch (item.type)
+        {
+            case ItemType::separator:       text << "---"; break;
+            case ItemType::sectionHeader:   text << "# " << item.text; break;
+            case ItemType::submenu:         text << "> " << item.text; break;
+            case ItemType::item:            text << (item.isTicked ? "[x] " : "") << item.text
+                                                 << " (" << juce::String (item.itemID) << ")"; break;
+        }
+
+        if (! item.isEnabled && item.type != ItemType::sectionHeader)
+            text << " [disabled]";
+
+        text << "\n";
+    }
+
+    return text;
+}
+
+//==============================================================================
+juce::uint64 NativeMacMenuModel::getHash() const noexcept
+{
+    using Checksum = NativeMacClipboardPayload::Checksum;
+
+    auto hash = (juce::uint64) items.size();
+
+    for (auto& item : items)
+    {
+        // Depth and type fix the item's place in the tree; parent is implied by them
+        const juce::int32 fields[] = { (juce::int32) item.type, item.itemID, item.depth,
+                                       (item.isEnabled ? 1 : 0) | (item.isTicked ? 2 : 0) };
+
+        hash = Checksum::hash64 (fields, sizeof (fields), hash);
+        hash = Checksum::hash64 (item.text.toRawUTF8(), item.text.getNumBytesAsUTF8(), hash);
+    }
+
+    return hash;
+}
+
+NativeMacMenuModel::Difference NativeMacMenuModel::compare (const NativeMacMenuModel& before,
+                                                           const NativeMacMenuModel& after)
+{
+    Difference difference;
+
+    if (before.items.size() != after.items.size())
+    {
+        difference.structureChanged = true;
+        return difference;
+    }
+
+    for (size_t i = 0; i < before.items.size(); ++i)
+    {
+        const auto& a = before.items[i];
+        const auto& b = after.items[i];
+
+        if (a.type != b.type || a.depth != b.depth)
+        {
+            difference.structureChanged = true;
+            difference.changedItems.clear();
+            return difference;
+        }
+
+        if (a.itemID != b.itemID || a.isEnabled != b.isEnabled || a.isTicked != b.isTicked || a.text != b.text)
+            difference.changedItems.push_back ((int) i);
+    }
+
+    return difference;
+}
+
+} // namespace juce
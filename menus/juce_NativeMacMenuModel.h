@@ -0,0 +1,140 @@
+/*******************************************************************************
+ Menu model
+
+ A flat, platform independent copy of a juce::PopupMenu, which menu
+ backends build their menus from.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    The items of a popup menu, flattened in display order.
+
+    Each submenu item is followed directly by everything inside it, so a whole
+    menu tree lives in one array and a submenu is a contiguous range of it:
+
+    @code
+    0  Presets          (submenu, 3 descendants)
+    1    Init           (parent 0)
+    2    Pads           (submenu, parent 0, 1 descendant)
+    3      Warm Pad     (parent 2)
+    4  ---              (separator)
+    5  Settings...
+    @endcode
+
+    Items can be looked up by ID in constant time. A model is built either from
+    a juce::PopupMenu or item by item, which is how tests and backends that don't
+    depend on PopupMenu create one.
+
+    @see NativeMacMenuBackend
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacMenuModel
+{
+public:
+    //==============================================================================
+    enum class ItemType
+    {
+        item,
+        separator,
+        sectionHeader,
+        submenu
+    };
+
+    struct Item
+    {
+        ItemType type = ItemType::item;
+        int itemID = 0;                   /**< 0 for anything but a plain item. */
+        juce::String text;
+        bool isEnabled = true;
+        bool isTicked = false;
+        int parent = -1;                  /**< Index of the enclosing submenu item, or -1 at the top level. */
+        int depth = 0;                    /**< 0 at the top level. */
+        int numDescendants = 0;           /**< Items inside a submenu, at any depth. */
+    };
+
+    //==============================================================================
+    /** Creates an empty model. */
+    NativeMacMenuModel();
+
+    /** Flattens a PopupMenu, including its submenus. */
+    explicit NativeMacMenuModel (const juce::PopupMenu& menu);
+
+    //==============================================================================
+    /** Adds an item to the current submenu (or the top level). */
+    void addItem (int itemID, const juce::String& text, bool isEnabled = true, bool isTicked = false);
+
+    /** Adds a separator. */
+    void addSeparator();
+
+    /** Adds a section header. */
+    void addSectionHeader (const juce::String& text);
+
+    /** Adds a submenu item; the following items go inside it until endSubmenu(). */
+    void beginSubmenu (const juce::String& text, bool isEnabled = true);
+
+    /** Closes the submenu opened by the last unmatched beginSubmenu(). */
+    void endSubmenu();
+
+    //==============================================================================
+    int getNumItems() const noexcept                      { return (int) items.size(); }
+    const Item& getItem (int index) const noexcept        { return items[(size_t) index]; }
+
+    /** Returns the index of the item after the given one at the same level,
+        skipping everything inside it if it is a submenu.
+    */
+    int getNextSibling (int index) const noexcept         { return index + 1 + items[(size_t) index].numDescendants; }
+
+    /** Returns the index of the first item with the given ID, or -1. Constant time. */
+    int indexOfItemID (int itemID) const;
+
+    /** Returns the index of the first plain item with the given text, or -1. */
+    int indexOfItemText (const juce::String& text) const;
+
+    /** Returns the index of the first ticked item at the top level, or -1. */
+    int getFirstTickedTopLevelItem() const noexcept;
+
+    /** Returns a readable listing, one item per line, indented by depth. */
+    juce::String toText() const;
+
+    //==============================================================================
+    /** Returns a 64-bit hash of every item and its place in the tree.
+
+        Equal models have equal hashes, so a backend that keeps its native menu
+        between shows can tell whether anything changed without comparing items.
+    */
+    juce::uint64 getHash() const noexcept;
+
+    /** The differences between two versions of a menu. */
+    struct Difference
+    {
+        /** True if items were added, removed or moved; the native menu must be rebuilt. */
+        bool structureChanged = false;
+
+        /** With an unchanged structure, the indices of the items whose ID, text,
+            enabled or ticked state changed; these can be updated in place.
+        */
+        std::vector<int> changedItems;
+
+        bool isEmpty() const noexcept   { return ! structureChanged && changedItems.empty(); }
+    };
+
+    /** Compares two versions of a menu item by item. Linear in the number of items. */
+    static Difference compare (const NativeMacMenuModel& before, const NativeMacMenuModel& after);
+
+private:
+    //==============================================================================
+    void add (Item item);
+    void addMenu (const juce::PopupMenu& menu);
+
+    std::vector<Item> items;
+    std::vector<int> openSubmenus;
+    std::unordered_map<int, int> indexByID;
+};
+
+} // namespace juce
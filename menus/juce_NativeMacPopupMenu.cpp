@@ -0,0 +1,126 @@
+/*******************************************************************************
+ NativeMacPopupMenu - platform independent implementation
+
+ Menus are flattened into a NativeMacMenuModel and shown by the current
+ NativeMacMenuBackend. The NSMenu backend lives in juce_native_macos_dialogs.mm.
+*******************************************************************************/
+
+namespace juce
+{
+
+#if JUCE_MAC
+ // Defined in juce_native_macos_dialogs.mm
+ std::shared_ptr<NativeMacMenuBackend> createNativeMacMenuBackend();
+#endif
+
+namespace PopupMenuHelpers
+{
+    static std::shared_ptr<NativeMacMenuBackend> createDefaultBackend()
+    {
+       #if JUCE_MAC
+        return createNativeMacMenuBackend();
+       #else
+        // Nothing to show menus with on this platform, so every menu is cancelled
+        return std::make_shared<NativeMacHeadlessMenuBackend>();
+       #endif
+    }
+
+    struct BackendHolder
+    {
+        juce::SpinLock lock;
+        std::shared_ptr<NativeMacMenuBackend> backend;
+    };
+
+    static BackendHolder& getBackendHolder()
+    {
+        static BackendHolder holder;
+        return holder;
+    }
+
+    static NativeMacMenuModel flatten (const juce::PopupMenu& menu)
+    {
+        JUCE_NATIVE_MACOS_TRACE ("menus", "flattenMenu");
+        return NativeMacMenuModel (menu);
+    }
+
+    static int show (const juce::PopupMenu& menu, NativeMacMenuBackend::ShowOptions& options,
+                     NativeMacLatencyStats::Function function)
+    {
+        NativeMacLatencyStats::ScopedCall call (function);
+        options.onOpened = call.getOpenedCallback();
+
+        const auto model = flatten (menu);
+        return NativeMacPopupMenu::getBackend()->showMenu (model, options);
+    }
+}
+
+//==============================================================================
+void NativeMacPopupMenu::setBackend (std::shared_ptr<NativeMacMenuBackend> newBackend)
+{
+    auto& holder = PopupMenuHelpers::getBackendHolder();
+
+    const juce::SpinLock::ScopedLockType sl (holder.lock);
+    holder.backend = std::move (newBackend);
+}
+
+std::shared_ptr<NativeMacMenuBackend> NativeMacPopupMenu::getBackend()
+{
+    auto& holder = PopupMenuHelpers::getBackendHolder();
+
+    const juce::SpinLock::ScopedLockType sl (holder.lock);
+
+    if (holder.backend == nullptr)
+        holder.backend = PopupMenuHelpers::createDefaultBackend();
+
+    return holder.backend;
+}
+
+//==============================================================================
+int NativeMacPopupMenu::showPopupMenu (const juce::PopupMenu& menu,
+                                       juce::Component* parentComponent,
+                                       bool useSmallSize,
+                                       bool centerOnCheckedItem)
+{
+    JUCE_NATIVE_MACOS_TRACE ("menus", "showPopupMenu");
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (showPopupMenu);
+
+    NativeMacMenuBackend::ShowOptions options;
+    options.position = NativeMacMenuBackend::Position::mouse;
+    options.parentComponent = parentComponent;
+    options.useSmallSize = useSmallSize;
+    options.centreOnTickedItem = centerOnCheckedItem;
+
+    return PopupMenuHelpers::show (menu, options, NativeMacLatencyStats::Function::showPopupMenu);
+}
+
+int NativeMacPopupMenu::showPopupMenuAt (const juce::PopupMenu& menu,
+                                         juce::Point<int> screenPosition,
+                                         bool useSmallSize)
+{
+    JUCE_NATIVE_MACOS_TRACE ("menus", "showPopupMenuAt");
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (showPopupMenuAt);
+
+    NativeMacMenuBackend::ShowOptions options;
+    options.position = NativeMacMenuBackend::Position::atPoint;
+    options.screenPosition = screenPosition;
+    options.useSmallSize = useSmallSize;
+
+    return PopupMenuHelpers::show (menu, options, NativeMacLatencyStats::Function::showPopupMenuAt);
+}
+
+int NativeMacPopupMenu::showPopupMenuAtFixed (const juce::PopupMenu& menu,
+                                              juce::Point<int> screenPosition,
+                                              bool useSmallSize)
+{
+    JUCE_NATIVE_MACOS_TRACE ("menus", "showPopupMenuAtFixed");
+    JUCE_NATIVE_MACOS_COUNT_ALLOCATIONS (showPopupMenuAtFixed);
+
+    NativeMacMenuBackend::ShowOptions options;
+    options.position = NativeMacMenuBackend::Position::atPointFixed;
+    options.screenPosition = screenPosition;
+    options.useSmallSize = useSmallSize;
+
+    return PopupMenuHelpers::show (menu, options, NativeMacLatencyStats::Function::showPopupMenuAtFixed);
+}
+
+} // namespace juce
@@ -0,0 +1,546 @@
+/*******************************************************************************
+ Scripted user interface - implementation
+*******************************************************************************/
+
+namespace juce
+{
+
+//==============================================================================
+NativeMacScriptedUI::NativeMacScriptedUI()
+    : NativeMacScriptedUI (Options())
+{
+}
+
+NativeMacScriptedUI::NativeMacScriptedUI (Options o, std::function<double()> c)
+    : options (o),
+      clock (c != nullptr ? std::move (c) : [] { return juce::Time::getMillisecondCounterHiRes(); }),
+      dialogBackend (std::make_shared<NativeMacHeadlessDialogBackend>()),
+      menuBackend (std::make_shared<NativeMacHeadlessMenuBackend>())
+{
+    dialogBackend->setResponder ([this] (const NativeMacDialogBackend::AlertContent& content, juce::String& text)
+    {
+        return answerAlert (content, text);
+    });
+
+    menuBackend->setResponder ([this] (const NativeMacMenuModel& menu, const NativeMacMenuBackend::ShowOptions&)
+    {
+        return answerMenu (menu);
+    });
+}
+
+NativeMacScriptedUI::~NativeMacScriptedUI()
+{
+    uninstall();
+
+    // Someone may still hold a backend; it must not call back into a deleted script
+    dialogBackend->setResponder (nullptr);
+    menuBackend->setResponder (nullptr);
+}
+
+//==============================================================================
+void NativeMacScriptedUI::install()
+{
+    NativeMacDialogs::setBackend (dialogBackend);
+    NativeMacPopupMenu::setBackend (menuBackend);
+}
+
+void NativeMacScriptedUI::uninstall()
+{
+    if (NativeMacDialogs::getBackend() == dialogBackend)
+        NativeMacDialogs::setBackend (nullptr);
+
+    if (NativeMacPopupMenu::getBackend() == menuBackend)
+        NativeMacPopupMenu::setBackend (nullptr);
+}
+
+//==============================================================================
+NativeMacScriptedUI& NativeMacScriptedUI::addStep (Step step)
+{
+    const juce::ScopedLock sl (lock);
+
+    if (step.kind == Kind::alert)
+    {
+        step.hasText = pendingAlertInput.hasText;
+        step.text = pendingAlertInput.text;
+        step.tickSuppression = pendingAlertInput.tickSuppression;
+        step.formEditor = std::move (pendingAlertInput.formEditor);
+        pendingAlertInput = {};
+    }
+    else
+    {
+        // typeText(), tickSuppression() and editForm() must be followed by an alert step
+        jassert (! pendingAlertInput.hasText && ! pendingAlertInput.tickSuppression
+                  && pendingAlertInput.formEditor == nullptr);
+    }
+
+    steps.push_back (std::move (step));
+    return *this;
+}
+
+NativeMacScriptedUI& NativeMacScriptedUI::selectMenuItem (int itemID, double afterMs)
+{
+    Step step;
+    step.kind = Kind::menu;
+    step.afterMs = afterMs;
+    step.value = itemID;
+    return addStep (std::move (step));
+}
+
+NativeMacScriptedUI& NativeMacScriptedUI::selectMenuItem (const juce::String& itemText, double afterMs)
+{
+    Step step;
+    step.kind = Kind::menu;
+    step.afterMs = afterMs;
+    step.name = itemText;
+    return addStep (std::move (step));
+}
+
+NativeMacScriptedUI& NativeMacScriptedUI::cancelMenu (double afterMs)
+{
+    return selectMenuItem (0, afterMs);
+}
+
+NativeMacScriptedUI& NativeMacScriptedUI::clickButton (int buttonIndex, double afterMs)
+{
+    Step step;
+    step.afterMs = afterMs;
+    step.value = buttonIndex;
+    return addStep (std::move (step));
+}
+
+NativeMacScriptedUI& NativeMacScriptedUI::clickButton (const juce::String& buttonText, double afterMs)
+{
+    Step step;
+    step.afterMs = afterMs;
+    step.name = buttonText;
+    return addStep (std::move (step));
+}
+
+NativeMacScriptedUI& NativeMacScriptedUI::dismissAlert (double afterMs)
+{
+    return clickButton (-1, afterMs);
+}
+
+NativeMacScriptedUI& NativeMacScriptedUI::typeText (const juce::String& text)
+{
+    const juce::ScopedLock sl (lock);
+    pendingAlertInput.hasText = true;
+    pendingAlertInput.text = text;
+    return *this;
+}
+
+NativeMacScriptedUI& NativeMacScriptedUI::tickSuppression()
+{
+    const juce::ScopedLock sl (lock);
+    pendingAlertInput.tickSuppression = true;
+    return *this;
+}
+
+NativeMacScriptedUI& NativeMacScriptedUI::editForm (std::function<void (NativeMacForm&)> editor)
+{
+    const juce::ScopedLock sl (lock);
+    pendingAlertInput.formEditor = std::move (editor);
+    return *this;
+}
+
+//==============================================================================
+bool NativeMacScriptedUI::takeStep (Kind kind, const juce::String& description, Step& step)
+{
+    const juce::ScopedLock sl (lock);
+
+    if (steps.empty())
+    {
+        errors.add ("Unexpected " + description + ": the script has no steps left");
+        return false;
+    }
+
+    if (steps.front().kind != kind)
+    {
+        errors.add ("Expected " + juce::String (kind == Kind::alert ? "a menu" : "an alert")
+                      + ", but " + description + " was shown");
+        return false;
+    }
+
+    step = std::move (steps.front());
+    steps.pop_front();
+    return true;
+}
+
+void NativeMacScriptedUI::wait (double ms) const
+{
+    const auto scaledMs = ms * options.timeScale;
+
+    if (scaledMs > 0)
+        juce::Thread::sleep (jmax (1, roundToInt (scaledMs)));
+}
+
+int NativeMacScriptedUI::answerAlert (const NativeMacDialogBackend::AlertContent& content, juce::String& text)
+{
+    Record record;
+    record.kind = Kind::alert;
+    record.title = content.title;
+    record.message = content.message;
+    record.buttons = content.buttons;
+    record.contents = content.hasTextField ? content.text : juce::String();
+    record.result = -1;
+    record.shownAtMs = clock();
+
+    Step step;
+    record.scripted = takeStep (Kind::alert, "alert \"" + content.title + "\"", step);
+
+    if (record.scripted)
+    {
+        wait (step.afterMs);
+
+        auto button = step.value;
+
+        if (step.name.isNotEmpty())
+        {
+            button = -1;
+
+            for (int i = 0; i < content.buttons.size(); ++i)
+                if (content.buttons[i] == step.name)
+                    button = i;
+
+            if (button < 0)
+            {
+                const juce::ScopedLock sl (lock);
+                errors.add ("Alert \"" + content.title + "\" has no button \"" + step.name + "\"");
+            }
+        }
+
+        if (step.hasText)
+        {
+            text = step.text;
+            record.typedText = step.text;
+        }
+
+        if (step.formEditor != nullptr && content.form != nullptr)
+            step.formEditor (*content.form);
+
+        record.suppressionTicked = step.tickSuppression && content.suppressionText.isNotEmpty();
+        record.result = button;
+    }
+
+    dialogBackend->setSuppressionChecked (record.suppressionTicked);
+    record.answeredAtMs = clock();
+
+    const juce::ScopedLock sl (lock);
+    records.push_back (std::move (record));
+    return records.back().result;
+}
+
+int NativeMacScriptedUI::answerMenu (const NativeMacMenuModel& menu)
+{
+    Record record;
+    record.kind = Kind::menu;
+    record.contents = menu.toText();
+    record.shownAtMs = clock();
+
+    Step step;
+    record.scripted = takeStep (Kind::menu, "a menu", step);
+
+    if (record.scripted)
+    {
+        wait (step.afterMs);
+
+        auto itemID = step.value;
+
+        if (step.name.isNotEmpty())
+        {
+            const auto index = menu.indexOfItemText (step.name);
+            itemID = index >= 0 ? menu.getItem (index).itemID : 0;
+        }
+
+        if ((itemID != 0 || step.name.isNotEmpty()) && ! NativeMacHeadlessMenuBackend::canChoose (menu, itemID))
+        {
+            const juce::ScopedLock sl (lock);
+            errors.add ("The menu has no item " + (step.name.isNotEmpty() ? "\"" + step.name + "\"" : juce::String (itemID))
+                          + " that can be chosen");
+            itemID = 0;
+        }
+
+        record.result = itemID;
+    }
+
+    record.answeredAtMs = clock();
+
+    const juce::ScopedLock sl (lock);
+    records.push_back (std::move (record));
+    return records.back().result;
+}
+
+//==============================================================================
+int NativeMacScriptedUI::getNumStepsRemaining() const
+{
+    const juce::ScopedLock sl (lock);
+    return (int) steps.size();
+}
+
+std::vector<NativeMacScriptedUI::Record> NativeMacScriptedUI::getRecords() const
+{
+    const juce::ScopedLock sl (lock);
+    return records;
+}
+
+juce::StringArray NativeMacScriptedUI::getErrors() const
+{
+    const juce::ScopedLock sl (lock);
+    return errors;
+}
+
+void NativeMacScriptedUI::clear()
+{
+    const juce::ScopedLock sl (lock);
+    steps.clear();
+    pendingAlertInput = {};
+    records.clear();
+    errors.clear();
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class NativeMacScriptedUITests  : public juce::UnitTest
+{
+public:
+    NativeMacScriptedUITests()
+        : juce::UnitTest ("NativeMacScriptedUI", "juce_native_macos_dialogs")
+    {
+    }
+
+    void runTest() override
+    {
+        const auto previousDialogBackend = NativeMacDialogs::getBackend();
+        const auto previousMenuBackend = NativeMacPopupMenu::getBackend();
+        const auto previousStore = NativeMacDialogs::getSuppressionStore();
+
+        // Each reading of the clock is a millisecond later than the last
+        double nowMs = 0.0;
+
+        NativeMacScriptedUI::Options options;
+        options.timeScale = 0.0;
+
+        juce::PopupMenu menu;
+        menu.addItem (1, "Cut");
+        menu.addItem (2, "Copy");
+        menu.addItem (3, "Paste", false);
+
+        beginTest ("Scripted sequence");
+        {
+            NativeMacScriptedUI ui (options, [&nowMs] { return nowMs += 1.0; });
+            ui.selectMenuItem (1)
+              .typeText ("Pad").clickButton ("Save")
+              .clickButton (1)
+              .selectMenuItem ("Copy")
+              .dismissAlert()
+              .cancelMenu();
+            ui.install();
+
+            expect (NativeMacDialogs::getBackend() == ui.getDialogBackend());
+            expect (NativeMacPopupMenu::getBackend() == ui.getMenuBackend());
+            expectEquals (ui.getNumStepsRemaining(), 6);
+
+            expectEquals (NativeMacPopupMenu::showPopupMenu (menu), 1);
+
+            juce::String presetName;
+            expect (NativeMacDialogs::showTextInputDialog ("Save Preset", "Name:", "Init", 0, "Save", "Cancel", presetName));
+            expectEquals (presetName, juce::String ("Pad"));
+
+            expect (! NativeMacDialogs::showConfirmDialog ("Delete", "Delete the preset?", "Delete", "Keep"));
+            expectEquals (NativeMacPopupMenu::showPopupMenu (menu), 2);
+            NativeMacDialogs::showInfoDialog ("Saved", "The preset was saved.");
+            expectEquals (NativeMacPopupMenu::showPopupMenu (menu), 0);
+
+            expect (ui.getErrors().isEmpty(), ui.getErrors().joinIntoString ("\n"));
+            expectEquals (ui.getNumStepsRemaining(), 0);
+
+            const auto records = ui.getRecords();
+            expectEquals ((int) records.size(), 6);
+
+            if (records.size() == 6)
+            {
+                using Kind = NativeMacScriptedUI::Kind;
+
+                expectRecord (records[0], Kind::menu,  {},            1);
+                expectRecord (records[1], Kind::alert, "Save Preset", 0);
+                expectRecord (records[2], Kind::alert, "Delete",      1);
+                expectRecord (records[3], Kind::menu,  {},            2);
+                expectRecord (records[4], Kind::alert, "Saved",       -1);
+                expectRecord (records[5], Kind::menu,  {},            0);
+
+                expectEquals (records[0].contents, NativeMacMenuModel (menu).toText());
+                expectEquals (records[1].message, juce::String ("Name:"));
+                expectEquals (records[1].buttons.joinIntoString (","), juce::String ("Save,Cancel"));
+                expectEquals (records[1].contents, juce::String ("Init"));
+                expectEquals (records[1].typedText, juce::String ("Pad"));
+                expectEquals (records[2].buttons.joinIntoString (","), juce::String ("Delete,Keep"));
+                expect (records[2].contents.isEmpty());
+                expect (records[2].typedText.isEmpty());
+
+                // In the order shown, each answered after it was shown
+                for (size_t i = 0; i < records.size(); ++i)
+                {
+                    expectGreaterThan (records[i].answeredAtMs, records[i].shownAtMs);
+
+                    if (i > 0)
+                        expectGreaterThan (records[i].shownAtMs, records[i - 1].answeredAtMs);
+                }
+            }
+
+            ui.uninstall();
+            expect (NativeMacDialogs::getBackend() != ui.getDialogBackend());
+            expect (NativeMacPopupMenu::getBackend() != ui.getMenuBackend());
+        }
+
+        beginTest ("No steps left");
+        {
+            NativeMacScriptedUI ui (options);
+            ui.clickButton (0);
+            ui.install();
+
+            expect (NativeMacDialogs::showConfirmDialog ("Delete", "Delete the preset?"));
+
+            // Anything after the last step gets the default answer and is reported
+            expect (! NativeMacDialogs::showConfirmDialog ("Delete", "Delete another preset?"));
+            expectEquals (NativeMacPopupMenu::showPopupMenu (menu), 0);
+
+            expectErrors (ui, { "Unexpected alert \"Delete\": the script has no steps left",
+                                "Unexpected a menu: the script has no steps left" });
+
+            const auto records = ui.getRecords();
+            expectEquals ((int) records.size(), 3);
+
+            if (records.size() == 3)
+            {
+                expect (records[0].scripted);
+                expect (! records[1].scripted);
+                expect (! records[2].scripted);
+                expectEquals (records[1].result, -1);
+                expectEquals (records[2].result, 0);
+            }
+
+            // clear() forgets everything
+            ui.clear();
+            expect (ui.getErrors().isEmpty());
+            expect (ui.getRecords().empty());
+        }
+
+        beginTest ("Steps of the wrong kind stay in the script");
+        {
+            NativeMacScriptedUI ui (options);
+            ui.clickButton (0).selectMenuItem (2);
+            ui.install();
+
+            expectEquals (NativeMacPopupMenu::showPopupMenu (menu), 0);
+            expectEquals (ui.getNumStepsRemaining(), 2);
+
+            expect (NativeMacDialogs::showConfirmDialog ("Delete", "Delete the preset?"));
+            expectEquals (ui.getNumStepsRemaining(), 1);
+
+            expect (! NativeMacDialogs::showConfirmDialog ("Rename", "Rename the preset?"));
+            expectEquals (ui.getNumStepsRemaining(), 1);
+
+            expectEquals (NativeMacPopupMenu::showPopupMenu (menu), 2);
+            expectEquals (ui.getNumStepsRemaining(), 0);
+
+            expectErrors (ui, { "Expected an alert, but a menu was shown",
+                                "Expected a menu, but alert \"Rename\" was shown" });
+        }
+
+        beginTest ("Steps that don't fit are used up");
+        {
+            NativeMacScriptedUI ui (options);
+            ui.clickButton ("Remove")
+              .selectMenuItem (3)
+              .selectMenuItem ("Undo")
+              .selectMenuItem (42);
+            ui.install();
+
+            expect (! NativeMacDialogs::showConfirmDialog ("Delete", "Delete the preset?", "Delete", "Keep"));
+
+            for (int i = 0; i < 3; ++i)
+                expectEquals (NativeMacPopupMenu::showPopupMenu (menu), 0);
+
+            expectEquals (ui.getNumStepsRemaining(), 0);
+            expectErrors (ui, { "Alert \"Delete\" has no button \"Remove\"",
+                                "The menu has no item 3 that can be chosen",
+                                "The menu has no item \"Undo\" that can be chosen",
+                                "The menu has no item 42 that can be chosen" });
+
+            const auto records = ui.getRecords();
+            expectEquals ((int) records.size(), 4);
+
+            if (records.size() == 4)
+                expectEquals (records[0].result, -1);
+        }
+
+        beginTest ("Suppression");
+        {
+            NativeMacDialogs::setSuppressionStore (std::make_shared<NativeMacSuppressionStore>());
+
+            NativeMacConfirmOptions confirmOptions;
+            confirmOptions.suppressionID = "scriptedUITests.delete";
+
+            NativeMacScriptedUI ui (options);
+            ui.tickSuppression().clickButton ("Keep");
+            ui.install();
+
+            // The remembered answer is used without showing the dialog again
+            expect (! NativeMacDialogs::showConfirmDialog ("Delete", "Delete the preset?", "Delete", "Keep", confirmOptions));
+            expect (! NativeMacDialogs::showConfirmDialog ("Delete", "Delete the preset?", "Delete", "Keep", confirmOptions));
+
+            expect (ui.getErrors().isEmpty(), ui.getErrors().joinIntoString ("\n"));
+
+            const auto records = ui.getRecords();
+            expectEquals ((int) records.size(), 1);
+
+            if (records.size() == 1)
+                expect (records[0].suppressionTicked);
+        }
+
+        beginTest ("Destruction uninstalls");
+        {
+            std::weak_ptr<NativeMacHeadlessDialogBackend> dialogBackend;
+            std::weak_ptr<NativeMacHeadlessMenuBackend> menuBackend;
+
+            {
+                NativeMacScriptedUI ui (options);
+                ui.install();
+
+                dialogBackend = ui.getDialogBackend();
+                menuBackend = ui.getMenuBackend();
+            }
+
+            // Nothing holds the script's backends any more
+            expect (dialogBackend.expired());
+            expect (menuBackend.expired());
+        }
+
+        NativeMacDialogs::setBackend (previousDialogBackend);
+        NativeMacPopupMenu::setBackend (previousMenuBackend);
+        NativeMacDialogs::setSuppressionStore (previousStore);
+    }
+
+private:
+    void expectRecord (const NativeMacScriptedUI::Record& record, NativeMacScriptedUI::Kind kind,
+                       const juce::String& title, int result)
+    {
+        expect (record.kind == kind, title);
+        expectEquals (record.title, title);
+        expectEquals (record.result, result, title);
+        expect (record.scripted, title);
+    }
+
+    void expectErrors (const NativeMacScriptedUI& ui, const juce::StringArray& expected)
+    {
+        expectEquals (ui.getErrors().joinIntoString ("\n"), expected.joinIntoString ("\n"));
+    }
+};
+
+static NativeMacScriptedUITests nativeMacScriptedUITests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,186 @@
+/*******************************************************************************
+ Scripted user interface
+
+ Replays scripted user responses to the module's dialogs and menus, and
+ records what would have been shown. Runs on any platform.
+*******************************************************************************/
+
+#pragma once
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Stands in for the user: answers dialogs and menus from a script.
+
+    Once installed, NativeMacDialogs, NativeMacAlertTemplate, NativeMacDialogQueue
+    and NativeMacPopupMenu show everything through headless backends, and each
+    dialog or menu consumes the next step of the script:
+
+    @code
+    NativeMacScriptedUI ui;
+    ui.selectMenuItem (42, 3.0)                 // pick item 42 after 3 ms
+      .typeText ("Pad").clickButton ("OK")      // type into the next dialog, then click OK
+      .tickSuppression().clickButton (0);       // "Don't ask again", then the first button
+    ui.install();
+
+    runTheCodeUnderTest();
+
+    jassert (ui.getErrors().isEmpty() && ui.getNumStepsRemaining() == 0);
+
+    for (auto& record : ui.getRecords())
+        DBG (record.title << " -> " << record.result);
+    @endcode
+
+    When a step doesn't fit, an error is recorded and the dialog is dismissed or
+    the menu cancelled. A step of the wrong kind (a menu step when an alert comes
+    up) stays in the script; a step naming a button or item that doesn't exist or
+    is disabled is used up. Anything shown after the script has run out is an
+    error too.
+
+    Step delays are real waits, so timing measured around the code under test
+    includes the simulated user; set Options::timeScale to 0 to answer at once.
+
+    Steps can be added from any thread; dialogs and menus are answered on the
+    thread that shows them.
+
+    @see NativeMacHeadlessDialogBackend, NativeMacHeadlessMenuBackend
+
+    @tags{GUI}
+*/
+class JUCE_API  NativeMacScriptedUI
+{
+public:
+    //==============================================================================
+    struct Options
+    {
+        double timeScale = 1.0;            /**< Multiplies every step delay; 0 answers at once. */
+    };
+
+    enum class Kind
+    {
+        alert,
+        menu
+    };
+
+    /** What was shown, and how the script answered it. */
+    struct Record
+    {
+        Kind kind = Kind::alert;
+        juce::String title;                /**< Empty for menus. */
+        juce::String message;
+        juce::StringArray buttons;
+        juce::String contents;             /**< The menu listing (NativeMacMenuModel::toText()), or the initial text of a text field. */
+        int result = 0;                    /**< The button index (-1 if dismissed) or item ID (0 if cancelled). */
+        juce::String typedText;
+        bool suppressionTicked = false;
+        bool scripted = false;             /**< False if no step matched and the default answer was used. */
+        double shownAtMs = 0.0;
+        double answeredAtMs = 0.0;
+    };
+
+    //==============================================================================
+    /** Creates an empty script. */
+    NativeMacScriptedUI();
+
+    /** Creates an empty script.
+
+        @param options   Delay scaling
+        @param clock     Returns the current time in milliseconds for the records; if
+                         empty, Time::getMillisecondCounterHiRes() is used
+    */
+    NativeMacScriptedUI (Options options, std::function<double()> clock = nullptr);
+
+    /** Destructor. Uninstalls the backends if they are still installed. */
+    ~NativeMacScriptedUI();
+
+    //==============================================================================
+    /** Chooses a menu item by ID. */
+    NativeMacScriptedUI& selectMenuItem (int itemID, double afterMs = 0.0);
+
+    /** Chooses the first menu item with the given text, at any depth. */
+    NativeMacScriptedUI& selectMenuItem (const juce::String& itemText, double afterMs = 0.0);
+
+    /** Cancels a menu. */
+    NativeMacScriptedUI& cancelMenu (double afterMs = 0.0);
+
+    /** Clicks an alert button by index; 0 is the default button. */
+    NativeMacScriptedUI& clickButton (int buttonIndex, double afterMs = 0.0);
+
+    /** Clicks the alert button with the given title. */
+    NativeMacScriptedUI& clickButton (const juce::String& buttonText, double afterMs = 0.0);
+
+    /** Closes an alert without choosing a button. */
+    NativeMacScriptedUI& dismissAlert (double afterMs = 0.0);
+
+    /** Replaces the text field's text in the next alert step added. */
+    NativeMacScriptedUI& typeText (const juce::String& text);
+
+    /** Ticks the "Don't ask again" checkbox in the next alert step added. */
+    NativeMacScriptedUI& tickSuppression();
+
+    /** Changes the form's fields in the next alert step added. */
+    NativeMacScriptedUI& editForm (std::function<void (NativeMacForm& form)> editor);
+
+    //==============================================================================
+    /** Makes NativeMacDialogs and NativeMacPopupMenu use this script's backends. */
+    void install();
+
+    /** Restores the default backends, if this script's are still installed. */
+    void uninstall();
+
+    /** Returns the dialog backend, e.g. for its counters. */
+    std::shared_ptr<NativeMacHeadlessDialogBackend> getDialogBackend() const noexcept   { return dialogBackend; }
+
+    /** Returns the menu backend, e.g. for its counters. */
+    std::shared_ptr<NativeMacHeadlessMenuBackend> getMenuBackend() const noexcept       { return menuBackend; }
+
+    //==============================================================================
+    /** Returns the number of steps not consumed yet. */
+    int getNumStepsRemaining() const;
+
+    /** Returns a record of everything shown so far, in order. */
+    std::vector<Record> getRecords() const;
+
+    /** Returns a description of each step that didn't fit and each unexpected dialog or menu. */
+    juce::StringArray getErrors() const;
+
+    /** Removes all steps, records and errors. */
+    void clear();
+
+private:
+    //==============================================================================
+    struct Step
+    {
+        Kind kind = Kind::alert;
+        double afterMs = 0.0;
+        int value = 0;                     // button index or item ID
+        juce::String name;                 // button title or item text, if chosen by name
+        bool hasText = false;
+        juce::String text;
+        bool tickSuppression = false;
+        std::function<void (NativeMacForm&)> formEditor;
+    };
+
+    NativeMacScriptedUI& addStep (Step step);
+    int answerAlert (const NativeMacDialogBackend::AlertContent& content, juce::String& text);
+    int answerMenu (const NativeMacMenuModel& menu);
+    bool takeStep (Kind kind, const juce::String& description, Step& step);
+    void wait (double ms) const;
+
+    const Options options;
+    const std::function<double()> clock;
+    const std::shared_ptr<NativeMacHeadlessDialogBackend> dialogBackend;
+    const std::shared_ptr<NativeMacHeadlessMenuBackend> menuBackend;
+
+    mutable juce::CriticalSection lock;    // guards the members below
+    std::deque<Step> steps;
+    Step pendingAlertInput;                // typeText(), tickSuppression() and editForm() for the next alert step
+    std::vector<Record> records;
+    juce::StringArray errors;
+
+    JUCE_DECLARE_NON_COPYABLE (NativeMacScriptedUI)
+};
+
+} // namespace juce